@@ -99,6 +99,7 @@ SOURCES += fiff.cpp \
     fiff_cov.cpp \
     fiff_stream.cpp \
     fiff_dir_entry.cpp \
+    fiff_dir_index.cpp \
     fiff_info_base.cpp \
     fiff_evoked.cpp \
     fiff_evoked_set.cpp \
@@ -119,6 +120,7 @@ HEADERS += fiff.h \
     fiff_info.h \
     fiff_raw_data.h \
     fiff_dir_entry.h \
+    fiff_dir_index.h \
     fiff_raw_dir.h \
     fiff_dig_point.h \
     fiff_ch_pos.h \
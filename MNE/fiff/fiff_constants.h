@@ -623,6 +623,27 @@ namespace FIFFLIB
 //
 #define FIFFB_MNE_RT_MEAS_INFO      3710              /**< Fiff Real-Time Measurement Info */
 
+//
+// 3720... Cluster cache
+//
+#define FIFFB_MNE_CLUSTER_CACHE             3720    /**< Cached result of a forward solution or kernel clustering */
+#define FIFFB_MNE_CLUSTER_INFO              3721    /**< Cluster information of one hemisphere */
+
+#define FIFF_MNE_CLUSTER_CACHE_KEY          3730    /**< Hash of the clustering inputs */
+#define FIFF_MNE_CLUSTER_DATA               3731    /**< Clustered gain matrix or kernel (double, column major) */
+#define FIFF_MNE_CLUSTER_OPERATOR           3732    /**< Non-zero values of the cluster operator D (sources x clusters, double) */
+#define FIFF_MNE_CLUSTER_LABEL_NAMES        3733    /**< Label name of each cluster */
+#define FIFF_MNE_CLUSTER_LABEL_IDS          3734    /**< Label id of each cluster */
+#define FIFF_MNE_CLUSTER_CENTROID_VERTNO    3735    /**< Vertex closest to each cluster centroid */
+#define FIFF_MNE_CLUSTER_CENTROID_RR        3736    /**< Location of the vertex closest to each cluster centroid */
+#define FIFF_MNE_CLUSTER_NVERT              3737    /**< Number of vertices of each cluster */
+#define FIFF_MNE_CLUSTER_VERTNOS            3738    /**< Vertices of all clusters, one cluster after the other */
+#define FIFF_MNE_CLUSTER_SOURCE_RR          3739    /**< Locations of the vertices of all clusters */
+#define FIFF_MNE_CLUSTER_DISTANCES          3740    /**< Distances of the vertices of all clusters to their centroid */
+#define FIFF_MNE_CLUSTER_OPERATOR_DIM       3741    /**< Number of rows and columns of the cluster operator D */
+#define FIFF_MNE_CLUSTER_OPERATOR_ROWS      3742    /**< Row index of each non-zero value of D */
+#define FIFF_MNE_CLUSTER_OPERATOR_COLS      3743    /**< Column index of each non-zero value of D */
+
 
 //
 // Fiff values associated with MNE computations
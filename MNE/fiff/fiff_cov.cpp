@@ -333,12 +333,28 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
 {
     FiffCov cov(*this);
 
+    RegularizePlan t_plan;
+    if(this->prepare_regularization(t_plan, p_info, p_fRegMag, p_fRegGrad, p_fRegEeg, p_bProj, p_exclude))
+        cov.apply_regularization(t_plan);
+
+    return cov;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffCov::prepare_regularization(RegularizePlan& p_plan, const FiffInfo& p_info, double p_fRegMag, double p_fRegGrad, double p_fRegEeg, bool p_bProj, QStringList p_exclude) const
+{
+    p_plan = RegularizePlan();
+    p_plan.bads = p_info.bads + this->bads;
+    p_plan.projs = p_info.projs + this->projs;
+
     if(p_exclude.size() == 0)
     {
         p_exclude = p_info.bads;
-        for(qint32 i = 0; i < cov.bads.size(); ++i)
-            if(!p_exclude.contains(cov.bads[i]))
-                p_exclude << cov.bads[i];
+        for(qint32 i = 0; i < this->bads.size(); ++i)
+            if(!p_exclude.contains(this->bads[i]))
+                p_exclude << this->bads[i];
     }
 
     //Allways exclude all STI channels from covariance computation
@@ -360,9 +376,11 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
         ch_names_grad << info_ch_names[sel_grad(i)];
 
     // This actually removes bad channels from the cov, which is not backward
-    // compatible, so let's leave all channels in
-    FiffCov cov_good = cov.pick_channels(info_ch_names, p_exclude);
-    QStringList ch_names = cov_good.names;
+    // compatible, so let's leave all channels in. sel maps the good channels back to their covariance rows.
+    RowVectorXi sel = FiffInfo::pick_channels(this->names, info_ch_names, p_exclude);
+    QStringList ch_names;
+    for(qint32 k = 0; k < sel.size(); ++k)
+        ch_names << this->names[sel(k)];
 
     std::vector<qint32> idx_eeg, idx_mag, idx_grad;
     for(qint32 i = 0; i < ch_names.size(); ++i)
@@ -375,15 +393,13 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
             idx_grad.push_back(i);
     }
 
-    MatrixXd C(cov_good.data);
-
-    if((unsigned) C.rows() != idx_eeg.size() + idx_mag.size() + idx_grad.size())
+    if((unsigned) sel.size() != idx_eeg.size() + idx_mag.size() + idx_grad.size())
         printf("Error in FiffCov::regularize: Channel dimensions do not fit.\n");//ToDo Throw
 
     QList<FiffProj> t_listProjs;
     if(p_bProj)
     {
-        t_listProjs = p_info.projs + cov_good.projs;
+        t_listProjs = p_info.projs + this->projs;
         FiffProj::activate_projs(t_listProjs);
     }
 
@@ -394,7 +410,7 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
     regData.insert("GRAD", QPair<double, std::vector<qint32> >(p_fRegGrad, idx_grad));
 
     //
-    //Regularize
+    //Plan the regularization
     //
     QMap<QString, QPair<double, std::vector<qint32> > >::Iterator it;
     for(it = regData.begin(); it != regData.end(); ++it)
@@ -408,13 +424,14 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
         else
         {
             printf("\tRegularize %s: %f\n", desc.toLatin1().constData(), reg);
-            MatrixXd this_C(idx.size(), idx.size());
-            for(quint32 i = 0; i < idx.size(); ++i)
-                for(quint32 j = 0; j < idx.size(); ++j)
-                    this_C(i,j) = cov_good.data(idx[i], idx[j]);
 
-            MatrixXd U;
-            qint32 ncomp;
+            RegularizeBlock t_block;
+            t_block.desc = desc;
+            t_block.reg = reg;
+            t_block.idx.resize(idx.size());
+            for(quint32 k = 0; k < idx.size(); ++k)
+                t_block.idx[k] = sel(idx[k]);
+
             if(p_bProj)
             {
                 QStringList this_ch_names;
@@ -422,41 +439,78 @@ FiffCov FiffCov::regularize(const FiffInfo& p_info, double p_fRegMag, double p_f
                     this_ch_names << ch_names[idx[k]];
 
                 MatrixXd P;
-                ncomp = FiffProj::make_projector(t_listProjs, this_ch_names, P); //ToDo: Synchronize with mne-python and debug
-
-                JacobiSVD<MatrixXd> svd(P, ComputeFullU);
-                //Sort singular values and singular vectors
-                VectorXd t_s = svd.singularValues();
-                MatrixXd t_U = svd.matrixU();
-                MNEMath::sort<double>(t_s, t_U);
-
-                U = t_U.block(0,0, t_U.rows(), t_U.cols()-ncomp);
+                qint32 ncomp = FiffProj::make_projector(t_listProjs, this_ch_names, P); //ToDo: Synchronize with mne-python and debug
 
                 if (ncomp > 0)
                 {
+                    JacobiSVD<MatrixXd> svd(P, ComputeFullU);
+                    //Sort singular values and singular vectors
+                    VectorXd t_s = svd.singularValues();
+                    MatrixXd t_U = svd.matrixU();
+                    MNEMath::sort<double>(t_s, t_U);
+
+                    t_block.U = t_U.block(0,0, t_U.rows(), t_U.cols()-ncomp);
+
                     printf("\tCreated an SSP operator for %s (dimension = %d).\n", desc.toLatin1().constData(), ncomp);
-                    this_C = U.transpose() * (this_C * U);
                 }
             }
 
-            double sigma = this_C.diagonal().mean();
-            this_C.diagonal() = this_C.diagonal().array() + reg * sigma;  // modify diag inplace
-            if(p_bProj && ncomp > 0)
-                this_C = U * (this_C * U.transpose());
-
-            for(qint32 i = 0; i < this_C.rows(); ++i)
-                for(qint32 j = 0; j < this_C.cols(); ++j)
-                    C(idx[i],idx[j]) = this_C(i,j);
+            p_plan.blocks.append(t_block);
         }
     }
 
-    // Put data back in correct locations
-    RowVectorXi idx = FiffInfo::pick_channels(cov.names, info_ch_names, p_exclude);
-    for(qint32 i = 0; i < idx.size(); ++i)
+    p_plan.dim = this->data.rows();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffCov::fits_regularization(const RegularizePlan& p_plan, const FiffInfo& p_info) const
+{
+    return p_plan.dim == this->data.rows()
+            && p_plan.bads == p_info.bads + this->bads
+            && p_plan.projs == p_info.projs + this->projs;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffCov::apply_regularization(const RegularizePlan& p_plan)
+{
+    if(p_plan.dim != this->data.rows() || this->data.rows() != this->data.cols())
+    {
+        printf("Error in FiffCov::apply_regularization: Plan does not fit the covariance dimension.\n");
+        return false;
+    }
+
+    MatrixXd this_C;
+    for(qint32 b = 0; b < p_plan.blocks.size(); ++b)
+    {
+        const RegularizeBlock& t_block = p_plan.blocks[b];
+        const VectorXi& idx = t_block.idx;
+
+        this_C.resize(idx.size(), idx.size());
         for(qint32 j = 0; j < idx.size(); ++j)
-            cov.data(idx[i], idx[j]) = C(i, j);
+            for(qint32 i = 0; i < idx.size(); ++i)
+                this_C(i,j) = this->data(idx[i], idx[j]);
 
-    return cov;
+        bool t_bProj = t_block.U.size() > 0;
+        if(t_bProj)
+            this_C = t_block.U.transpose() * (this_C * t_block.U);
+
+        double sigma = this_C.diagonal().mean();
+        this_C.diagonal().array() += t_block.reg * sigma;  // modify diag inplace
+        if(t_bProj)
+            this_C = t_block.U * (this_C * t_block.U.transpose());
+
+        for(qint32 j = 0; j < idx.size(); ++j)
+            for(qint32 i = 0; i < idx.size(); ++i)
+                this->data(idx[i], idx[j]) = this_C(i,j);
+    }
+
+    return true;
 }
 
 
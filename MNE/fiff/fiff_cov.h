@@ -98,6 +98,32 @@ public:
     typedef QSharedPointer<const FiffCov> ConstSPtr;    /**< Const shared pointer type for FiffCov. */
     typedef QSharedDataPointer<FiffCov> SDPtr;       /**< Shared data pointer type for FiffCov. */
 
+    //=========================================================================================================
+    /**
+    * One channel type block of a regularization plan.
+    */
+    struct RegularizeBlock
+    {
+        QString desc;       /**< Channel type description (EEG, MAG, GRAD). */
+        double reg;         /**< Regularization factor. */
+        VectorXi idx;       /**< Indices of the block channels within the covariance matrix. */
+        MatrixXd U;         /**< Basis of the range of the SSP operator, empty if no projection is applied. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Channel type blocks and SSP bases of regularize(), computed once by prepare_regularization() and reused
+    * for every covariance with the same channel layout.
+    */
+    struct RegularizePlan
+    {
+        RegularizePlan() : dim(-1) {}
+        fiff_int_t dim;                         /**< Dimension of the covariance the plan was prepared for. */
+        QStringList bads;                       /**< Bad channels of the info and the covariance the plan was prepared for. */
+        QList<FiffProj> projs;                  /**< Projectors of the info and the covariance the plan was prepared for. */
+        QList<RegularizeBlock> blocks;          /**< Blocks to regularize. */
+    };
+
     //=========================================================================================================
     /**
     * Constructs the covariance data matrix.
@@ -182,6 +208,46 @@ public:
     */
     FiffCov regularize(const FiffInfo& p_info, double p_fMag = 0.1, double p_fGrad = 0.1, double p_fEeg = 0.1, bool p_bProj = true, QStringList p_exclude = defaultQStringList) const;
 
+    //=========================================================================================================
+    /**
+    * Prepares the regularization of this covariance matrix. Picks the channel type blocks and computes their
+    * SSP bases once; apply_regularization() then only touches the covariance data. The plan stays valid for
+    * every covariance with the same channels, bads and projectors.
+    *
+    * @param[out] p_plan    The regularization plan.
+    * @param[in] p_info     The measurement info (used to get channel types and bad channels).
+    * @param[in] p_fMag      Regularization factor for MEG magnetometers.
+    * @param[in] p_fGrad     Regularization factor for MEG gradiometers.
+    * @param[in] p_fEeg      Regularization factor for EEG.
+    * @param[in] p_bProj     Apply or not projections to keep rank of data.
+    * @param[in] p_exclude  List of channels to mark as bad. If None, bads channels are extracted from both info['bads'] and cov['bads'].
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool prepare_regularization(RegularizePlan& p_plan, const FiffInfo& p_info, double p_fMag = 0.1, double p_fGrad = 0.1, double p_fEeg = 0.1, bool p_bProj = true, QStringList p_exclude = defaultQStringList) const;
+
+    //=========================================================================================================
+    /**
+    * Regularizes this covariance matrix in place using a plan of prepare_regularization().
+    *
+    * @param[in] p_plan     The regularization plan.
+    *
+    * @return true if succeeded, false if the plan does not fit the covariance.
+    */
+    bool apply_regularization(const RegularizePlan& p_plan);
+
+    //=========================================================================================================
+    /**
+    * Checks whether a plan of prepare_regularization() still fits this covariance, i.e. it was prepared for the
+    * same dimension, bad channels and projectors.
+    *
+    * @param[in] p_plan     The regularization plan.
+    * @param[in] p_info     The measurement info the covariance is regularized with.
+    *
+    * @return true if the plan can be applied, false if it has to be prepared again.
+    */
+    bool fits_regularization(const RegularizePlan& p_plan, const FiffInfo& p_info) const;
+
     //=========================================================================================================
     /**
     * Assignment Operator
@@ -112,7 +112,7 @@ public:
     fiff_int_t  kind;   /**< Tag number */
     fiff_int_t  type;   /**< Data type */
     fiff_int_t  size;   /**< How many bytes */
-    fiff_int_t  pos;    /**< Location in file; Note: the data is located at pos + FIFFC_DATA_OFFSET */
+    fiff_long_t pos;    /**< Location in file (64-bit, files may exceed 2 GB); Note: the data is located at pos + FIFFC_DATA_OFFSET */
 
 // ### OLD STRUCT ###
 //    /** Directories are composed of these structures. *
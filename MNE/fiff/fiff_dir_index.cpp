@@ -0,0 +1,382 @@
+//=============================================================================================================
+/**
+* @file     fiff_dir_index.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Implementation of the FiffDirIndex Class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_dir_index.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <stdio.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+static const quint32 FIFF_DIR_INDEX_MAGIC   = 0x46494458;   /**< "FIDX" */
+static const qint32  FIFF_DIR_INDEX_VERSION = 1;
+static const qint32  FIFF_DIR_INDEX_MAX_DEPTH = 256;
+
+static QString s_sFiffDirIndexCacheDir;                     /**< Cache directory of the index files, empty if disabled */
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffDirIndex::FiffDirIndex()
+: file_size(-1)
+, file_mtime(-1)
+, raw_kind(-1)
+, first_samp(0)
+, last_samp(0)
+{
+
+}
+
+
+//*************************************************************************************************************
+
+FiffDirIndex::FiffDirIndex(const FiffDirIndex &p_FiffDirIndex)
+: file_id(p_FiffDirIndex.file_id)
+, file_size(p_FiffDirIndex.file_size)
+, file_mtime(p_FiffDirIndex.file_mtime)
+, dir(p_FiffDirIndex.dir)
+, tree(p_FiffDirIndex.tree)
+, raw_kind(p_FiffDirIndex.raw_kind)
+, first_samp(p_FiffDirIndex.first_samp)
+, last_samp(p_FiffDirIndex.last_samp)
+, rawdir(p_FiffDirIndex.rawdir)
+{
+
+}
+
+
+//*************************************************************************************************************
+
+FiffDirIndex::~FiffDirIndex()
+{
+
+}
+
+
+//*************************************************************************************************************
+
+void FiffDirIndex::clear()
+{
+    file_id.clear();
+    file_size = -1;
+    file_mtime = -1;
+    dir.clear();
+    tree.clear();
+    raw_kind = -1;
+    first_samp = 0;
+    last_samp = 0;
+    rawdir.clear();
+}
+
+
+//*************************************************************************************************************
+
+void FiffDirIndex::setCacheDir(const QString& p_sCacheDir)
+{
+    s_sFiffDirIndexCacheDir = p_sCacheDir;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffDirIndex::cacheDir()
+{
+    return s_sFiffDirIndexCacheDir;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffDirIndex::indexFileName(const QString& p_sFileName)
+{
+    if(s_sFiffDirIndexCacheDir.isEmpty())
+        return QString();
+
+    QByteArray t_hash = QCryptographicHash::hash(QFileInfo(p_sFileName).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return QDir(s_sFiffDirIndexCacheDir).filePath(QString("%1.idx").arg(QString(t_hash.toHex())));
+}
+
+
+//*************************************************************************************************************
+
+bool FiffDirIndex::read(const QString& p_sFileName, const FiffId& p_FileId)
+{
+    clear();
+
+    if(s_sFiffDirIndexCacheDir.isEmpty())
+        return false;
+
+    QFileInfo t_fileInfo(p_sFileName);
+    QFile t_file(indexFileName(p_sFileName));
+    if(!t_fileInfo.exists() || !t_file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream t_stream(&t_file);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 t_iMagic;
+    qint32 t_iVersion;
+    t_stream >> t_iMagic >> t_iVersion;
+    if(t_iMagic != FIFF_DIR_INDEX_MAGIC || t_iVersion != FIFF_DIR_INDEX_VERSION)
+        return false;
+
+    //
+    //   The index is only valid for the very same file
+    //
+    t_stream >> file_id.version >> file_id.machid[0] >> file_id.machid[1] >> file_id.time.secs >> file_id.time.usecs;
+    t_stream >> file_size >> file_mtime;
+
+    if(file_id.version != p_FileId.version || file_id.machid[0] != p_FileId.machid[0] || file_id.machid[1] != p_FileId.machid[1]
+            || file_id.time.secs != p_FileId.time.secs || file_id.time.usecs != p_FileId.time.usecs
+            || file_size != t_fileInfo.size() || file_mtime != t_fileInfo.lastModified().toMSecsSinceEpoch())
+    {
+        clear();
+        return false;
+    }
+
+    //
+    //   Flat directory
+    //
+    qint32 t_iNent;
+    t_stream >> t_iNent;
+    if(t_stream.status() != QDataStream::Ok || t_iNent <= 0 || t_iNent > file_size/FiffDirEntry::storageSize())
+    {
+        clear();
+        return false;
+    }
+
+    dir.reserve(t_iNent);
+    FiffDirEntry t_entry;
+    for(qint32 k = 0; k < t_iNent; ++k)
+    {
+        t_stream >> t_entry.kind >> t_entry.type >> t_entry.size >> t_entry.pos;
+        dir.append(t_entry);
+    }
+
+    //
+    //   Tree
+    //
+    if(!read_tree(t_stream, dir, tree))
+    {
+        printf("Ignoring corrupt index %s\n", t_file.fileName().toUtf8().constData());
+        clear();
+        return false;
+    }
+
+    //
+    //   Raw data buffer ranges
+    //
+    qint32 t_iNRaw;
+    t_stream >> raw_kind >> first_samp >> last_samp >> t_iNRaw;
+    if(t_stream.status() != QDataStream::Ok || t_iNRaw < 0 || t_iNRaw > t_iNent)
+    {
+        printf("Ignoring corrupt index %s\n", t_file.fileName().toUtf8().constData());
+        clear();
+        return false;
+    }
+
+    rawdir.reserve(t_iNRaw);
+    qint32 t_iIdx;
+    for(qint32 k = 0; k < t_iNRaw; ++k)
+    {
+        FiffRawDir t_RawDir;
+        t_stream >> t_iIdx >> t_RawDir.first >> t_RawDir.last >> t_RawDir.nsamp;
+        if(t_iIdx >= t_iNent)
+            break;
+        if(t_iIdx >= 0)
+            t_RawDir.ent = dir[t_iIdx];
+        rawdir.append(t_RawDir);
+    }
+
+    if(t_stream.status() != QDataStream::Ok || rawdir.size() != t_iNRaw)
+    {
+        printf("Ignoring corrupt index %s\n", t_file.fileName().toUtf8().constData());
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffDirIndex::write(const QString& p_sFileName)
+{
+    QFileInfo t_fileInfo(p_sFileName);
+    if(s_sFiffDirIndexCacheDir.isEmpty() || !t_fileInfo.exists() || dir.isEmpty())
+        return false;
+
+    if(!QDir().mkpath(s_sFiffDirIndexCacheDir))
+        return false;
+
+    file_size = t_fileInfo.size();
+    file_mtime = t_fileInfo.lastModified().toMSecsSinceEpoch();
+
+    QSaveFile t_file(indexFileName(p_sFileName));
+    if(!t_file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream t_stream(&t_file);
+    t_stream.setVersion(QDataStream::Qt_5_0);
+
+    t_stream << FIFF_DIR_INDEX_MAGIC << FIFF_DIR_INDEX_VERSION;
+    t_stream << file_id.version << file_id.machid[0] << file_id.machid[1] << file_id.time.secs << file_id.time.usecs;
+    t_stream << file_size << file_mtime;
+
+    QHash<fiff_long_t, qint32> t_hashIdx;
+    t_hashIdx.reserve(dir.size());
+    t_stream << (qint32)dir.size();
+    for(qint32 k = 0; k < dir.size(); ++k)
+    {
+        t_stream << dir[k].kind << dir[k].type << dir[k].size << dir[k].pos;
+        t_hashIdx.insert(dir[k].pos, k);
+    }
+
+    write_tree(t_stream, tree, t_hashIdx);
+
+    t_stream << raw_kind << first_samp << last_samp << (qint32)rawdir.size();
+    for(qint32 k = 0; k < rawdir.size(); ++k)
+        t_stream << (rawdir[k].ent.pos >= 0 ? t_hashIdx.value(rawdir[k].ent.pos, -1) : -1) << rawdir[k].first << rawdir[k].last << rawdir[k].nsamp;
+
+    if(t_stream.status() != QDataStream::Ok)
+    {
+        t_file.cancelWriting();
+        return false;
+    }
+
+    return t_file.commit();
+}
+
+
+//*************************************************************************************************************
+
+void FiffDirIndex::write_tree(QDataStream& p_Stream, const FiffDirTree& p_Node, const QHash<fiff_long_t, qint32>& p_hashIdx)
+{
+    p_Stream << p_Node.block;
+    p_Stream << p_Node.id.version << p_Node.id.machid[0] << p_Node.id.machid[1] << p_Node.id.time.secs << p_Node.id.time.usecs;
+    p_Stream << p_Node.parent_id.version << p_Node.parent_id.machid[0] << p_Node.parent_id.machid[1] << p_Node.parent_id.time.secs << p_Node.parent_id.time.usecs;
+    p_Stream << p_Node.nent << p_Node.nent_tree;
+
+    p_Stream << (qint32)p_Node.dir.size();
+    for(qint32 k = 0; k < p_Node.dir.size(); ++k)
+        p_Stream << p_hashIdx.value(p_Node.dir[k].pos, -1);
+
+    p_Stream << (qint32)p_Node.children.size();
+    for(qint32 k = 0; k < p_Node.children.size(); ++k)
+        write_tree(p_Stream, p_Node.children[k], p_hashIdx);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffDirIndex::read_tree(QDataStream& p_Stream, const QList<FiffDirEntry>& p_Dir, FiffDirTree& p_Node, qint32 p_iDepth)
+{
+    if(p_iDepth > FIFF_DIR_INDEX_MAX_DEPTH)
+        return false;
+
+    p_Node.clear();
+
+    p_Stream >> p_Node.block;
+    p_Stream >> p_Node.id.version >> p_Node.id.machid[0] >> p_Node.id.machid[1] >> p_Node.id.time.secs >> p_Node.id.time.usecs;
+    p_Stream >> p_Node.parent_id.version >> p_Node.parent_id.machid[0] >> p_Node.parent_id.machid[1] >> p_Node.parent_id.time.secs >> p_Node.parent_id.time.usecs;
+    p_Stream >> p_Node.nent >> p_Node.nent_tree;
+
+    qint32 t_iNDir, t_iIdx;
+    p_Stream >> t_iNDir;
+    if(p_Stream.status() != QDataStream::Ok || t_iNDir < 0 || t_iNDir > p_Dir.size())
+        return false;
+
+    for(qint32 k = 0; k < t_iNDir; ++k)
+    {
+        p_Stream >> t_iIdx;
+        if(t_iIdx < 0 || t_iIdx >= p_Dir.size())
+            return false;
+        p_Node.dir.append(p_Dir[t_iIdx]);
+    }
+
+    qint32 t_iNChild;
+    p_Stream >> t_iNChild;
+    if(p_Stream.status() != QDataStream::Ok || t_iNChild < 0 || t_iNChild > p_Dir.size())
+        return false;
+
+    for(qint32 k = 0; k < t_iNChild; ++k)
+    {
+        FiffDirTree t_ChildTree;
+        if(!read_tree(p_Stream, p_Dir, t_ChildTree, p_iDepth + 1))
+            return false;
+        p_Node.children.append(t_ChildTree);
+    }
+    p_Node.nchild = p_Node.children.size();
+
+    return p_Stream.status() == QDataStream::Ok;
+}
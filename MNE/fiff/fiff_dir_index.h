@@ -0,0 +1,221 @@
+//=============================================================================================================
+/**
+* @file     fiff_dir_index.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+* @brief    FiffDirIndex class declaration.
+*
+*/
+
+#ifndef FIFF_DIR_INDEX_H
+#define FIFF_DIR_INDEX_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_id.h"
+#include "fiff_dir_entry.h"
+#include "fiff_dir_tree.h"
+#include "fiff_raw_dir.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+* Cached directory index of a fiff file. Holds the flattened tag directory, the directory tree and the sample
+* ranges of the raw data buffers, so that reopening a large file which has no usable directory doesn't require a
+* scan of all tag headers. Indexing is off by default. It is enabled by setting a cache directory with setCacheDir(),
+* the index files are then kept there, never next to the fiff files. An index is only accepted when file id,
+* size and modification time still match the fiff file.
+*
+* @brief Persistent directory index of a fiff file
+*/
+class FIFFSHARED_EXPORT FiffDirIndex {
+
+public:
+    typedef QSharedPointer<FiffDirIndex> SPtr;            /**< Shared pointer type for FiffDirIndex. */
+    typedef QSharedPointer<const FiffDirIndex> ConstSPtr; /**< Const shared pointer type for FiffDirIndex. */
+
+    //=========================================================================================================
+    /**
+    * Default constructor
+    */
+    FiffDirIndex();
+
+    //=========================================================================================================
+    /**
+    * Copy constructor.
+    *
+    * @param[in] p_FiffDirIndex     Directory index which should be copied
+    */
+    FiffDirIndex(const FiffDirIndex &p_FiffDirIndex);
+
+    //=========================================================================================================
+    /**
+    * Destroys the directory index.
+    */
+    ~FiffDirIndex();
+
+    //=========================================================================================================
+    /**
+    * Initializes the directory index.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the index holds the raw data buffer ranges of the given raw data block.
+    *
+    * @param[in] p_iRawKind     Block kind of the raw data (FIFFB_RAW_DATA, FIFFB_CONTINUOUS_DATA, ...)
+    *
+    * @return true if the raw directory is available
+    */
+    inline bool hasRawDir(fiff_int_t p_iRawKind) const;
+
+    //=========================================================================================================
+    /**
+    * Enables the index for all fiff files which are opened afterwards. Should be set once at startup.
+    *
+    * @param[in] p_sCacheDir    Directory the index files are kept in, an empty string disables the index
+    */
+    static void setCacheDir(const QString& p_sCacheDir);
+
+    //=========================================================================================================
+    /**
+    * Directory the index files are kept in.
+    *
+    * @return the cache directory, empty if the index is disabled (default)
+    */
+    static QString cacheDir();
+
+    //=========================================================================================================
+    /**
+    * Name of the index file which belongs to a fiff file. It is named after the SHA-1 of the absolute path of
+    * the fiff file and lies in the cache directory.
+    *
+    * @param[in] p_sFileName    Name of the fiff file
+    *
+    * @return the name of the index file, empty if the index is disabled
+    */
+    static QString indexFileName(const QString& p_sFileName);
+
+    //=========================================================================================================
+    /**
+    * Reads the index of a fiff file. Fails if there is no index or if it doesn't match the current
+    * state of the fiff file.
+    *
+    * @param[in] p_sFileName    Name of the fiff file
+    * @param[in] p_FileId       File id read from the fiff file
+    *
+    * @return true if a valid index was read, false otherwise
+    */
+    bool read(const QString& p_sFileName, const FiffId& p_FileId);
+
+    //=========================================================================================================
+    /**
+    * Writes the index of a fiff file. File size and modification time are taken from the fiff file.
+    *
+    * @param[in] p_sFileName    Name of the fiff file
+    *
+    * @return true if succeeded, false otherwise (e.g. the index is disabled or the cache directory is read-only)
+    */
+    bool write(const QString& p_sFileName);
+
+private:
+    //=========================================================================================================
+    /**
+    * Writes a tree node and its children. Directory entries are stored as indices into the flat directory.
+    *
+    * @param[in] p_Stream       The index stream
+    * @param[in] p_Node         The tree node to write
+    * @param[in] p_hashIdx      Position to flat directory index lookup
+    */
+    static void write_tree(QDataStream& p_Stream, const FiffDirTree& p_Node, const QHash<fiff_long_t, qint32>& p_hashIdx);
+
+    //=========================================================================================================
+    /**
+    * Reads a tree node and its children.
+    *
+    * @param[in] p_Stream       The index stream
+    * @param[in] p_Dir          The flat directory
+    * @param[out] p_Node        The read tree node
+    * @param[in] p_iDepth       Current nesting depth
+    *
+    * @return true if succeeded, false if the index is corrupt
+    */
+    static bool read_tree(QDataStream& p_Stream, const QList<FiffDirEntry>& p_Dir, FiffDirTree& p_Node, qint32 p_iDepth = 0);
+
+public:
+    FiffId              file_id;        /**< Id of the indexed fiff file */
+    qint64              file_size;      /**< Size of the indexed fiff file in bytes */
+    qint64              file_mtime;     /**< Modification time of the indexed fiff file, ms since epoch */
+    QList<FiffDirEntry> dir;            /**< Flattened tag directory */
+    FiffDirTree         tree;           /**< Directory tree */
+    fiff_int_t          raw_kind;       /**< Block kind the raw directory belongs to, -1 if not indexed */
+    fiff_int_t          first_samp;     /**< First sample of the raw data */
+    fiff_int_t          last_samp;      /**< Last sample of the raw data */
+    QList<FiffRawDir>   rawdir;         /**< Sample ranges of the raw data buffers */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffDirIndex::hasRawDir(fiff_int_t p_iRawKind) const
+{
+    return raw_kind == p_iRawKind && !rawdir.isEmpty();
+}
+
+} // NAMESPACE
+
+#endif // FIFF_DIR_INDEX_H
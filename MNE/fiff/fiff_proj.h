@@ -149,6 +149,16 @@ public:
     */
     static fiff_int_t make_projector(const QList<FiffProj>& projs, const QStringList& ch_names, MatrixXd& proj, const QStringList& bads = defaultQStringList, MatrixXd& U = defaultMatrixXd);
 
+    //=========================================================================================================
+    /**
+    * Compares kind, state, description and data of two projectors.
+    *
+    * @param[in] p_FiffProj    Projector to compare with.
+    *
+    * @return true if both projectors are equal, false otherwise
+    */
+    inline bool operator== (const FiffProj& p_FiffProj) const;
+
     //=========================================================================================================
     /**
     * overloading the stream out operator<<
@@ -174,6 +184,25 @@ public:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline bool FiffProj::operator== (const FiffProj& p_FiffProj) const
+{
+    if(kind != p_FiffProj.kind || active != p_FiffProj.active || desc != p_FiffProj.desc)
+        return false;
+    if(data == p_FiffProj.data)
+        return true;
+    if(!data || !p_FiffProj.data)
+        return false;
+
+    return data->row_names == p_FiffProj.data->row_names
+            && data->col_names == p_FiffProj.data->col_names
+            && data->data.rows() == p_FiffProj.data->data.rows()
+            && data->data.cols() == p_FiffProj.data->data.cols()
+            && data->data == p_FiffProj.data->data;
+}
+
+
+//*************************************************************************************************************
+
 inline std::ostream& operator<<(std::ostream& out, const FIFFLIB::FiffProj &p_FiffProj)
 {
     out << "#### Fiff Projector ####\n";
@@ -59,6 +59,7 @@ using namespace FIFFLIB;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, m_bReadPlanValid(false)
 {
 
 }
@@ -69,6 +70,7 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, m_bReadPlanValid(false)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -91,6 +93,12 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , rawdir(p_FiffRawData.rawdir)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, split_files(p_FiffRawData.split_files)
+, split_devices(p_FiffRawData.split_devices)
+, m_bReadPlanValid(p_FiffRawData.m_bReadPlanValid)
+, m_vecReadSel(p_FiffRawData.m_vecReadSel)
+, m_vecReadCals(p_FiffRawData.m_vecReadCals)
+, m_matReadMult(p_FiffRawData.m_matReadMult)
 {
 
 }
@@ -115,6 +123,61 @@ void FiffRawData::clear()
     rawdir.clear();
     proj = MatrixXd();
     comp.clear();
+    split_files.clear();
+    split_devices.clear();
+    m_bReadPlanValid = false;
+    m_vecReadSel = RowVectorXi();
+    m_vecReadCals = VectorXd();
+    m_matReadMult = MatrixXd();
+    m_matReadBuffer = MatrixXd();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::append_split(const FiffRawData& p_Split, const QSharedPointer<QIODevice>& p_pDevice)
+{
+    if (p_Split.info.nchan != this->info.nchan)
+    {
+        printf("Split file %s has %d instead of %d channels. Not appended.\n", p_Split.info.filename.toUtf8().constData(), p_Split.info.nchan, this->info.nchan);
+        return false;
+    }
+    if (p_Split.first_samp <= this->last_samp)
+    {
+        printf("Split file %s starts at sample %d which overlaps with %d. Not appended.\n", p_Split.info.filename.toUtf8().constData(), p_Split.first_samp, this->last_samp);
+        return false;
+    }
+    //
+    //   Bridge a gap between the files with a skip
+    //
+    if (p_Split.first_samp > this->last_samp + 1)
+    {
+        FiffRawDir t_RawDir;
+        t_RawDir.first = this->last_samp + 1;
+        t_RawDir.last  = p_Split.first_samp - 1;
+        t_RawDir.nsamp = t_RawDir.last - t_RawDir.first + 1;
+        this->rawdir.append(t_RawDir);
+    }
+    //
+    //   Add the buffers, their file index is relative to the split
+    //
+    qint32 t_iFileOffset = this->split_files.size() + 1;
+
+    this->split_files.append(p_Split.file);
+    this->split_files.append(p_Split.split_files);
+    this->split_devices.append(p_pDevice);
+    this->split_devices.append(p_Split.split_devices);
+
+    for (qint32 k = 0; k < p_Split.rawdir.size(); ++k)
+    {
+        FiffRawDir t_RawDir = p_Split.rawdir[k];
+        t_RawDir.file_idx += t_iFileOffset;
+        this->rawdir.append(t_RawDir);
+    }
+
+    this->last_samp = p_Split.last_samp;
+
+    return true;
 }
 
 
@@ -246,7 +309,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
     {
         if (!this->file->device()->open(QIODevice::ReadOnly))
         {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+            printf("Cannot open file %s\n",this->info.filename.toUtf8().constData());
         }
         fid = this->file;
     }
@@ -255,6 +318,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
         fid = this->file;
     }
 
+    //Split files opened by this call are closed again at the end
+    QList<QIODevice*> t_listOpenedSplits;
     MatrixXd one;
     fiff_int_t first_pick, last_pick, picksamp;
     for(k = 0; k < this->rawdir.size(); ++k)
@@ -281,8 +346,29 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
             }
             else
             {
+                FiffStream::SPtr t_pStream = thisRawDir.file_idx > 0 ? this->split_files[thisRawDir.file_idx-1] : fid;
+                if (!t_pStream->device()->isOpen())
+                {
+                    if (t_pStream->device()->open(QIODevice::ReadOnly))
+                    {
+                        if (t_pStream != fid)
+                            t_listOpenedSplits.append(t_pStream->device());
+                    }
+                    else
+                        printf("Cannot open file %s\n",t_pStream->streamName().toUtf8().constData());
+                }
+
                 FiffTag::SPtr t_pTag;
-                FiffTag::read_tag(fid.data(), t_pTag, thisRawDir.ent.pos);
+                FiffTag::read_tag(t_pStream.data(), t_pTag, thisRawDir.ent.pos);
+                //
+                //   Decode the buffer straight from the tag - no intermediate copy for memory-mapped files
+                //
+                MatrixXd t_matBuffer;
+                if (!t_pTag->toRawBuffer(nchan, t_matBuffer))
+                {
+                    printf("Data Storage Format not known jet!! Type: %d\n", t_pTag->type);
+                    t_matBuffer = MatrixXd::Zero(nchan, thisRawDir.nsamp);
+                }
                 //
                 //   Depending on the state of the projection and selection
                 //   we proceed a little bit differently
@@ -290,62 +376,18 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
                 if (mult.cols() == 0)
                 {
                     if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
-                    }
+                        one = cal*t_matBuffer;
                     else
                     {
-
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
-                        }
+                        MatrixXd newData(sel.cols(), thisRawDir.nsamp);
+                        for(r = 0; r < sel.size(); ++r)
+                            newData.row(r) = t_matBuffer.row(sel[r]);
 
                         one = cal*newData;
                     }
                 }
                 else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
-                }
+                    one = mult*t_matBuffer;
             }
             //
             //  The picking logic is a bit complicated
@@ -425,7 +467,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
         }
     }
 
-//        fclose(fid);
+    for (i = 0; i < t_listOpenedSplits.size(); ++i)
+        t_listOpenedSplits[i]->close();
 
     times = MatrixXd(1, to-from+1);
 
@@ -564,7 +607,7 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
     {
         if (!this->file->device()->open(QIODevice::ReadOnly))
         {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+            printf("Cannot open file %s\n",this->info.filename.toUtf8().constData());
         }
         fid = this->file;
     }
@@ -573,6 +616,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
         fid = this->file;
     }
 
+    //Split files opened by this call are closed again at the end
+    QList<QIODevice*> t_listOpenedSplits;
     MatrixXd one;
     fiff_int_t first_pick, last_pick, picksamp;
     for(k = 0; k < this->rawdir.size(); ++k)
@@ -599,8 +644,29 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
             }
             else
             {
+                FiffStream::SPtr t_pStream = thisRawDir.file_idx > 0 ? this->split_files[thisRawDir.file_idx-1] : fid;
+                if (!t_pStream->device()->isOpen())
+                {
+                    if (t_pStream->device()->open(QIODevice::ReadOnly))
+                    {
+                        if (t_pStream != fid)
+                            t_listOpenedSplits.append(t_pStream->device());
+                    }
+                    else
+                        printf("Cannot open file %s\n",t_pStream->streamName().toUtf8().constData());
+                }
+
                 FiffTag::SPtr t_pTag;
-                FiffTag::read_tag(fid.data(), t_pTag, thisRawDir.ent.pos);
+                FiffTag::read_tag(t_pStream.data(), t_pTag, thisRawDir.ent.pos);
+                //
+                //   Decode the buffer straight from the tag - no intermediate copy for memory-mapped files
+                //
+                MatrixXd t_matBuffer;
+                if (!t_pTag->toRawBuffer(nchan, t_matBuffer))
+                {
+                    printf("Data Storage Format not known jet!! Type: %d\n", t_pTag->type);
+                    t_matBuffer = MatrixXd::Zero(nchan, thisRawDir.nsamp);
+                }
                 //
                 //   Depending on the state of the projection and selection
                 //   we proceed a little bit differently
@@ -608,62 +674,18 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
                 if (mult.cols() == 0)
                 {
                     if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
-                    }
+                        one = cal*t_matBuffer;
                     else
                     {
-
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
-                        }
+                        MatrixXd newData(sel.cols(), thisRawDir.nsamp);
+                        for(r = 0; r < sel.size(); ++r)
+                            newData.row(r) = t_matBuffer.row(sel[r]);
 
                         one = cal*newData;
                     }
                 }
                 else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
-                }
+                    one = mult*t_matBuffer;
             }
             //
             //  The picking logic is a bit complicated
@@ -747,7 +769,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
         multSegment = cal;
     else
         multSegment = mult;
-//        fclose(fid);
+    for (i = 0; i < t_listOpenedSplits.size(); ++i)
+        t_listOpenedSplits[i]->close();
 
     times = MatrixXd(1, to-from+1);
 
@@ -772,3 +795,176 @@ bool FiffRawData::read_raw_segment_times(MatrixXd& data, MatrixXd& times, float
     //
     return this->read_raw_segment(data, times, (qint32)from, (qint32)to, sel);
 }
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::prepare_read_plan(const RowVectorXi& sel)
+{
+    m_bReadPlanValid = false;
+
+    qint32 nchan = this->info.nchan;
+    if (nchan <= 0 || this->cals.size() != nchan)
+    {
+        printf("Cannot prepare read plan: no channels or calibration available.\n");
+        return false;
+    }
+    if (sel.size() > 0 && (sel.minCoeff() < 0 || sel.maxCoeff() >= nchan))
+    {
+        printf("Cannot prepare read plan: channel selection out of range.\n");
+        return false;
+    }
+
+    qint32 nout = sel.size() > 0 ? sel.size() : nchan;
+    qint32 i;
+
+    m_vecReadSel = sel;
+
+    if (this->proj.size() == 0 && this->comp.kind == -1)
+    {
+        //
+        //  Calibration only - applied while decoding
+        //
+        m_matReadMult = MatrixXd();
+        m_vecReadCals.resize(nout);
+        for (i = 0; i < nout; ++i)
+            m_vecReadCals[i] = this->cals[sel.size() > 0 ? sel[i] : i];
+    }
+    else
+    {
+        //
+        //  Fuse sel*proj*comp*cal into one operator
+        //
+        MatrixXd t_matOp = this->proj.size() > 0 ? this->proj : MatrixXd::Identity(nchan, nchan);
+        if (this->comp.kind != -1)
+            t_matOp = t_matOp * this->comp.data->data;
+        t_matOp = t_matOp * this->cals.transpose().asDiagonal();
+
+        if (sel.size() > 0)
+        {
+            m_matReadMult.resize(nout, nchan);
+            for (i = 0; i < nout; ++i)
+                m_matReadMult.row(i) = t_matOp.row(sel[i]);
+        }
+        else
+            m_matReadMult = t_matOp;
+
+        m_vecReadCals = VectorXd();
+    }
+
+    m_bReadPlanValid = true;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawData::read_raw_segment(MatrixXd& data, fiff_int_t from, fiff_int_t to)
+{
+    if (!m_bReadPlanValid && !prepare_read_plan())
+        return false;
+
+    //
+    //  Initial checks
+    //
+    if(from < this->first_samp)
+        from = this->first_samp;
+    if(to > this->last_samp)
+        to = this->last_samp;
+    if(from > to)
+    {
+        printf("No data in this range\n");
+        return false;
+    }
+
+    qint32 nchan = this->info.nchan;
+    qint32 nout = m_vecReadSel.size() > 0 ? m_vecReadSel.size() : nchan;
+    if (data.rows() != nout || data.cols() != to-from+1)
+        data.resize(nout, to-from+1);
+
+    bool t_bFused = m_matReadMult.size() > 0;
+    qint32 dest = 0;
+    fiff_int_t first_pick, last_pick, picksamp;
+    FiffTag::SPtr t_pTag;
+    //Split files opened by this call are closed again at the end
+    QList<QIODevice*> t_listOpenedSplits;
+
+    for (qint32 k = 0; k < this->rawdir.size(); ++k)
+    {
+        const FiffRawDir& thisRawDir = this->rawdir[k];
+        //
+        //  Do we need this buffer
+        //
+        if (thisRawDir.last < from)
+            continue;
+
+        first_pick = from > thisRawDir.first ? from - thisRawDir.first : 0;
+        last_pick  = (to < thisRawDir.last ? to : thisRawDir.last) - thisRawDir.first;
+        picksamp   = last_pick - first_pick + 1;
+
+        if (picksamp > 0)
+        {
+            if (thisRawDir.ent.kind == -1)
+            {
+                //
+                //  Skip is translated to zeros
+                //
+                data.block(0, dest, nout, picksamp).setZero();
+            }
+            else
+            {
+                FiffStream::SPtr t_pStream = thisRawDir.file_idx > 0 ? this->split_files[thisRawDir.file_idx-1] : this->file;
+                if (!t_pStream->device()->isOpen())
+                {
+                    if (!t_pStream->device()->open(QIODevice::ReadOnly))
+                    {
+                        printf("Cannot open file %s\n",t_pStream->streamName().toUtf8().constData());
+                        for (qint32 j = 0; j < t_listOpenedSplits.size(); ++j)
+                            t_listOpenedSplits[j]->close();
+                        return false;
+                    }
+                    if (t_pStream != this->file)
+                        t_listOpenedSplits.append(t_pStream->device());
+                }
+
+                FiffTag::read_tag(t_pStream.data(), t_pTag, thisRawDir.ent.pos);
+
+                bool t_bDecoded;
+                if (!t_bFused)
+                {
+                    //
+                    //  Decode and calibrate the selected channels straight into the output
+                    //
+                    t_bDecoded = t_pTag->toRawBuffer(nchan, m_vecReadSel, m_vecReadCals, first_pick, picksamp, data, dest);
+                }
+                else
+                {
+                    if (m_matReadBuffer.rows() != nchan || m_matReadBuffer.cols() < picksamp)
+                        m_matReadBuffer.resize(nchan, qMax(picksamp, thisRawDir.nsamp));
+
+                    t_bDecoded = t_pTag->toRawBuffer(nchan, defaultRowVectorXi, VectorXd(), first_pick, picksamp, m_matReadBuffer, 0);
+                    if (t_bDecoded)
+                        data.block(0, dest, nout, picksamp).noalias() = m_matReadMult * m_matReadBuffer.leftCols(picksamp);
+                }
+
+                if (!t_bDecoded)
+                {
+                    printf("Cannot decode raw data buffer of type %d\n", t_pTag->type);
+                    data.block(0, dest, nout, picksamp).setZero();
+                }
+            }
+
+            dest += picksamp;
+        }
+        //
+        //  Done?
+        //
+        if (thisRawDir.last >= to)
+            break;
+    }
+
+    for (qint32 k = 0; k < t_listOpenedSplits.size(); ++k)
+        t_listOpenedSplits[k]->close();
+
+    return true;
+}
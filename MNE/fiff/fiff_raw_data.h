@@ -125,6 +125,18 @@ public:
     */
     ~FiffRawData();
 
+    //=========================================================================================================
+    /**
+    * Appends the next file of a split recording. The raw directory of the split is concatenated with sample
+    * indices continuing seamlessly; a gap between the files is filled with a skip.
+    *
+    * @param[in] p_Split        raw data of the next split file (may contain further splits itself)
+    * @param[in] p_pDevice      IO device of p_Split.file; ownership is shared with this raw data object
+    *
+    * @return true if the split was appended, false if it doesn't continue this recording
+    */
+    bool append_split(const FiffRawData& p_Split, const QSharedPointer<QIODevice>& p_pDevice);
+
     //=========================================================================================================
     /**
     * Initializes the fiff raw measurement data.
@@ -191,6 +203,32 @@ public:
     */
     bool read_raw_segment_times(MatrixXd& data, MatrixXd& times, float from, float to, const RowVectorXi& sel = defaultRowVectorXi);
 
+    //=========================================================================================================
+    /**
+    * Prepares the read plan which is used by read_raw_segment(MatrixXd&, fiff_int_t, fiff_int_t). Selection,
+    * projector, compensator and calibration are fused into a single operator. Has to be called again after
+    * proj, comp or cals were changed.
+    *
+    * @param[in] sel        channel selection vector (optional)
+    *
+    * @return true if succeeded, false if the selection is invalid
+    */
+    bool prepare_read_plan(const RowVectorXi& sel = defaultRowVectorXi);
+
+    //=========================================================================================================
+    /**
+    * Read a specific raw data segment using the prepared read plan (prepare_read_plan is called with the
+    * defaults if no plan exists). The buffers are decoded straight into the output, which is only reallocated
+    * when its size doesn't match the segment. Intended for repeated reads in a loop.
+    *
+    * @param[in, out] data  the data matrix (selected channels x samples), reused if it has the right size
+    * @param[in] from       first sample to include
+    * @param[in] to         last sample to include
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool read_raw_segment(MatrixXd& data, fiff_int_t from, fiff_int_t to);
+
 public:
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
@@ -200,6 +238,15 @@ public:
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
     MatrixXd proj;              /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
+    QList<FiffStream::SPtr> split_files;            /**< Continuation files of a split recording (*-1.fif, *-2.fif, ...). */
+    QList<QSharedPointer<QIODevice> > split_devices; /**< IO devices of the split files. */
+
+private:
+    bool        m_bReadPlanValid;   /**< Whether the read plan is prepared. */
+    RowVectorXi m_vecReadSel;       /**< Channel selection of the read plan, all channels if empty. */
+    VectorXd    m_vecReadCals;      /**< Calibration of the selected channels, used if there is no fused operator. */
+    MatrixXd    m_matReadMult;      /**< Fused operator sel*proj*comp*cal, empty if only calibration is applied. */
+    MatrixXd    m_matReadBuffer;    /**< Decoded buffer (all channels), reused between reads. */
 };
 
 } // NAMESPACE
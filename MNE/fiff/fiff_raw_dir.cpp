@@ -58,6 +58,7 @@ FiffRawDir::FiffRawDir()
 : first(-1)
 , last(-1)
 , nsamp(-1)
+, file_idx(0)
 {
 
 }
@@ -70,6 +71,7 @@ FiffRawDir::FiffRawDir(const FiffRawDir &p_FiffRawDir)
 , first(p_FiffRawDir.first)
 , last(p_FiffRawDir.last)
 , nsamp(p_FiffRawDir.nsamp)
+, file_idx(p_FiffRawDir.file_idx)
 {
 
 }
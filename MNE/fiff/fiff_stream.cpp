@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "fiff_stream.h"
+#include "fiff_dir_index.h"
 #include "fiff_tag.h"
 #include "fiff_dir_tree.h"
 #include "fiff_ctf_comp.h"
@@ -55,7 +56,10 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
 
 
 //*************************************************************************************************************
@@ -74,6 +78,9 @@ using namespace UTILSLIB;
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_pMappedFile(NULL)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -85,6 +92,9 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 
 FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_pMappedFile(NULL)
+, m_pMappedData(NULL)
+, m_iMappedSize(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -96,6 +106,8 @@ FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 
 FiffStream::~FiffStream()
 {
+    setMemoryMapped(false);
+
     //ToDo check if all IO devices are closed outside --> don't do this here!!
 //    printf("DEBUG: check if FiffStream::IODevice is closed else where. Cause here it's not anymore.");
 
@@ -148,7 +160,8 @@ bool FiffStream::get_evoked_entries(const QList<FiffDirTree> &evoked_node, QStri
     QList<FiffDirTree>::ConstIterator ev;
 
     FiffTag::SPtr t_pTag;
-    qint32 kind, pos, k;
+    qint32 kind, k;
+    fiff_long_t pos;
 
     for(ev = evoked_node.begin(); ev != evoked_node.end(); ++ev)
     {
@@ -209,8 +222,10 @@ bool FiffStream::open(FiffDirTree& p_Tree, QList<FiffDirEntry>& p_Dir)
         return false;
     }
 
+    m_pDirIndex.clear();
+
     FiffTag::SPtr t_pTag;
-    FiffTag::read_tag_info(this, t_pTag);
+    FiffTag::read_tag(this, t_pTag);
 
     if (t_pTag->kind != FIFF_FILE_ID)
     {
@@ -229,6 +244,25 @@ bool FiffStream::open(FiffDirTree& p_Tree, QList<FiffDirEntry>& p_Dir)
         return false;
     }
 
+    //
+    //   A valid index saves the directory scan, if indexing was enabled with FiffDirIndex::setCacheDir
+    //
+    QFile* t_pFile = FiffDirIndex::cacheDir().isEmpty() ? NULL : qobject_cast<QFile*>(this->device());
+    FiffId t_fileId = t_pTag->toFiffID();
+    if (t_pFile)
+    {
+        FiffDirIndex::SPtr t_pIndex(new FiffDirIndex());
+        if (t_pIndex->read(t_pFile->fileName(), t_fileId))
+        {
+            printf("\nReading tag directory of %s from index...[done]\n", t_sFileName.toUtf8().constData());
+            p_Dir = t_pIndex->dir;
+            p_Tree = t_pIndex->tree;
+            m_pDirIndex = t_pIndex;
+            this->device()->seek(0);
+            return true;
+        }
+    }
+
     FiffTag::read_tag(this, t_pTag);
 
     if (t_pTag->kind != FIFF_DIR_POINTER)
@@ -243,7 +277,14 @@ bool FiffStream::open(FiffDirTree& p_Tree, QList<FiffDirEntry>& p_Dir)
     printf("\nCreating tag directory for %s...", t_sFileName.toUtf8().constData());
 
     p_Dir.clear();
-    qint32 dirpos = *t_pTag->toInt();
+    //
+    //   The directory stores 32-bit positions. Read them unsigned, which covers files up to 4 GB.
+    //   Beyond that the directory can't address all tags and is rebuilt with 64-bit positions.
+    //
+    fiff_long_t dirpos = (quint32)*t_pTag->toInt();
+    if (*t_pTag->toInt() == FIFFV_NEXT_NONE || this->device()->size() > Q_INT64_C(0xFFFFFFFF))
+        dirpos = 0;
+
     if (dirpos > 0)
     {
         FiffTag::read_tag(this, t_pTag, dirpos);
@@ -254,7 +295,7 @@ bool FiffStream::open(FiffDirTree& p_Tree, QList<FiffDirEntry>& p_Dir)
         qint32 k = 0;
         this->device()->seek(0);//fseek(fid,0,'bof');
         FiffDirEntry t_fiffDirEntry;
-        while (t_pTag->next >= 0)
+        while (t_pTag->next >= 0 && !this->device()->atEnd())
         {
             t_fiffDirEntry.pos = this->device()->pos();//pos = ftell(fid);
             FiffTag::read_tag_info(this, t_pTag);
@@ -271,6 +312,19 @@ bool FiffStream::open(FiffDirTree& p_Tree, QList<FiffDirEntry>& p_Dir)
 
     FiffDirTree::make_dir_tree(this, p_Dir, p_Tree);
 
+    //
+    //   Keep the result of a full scan in the index
+    //
+    if (dirpos <= 0 && t_pFile)
+    {
+        m_pDirIndex = FiffDirIndex::SPtr(new FiffDirIndex());
+        m_pDirIndex->file_id = t_fileId;
+        m_pDirIndex->dir = p_Dir;
+        m_pDirIndex->tree = p_Tree;
+        if (!m_pDirIndex->write(t_pFile->fileName()))
+            m_pDirIndex.clear();
+    }
+
     printf("[done]\n");
 
     //
@@ -526,7 +580,8 @@ QList<FiffCtfComp> FiffStream::read_ctf_comp(const FiffDirTree& p_Node, const QL
     QList<FiffDirTree> t_qListComps = p_Node.dir_tree_find(FIFFB_MNE_CTF_COMP_DATA);
 
     qint32 i, k, p, col, row;
-    fiff_int_t kind, pos;
+    fiff_int_t kind;
+    fiff_long_t pos;
     FiffTag::SPtr t_pTag;
     for (k = 0; k < t_qListComps.size(); ++k)
     {
@@ -675,6 +730,61 @@ QList<FiffCtfComp> FiffStream::read_ctf_comp(const FiffDirTree& p_Node, const QL
 }
 
 
+//*************************************************************************************************************
+
+QString FiffStream::read_next_split_file_name(const FiffDirTree& p_Node, bool p_bGuessName)
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if (!t_pFile)
+        return QString();
+
+    QFileInfo t_FileInfo(t_pFile->fileName());
+    QString t_sNextFile;
+    //
+    //   Is there a reference to the next file?
+    //
+    bool t_bHasNextRef = false;
+    fiff_int_t t_iNextNum = -1;
+    QList<FiffDirTree> refs = p_Node.dir_tree_find(FIFFB_REF);
+    FiffTag::SPtr t_pTag;
+    for (qint32 k = 0; k < refs.size(); ++k)
+    {
+        if (refs[k].find_tag(this, FIFF_REF_ROLE, t_pTag) && *t_pTag->toInt() == FIFFV_ROLE_NEXT_FILE)
+        {
+            t_bHasNextRef = true;
+            if (refs[k].find_tag(this, FIFF_REF_FILE_NAME, t_pTag))
+                t_sNextFile = t_FileInfo.dir().filePath(QFileInfo(t_pTag->toString()).fileName());
+            else if (refs[k].find_tag(this, FIFF_REF_FILE_NUM, t_pTag))
+                t_iNextNum = *t_pTag->toInt();
+            break;
+        }
+    }
+    //
+    //   Without a file name follow the naming convention: name.fif, name-1.fif, name-2.fif, ...
+    //   The number comes from the reference; guessing it from the name alone has to be asked for, since
+    //   names like sub-01_run-1.fif are no split files.
+    //
+    if (t_sNextFile.isEmpty() && (t_bHasNextRef || p_bGuessName) && t_FileInfo.suffix() == "fif")
+    {
+        QString t_sBaseName = t_FileInfo.completeBaseName();
+        QRegExp t_SplitExp("^(.*)-(\\d+)$");
+        bool t_bNumbered = t_SplitExp.exactMatch(t_sBaseName);
+        if (t_bNumbered)
+            t_sBaseName = t_SplitExp.cap(1);
+
+        if (t_iNextNum < 0)
+            t_iNextNum = t_bNumbered ? t_SplitExp.cap(2).toInt() + 1 : 1;
+
+        t_sNextFile = t_FileInfo.dir().filePath(QString("%1-%2.fif").arg(t_sBaseName).arg(t_iNextNum));
+    }
+
+    if (t_sNextFile.isEmpty() || !QFile::exists(t_sNextFile))
+        return QString();
+
+    return t_sNextFile;
+}
+
+
 //*************************************************************************************************************
 
 bool FiffStream::read_meas_info_base(const FiffDirTree& p_Node, FiffInfoBase& p_InfoForward)
@@ -697,7 +807,7 @@ bool FiffStream::read_meas_info_base(const FiffDirTree& p_Node, FiffInfoBase& p_
     QList<FiffChInfo> chs;
     FiffCoordTrans cand;
     fiff_int_t kind = -1;
-    fiff_int_t pos = -1;
+    fiff_long_t pos = -1;
 
     for (qint32 k = 0; k < parent_meg[0].nent; ++k)
     {
@@ -792,7 +902,7 @@ bool FiffStream::read_meas_info(const FiffDirTree& p_Node, FiffInfo& info, FiffD
     meas_date[1] = -1;
 
     fiff_int_t kind = -1;
-    fiff_int_t pos = -1;
+    fiff_long_t pos = -1;
 
     for (qint32 k = 0; k < meas_info[0].nent; ++k)
     {
@@ -1313,7 +1423,7 @@ QList<FiffProj> FiffStream::read_proj(const FiffDirTree& p_Node)
 
 //*************************************************************************************************************
 
-bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield)
+bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield, bool read_split_files, bool guess_split_names)
 {
     //
     //   Open the file
@@ -1410,13 +1520,21 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     }
     data.first_samp = first_samp;
     //
-    //   Go through the remaining tags in the directory
+    //   Go through the remaining tags in the directory, unless the index has the buffer ranges already
     //
     QList<FiffRawDir> rawdir;
 //        rawdir = struct('ent',{},'first',{},'last',{},'nsamp',{});
     fiff_int_t nskip = 0;
     fiff_int_t ndir  = 0;
     fiff_int_t nsamp = 0;
+    bool t_bIndexedRawDir = p_pStream->m_pDirIndex && p_pStream->m_pDirIndex->hasRawDir(raw[0].block);
+    if (t_bIndexedRawDir)
+    {
+        rawdir = p_pStream->m_pDirIndex->rawdir;
+        data.first_samp = p_pStream->m_pDirIndex->first_samp;
+        first_samp = p_pStream->m_pDirIndex->last_samp + 1;
+        nent = first;
+    }
     for (qint32 k = first; k < nent; ++k)
     {
         FiffDirEntry ent = dir.at(k);
@@ -1485,6 +1603,17 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
         }
     }
     data.last_samp  = first_samp - 1;//ToDo -1 right or is that MATLAB syntax
+
+    if (p_pStream->m_pDirIndex && !t_bIndexedRawDir)
+    {
+        QFile* t_pFile = qobject_cast<QFile*>(&p_IODevice);
+        p_pStream->m_pDirIndex->raw_kind = raw[0].block;
+        p_pStream->m_pDirIndex->first_samp = data.first_samp;
+        p_pStream->m_pDirIndex->last_samp = data.last_samp;
+        p_pStream->m_pDirIndex->rawdir = rawdir;
+        if (t_pFile)
+            p_pStream->m_pDirIndex->write(t_pFile->fileName());
+    }
     //
     //   Add the calibration factors
     //
@@ -1498,12 +1627,90 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     //data->proj       = [];
     //data.comp       = [];
     //
+    //   Continue with the next file of a split recording
+    //
+    QString t_sNextFile;
+    if (read_split_files)
+        t_sNextFile = p_pStream->read_next_split_file_name(t_Tree, guess_split_names);
+
+    data.file->device()->close();
+
+    if (!t_sNextFile.isEmpty())
+    {
+        QSharedPointer<QIODevice> t_pNextDevice(new QFile(t_sNextFile));
+        FiffRawData t_NextRaw;
+        if (FiffStream::setup_read_raw(*t_pNextDevice, t_NextRaw, allow_maxshield, true, guess_split_names))
+        {
+            //
+            //   Only parts of the same measurement are joined
+            //
+            const FiffId& t_id = data.info.meas_id;
+            const FiffId& t_nextId = t_NextRaw.info.meas_id;
+            if (t_id.isEmpty() || t_nextId.isEmpty()
+                    || t_id.version != t_nextId.version
+                    || t_id.machid[0] != t_nextId.machid[0] || t_id.machid[1] != t_nextId.machid[1]
+                    || t_id.time.secs != t_nextId.time.secs || t_id.time.usecs != t_nextId.time.usecs)
+                printf("%s is not part of the same measurement. Not appended.\n", t_sNextFile.toUtf8().constData());
+            else
+                data.append_split(t_NextRaw, t_pNextDevice);
+        }
+    }
+
     printf("\tRange : %d ... %d  =  %9.3f ... %9.3f secs\n",
            data.first_samp,data.last_samp,
            (double)data.first_samp/data.info.sfreq,
            (double)data.last_samp/data.info.sfreq);
     printf("Ready.\n");
-    data.file->device()->close();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::setMemoryMapped(bool p_bMemoryMapped)
+{
+    if(!p_bMemoryMapped)
+    {
+        if(m_pMappedFile)
+        {
+            if(m_pMappedData)
+                m_pMappedFile->unmap(m_pMappedData);
+            m_pMappedFile->close();
+            delete m_pMappedFile;
+        }
+        m_pMappedFile = NULL;
+        m_pMappedData = NULL;
+        m_iMappedSize = 0;
+        return true;
+    }
+
+    if(m_pMappedData)
+        return true;
+
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile)
+    {
+        printf("Memory mapping is only supported for fiff files.\n");
+        return false;
+    }
+
+    m_pMappedFile = new QFile(t_pFile->fileName());
+    if(!m_pMappedFile->open(QIODevice::ReadOnly) || m_pMappedFile->size() == 0)
+    {
+        printf("Cannot open %s for memory mapping\n", t_pFile->fileName().toUtf8().constData());
+        setMemoryMapped(false);
+        return false;
+    }
+
+    m_iMappedSize = m_pMappedFile->size();
+    m_pMappedData = m_pMappedFile->map(0, m_iMappedSize);
+    if(!m_pMappedData)
+    {
+        printf("Cannot map %s: %s\n", t_pFile->fileName().toUtf8().constData(), m_pMappedFile->errorString().toUtf8().constData());
+        setMemoryMapped(false);
+        return false;
+    }
 
     return true;
 }
@@ -2008,10 +2215,13 @@ void FiffStream::write_double(fiff_int_t kind, const double* data, fiff_int_t ne
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
+    //The stream writes single precision by default -> a double would be truncated to 4 bytes
+    this->setFloatingPointPrecision(QDataStream::DoublePrecision);
 
     for(qint32 i = 0; i < nel; ++i)
         *this << data[i];
+
+    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
 }
 
 
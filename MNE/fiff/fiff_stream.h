@@ -106,6 +106,7 @@ class FiffRawData;
 class FiffInfo;
 class FiffInfoBase;
 class FiffCov;
+class FiffDirIndex;
 
 
 static FiffId defaultFiffId;
@@ -196,6 +197,31 @@ public:
     */
     bool get_evoked_entries(const QList<FiffDirTree> &evoked_node, QStringList &comments, QList<fiff_int_t> &aspect_kinds, QString &t);
 
+    //=========================================================================================================
+    /**
+    * Returns whether the underlying file is memory-mapped. In that case FiffTag::read_tag doesn't copy the
+    * tag payload; the tag is a view into the mapped file and is byte-swapped lazily on access.
+    *
+    * @return true if the stream reads tags from a memory-mapped file, false otherwise
+    */
+    inline bool isMemoryMapped() const;
+
+    //=========================================================================================================
+    /**
+    * Pointer to the beginning of the memory-mapped file.
+    *
+    * @return the mapped file or NULL if the stream is not memory-mapped
+    */
+    inline const uchar* mappedData() const;
+
+    //=========================================================================================================
+    /**
+    * Size of the memory-mapped file in bytes.
+    *
+    * @return the size of the mapping, 0 if the stream is not memory-mapped
+    */
+    inline qint64 mappedSize() const;
+
     //=========================================================================================================
     /**
     * QFile::open
@@ -210,7 +236,9 @@ public:
     *
     * ### MNE toolbox root function ###
     *
-    * Opens a fif file and provides the directory of tags
+    * Opens a fif file and provides the directory of tags. If the directory has to be rebuilt by scanning all
+    * tag headers and an index cache directory is set (see FiffDirIndex::setCacheDir), the result is kept in
+    * an index which is used on the next open.
     *
     * @param[out] p_Tree    tag directory organized into a tree
     * @param[out] p_Dir     the sequential tag directory
@@ -266,6 +294,19 @@ public:
     */
     QList<FiffCtfComp> read_ctf_comp(const FiffDirTree& p_Node, const QList<FiffChInfo>& p_Chs);
 
+    //=========================================================================================================
+    /**
+    * Determines the next file of a split recording from a FIFFB_REF block with the role FIFFV_ROLE_NEXT_FILE.
+    * Its file name is used if present, otherwise the naming convention name.fif, name-1.fif, name-2.fif, ...
+    * with the referenced file number. Files without such a reference are only continued by name if asked for.
+    *
+    * @param[in] p_Node         The node to search for file references (usually the root of the file)
+    * @param[in] p_bGuessName   Follow the naming convention also if there is no reference (optional, default = false)
+    *
+    * @return the path of the existing next file, an empty string if there is none
+    */
+    QString read_next_split_file_name(const FiffDirTree& p_Node, bool p_bGuessName = false);
+
     //=========================================================================================================
     /**
     * fiff_read_meas_info
@@ -339,10 +380,27 @@ public:
     * @param[in] p_IODevice        An fiff IO device like a fiff QFile or QTCPSocket
     * @param[out] data              The raw data information - contains the opened fiff file
     * @param[in] allow_maxshield    Accept unprocessed MaxShield data
+    * @param[in] read_split_files   Append the following files of a split recording, so that data presents
+    *                               the whole recording (optional, default = true)
+    * @param[in] guess_split_names  Look for name-1.fif, name-2.fif, ... also if a file doesn't reference a next
+    *                               file (optional, default = false). Only files of the same measurement are appended.
     *
     * @return true if succeeded, false otherwise
     */
-    static bool setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield = false);
+    static bool setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool allow_maxshield = false, bool read_split_files = true, bool guess_split_names = false);
+
+    //=========================================================================================================
+    /**
+    * Switches the memory-mapped reader mode on or off. The file behind the stream's QFile device is mapped
+    * read-only through an own file handle, so the mapping stays valid while the device is closed and reopened.
+    * Tags read from a mapped stream reference the mapping and must not outlive the stream.
+    * Not available for sockets and byte arrays.
+    *
+    * @param[in] p_bMemoryMapped    true to map the file, false to release the mapping
+    *
+    * @return true if the requested mode is active, false otherwise
+    */
+    bool setMemoryMapped(bool p_bMemoryMapped);
 
     //=========================================================================================================
     /**
@@ -692,8 +750,40 @@ public:
     * @param[in] data       The string data to write
     */
     void write_rt_command(fiff_int_t command, const QString& data);
+
+private:
+    QFile*  m_pMappedFile;      /**< Own read-only handle of the memory-mapped file. */
+    uchar*  m_pMappedData;      /**< Start of the mapping, NULL if not mapped. */
+    qint64  m_iMappedSize;      /**< Size of the mapping in bytes. */
+    QSharedPointer<FiffDirIndex> m_pDirIndex;  /**< Index of the opened file, NULL if the file isn't indexed. */
 };
 
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffStream::isMemoryMapped() const
+{
+    return m_pMappedData != NULL;
+}
+
+
+//*************************************************************************************************************
+
+inline const uchar* FiffStream::mappedData() const
+{
+    return m_pMappedData;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 FiffStream::mappedSize() const
+{
+    return m_iMappedSize;
+}
+
 } // NAMESPACE
 
 #endif // FIFF_STREAM_H
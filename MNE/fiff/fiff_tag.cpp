@@ -49,6 +49,7 @@
 //=============================================================================================================
 
 #include <QTcpSocket>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -66,7 +67,8 @@ using namespace FIFFLIB;
 //=============================================================================================================
 
 FiffTag::FiffTag()
-: m_pComplexFloatData(NULL)
+: m_bConversionPending(false)
+, m_pComplexFloatData(NULL)
 , m_pComplexDoubleData(NULL)
 {
 }
@@ -79,6 +81,7 @@ FiffTag::FiffTag(const FiffTag* p_pFiffTag)
 , kind(p_pFiffTag->kind)
 , type(p_pFiffTag->type)
 , next(p_pFiffTag->next)
+, m_bConversionPending(p_pFiffTag->m_bConversionPending)
 {
     if(p_pFiffTag->m_pComplexFloatData)
         this->toComplexFloat();
@@ -202,6 +205,54 @@ bool FiffTag::read_rt_tag(FiffStream* p_pStream, FiffTag::SPtr& p_pTag)
 
 bool FiffTag::read_tag(FiffStream* p_pStream, FiffTag::SPtr& p_pTag, qint64 pos)
 {
+    if (p_pStream->isMemoryMapped() && (pos >= 0 || p_pStream->device()->isOpen()))
+    {
+        //
+        // Memory-mapped file: the tag data are a view into the mapping
+        //
+        if (pos < 0)
+            pos = p_pStream->device()->pos();
+
+        if (pos + 16 > p_pStream->mappedSize())
+        {
+            printf("Error in FiffTag::read_tag: tag position %lld is beyond the end of file.\n", pos);
+            return false;
+        }
+
+        const uchar* t_pHeader = p_pStream->mappedData() + pos;
+
+        p_pTag = FiffTag::SPtr(new FiffTag());
+        p_pTag->kind = qFromBigEndian<qint32>(t_pHeader);
+        p_pTag->type = qFromBigEndian<qint32>(t_pHeader + 4);
+        qint32 size  = qFromBigEndian<qint32>(t_pHeader + 8);
+        p_pTag->next = qFromBigEndian<qint32>(t_pHeader + 12);
+
+        if (size < 0 || pos + 16 + size > p_pStream->mappedSize())
+        {
+            printf("Error in FiffTag::read_tag: tag at position %lld exceeds the file size.\n", pos);
+            return false;
+        }
+
+        if (size > 0)
+        {
+            p_pTag->setRawData((const char*)(t_pHeader + 16), size);
+            p_pTag->m_bConversionPending = (NATIVE_ENDIAN != FIFFV_BIG_ENDIAN);
+        }
+
+        //
+        // Keep the device position consistent with the stream based reading
+        //
+        if (p_pStream->device()->isOpen())
+        {
+            if (p_pTag->next != FIFFV_NEXT_SEQ)
+                p_pStream->device()->seek(p_pTag->next);
+            else
+                p_pStream->device()->seek(pos + 16 + size);
+        }
+
+        return true;
+    }
+
     if (pos >= 0)
     {
         p_pStream->device()->seek(pos);
@@ -270,22 +321,29 @@ bool FiffTag::getMatrixDimensions(qint32& p_ndim, QVector<qint32>& p_Dims) const
     //
     // Find dimensions and return to the beginning of tag data
     //
-    qint32* t_pInt32 = (qint32*)this->data();
+    const qint32* t_pInt32 = (const qint32*)this->constData();
 
     p_ndim = t_pInt32[(this->size()-4)/4];
+    if (m_bConversionPending)
+        p_ndim = IOUtils::swap_int(p_ndim);
 
+    qint32 t_iNumDims;
     if (fiff_type_matrix_coding(this->type) == FIFFTS_MC_DENSE)
-        for(int i = p_ndim+1; i > 1; --i)
-            p_Dims.append(t_pInt32[(this->size()-(i*4))/4]);
+        t_iNumDims = p_ndim;
     else if(fiff_type_matrix_coding(this->type) == FIFFTS_MC_CCS || fiff_type_matrix_coding(this->type) == FIFFTS_MC_RCS)
-        for(int i = p_ndim+2; i > 1; --i)
-            p_Dims.append(t_pInt32[(this->size()-(i*4))/4]);
+        t_iNumDims = p_ndim+1;
     else
     {
         printf("Error: Cannot handle other than dense or sparse matrices yet.\n");//ToDo Throw
         return false;
     }
 
+    for(int i = t_iNumDims+1; i > 1; --i)
+    {
+        qint32 t_iDim = t_pInt32[(this->size()-(i*4))/4];
+        p_Dims.append(m_bConversionPending ? IOUtils::swap_int(t_iDim) : t_iDim);
+    }
+
     return true;
 }
 
@@ -406,6 +464,190 @@ QString FiffTag::getInfo() const
 }
 
 
+//*************************************************************************************************************
+
+void FiffTag::convertToNative() const
+{
+    if (!m_bConversionPending)
+        return;
+
+    FiffTag* t_pTag = const_cast<FiffTag*>(this);
+    t_pTag->m_bConversionPending = false;
+    t_pTag->detach();
+    FiffTag::convert_tag_data(t_pTag,FIFFV_BIG_ENDIAN,FIFFV_NATIVE_ENDIAN);
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static void decode_raw_samples(const char* p_pData, bool p_bSwap, MatrixXd& p_matData)
+{
+    if (p_bSwap)
+    {
+        const uchar* t_pSource = (const uchar*)p_pData;
+        double* t_pDest = p_matData.data();
+        for (qint64 i = 0; i < p_matData.size(); ++i, t_pSource += sizeof(T))
+            t_pDest[i] = (double)qFromBigEndian<T>(t_pSource);
+    }
+    else
+        p_matData = Map< const Matrix<T, Dynamic, Dynamic> >((const T*)p_pData, p_matData.rows(), p_matData.cols()).template cast<double>();
+}
+
+
+//*************************************************************************************************************
+
+template<>
+void decode_raw_samples<float>(const char* p_pData, bool p_bSwap, MatrixXd& p_matData)
+{
+    if (p_bSwap)
+    {
+        const uchar* t_pSource = (const uchar*)p_pData;
+        double* t_pDest = p_matData.data();
+        float t_fValue;
+        for (qint64 i = 0; i < p_matData.size(); ++i, t_pSource += sizeof(float))
+        {
+            quint32 t_iBits = qFromBigEndian<quint32>(t_pSource);
+            memcpy(&t_fValue, &t_iBits, sizeof(float));
+            t_pDest[i] = (double)t_fValue;
+        }
+    }
+    else
+        p_matData = Map< const MatrixXf >((const float*)p_pData, p_matData.rows(), p_matData.cols()).cast<double>();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffTag::toRawBuffer(qint32 p_iNChan, MatrixXd& p_matData) const
+{
+    if (this->isMatrix() || p_iNChan <= 0 || this->size() == 0)
+        return false;
+
+    switch (this->type)
+    {
+    case FIFFT_DAU_PACK16:
+    case FIFFT_SHORT:
+        p_matData.resize(p_iNChan, this->size()/(2*p_iNChan));
+        decode_raw_samples<qint16>(this->constData(), m_bConversionPending, p_matData);
+        return true;
+    case FIFFT_INT:
+        p_matData.resize(p_iNChan, this->size()/(4*p_iNChan));
+        decode_raw_samples<qint32>(this->constData(), m_bConversionPending, p_matData);
+        return true;
+    case FIFFT_FLOAT:
+        p_matData.resize(p_iNChan, this->size()/(4*p_iNChan));
+        decode_raw_samples<float>(this->constData(), m_bConversionPending, p_matData);
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static inline double raw_sample(const uchar* p_pSource, bool p_bSwap)
+{
+    if (p_bSwap)
+        return (double)qFromBigEndian<T>(p_pSource);
+    T t_value;
+    memcpy(&t_value, p_pSource, sizeof(T));
+    return (double)t_value;
+}
+
+
+//*************************************************************************************************************
+
+template<>
+inline double raw_sample<float>(const uchar* p_pSource, bool p_bSwap)
+{
+    float t_fValue;
+    if (p_bSwap)
+    {
+        quint32 t_iBits = qFromBigEndian<quint32>(p_pSource);
+        memcpy(&t_fValue, &t_iBits, sizeof(float));
+    }
+    else
+        memcpy(&t_fValue, p_pSource, sizeof(float));
+    return (double)t_fValue;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+static void decode_raw_block(const char* p_pData, bool p_bSwap, qint32 p_iNChan, const RowVectorXi& p_vecSel, const VectorXd& p_vecScale, qint32 p_iFirst, qint32 p_iNSamp, MatrixXd& p_matDest, qint32 p_iDestCol)
+{
+    const qint32 t_iNRows = p_matDest.rows();
+    const bool t_bSel = p_vecSel.size() > 0;
+    const bool t_bScale = p_vecScale.size() > 0;
+
+    for (qint32 s = 0; s < p_iNSamp; ++s)
+    {
+        const uchar* t_pSource = (const uchar*)p_pData + (qint64)(p_iFirst + s)*p_iNChan*sizeof(T);
+        double* t_pDest = p_matDest.data() + (qint64)(p_iDestCol + s)*t_iNRows;
+        for (qint32 r = 0; r < t_iNRows; ++r)
+        {
+            double t_dValue = raw_sample<T>(t_pSource + (t_bSel ? p_vecSel[r] : r)*sizeof(T), p_bSwap);
+            t_pDest[r] = t_bScale ? p_vecScale[r]*t_dValue : t_dValue;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffTag::toRawBuffer(qint32 p_iNChan, const RowVectorXi& p_vecSel, const VectorXd& p_vecScale, qint32 p_iFirst, qint32 p_iNSamp, MatrixXd& p_matDest, qint32 p_iDestCol) const
+{
+    if (this->isMatrix() || p_iNChan <= 0 || this->size() == 0 || p_iFirst < 0 || p_iNSamp <= 0)
+        return false;
+
+    qint32 t_iNRows = p_vecSel.size() > 0 ? p_vecSel.size() : p_iNChan;
+    if (p_matDest.rows() != t_iNRows || p_iDestCol < 0 || p_iDestCol + p_iNSamp > p_matDest.cols())
+        return false;
+    if (p_vecScale.size() > 0 && p_vecScale.size() != t_iNRows)
+        return false;
+    if (p_vecSel.size() > 0 && (p_vecSel.minCoeff() < 0 || p_vecSel.maxCoeff() >= p_iNChan))
+        return false;
+
+    qint32 t_iSampleSize;
+    switch (this->type)
+    {
+    case FIFFT_DAU_PACK16:
+    case FIFFT_SHORT:
+        t_iSampleSize = 2;
+        break;
+    case FIFFT_INT:
+    case FIFFT_FLOAT:
+        t_iSampleSize = 4;
+        break;
+    default:
+        return false;
+    }
+
+    if ((qint64)(p_iFirst + p_iNSamp)*p_iNChan*t_iSampleSize > this->size())
+        return false;
+
+    switch (this->type)
+    {
+    case FIFFT_DAU_PACK16:
+    case FIFFT_SHORT:
+        decode_raw_block<qint16>(this->constData(), m_bConversionPending, p_iNChan, p_vecSel, p_vecScale, p_iFirst, p_iNSamp, p_matDest, p_iDestCol);
+        break;
+    case FIFFT_INT:
+        decode_raw_block<qint32>(this->constData(), m_bConversionPending, p_iNChan, p_vecSel, p_vecScale, p_iFirst, p_iNSamp, p_matDest, p_iDestCol);
+        break;
+    default:
+        decode_raw_block<float>(this->constData(), m_bConversionPending, p_iNChan, p_vecSel, p_vecScale, p_iFirst, p_iNSamp, p_matDest, p_iDestCol);
+        break;
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 /*---------------------------------------------------------------------------
@@ -462,6 +704,14 @@ void FiffTag::convert_ch_pos(FiffChPos* pos)
 //*************************************************************************************************************
 
 void FiffTag::convert_matrix_from_file_data(FiffTag::SPtr tag)
+{
+    convert_matrix_from_file_data(tag.data());
+}
+
+
+//*************************************************************************************************************
+
+void FiffTag::convert_matrix_from_file_data(FiffTag* tag)
 /*
  * Assumes that the input is in the non-native byte order and needs to be swapped to the other one
  */
@@ -537,6 +787,14 @@ void FiffTag::convert_matrix_from_file_data(FiffTag::SPtr tag)
 //*************************************************************************************************************
 
 void FiffTag::convert_matrix_to_file_data(FiffTag::SPtr tag)
+{
+    convert_matrix_to_file_data(tag.data());
+}
+
+
+//*************************************************************************************************************
+
+void FiffTag::convert_matrix_to_file_data(FiffTag* tag)
 /*
  * Assumes that the input is in the NATIVE_ENDIAN byte order and needs to be swapped to the other one
  */
@@ -612,8 +870,47 @@ void FiffTag::convert_matrix_to_file_data(FiffTag::SPtr tag)
 
 
 //*************************************************************************************************************
-//ToDo remove this function by swapping -> define little endian big endian, QByteArray
 void FiffTag::convert_tag_data(FiffTag::SPtr tag, int from_endian, int to_endian)
+{
+    convert_tag_data(tag.data(), from_endian, to_endian);
+}
+
+
+//*************************************************************************************************************
+
+void FiffTag::copy_from_file_data(fiff_int_t type, const char* src, char* dest, qint64 count)
+{
+    const uchar* t_pSource = (const uchar*)src;
+    qint64 k;
+
+    switch (type) {
+    case FIFFT_SHORT :
+    case FIFFT_DAU_PACK16 :
+    case FIFFT_USHORT :
+        for (k = 0; k < count; ++k)
+            ((qint16*)dest)[k] = qFromBigEndian<qint16>(t_pSource + 2*k);
+        break;
+    case FIFFT_INT :
+    case FIFFT_JULIAN :
+    case FIFFT_UINT :
+    case FIFFT_FLOAT :
+        for (k = 0; k < count; ++k)
+            ((quint32*)dest)[k] = qFromBigEndian<quint32>(t_pSource + 4*k);
+        break;
+    case FIFFT_DOUBLE :
+        for (k = 0; k < count; ++k)
+            ((quint64*)dest)[k] = qFromBigEndian<quint64>(t_pSource + 8*k);
+        break;
+    default :
+        memcpy(dest, src, count);
+        break;
+    }
+}
+
+
+//*************************************************************************************************************
+//ToDo remove this function by swapping -> define little endian big endian, QByteArray
+void FiffTag::convert_tag_data(FiffTag* tag, int from_endian, int to_endian)
 {
     int            np;
     int            k,r;//,c;
@@ -284,6 +284,51 @@ public:
     */
     QString getInfo() const;
 
+    //=========================================================================================================
+    /**
+    * Returns whether the tag data are still in file byte order. This is the case for tags read from a
+    * memory-mapped FiffStream: the data are a view into the mapping and are converted only on access.
+    *
+    * @return true if the byte order conversion is still pending
+    */
+    inline bool isConversionPending() const;
+
+    //=========================================================================================================
+    /**
+    * Converts pending tag data into the native byte order. A tag which is a view into a memory-mapped file is
+    * detached (copied) first. Nothing is done if the conversion was already performed.
+    */
+    void convertToNative() const;
+
+    //=========================================================================================================
+    /**
+    * Decodes a raw data buffer (FIFFT_DAU_PACK16, FIFFT_SHORT, FIFFT_INT or FIFFT_FLOAT) into a double matrix.
+    * Pending byte swapping is done on the fly, i.e. a view into a memory-mapped file is read exactly once.
+    *
+    * @param[in] p_iNChan       number of channels stored in the buffer
+    * @param[out] p_matData     the decoded buffer (channels x samples)
+    *
+    * @return true if the tag contains a supported raw data buffer, false otherwise
+    */
+    bool toRawBuffer(qint32 p_iNChan, MatrixXd& p_matData) const;
+
+    //=========================================================================================================
+    /**
+    * Decodes a sample range of a raw data buffer straight into columns of a preallocated matrix. Channels can be
+    * picked and scaled on the way, so that no intermediate buffer is needed.
+    *
+    * @param[in] p_iNChan       number of channels stored in the buffer
+    * @param[in] p_vecSel       channels to decode, all channels if empty
+    * @param[in] p_vecScale     factor per destination row (e.g. calibration), no scaling if empty
+    * @param[in] p_iFirst       first sample of the buffer to decode
+    * @param[in] p_iNSamp       number of samples to decode
+    * @param[out] p_matDest     destination, must have one row per decoded channel
+    * @param[in] p_iDestCol     first destination column
+    *
+    * @return true if succeeded, false if the tag is no supported raw data buffer or the ranges don't fit
+    */
+    bool toRawBuffer(qint32 p_iNChan, const RowVectorXi& p_vecSel, const VectorXd& p_vecScale, qint32 p_iFirst, qint32 p_iNSamp, MatrixXd& p_matDest, qint32 p_iDestCol) const;
+
     //
     // Simple types
     //
@@ -544,6 +589,17 @@ public:
     */
     static void convert_tag_data(FiffTag::SPtr tag, int from_endian, int to_endian);
 
+    //=========================================================================================================
+    /**
+    * Copies values of a fundamental type from file byte order (big endian) into native byte order.
+    *
+    * @param[in] type       the fundamental type (FIFFT_SHORT, FIFFT_DAU_PACK16, FIFFT_INT, FIFFT_FLOAT or FIFFT_DOUBLE)
+    * @param[in] src        the data in file byte order
+    * @param[out] dest      the converted data
+    * @param[in] count      number of values to copy
+    */
+    static void copy_from_file_data(fiff_int_t type, const char* src, char* dest, qint64 count);
+
     //
     // from fiff_type_spec.c
     //
@@ -587,6 +643,12 @@ public:
 //    QByteArray* data;       /**< Pointer to the data.
 //                             *   This point to the data read or to be written. */
 private:
+    static void convert_matrix_from_file_data(FiffTag* tag);
+    static void convert_matrix_to_file_data(FiffTag* tag);
+    static void convert_tag_data(FiffTag* tag, int from_endian, int to_endian);
+
+    mutable bool m_bConversionPending;  /**< Tag data are still in file byte order. */
+
     std::complex<float>* m_pComplexFloatData;
 
     std::complex<double>* m_pComplexDoubleData;
@@ -598,6 +660,12 @@ private:
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline bool FiffTag::isConversionPending() const
+{
+    return m_bConversionPending;
+}
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // Simple types
@@ -605,6 +673,7 @@ private:
 
 inline quint8* FiffTag::toByte()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_BYTE)
         return NULL;
     else
@@ -616,6 +685,7 @@ inline quint8* FiffTag::toByte()
 
 inline quint16* FiffTag::toUnsignedShort()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_USHORT)
         return NULL;
     else
@@ -627,6 +697,7 @@ inline quint16* FiffTag::toUnsignedShort()
 
 inline qint16* FiffTag::toShort()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_SHORT)
         return NULL;
     else
@@ -638,6 +709,7 @@ inline qint16* FiffTag::toShort()
 
 inline quint32* FiffTag::toUnsignedInt()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_UINT)
         return NULL;
     else
@@ -649,6 +721,7 @@ inline quint32* FiffTag::toUnsignedInt()
 
 inline qint32* FiffTag::toInt()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_INT)
         return NULL;
     else
@@ -660,6 +733,7 @@ inline qint32* FiffTag::toInt()
 
 inline float* FiffTag::toFloat()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_FLOAT)
         return NULL;
     else
@@ -671,6 +745,7 @@ inline float* FiffTag::toFloat()
 
 inline double* FiffTag::toDouble()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_DOUBLE)
         return NULL;
     else
@@ -693,6 +768,7 @@ inline QString FiffTag::toString()
 
 inline qint16* FiffTag::toDauPack16()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_DAU_PACK16)
         return NULL;
     else
@@ -704,6 +780,7 @@ inline qint16* FiffTag::toDauPack16()
 
 inline std::complex<float>* FiffTag::toComplexFloat()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_COMPLEX_FLOAT)
         return NULL;
     else if(this->m_pComplexFloatData == NULL)
@@ -721,6 +798,7 @@ inline std::complex<float>* FiffTag::toComplexFloat()
 
 inline std::complex<double>* FiffTag::toComplexDouble()
 {
+    this->convertToNative();
     if(this->isMatrix() || this->getType() != FIFFT_COMPLEX_DOUBLE)
         return NULL;
     else if(this->m_pComplexDoubleData == NULL)
@@ -740,6 +818,7 @@ inline std::complex<double>* FiffTag::toComplexDouble()
 
 inline FiffId FiffTag::toFiffID() const
 {
+    this->convertToNative();
     FiffId p_fiffID;
     if(this->isMatrix() || this->getType() != FIFFT_ID_STRUCT || this->data() == NULL)
         return p_fiffID;
@@ -763,6 +842,7 @@ inline FiffId FiffTag::toFiffID() const
 
 inline FiffDigPoint FiffTag::toDigPoint() const
 {
+    this->convertToNative();
 
     FiffDigPoint t_fiffDigPoint;
     if(this->isMatrix() || this->getType() != FIFFT_DIG_POINT_STRUCT || this->data() == NULL)
@@ -790,6 +870,7 @@ inline FiffDigPoint FiffTag::toDigPoint() const
 
 inline FiffCoordTrans FiffTag::toCoordTrans() const
 {
+    this->convertToNative();
 
     FiffCoordTrans p_FiffCoordTrans;
     if(this->isMatrix() || this->getType() != FIFFT_COORD_TRANS_STRUCT || this->data() == NULL)
@@ -833,6 +914,7 @@ inline FiffCoordTrans FiffTag::toCoordTrans() const
 */
 inline FiffChInfo FiffTag::toChInfo() const
 {
+    this->convertToNative();
     FiffChInfo p_FiffChInfo;
 
     if(this->isMatrix() || this->getType() != FIFFT_CH_INFO_STRUCT || this->data() == NULL)
@@ -920,6 +1002,7 @@ inline FiffChInfo FiffTag::toChInfo() const
 
 inline QList<FiffDirEntry> FiffTag::toDirEntry() const
 {
+    this->convertToNative();
 //         tag.data = struct('kind',{},'type',{},'size',{},'pos',{});
     QList<FiffDirEntry> p_ListFiffDir;
     if(this->isMatrix() || this->getType() != FIFFT_DIR_ENTRY_STRUCT || this->data() == NULL)
@@ -933,7 +1016,7 @@ inline QList<FiffDirEntry> FiffTag::toDirEntry() const
             t_fiffDirEntry.kind = t_pInt32[k*4];//fread(fid,1,'int32');
             t_fiffDirEntry.type = t_pInt32[k*4+1];//fread(fid,1,'uint32');
             t_fiffDirEntry.size = t_pInt32[k*4+2];//fread(fid,1,'int32');
-            t_fiffDirEntry.pos  = t_pInt32[k*4+3];//fread(fid,1,'int32');
+            t_fiffDirEntry.pos  = (quint32)t_pInt32[k*4+3];//fread(fid,1,'int32'); -> unsigned, valid up to 4 GB
             p_ListFiffDir.append(t_fiffDirEntry);
         }
     }
@@ -965,7 +1048,11 @@ inline MatrixXi FiffTag::toIntMatrix() const
 
     //MatrixXd p_Matrix = Map<MatrixXd>( (float*)this->data,p_dims[0], p_dims[1]);
     // --> Use copy constructor instead --> slower performance but higher memory management reliability
-    MatrixXi p_Matrix(Map<MatrixXi>( (int*)this->data(),dims[0], dims[1]));
+    MatrixXi p_Matrix(dims[0], dims[1]);
+    if(m_bConversionPending)
+        copy_from_file_data(FIFFT_INT, this->constData(), (char*)p_Matrix.data(), p_Matrix.size());
+    else
+        p_Matrix = Map<const MatrixXi>( (const int*)this->constData(),dims[0], dims[1]);
 
     return p_Matrix;
 }
@@ -995,7 +1082,11 @@ inline MatrixXf FiffTag::toFloatMatrix() const
     }
 
     // --> Use copy constructor instead --> slower performance but higher memory management reliability
-    MatrixXf p_Matrix((Map<MatrixXf>( (float*)this->data(),dims[0], dims[1])));
+    MatrixXf p_Matrix(dims[0], dims[1]);
+    if(m_bConversionPending)
+        copy_from_file_data(FIFFT_FLOAT, this->constData(), (char*)p_Matrix.data(), p_Matrix.size());
+    else
+        p_Matrix = Map<const MatrixXf>( (const float*)this->constData(),dims[0], dims[1]);
 
     return p_Matrix;
 }
@@ -1005,6 +1096,7 @@ inline MatrixXf FiffTag::toFloatMatrix() const
 
 inline SparseMatrix<double> FiffTag::toSparseFloatMatrix() const
 {
+    this->convertToNative();
     if(!this->isMatrix() || this->getType() != FIFFT_FLOAT || this->data() == NULL)
         return SparseMatrix<double>();//NULL;
 
@@ -1083,7 +1175,8 @@ inline SparseMatrix<double> FiffTag::toSparseFloatMatrix() const
     SparseMatrix<double> p_Matrix(nrow, ncol);
     p_Matrix.setFromTriplets(tripletList.begin(), tripletList.end());
 
-    p_Matrix.insert(nrow-1, ncol-1) = 0.0;
+    //insert() must not be used here, the last element may be one of the triplets
+    p_Matrix.coeffRef(nrow-1, ncol-1) += 0.0;
 
     return p_Matrix;
 }
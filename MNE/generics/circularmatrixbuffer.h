@@ -46,6 +46,7 @@
 #include "buffer.h"
 
 #include <typeinfo>
+#include <string.h>
 
 
 //*************************************************************************************************************
@@ -61,9 +62,10 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QAtomicInt>
 #include <QPair>
-#include <QSemaphore>
 #include <QSharedPointer>
+#include <QThread>
 
 
 //*************************************************************************************************************
@@ -83,9 +85,25 @@ namespace IOBuffer
 using namespace Eigen;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define CIRCULARMATRIXBUFFER_CACHE_LINE 64
+
+
 //=============================================================================================================
 /**
-* Circular Matrix buffer provides a template for thread safe circular matrix buffers.
+* Circular Matrix buffer provides a template for thread safe circular matrix buffers. It is a lock-free single
+* producer/single consumer ring of matrix slots: push and pop copy a whole matrix with one memcpy and only
+* touch an atomic read or write index, each of which sits on its own cache line. Push blocks while the
+* buffer is full, pop blocks while it is empty.
+*
+* Thread contract: push() must only be called by one producer thread and pop(), acquireView() and releaseView()
+* by one consumer thread at a time. pause(), clear(), releaseFromPop() and releaseFromPush() may be called from
+* any thread, e.g. while stopping a plugin. clear() only posts the drop of the pending matrices, the consumer
+* applies it before it reads the next matrix.
 *
 * @brief The circular matrix buffer
 */
@@ -131,7 +149,34 @@ public:
 
     //=========================================================================================================
     /**
-    * Clears the buffer.
+    * Pops the first matrix (first in first out) into a preallocated matrix. The matrix is only resized if it
+    * doesn't have the dimensions of the buffer.
+    *
+    * @param [out] matrix   the first matrix.
+    */
+    inline void pop(Matrix<_Tp, Dynamic, Dynamic>& matrix);
+
+    //=========================================================================================================
+    /**
+    * Borrows the first matrix without copying it. The returned view stays valid until releaseView() is
+    * called, which removes the matrix from the buffer. Returns a view of zeros if the buffer is paused or
+    * released from pop.
+    *
+    * @return view of the first matrix
+    */
+    inline Map<const Matrix<_Tp, Dynamic, Dynamic> > acquireView();
+
+    //=========================================================================================================
+    /**
+    * Removes the matrix borrowed by acquireView() from the buffer. Does nothing if acquireView() returned the
+    * view of zeros.
+    */
+    inline void releaseView();
+
+    //=========================================================================================================
+    /**
+    * Clears the buffer by dropping all matrices which were pushed but not popped yet, and discards releases
+    * no pop or push is waiting for. Can be called from any thread.
     */
     void clear();
 
@@ -176,23 +221,89 @@ public:
 private:
     //=========================================================================================================
     /**
-    * Returns the current circular index to the corresponding given index.
+    * Waits until a slot can be written. Returns false if the push was released.
+    */
+    inline bool waitForFreeSlot();
+
+    //=========================================================================================================
+    /**
+    * Waits until a slot can be read. Returns false if the pop was released.
+    */
+    inline bool waitForUsedSlot();
+
+    //=========================================================================================================
+    /**
+    * Drops the matrices which were pending when clear() was called. Called by the consumer only.
+    */
+    inline void applyClear();
+
+    //=========================================================================================================
+    /**
+    * Backs off while waiting: spins first, then yields, then sleeps up to a millisecond.
+    *
+    * @param [in, out] iRound   number of unsuccessful tries so far.
+    */
+    static inline void backOff(int& iRound);
+
+    //=========================================================================================================
+    /**
+    * Atomically sets or clears flags of a wait state.
+    *
+    * @param [in, out] iState   the wait state.
+    * @param [in] iSet          flags to set.
+    * @param [in] iClear        flags to clear.
+    */
+    static inline void updateState(QAtomicInt& iState, int iSet, int iClear);
+
+    //=========================================================================================================
+    /**
+    * Number of matrices between a read and a write index.
     *
-    * @param [in] index which should be mapped.
-    * @return the mapped index.
+    * @param [in] uiWrite       write index.
+    * @param [in] uiRead        read index.
     */
-    inline unsigned int mapIndex(int& index);
+    inline quint32 numUsed(quint32 uiWrite, quint32 uiRead) const;
+
+    //=========================================================================================================
+    /**
+    * Index which follows a read or write index.
+    *
+    * @param [in] uiIndex       read or write index.
+    */
+    inline quint32 next(quint32 uiIndex) const;
+
+    //=========================================================================================================
+    /**
+    * Start of a slot.
+    *
+    * @param [in] uiIndex       read or write index.
+    */
+    inline _Tp* slot(quint32 uiIndex) const;
+
+    enum WaitState {
+        Waiting = 1,    /**< A pop or push is waiting.*/
+        Released = 2    /**< The waiting pop or push has to return.*/
+    };
 
     unsigned int    m_uiMaxNumMatrices;         /**< Holds the maximal number of matrices.*/
     unsigned int    m_uiRows;                   /**< Holds the number rows.*/
     unsigned int    m_uiCols;                   /**< Holds the number cols.*/
-    unsigned int    m_uiMaxNumElements;         /**< Holds the maximal number of buffer elements.*/
-    _Tp*            m_pBuffer;                  /**< Holds the circular buffer.*/
-    int             m_iCurrentReadIndex;        /**< Holds the current read index.*/
-    int             m_iCurrentWriteIndex;       /**< Holds the current write index.*/
-    QSemaphore*     m_pFreeElements;            /**< Holds a semaphore which acquires free elements for thread safe writing. A semaphore is a generalization of a mutex.*/
-    QSemaphore*     m_pUsedElements;            /**< Holds a semaphore which acquires written semaphore for thread safe reading.*/
-    bool            m_bPause;
+    unsigned int    m_uiMatrixSize;             /**< Holds the number of elements of one matrix.*/
+    char*           m_pRawBuffer;               /**< Holds the allocated memory.*/
+    _Tp*            m_pBuffer;                  /**< Holds the circular buffer, aligned to a cache line.*/
+    _Tp*            m_pZeroBuffer;              /**< Holds a zero matrix for paused or released pops.*/
+    QAtomicInt      m_iPause;                   /**< Whether the buffer is paused.*/
+    bool            m_bViewBorrowed;            /**< Whether acquireView() borrowed a slot, used by the consumer only.*/
+
+    //The indices run modulo 2*m_uiMaxNumMatrices, so a full and an empty buffer can be told apart
+    char            m_padding0[CIRCULARMATRIXBUFFER_CACHE_LINE];
+    QAtomicInt      m_iWriteIndex;              /**< Next slot to write, written by the producer only.*/
+    char            m_padding1[CIRCULARMATRIXBUFFER_CACHE_LINE - sizeof(QAtomicInt)];
+    QAtomicInt      m_iReadIndex;               /**< Next slot to read, written by the consumer only.*/
+    char            m_padding2[CIRCULARMATRIXBUFFER_CACHE_LINE - sizeof(QAtomicInt)];
+    QAtomicInt      m_iPopState;                /**< WaitState flags of the consumer.*/
+    QAtomicInt      m_iPushState;               /**< WaitState flags of the producer.*/
+    QAtomicInt      m_iClearIndex;              /**< Write index at the last clear(), -1 if there is no pending clear.*/
 };
 
 
@@ -204,18 +315,23 @@ private:
 template<typename _Tp>
 CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, unsigned int uiRows, unsigned int uiCols)
 : Buffer(typeid(_Tp).name())
-, m_uiMaxNumMatrices(uiMaxNumMatrices)
+, m_uiMaxNumMatrices(uiMaxNumMatrices > 0 ? uiMaxNumMatrices : 1)
 , m_uiRows(uiRows)
 , m_uiCols(uiCols)
-, m_uiMaxNumElements(m_uiMaxNumMatrices*m_uiRows*m_uiCols)
-, m_pBuffer(new _Tp[m_uiMaxNumElements])
-, m_iCurrentReadIndex(-1)
-, m_iCurrentWriteIndex(-1)
-, m_pFreeElements(new QSemaphore(m_uiMaxNumElements))
-, m_pUsedElements(new QSemaphore(0))
-, m_bPause(false)
+, m_uiMatrixSize(m_uiRows*m_uiCols)
+, m_pRawBuffer(new char[(m_uiMaxNumMatrices+1)*m_uiMatrixSize*sizeof(_Tp) + CIRCULARMATRIXBUFFER_CACHE_LINE])
+, m_iPause(0)
+, m_bViewBorrowed(false)
+, m_iWriteIndex(0)
+, m_iReadIndex(0)
+, m_iPopState(0)
+, m_iPushState(0)
+, m_iClearIndex(-1)
 {
-
+    quintptr t_offset = (quintptr)m_pRawBuffer % CIRCULARMATRIXBUFFER_CACHE_LINE;
+    m_pBuffer = (_Tp*)(m_pRawBuffer + (t_offset > 0 ? CIRCULARMATRIXBUFFER_CACHE_LINE - t_offset : 0));
+    m_pZeroBuffer = m_pBuffer + m_uiMaxNumMatrices*m_uiMatrixSize;
+    memset(m_pZeroBuffer, 0, m_uiMatrixSize*sizeof(_Tp));
 }
 
 
@@ -224,9 +340,7 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 template<typename _Tp>
 CircularMatrixBuffer<_Tp>::~CircularMatrixBuffer()
 {
-    delete m_pFreeElements;
-    delete m_pUsedElements;
-    delete [] m_pBuffer;
+    delete [] m_pRawBuffer;
 }
 
 
@@ -235,15 +349,16 @@ CircularMatrixBuffer<_Tp>::~CircularMatrixBuffer()
 template<typename _Tp>
 inline void CircularMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>* pMatrix)
 {
-    if(!m_bPause)
+    if(!m_iPause.loadAcquire())
     {
-        unsigned int t_size = pMatrix->size();
-        if(t_size == m_uiRows*m_uiCols)
+        if((unsigned int)pMatrix->size() == m_uiMatrixSize)
         {
-            m_pFreeElements->acquire(t_size);
-            for(unsigned int i = 0; i < t_size; ++i)
-                m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pMatrix->data()[i];
-            m_pUsedElements->release(t_size);
+            if(!waitForFreeSlot())
+                return;
+
+            quint32 t_uiWrite = (quint32)m_iWriteIndex.load();
+            memcpy(slot(t_uiWrite), pMatrix->data(), m_uiMatrixSize*sizeof(_Tp));
+            m_iWriteIndex.storeRelease((int)next(t_uiWrite));
         }
     //    else
     //        printf("Error: Matrix not appended to CircularMatrixBuffer - wrong dimensions\n");
@@ -257,45 +372,199 @@ template<typename _Tp>
 inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::pop()
 {
     Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols);
+    pop(matrix);
+    return matrix;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::pop(Matrix<_Tp, Dynamic, Dynamic>& matrix)
+{
+    if((unsigned int)matrix.rows() != m_uiRows || (unsigned int)matrix.cols() != m_uiCols)
+        matrix.resize(m_uiRows, m_uiCols);
+
+    if(m_iPause.loadAcquire() || !waitForUsedSlot())
+    {
+        matrix.setZero();
+        return;
+    }
+
+    quint32 t_uiRead = (quint32)m_iReadIndex.load();
+    memcpy(matrix.data(), slot(t_uiRead), m_uiMatrixSize*sizeof(_Tp));
+    m_iReadIndex.storeRelease((int)next(t_uiRead));
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline Map<const Matrix<_Tp, Dynamic, Dynamic> > CircularMatrixBuffer<_Tp>::acquireView()
+{
+    m_bViewBorrowed = !m_iPause.loadAcquire() && waitForUsedSlot();
+    if(!m_bViewBorrowed)
+        return Map<const Matrix<_Tp, Dynamic, Dynamic> >(m_pZeroBuffer, m_uiRows, m_uiCols);
+
+    return Map<const Matrix<_Tp, Dynamic, Dynamic> >(slot((quint32)m_iReadIndex.load()), m_uiRows, m_uiCols);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::releaseView()
+{
+    //Only a borrowed slot is removed, a zero view must not drop a matrix which arrived in the meantime
+    if(!m_bViewBorrowed)
+        return;
+    m_bViewBorrowed = false;
+
+    quint32 t_uiRead = (quint32)m_iReadIndex.load();
+    if((quint32)m_iWriteIndex.loadAcquire() != t_uiRead)
+        m_iReadIndex.storeRelease((int)next(t_uiRead));
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool CircularMatrixBuffer<_Tp>::waitForFreeSlot()
+{
+    quint32 t_uiWrite = (quint32)m_iWriteIndex.load();
+    if(numUsed(t_uiWrite, (quint32)m_iReadIndex.loadAcquire()) < m_uiMaxNumMatrices)
+        return true;
+
+    updateState(m_iPushState, Waiting, 0);
 
-    if(!m_bPause)
+    int t_iRound = 0;
+    while(numUsed(t_uiWrite, (quint32)m_iReadIndex.loadAcquire()) >= m_uiMaxNumMatrices)
     {
-        m_pUsedElements->acquire(m_uiRows*m_uiCols);
-        for(quint32 i = 0; i < m_uiRows*m_uiCols; ++i)
-            matrix.data()[i] = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
-        m_pFreeElements->release(m_uiRows*m_uiCols);
+        int t_iState = m_iPushState.loadAcquire();
+        if((t_iState & Released) && m_iPushState.testAndSetOrdered(t_iState, 0))
+            return false;
+        backOff(t_iRound);
     }
+
+    updateState(m_iPushState, 0, Waiting);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool CircularMatrixBuffer<_Tp>::waitForUsedSlot()
+{
+    applyClear();
+
+    quint32 t_uiRead = (quint32)m_iReadIndex.load();
+    if((quint32)m_iWriteIndex.loadAcquire() != t_uiRead)
+        return true;
+
+    updateState(m_iPopState, Waiting, 0);
+
+    int t_iRound = 0;
+    while((quint32)m_iWriteIndex.loadAcquire() == t_uiRead)
+    {
+        int t_iState = m_iPopState.loadAcquire();
+        if((t_iState & Released) && m_iPopState.testAndSetOrdered(t_iState, 0))
+            return false;
+        backOff(t_iRound);
+    }
+
+    updateState(m_iPopState, 0, Waiting);
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::applyClear()
+{
+    int t_iClear = m_iClearIndex.fetchAndStoreOrdered(-1);
+    if(t_iClear < 0)
+        return;
+
+    //Skip the matrices pending at clear(), unless they were popped meanwhile
+    quint32 t_uiRead = (quint32)m_iReadIndex.load();
+    quint32 t_uiWrite = (quint32)m_iWriteIndex.loadAcquire();
+    if(numUsed((quint32)t_iClear, t_uiRead) <= numUsed(t_uiWrite, t_uiRead))
+        m_iReadIndex.storeRelease(t_iClear);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::backOff(int& iRound)
+{
+    ++iRound;
+    if(iRound < 64)
+        return;
+    else if(iRound < 128)
+        QThread::yieldCurrentThread();
     else
-        matrix.setZero();
+        QThread::usleep(iRound < 256 ? 50 : 1000);
+}
 
-    return matrix;
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void CircularMatrixBuffer<_Tp>::updateState(QAtomicInt& iState, int iSet, int iClear)
+{
+    int t_iState = iState.loadAcquire();
+    while(!iState.testAndSetOrdered(t_iState, (t_iState | iSet) & ~iClear))
+        t_iState = iState.loadAcquire();
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-inline unsigned int CircularMatrixBuffer<_Tp>::mapIndex(int& index)
+inline quint32 CircularMatrixBuffer<_Tp>::numUsed(quint32 uiWrite, quint32 uiRead) const
 {
-    int AuxIndex;
-    AuxIndex = ++index;
-    return index = AuxIndex % m_uiMaxNumElements;
+    return uiWrite >= uiRead ? uiWrite - uiRead : uiWrite + 2*m_uiMaxNumMatrices - uiRead;
+}
+
 
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline quint32 CircularMatrixBuffer<_Tp>::next(quint32 uiIndex) const
+{
+    return uiIndex + 1 < 2*m_uiMaxNumMatrices ? uiIndex + 1 : 0;
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-void CircularMatrixBuffer<_Tp>::clear()
+inline _Tp* CircularMatrixBuffer<_Tp>::slot(quint32 uiIndex) const
 {
-    delete m_pFreeElements;
-    m_pFreeElements = new QSemaphore(m_uiMaxNumElements);
-    delete m_pUsedElements;
-    m_pUsedElements = new QSemaphore(0);
+    return m_pBuffer + (uiIndex < m_uiMaxNumMatrices ? uiIndex : uiIndex - m_uiMaxNumMatrices)*m_uiMatrixSize;
+}
+
 
-    m_iCurrentReadIndex = -1;
-    m_iCurrentWriteIndex = -1;
+//*************************************************************************************************************
+
+template<typename _Tp>
+void CircularMatrixBuffer<_Tp>::clear()
+{
+    //Only the consumer moves the read index -> it drops the pending matrices before its next read
+    m_iClearIndex.storeRelease(m_iWriteIndex.loadAcquire());
+
+    //Discard releases no one waits for, otherwise the first pop or push after a restart would return at once.
+    //A release a waiting pop or push hasn't consumed yet is kept.
+    int t_iState = m_iPopState.loadAcquire();
+    while(!(t_iState & Waiting) && (t_iState & Released) && !m_iPopState.testAndSetOrdered(t_iState, t_iState & ~Released))
+        t_iState = m_iPopState.loadAcquire();
+
+    t_iState = m_iPushState.loadAcquire();
+    while(!(t_iState & Waiting) && (t_iState & Released) && !m_iPushState.testAndSetOrdered(t_iState, t_iState & ~Released))
+        t_iState = m_iPushState.loadAcquire();
 }
 
 
@@ -331,7 +600,7 @@ inline quint32 CircularMatrixBuffer<_Tp>::cols() const
 template<typename _Tp>
 inline void CircularMatrixBuffer<_Tp>::pause(bool bPause)
 {
-    m_bPause = bPause;
+    m_iPause.storeRelease(bPause ? 1 : 0);
 }
 
 
@@ -340,16 +609,10 @@ inline void CircularMatrixBuffer<_Tp>::pause(bool bPause)
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 {
-   if((uint)m_pUsedElements->available() < m_uiRows*m_uiCols)
+    //A pop only waits while the buffer is empty, it then returns a zero matrix
+    if((quint32)m_iWriteIndex.loadAcquire() == (quint32)m_iReadIndex.loadAcquire())
     {
-        //The last matrix which is to be popped from the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pUsedElements so that the pop function can leave the acquire statement in the pop function
-        m_pUsedElements->release(m_uiRows*m_uiCols);
-
+        updateState(m_iPopState, Released, 0);
         return true;
     }
 
@@ -362,16 +625,10 @@ inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPush()
 {
-    if((uint)m_pFreeElements->available() < m_uiRows*m_uiCols)
+    //A push only waits while the buffer is full, the pushed matrix is then dropped
+    if(numUsed((quint32)m_iWriteIndex.loadAcquire(), (quint32)m_iReadIndex.loadAcquire()) >= m_uiMaxNumMatrices)
     {
-        //The last matrix which is to be pushed to the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pFreeElements so that the push function can leave the acquire statement in the push function
-        m_pFreeElements->release(m_uiRows*m_uiCols);
-
+        updateState(m_iPushState, Released, 0);
         return true;
     }
 
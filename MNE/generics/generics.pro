@@ -77,6 +77,7 @@ SOURCES += \
 
 HEADERS += generics_global.h \
     circularmatrixbuffer.h \
+    circularmatrixbuffer_old.h \
     circularbuffer.h \
     observerpattern.h \
     commandpattern.h \
@@ -70,6 +70,8 @@ using namespace INVERSELIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bSinglePrecision(false)
+, m_bCombineXyz(false)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -80,12 +82,32 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bSinglePrecision(false)
+, m_bCombineXyz(false)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
 }
 
 
+//*************************************************************************************************************
+
+template<typename T>
+void MinimumNorm::combineXyz(const Matrix<T,Dynamic,Dynamic> &p_matSol, Matrix<T,Dynamic,Dynamic> &p_matOut)
+{
+    typedef Map<const Matrix<T,Dynamic,Dynamic>, 0, Stride<Dynamic,Dynamic> > StridedMap;
+
+    qint32 nsrc = p_matSol.rows()/3;
+    Stride<Dynamic,Dynamic> t_stride(p_matSol.rows(), 3);
+    StridedMap x(p_matSol.data(), nsrc, p_matSol.cols(), t_stride);
+    StridedMap y(p_matSol.data()+1, nsrc, p_matSol.cols(), t_stride);
+    StridedMap z(p_matSol.data()+2, nsrc, p_matSol.cols(), t_stride);
+
+    p_matOut.resize(nsrc, p_matSol.cols());
+    p_matOut = (x.array().square() + y.array().square() + z.array().square()).sqrt().matrix();
+}
+
+
 //*************************************************************************************************************
 
 MNESourceEstimate MinimumNorm::calculateInverse(const FiffEvoked &p_fiffEvoked, bool pick_normal)
@@ -193,44 +215,83 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
         return MNESourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
-
-    if (inv.source_ori == FIFFV_MNE_FREE_ORI)
+    //Apply imaging kernel, the noise normalization is already folded in
+    MatrixXd sol;
+    if(m_bSinglePrecision)
     {
-        printf("combining the current components...");
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
+        MatrixXf solF = m_matKernelApplyF * data.cast<float>();
+        if(m_bCombineXyz)
         {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.block(0,i,sol.rows(),1));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
+            MatrixXf sol1F;
+            combineXyz<float>(solF, sol1F);
+            sol = sol1F.cast<double>();
         }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
+        else
+            sol = solF.cast<double>();
+    }
+    else
+    {
+        if(m_bCombineXyz)
+        {
+            MatrixXd sol1 = m_matKernelApply * data;
+            combineXyz<double>(sol1, sol);
+        }
+        else
+            sol = m_matKernelApply * data;
     }
 
-    if (m_bdSPM)
+    //Results
+    return MNESourceEstimate(sol, m_vecVertices, tmin, tstep);
+}
+
+
+//*************************************************************************************************************
+
+bool MinimumNorm::calculateInverse(const MatrixXd &data, float tmin, float tstep, MNESourceEstimate &p_sourceEstimate)
+{
+    if(!inverseSetup)
     {
-        printf("(dSPM)...");
-        sol = inv.noisenorm*sol;
+        qWarning("Inverse not setup -> call doInverseSetup first!");
+        return false;
     }
-    else if (m_bsLORETA)
+
+    if(data.rows() != K.cols())
     {
-        printf("(sLORETA)...");
-        sol = inv.noisenorm*sol;
+        qWarning("Data dimension does not fit the inverse kernel.");
+        return false;
     }
-    printf("[done]\n");
 
-    //Results
-    VectorXi p_vecVertices(inv.src[0].vertno.size() + inv.src[1].vertno.size());
-    p_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+    if(m_bSinglePrecision)
+    {
+        m_matDataF = data.cast<float>();
+        if(m_bCombineXyz)
+        {
+            m_matSolF.noalias() = m_matKernelApplyF * m_matDataF;
+            combineXyz<float>(m_matSolF, m_matOutF);
+        }
+        else
+            m_matOutF.noalias() = m_matKernelApplyF * m_matDataF;
 
-//    VectorXi p_vecVertices();
-//    for(qint32 h = 0; h < inv.src.size(); ++h)
-//        t_qListVertices.push_back(inv.src[h].vertno);
+        p_sourceEstimate.data = m_matOutF.cast<double>();
+    }
+    else
+    {
+        if(m_bCombineXyz)
+        {
+            m_matSol.noalias() = m_matKernelApply * data;
+            combineXyz<double>(m_matSol, p_sourceEstimate.data);
+        }
+        else
+            p_sourceEstimate.data.noalias() = m_matKernelApply * data;
+    }
 
-    return MNESourceEstimate(sol, p_vecVertices, tmin, tstep);
+    if(p_sourceEstimate.vertices.size() != m_vecVertices.size())
+        p_sourceEstimate.vertices = m_vecVertices;
+    p_sourceEstimate.tmin = tmin;
+    p_sourceEstimate.tstep = tstep;
+    p_sourceEstimate.update_times();
 
+    return true;
 }
 
 
@@ -248,10 +309,47 @@ void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 
     std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
 
+    m_bCombineXyz = inv.source_ori == FIFFV_MNE_FREE_ORI && !pick_normal;
+
+    m_vecVertices.resize(inv.src[0].vertno.size() + inv.src[1].vertno.size());
+    m_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+
+    prepareApplyKernel();
+
     inverseSetup = true;
 }
 
 
+//*************************************************************************************************************
+
+void MinimumNorm::prepareApplyKernel()
+{
+    m_matKernelApply = K;
+
+    //
+    //   Fold the noise normalization into the kernel. The normalization is a non-negative diagonal with one
+    //   entry per source, so in the free orientation case it scales all three rows of a source, which commutes
+    //   with taking the norm of the xyz components.
+    //
+    if((m_bdSPM || m_bsLORETA) && noise_norm.rows() > 0)
+    {
+        qint32 t_iRowsPerSource = m_bCombineXyz ? 3 : 1;
+        if(noise_norm.rows() * t_iRowsPerSource != m_matKernelApply.rows())
+            qWarning("Noise normalization does not fit the kernel dimension -> not applied.");
+        else
+        {
+            for(qint32 i = 0; i < noise_norm.rows(); ++i)
+                m_matKernelApply.middleRows(i*t_iRowsPerSource, t_iRowsPerSource) *= noise_norm.coeff(i,i);
+        }
+    }
+
+    if(m_bSinglePrecision)
+        m_matKernelApplyF = m_matKernelApply.cast<float>();
+    else
+        m_matKernelApplyF.resize(0,0);
+}
+
+
 //*************************************************************************************************************
 
 const char* MinimumNorm::getName() const
@@ -319,3 +417,14 @@ void MinimumNorm::setRegularization(float lambda)
 {
     m_fLambda = lambda;
 }
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setSinglePrecision(bool p_bSinglePrecision)
+{
+    m_bSinglePrecision = p_bSinglePrecision;
+
+    if(inverseSetup)
+        prepareApplyKernel();
+}
@@ -127,6 +127,21 @@ public:
 
     virtual MNESourceEstimate calculateInverse(const MatrixXd &data, float tmin, float tstep) const;
 
+    //=========================================================================================================
+    /**
+    * Applies the inverse to a block of data and writes the result into a given source estimate. The noise
+    * normalization is folded into the kernel during doInverseSetup() and the buffers of p_sourceEstimate and of
+    * this object are reused, so repeated calls with equally sized blocks don't allocate.
+    *
+    * @param[in] data                   Data block (channels x samples), channels picked as the inverse operator.
+    * @param[in] tmin                   Time of the first sample.
+    * @param[in] tstep                  Time between two samples.
+    * @param[out] p_sourceEstimate      Source estimate to write the result to.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    bool calculateInverse(const MatrixXd &data, float tmin, float tstep, MNESourceEstimate &p_sourceEstimate);
+
     virtual void doInverseSetup(qint32 nave, bool pick_normal = false);
 
 
@@ -167,9 +182,34 @@ public:
     */
     void setRegularization(float lambda);
 
+    //=========================================================================================================
+    /**
+    * Applies the kernel in single precision. Halves the memory traffic of the kernel multiplication, which
+    * dominates the real-time application for large source spaces. The result is still stored in double.
+    *
+    * @param[in] p_bSinglePrecision     Whether to apply the kernel in single precision
+    */
+    void setSinglePrecision(bool p_bSinglePrecision);
+
     inline MatrixXd& getKernel();
 
 private:
+    //=========================================================================================================
+    /**
+    * Folds the noise normalization into the imaging kernel and prepares the single precision kernel.
+    */
+    void prepareApplyKernel();
+
+    //=========================================================================================================
+    /**
+    * Combines the xyz components of a free orientation solution to their norm in one strided pass.
+    *
+    * @param[in] p_matSol   Solution with three consecutive rows per source
+    * @param[out] p_matOut  Norm per source
+    */
+    template<typename T>
+    static void combineXyz(const Matrix<T,Dynamic,Dynamic> &p_matSol, Matrix<T,Dynamic,Dynamic> &p_matOut);
+
     MNEInverseOperator m_inverseOperator;   /**< The inverse operator */
     float m_fLambda;                        /**< Regularization parameter */
     QString m_sMethod;                      /**< Selected method */
@@ -183,6 +223,16 @@ private:
     Label label;                            /**< The corresponding labels */
     MatrixXd K;                             /**< Imaging kernel */
 
+    bool m_bSinglePrecision;                /**< Apply the kernel in single precision */
+    bool m_bCombineXyz;                     /**< Whether the xyz components of a source are combined to their norm */
+    MatrixXd m_matKernelApply;              /**< Imaging kernel with the noise normalization folded in */
+    MatrixXf m_matKernelApplyF;             /**< Single precision imaging kernel with the noise normalization folded in */
+    VectorXi m_vecVertices;                 /**< Vertices of the source estimate */
+    MatrixXd m_matSol;                      /**< Solution buffer before the xyz combination */
+    MatrixXf m_matDataF;                    /**< Single precision data buffer */
+    MatrixXf m_matSolF;                     /**< Single precision solution buffer before the xyz combination */
+    MatrixXf m_matOutF;                     /**< Single precision result buffer */
+
 };
 
 //*************************************************************************************************************
@@ -125,6 +125,10 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
         return p_SourceEstimate;
     }
 
+    //Pair index combinations of the Powell search
+    if(m_vecPairIdxCombinations.size() != m_iNumLeadFieldCombinations)
+        calcPairCombinations(m_iNumGridPoints, m_iNumLeadFieldCombinations, m_vecPairIdxCombinations);
+
     //Inits
     //Stop the time for benchmark purpose
     clock_t start, end;
@@ -239,8 +243,8 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                     //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
                     MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
 
-                    int idx1 = m_ppPairIdxCombinations[k]->x1;
-                    int idx2 = m_ppPairIdxCombinations[k]->x2;
+                    int idx1 = m_vecPairIdxCombinations[k].x1;
+                    int idx2 = m_vecPairIdxCombinations[k].x2;
 
                     RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
 
@@ -279,8 +283,8 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
             {
                 t_iMaxIdx_old = t_iMaxIdx;
                 //get positions in sparsed leadfield from index combinations;
-                t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-                t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+                t_iIdx1 = m_vecPairIdxCombinations[t_iMaxIdx].x1;
+                t_iIdx2 = m_vecPairIdxCombinations[t_iMaxIdx].x2;
             }
 
 
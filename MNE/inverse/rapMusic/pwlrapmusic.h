@@ -152,6 +152,8 @@ public:
 
     virtual const char* getName() const;
 
+private:
+    mutable QVector<Pair> m_vecPairIdxCombinations; /**< Index combination vector with grid pair indices, built on the first calculateInverse call. */
 };
 
 //*************************************************************************************************************
@@ -41,6 +41,12 @@
 
 #include <utils/mnemath.h>
 
+#include <Eigen/Eigenvalues>
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -65,9 +71,9 @@ RapMusic::RapMusic()
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
+, m_bPrunedSearch(true)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
 {
@@ -82,9 +88,9 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
+, m_bPrunedSearch(true)
 , m_iSamplesStcWindow(-1)
 , m_fStcOverlap(-1)
 {
@@ -97,8 +103,6 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 
 RapMusic::~RapMusic()
 {
-    if(m_ppPairIdxCombinations != NULL)
-        free(m_ppPairIdxCombinations);
 }
 
 
@@ -153,20 +157,9 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_ForwardSolution = p_pFwd;
 
-    //##### Calc lead field combination #####
-
-    std::cout << "Calculate gain matrix combinations. \n";
-
+    //The pair index table is O(N^2) and only needed by the Powell search, which builds it on demand
     m_iNumLeadFieldCombinations = MNEMath::nchoose2(m_iNumGridPoints+1);
 
-    m_ppPairIdxCombinations = (Pair **)malloc(m_iNumLeadFieldCombinations * sizeof(Pair *));
-
-    calcPairCombinations(m_iNumGridPoints, m_iNumLeadFieldCombinations, m_ppPairIdxCombinations);
-
-    std::cout << "Gain matrix combinations calculated. \n\n";
-
-    //##### Calc lead field combination end #####
-
     std::cout << "Number of grid points: " << m_iNumGridPoints << "\n\n";
 
     std::cout << "Number of combinated points: " << m_iNumLeadFieldCombinations << "\n\n";
@@ -469,54 +462,15 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         MatrixXT t_matU_B;
         useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
 
-        //Inits
-        VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
-        t_vecRoh.setZero();
-
         //subcorr benchmark
         //Stop the time
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
-
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
-
-
-//         if(r==0)
-//         {
-//             std::fstream filestr;
-//             std::stringstream filename;
-//             filename << "Roh_gold.txt";
-//
-//             filestr.open ( filename.str().c_str(), std::fstream::out);
-//             for(int i = 0; i < m_iNumLeadFieldCombinations; ++i)
-//             {
-//               filestr << t_vecRoh(i) << "\n";
-//             }
-//             filestr.close();
-//
-//             //exit(0);
-//         }
+        //Find the maximum of correlation over all pair combinations
+        int t_iIdx1 = 0;
+        int t_iIdx2 = 0;
+        double t_val_roh_k = searchMaxPair(t_matProj_LeadField, t_matU_B, t_iIdx1, t_iIdx2);//p_vecCor = ^roh_k
 
         //subcorr benchmark
         end_subcorr = clock();
@@ -524,17 +478,6 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
         std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
 
-        //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
-        double t_val_roh_k;
-
-        VectorXT::Index t_iMaxIdx;
-
-        t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
-
-        //get positions in sparsed leadfield from index combinations;
-        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
-
         // (Idx+1) because of MATLAB positions -> starting with 1 not with 0
         std::cout << "Iteration: " << r+1 << " of " << t_iMaxSearch
             << "; Correlation: " << t_val_roh_k<< "; Position (Idx+1): " << t_iIdx1+1 << " - " << t_iIdx2+1 <<"\n\n";
@@ -751,6 +694,208 @@ double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vecto
 }
 
 
+//*************************************************************************************************************
+
+double RapMusic::searchMaxPair(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, int &p_iIdx1, int &p_iIdx2) const
+{
+    const int t_iNumPoints = m_iNumGridPoints;
+
+    //
+    // Step 1: orthonormal basis Q_i of each projected grid point, rank reduced with the epsilon of getRank
+    //
+    MatrixXT t_matQ = MatrixXT::Zero(m_iNumChannels, 3*t_iNumPoints);
+    VectorXT t_vecMask = VectorXT::Zero(3*t_iNumPoints);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        Eigen::JacobiSVD<MatrixXT> t_svdG(p_matProj_LeadField.block(0, 3*i, m_iNumChannels, 3), Eigen::ComputeThinU);
+
+        for(int k = 0; k < 3; ++k)
+        {
+            if(t_svdG.singularValues()(k) > 0.00001)
+            {
+                t_matQ.col(3*i+k) = t_svdG.matrixU().col(k);
+                t_vecMask(3*i+k) = 1.0;
+            }
+        }
+    }
+
+    //
+    // Step 2: correlation of each basis with the signal subspace D = U_B^T * Q and the single point correlations
+    //
+    MatrixXT t_matD = p_matU_B.transpose() * t_matQ;
+
+    MatrixXT t_matN(3, 3*t_iNumPoints);
+    std::vector< std::pair<double, int> > t_vecSingleCor(t_iNumPoints);
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        t_matN.block(0, 3*i, 3, 3) = t_matD.middleCols(3*i, 3).transpose() * t_matD.middleCols(3*i, 3);
+        Eigen::SelfAdjointEigenSolver<Matrix3T> t_eigN(Matrix3T(t_matN.block(0, 3*i, 3, 3)), Eigen::EigenvaluesOnly);
+        t_vecSingleCor[i] = std::make_pair(sqrt(std::max(t_eigN.eigenvalues()(2), 0.0)), i);
+    }
+
+    //Sort the points by their single correlation, so the strongest pairs are visited first -> tight pruning
+    std::stable_sort(t_vecSingleCor.begin(), t_vecSingleCor.end(), std::greater< std::pair<double, int> >());
+
+    MatrixXT t_matQSorted(t_matQ.rows(), t_matQ.cols());
+    MatrixXT t_matDSorted(t_matD.rows(), t_matD.cols());
+    MatrixXT t_matNSorted(t_matN.rows(), t_matN.cols());
+    VectorXT t_vecMaskSorted(t_vecMask.size());
+    VectorXT t_vecCorSorted(t_iNumPoints);
+    for(int i = 0; i < t_iNumPoints; ++i)
+    {
+        int t_iIdx = t_vecSingleCor[i].second;
+        t_matQSorted.block(0, 3*i, t_matQ.rows(), 3) = t_matQ.block(0, 3*t_iIdx, t_matQ.rows(), 3);
+        t_matDSorted.block(0, 3*i, t_matD.rows(), 3) = t_matD.block(0, 3*t_iIdx, t_matD.rows(), 3);
+        t_matNSorted.block(0, 3*i, 3, 3) = t_matN.block(0, 3*t_iIdx, 3, 3);
+        t_vecMaskSorted.segment(3*i, 3) = t_vecMask.segment(3*t_iIdx, 3);
+        t_vecCorSorted(i) = t_vecSingleCor[i].first;
+    }
+
+    //
+    // Step 3: tiled pair search, the 3 x 3 blocks of a tile are calculated with two matrix products
+    //
+    const int t_iNumTiles = (t_iNumPoints + RAPMUSIC_TILE_POINTS - 1) / RAPMUSIC_TILE_POINTS;
+    const int t_iNumTilePairs = t_iNumTiles*(t_iNumTiles+1)/2;
+
+    //A pair contains the span of its single points -> the best single point is a valid start value
+    double t_dBestCor = t_vecCorSorted(0);
+    int t_iBest1 = t_vecSingleCor[0].second;
+    int t_iBest2 = t_vecSingleCor[0].second;
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+        double t_dLocalCor = -1.0;
+        int t_iLocal1 = 0;
+        int t_iLocal2 = 0;
+
+    #ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+        for(int k = 0; k < t_iNumTilePairs; ++k)
+        {
+            int t_iTileA = 0;
+            int t_iTileB = 0;
+            RapMusic::getPointPair(t_iNumTiles, k, t_iTileA, t_iTileB);
+
+            int t_iStartA = t_iTileA*RAPMUSIC_TILE_POINTS;
+            int t_iStartB = t_iTileB*RAPMUSIC_TILE_POINTS;
+            int t_iSizeA = std::min(RAPMUSIC_TILE_POINTS, t_iNumPoints - t_iStartA);
+            int t_iSizeB = std::min(RAPMUSIC_TILE_POINTS, t_iNumPoints - t_iStartB);
+
+            double t_dThreshold;
+            #ifdef _OPENMP
+            #pragma omp critical (rapmusic_best)
+            #endif
+            t_dThreshold = t_dBestCor;
+            if(t_dLocalCor > t_dThreshold)
+                t_dThreshold = t_dLocalCor;
+
+            MatrixXT t_matS = t_matQSorted.middleCols(3*t_iStartA, 3*t_iSizeA).transpose() * t_matQSorted.middleCols(3*t_iStartB, 3*t_iSizeB);
+            MatrixXT t_matR = t_matDSorted.middleCols(3*t_iStartA, 3*t_iSizeA).transpose() * t_matDSorted.middleCols(3*t_iStartB, 3*t_iSizeB);
+
+            for(int i = 0; i < t_iSizeA; ++i)
+            {
+                int t_iPoint1 = t_iStartA + i;
+                double t_dCor1 = t_vecCorSorted(t_iPoint1);
+
+                for(int j = (t_iTileA == t_iTileB) ? i+1 : 0; j < t_iSizeB; ++j)
+                {
+                    int t_iPoint2 = t_iStartB + j;
+                    double t_dCor2 = t_vecCorSorted(t_iPoint2);
+
+                    Matrix3T t_matSij = t_matS.block(3*i, 3*j, 3, 3);
+
+                    //Upper bound: ||U_B^T(a+b)|| <= sqrt(c_1^2+c_2^2) * ||a+b|| / sqrt(1-s), s >= cos of the smallest principal angle
+                    if(m_bPrunedSearch)
+                    {
+                        double t_dS = t_matSij.norm();
+                        if(t_dS < 1.0 && (t_dCor1*t_dCor1 + t_dCor2*t_dCor2) < t_dThreshold*t_dThreshold*(1.0 - t_dS))
+                            continue;
+                    }
+
+                    double t_dCor = RapMusic::subcorrPair(  t_matSij,
+                                                            t_matR.block(3*i, 3*j, 3, 3),
+                                                            t_matNSorted.block(0, 3*t_iPoint1, 3, 3),
+                                                            t_matNSorted.block(0, 3*t_iPoint2, 3, 3),
+                                                            Matrix3T(t_vecMaskSorted.segment(3*t_iPoint2, 3).asDiagonal()));
+
+                    if(t_dCor > t_dThreshold)
+                    {
+                        t_dThreshold = t_dCor;
+                        t_dLocalCor = t_dCor;
+                        t_iLocal1 = t_vecSingleCor[t_iPoint1].second;
+                        t_iLocal2 = t_vecSingleCor[t_iPoint2].second;
+                    }
+                }
+            }
+
+            #ifdef _OPENMP
+            #pragma omp critical (rapmusic_best)
+            #endif
+            {
+                if(t_dLocalCor > t_dBestCor)
+                {
+                    t_dBestCor = t_dLocalCor;
+                    t_iBest1 = t_iLocal1;
+                    t_iBest2 = t_iLocal2;
+                }
+            }
+        }
+    }
+
+    p_iIdx1 = std::min(t_iBest1, t_iBest2);
+    p_iIdx2 = std::max(t_iBest1, t_iBest2);
+
+    return t_dBestCor;
+}
+
+
+//*************************************************************************************************************
+
+double RapMusic::subcorrPair(   const Matrix3T& p_matS,
+                                const Matrix3T& p_matR,
+                                const Matrix3T& p_matN1,
+                                const Matrix3T& p_matN2,
+                                const Matrix3T& p_matI2)
+{
+    //Part of Q_2 orthogonal to Q_1: (Q_2 - Q_1*S) with Gram matrix E = Q_2^T*Q_2 - S^T*S
+    Matrix3T t_matE = p_matI2 - p_matS.transpose()*p_matS;
+
+    Eigen::SelfAdjointEigenSolver<Matrix3T> t_eigE(t_matE);
+
+    //X whitens the orthogonal part -> Q_2' = (Q_2 - Q_1*S)*X is orthonormal; directions inside span(Q_1) are dropped
+    Matrix3T t_matX = t_eigE.eigenvectors();
+    for(int k = 0; k < 3; ++k)
+    {
+        double t_dLambda = t_eigE.eigenvalues()(k);
+        if(t_dLambda > 1e-10)
+            t_matX.col(k) /= sqrt(t_dLambda);
+        else
+            t_matX.col(k).setZero();
+    }
+
+    //C^T*C of the correlation C = [Q_1 Q_2']^T * U_B, assembled out of the 3 x 3 blocks
+    Matrix3T t_matN1S = p_matN1*p_matS;
+
+    Matrix6T t_matCC;
+    t_matCC.block<3,3>(0,0) = p_matN1;
+    t_matCC.block<3,3>(0,3) = (p_matR - t_matN1S)*t_matX;
+    t_matCC.block<3,3>(3,0) = t_matCC.block<3,3>(0,3).transpose();
+    t_matCC.block<3,3>(3,3) = t_matX.transpose()*(p_matN2 - p_matS.transpose()*p_matR - p_matR.transpose()*p_matS + p_matS.transpose()*t_matN1S)*t_matX;
+
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigCC(t_matCC, Eigen::EigenvaluesOnly);
+
+    //Step 3: the largest singular value of C is the correlation of the first principal components
+    return sqrt(std::max(t_eigCC.eigenvalues()(5), 0.0));
+}
+
+
 //*************************************************************************************************************
 
 void RapMusic::calcA_k_1(   const MatrixX6T& p_matG_k_1,
@@ -814,8 +959,11 @@ void RapMusic::calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj)
 
 void RapMusic::calcPairCombinations(    const int p_iNumPoints,
                                         const int p_iNumCombinations,
-                                        Pair** p_ppPairIdxCombinations) const
+                                        QVector<Pair>& p_vecPairIdxCombinations) const
 {
+    p_vecPairIdxCombinations.resize(p_iNumCombinations);
+    Pair* t_pPairIdxCombinations = p_vecPairIdxCombinations.data();
+
     int idx1 = 0;
     int idx2 = 0;
 
@@ -831,11 +979,8 @@ void RapMusic::calcPairCombinations(    const int p_iNumPoints,
         {
             RapMusic::getPointPair(p_iNumPoints, i, idx1, idx2);
 
-            Pair* t_pairCombination = new Pair();
-            t_pairCombination->x1 = idx1;
-            t_pairCombination->x2 = idx2;
-
-            p_ppPairIdxCombinations[i] = t_pairCombination;
+            t_pPairIdxCombinations[i].x1 = idx1;
+            t_pPairIdxCombinations[i].x2 = idx2;
         }
     }
 }
@@ -907,3 +1052,11 @@ void RapMusic::setStcAttr(int p_iSampStcWin, float p_fStcOverlap)
     m_iSamplesStcWindow = p_iSampStcWin;
     m_fStcOverlap = p_fStcOverlap;
 }
+
+
+//*************************************************************************************************************
+
+void RapMusic::setPrunedSearch(bool p_bPruned)
+{
+    m_bPrunedSearch = p_bPruned;
+}
@@ -87,6 +87,8 @@ using namespace MNELIB;
 #define NOT_TRANSPOSED   0  /**< Defines NOT_TRANSPOSED */
 #define IS_TRANSPOSED   1   /**< Defines IS_TRANSPOSED */
 
+#define RAPMUSIC_TILE_POINTS    64  /**< Number of grid points per side of a pair search tile */
+
 
 //=============================================================================================================
 /**
@@ -129,6 +131,8 @@ public:
                                                                              1> as VectorXT type. */
     typedef Eigen::Matrix<double, 6, 1> Vector6T;                            /**< Defines Eigen::Matrix<T, 6, 1>
                                                                              as Vector6T type. */
+    typedef Eigen::Matrix<double, 3, 3> Matrix3T;                            /**< Defines Eigen::Matrix<T, 3, 3>
+                                                                             as Matrix3T type. */
 
 
     //=========================================================================================================
@@ -183,6 +187,16 @@ public:
     */
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
+    //=========================================================================================================
+    /**
+    * Enables or disables the pruning of the pair search. When enabled, pairs whose correlation is bounded
+    * by their single point correlations below the current maximum are skipped. The result is the same as
+    * for the exhaustive search.
+    *
+    * @param[in] p_bPruned      True to skip bounded out pairs (default), false for the exhaustive search.
+    */
+    void setPrunedSearch(bool p_bPruned);
+
 protected:
     //=========================================================================================================
     /**
@@ -228,6 +242,40 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1);
 
+    //=========================================================================================================
+    /**
+    * Searches the grid point pair with the maximal subspace correlation. Each projected grid point is
+    * reduced once to an orthonormal basis Q_i and its correlation matrix D_i = U_B^T * Q_i. The pair
+    * correlations are then evaluated out of the 3 x 3 blocks Q_i^T * Q_j and D_i^T * D_j, which are
+    * computed tile by tile with matrix products.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field (m x 3*grid points).
+    * @param[in] p_matU_B       The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_iIdx1       Index of the first grid point of the best correlated pair.
+    * @param[out] p_iIdx2       Index of the second grid point of the best correlated pair (p_iIdx2 >= p_iIdx1).
+    * @return   The maximal subspace correlation.
+    */
+    double searchMaxPair(const MatrixXT& p_matProj_LeadField, const MatrixXT& p_matU_B, int &p_iIdx1, int &p_iIdx2) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a grid point pair out of the 3 x 3 blocks of the orthonormal point
+    * bases Q_1, Q_2 and their correlations D_1, D_2 with U_B. Q_2 is orthogonalized against Q_1, so only a
+    * 6 x 6 eigenvalue problem remains.
+    *
+    * @param[in] p_matS         Q_1^T * Q_2.
+    * @param[in] p_matR         D_1^T * D_2.
+    * @param[in] p_matN1        D_1^T * D_1.
+    * @param[in] p_matN2        D_2^T * D_2.
+    * @param[in] p_matI2        Q_2^T * Q_2 (identity for a full rank point, zero diagonal for dropped columns).
+    * @return   The maximal correlation c_1 of the pair.
+    */
+    static double subcorrPair(  const Matrix3T& p_matS,
+                                const Matrix3T& p_matR,
+                                const Matrix3T& p_matN1,
+                                const Matrix3T& p_matN2,
+                                const Matrix3T& p_matI2);
+
     //=========================================================================================================
     /**
     * Calculates the accumulated manifold vectors A_{k1}
@@ -259,13 +307,13 @@ protected:
     *
     * @param[in] p_iNumPoints   The number of Lead Field points -> for dimension check
     * @param[in] p_iNumCombinations The number of pair index combinations.
-    * @param[out] p_ppPairIdxCombinations   The destination which contains pointer to pointer of index
-    *                                       combinations of Lead Field indices -> Number of pointers =
-    *                                       Combination (number of grid points over 2 = Num + 1 C 2)
+    * @param[out] p_vecPairIdxCombinations  The destination which contains the index combinations of Lead Field
+    *                                       indices -> Number of pairs = Combination (number of grid points
+    *                                       over 2 = Num + 1 C 2)
     */
     void calcPairCombinations(  const int p_iNumPoints,
                                 const int p_iNumCombinations,
-                                Pair** p_ppPairIdxCombinations) const;
+                                QVector<Pair>& p_vecPairIdxCombinations) const;
 
     //=========================================================================================================
     /**
@@ -324,12 +372,12 @@ protected:
     int m_iNumChannels;                 /**< Number of channels */
     int m_iNumLeadFieldCombinations;    /**< Number of Lead Filed combinations (grid points + 1 over 2)*/
 
-    Pair** m_ppPairIdxCombinations; /**< Index combination vector with grid pair indices. */
-
     int m_iMaxNumThreads;   /**< Number of available CPU threads. */
 
     bool m_bIsInit; /**< Wether the algorithm is initialized. */
 
+    bool m_bPrunedSearch;   /**< Wether pairs bounded out by their single point correlations are skipped. */
+
     //Stc stuff
     int m_iSamplesStcWindow;    /**< Number of samples per localization window */
     float m_fStcOverlap;        /**< Percentage of localization window overlap */
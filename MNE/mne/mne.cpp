@@ -96,7 +96,8 @@ bool MNE::read_events(QIODevice &p_IODevice, MatrixXi& eventlist)
     }
 
     qint32 k, nelem;
-    fiff_int_t kind, pos;
+    fiff_int_t kind;
+    fiff_long_t pos;
     FiffTag::SPtr t_pTag;
     quint32* serial_eventlist_uint = NULL;
     qint32* serial_eventlist_int = NULL;
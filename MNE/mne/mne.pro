@@ -94,6 +94,7 @@ SOURCES += \
     mne_epoch_data.cpp \
     mne_epoch_data_list.cpp \
     mne_cluster_info.cpp \
+    mne_cluster_cache.cpp \
     mne_surface.cpp \
     mne_corsourceestimate.cpp\
     mne_bem.cpp\
@@ -110,6 +111,7 @@ HEADERS += \
     mne_epoch_data.h \
     mne_epoch_data_list.h \
     mne_cluster_info.h \
+    mne_cluster_cache.h \
     mne_surface.h \
     mne_corsourceestimate.h\
     mne_bem.h\
@@ -0,0 +1,413 @@
+//=============================================================================================================
+/**
+* @file     mne_cluster_cache.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEClusterCache class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_cluster_cache.h"
+
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_dir_tree.h>
+#include <fiff/fiff_tag.h>
+#include <fiff/fiff_constants.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MNEClusterCache::MNEClusterCache(const QString& p_sCacheDir)
+: m_sCacheDir(p_sCacheDir)
+{
+}
+
+
+//*************************************************************************************************************
+
+QString MNEClusterCache::key(const MatrixXd& p_matData, const MNESourceSpace& p_src, const AnnotationSet& p_AnnotationSet, qint32 p_iClusterSize, const QString& p_sMethod, const FiffCov& p_noiseCov, const FiffInfo& p_info)
+{
+    QCryptographicHash t_hash(QCryptographicHash::Sha1);
+
+    //Bump the version whenever the clustering itself (e.g. the k-means start) changes
+    t_hash.addData("MNEClusterCache 1; kmeans plus 5");
+    t_hash.addData(p_sMethod.toUtf8());
+    t_hash.addData((const char*)&p_iClusterSize, sizeof(p_iClusterSize));
+
+    addMatrix(t_hash, p_matData);
+
+    for(qint32 h = 0; h < p_src.size(); ++h)
+    {
+        addMatrix(t_hash, p_src[h].vertno);
+        addMatrix(t_hash, p_src[h].rr);
+    }
+
+    for(qint32 h = 0; h < p_AnnotationSet.size(); ++h)
+    {
+        addMatrix(t_hash, p_AnnotationSet[h].getLabelIds());
+        addMatrix(t_hash, p_AnnotationSet[h].getColortable().table);
+        t_hash.addData(p_AnnotationSet[h].getColortable().struct_names.join("\n").toUtf8());
+    }
+
+    //The whitener is only applied if both, the noise covariance and the measurement info are given
+    if(!p_noiseCov.isEmpty() && !p_info.isEmpty())
+    {
+        t_hash.addData("whitened");
+        addMatrix(t_hash, p_noiseCov.data);
+        t_hash.addData(p_noiseCov.names.join("\n").toUtf8());
+        t_hash.addData(p_noiseCov.bads.join("\n").toUtf8());
+        t_hash.addData(p_info.ch_names.join("\n").toUtf8());
+        t_hash.addData(p_info.bads.join("\n").toUtf8());
+        for(qint32 i = 0; i < p_info.projs.size(); ++i)
+        {
+            t_hash.addData(p_info.projs[i].active ? "active" : "inactive");
+            addMatrix(t_hash, p_info.projs[i].data->data);
+            t_hash.addData(p_info.projs[i].data->col_names.join("\n").toUtf8());
+        }
+    }
+
+    return QString(t_hash.result().toHex());
+}
+
+
+//*************************************************************************************************************
+
+QString MNEClusterCache::fileName(const QString& p_sKey) const
+{
+    return QDir(m_sCacheDir).filePath(p_sKey + "-clu.fif");
+}
+
+
+//*************************************************************************************************************
+
+bool MNEClusterCache::read(const QString& p_sKey, MatrixXd& p_matData, QList<MNEClusterInfo>& p_qListClusterInfo, MatrixXd& p_D) const
+{
+    QFile t_file(fileName(p_sKey));
+    if(!t_file.exists())
+        return false;
+
+    FiffStream::SPtr t_pStream(new FiffStream(&t_file));
+    FiffDirTree t_Tree;
+    QList<FiffDirEntry> t_Dir;
+
+    if(!t_pStream->open(t_Tree, t_Dir))
+        return false;
+
+    QList<FiffDirTree> t_qListCache = t_Tree.dir_tree_find(FIFFB_MNE_CLUSTER_CACHE);
+    if(t_qListCache.size() == 0)
+    {
+        printf("No cluster cache entry in %s\n", t_pStream->streamName().toUtf8().constData());
+        return false;
+    }
+    FiffDirTree* t_pCache = &t_qListCache[0];
+
+    //
+    //   The key guards against renamed or truncated entries
+    //
+    FiffTag::SPtr t_pTag;
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_CACHE_KEY, t_pTag) || t_pTag->toString() != p_sKey)
+    {
+        printf("Cluster cache entry %s doesn't match its key\n", t_pStream->streamName().toUtf8().constData());
+        return false;
+    }
+
+    //
+    //   Clustered data
+    //
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_NROW, t_pTag))
+        return false;
+    qint32 t_iRows = *t_pTag->toInt();
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_NCOL, t_pTag))
+        return false;
+    qint32 t_iCols = *t_pTag->toInt();
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_DATA, t_pTag) || !t_pTag->toDouble() || t_pTag->size()/8 != t_iRows*t_iCols)
+        return false;
+    MatrixXd t_matData = Map<MatrixXd>(t_pTag->toDouble(), t_iRows, t_iCols);
+
+    //
+    //   Cluster operator
+    //   (entries written by older versions lack the dimension tag and are recomputed)
+    //
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_OPERATOR_DIM, t_pTag) || t_pTag->size()/4 != 2)
+        return false;
+    MatrixXd t_D = MatrixXd::Zero(t_pTag->toInt()[0], t_pTag->toInt()[1]);
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_OPERATOR_ROWS, t_pTag))
+        return false;
+    VectorXi t_vecRows = Map<VectorXi>(t_pTag->toInt(), t_pTag->size()/4);
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_OPERATOR_COLS, t_pTag) || t_pTag->size()/4 != t_vecRows.size())
+        return false;
+    VectorXi t_vecCols = Map<VectorXi>(t_pTag->toInt(), t_vecRows.size());
+    if(!t_pCache->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_OPERATOR, t_pTag) || t_pTag->size()/8 != t_vecRows.size() || (t_vecRows.size() > 0 && !t_pTag->toDouble()))
+        return false;
+    for(qint32 i = 0; i < t_vecRows.size(); ++i)
+    {
+        if(t_vecRows[i] < 0 || t_vecRows[i] >= t_D.rows() || t_vecCols[i] < 0 || t_vecCols[i] >= t_D.cols())
+            return false;
+        t_D(t_vecRows[i], t_vecCols[i]) = t_pTag->toDouble()[i];
+    }
+
+    //
+    //   Cluster information of each hemisphere
+    //   (stored in the order of the hemispheres)
+    //
+    QList<FiffDirTree> t_qListInfo = t_pCache->dir_tree_find(FIFFB_MNE_CLUSTER_INFO);
+    QList<MNEClusterInfo> t_qListClusterInfo;
+    for(qint32 h = 0; h < t_qListInfo.size(); ++h)
+    {
+        MNEClusterInfo t_clusterInfo;
+        FiffDirTree* t_pInfo = &t_qListInfo[h];
+
+        if(!t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_NVERT, t_pTag))
+            return false;
+        VectorXi t_vecNVert = Map<VectorXi>(t_pTag->toInt(), t_pTag->size()/4);
+        qint32 t_iNumClust = t_vecNVert.size();
+        qint32 t_iNumVert = t_vecNVert.sum();
+
+        if(!t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_VERTNOS, t_pTag) || t_pTag->size()/4 != t_iNumVert)
+            return false;
+        VectorXi t_vecVertnos = Map<VectorXi>(t_pTag->toInt(), t_iNumVert);
+
+        VectorXd t_vecDistances;
+        if(t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_DISTANCES, t_pTag) && t_pTag->size()/8 == t_iNumVert)
+            t_vecDistances = Map<VectorXd>(t_pTag->toDouble(), t_iNumVert);
+
+        MatrixXf t_matSourceRR;
+        if(t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_SOURCE_RR, t_pTag))
+            t_matSourceRR = t_pTag->toFloatMatrix();
+
+        qint32 t_iOffset = 0;
+        for(qint32 i = 0; i < t_iNumClust; ++i)
+        {
+            t_clusterInfo.clusterVertnos.append(t_vecVertnos.segment(t_iOffset, t_vecNVert[i]));
+            if(t_vecDistances.size() == t_iNumVert)
+                t_clusterInfo.clusterDistances.append(t_vecDistances.segment(t_iOffset, t_vecNVert[i]));
+            if(t_matSourceRR.rows() == t_iNumVert)
+                t_clusterInfo.clusterSource_rr.append(t_matSourceRR.block(t_iOffset, 0, t_vecNVert[i], 3));
+            t_iOffset += t_vecNVert[i];
+        }
+
+        if(t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_LABEL_IDS, t_pTag))
+            for(qint32 i = 0; i < t_pTag->size()/4; ++i)
+                t_clusterInfo.clusterLabelIds.append(t_pTag->toInt()[i]);
+
+        if(t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_LABEL_NAMES, t_pTag))
+            t_clusterInfo.clusterLabelNames = FiffStream::split_name_list(t_pTag->toString());
+
+        if(t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_CENTROID_VERTNO, t_pTag))
+            for(qint32 i = 0; i < t_pTag->size()/4; ++i)
+                t_clusterInfo.centroidVertno.append(t_pTag->toInt()[i]);
+
+        if(t_pInfo->find_tag(t_pStream.data(), FIFF_MNE_CLUSTER_CENTROID_RR, t_pTag))
+        {
+            MatrixXf t_matCentroidRR = t_pTag->toFloatMatrix();
+            for(qint32 i = 0; i < t_matCentroidRR.rows(); ++i)
+                t_clusterInfo.centroidSource_rr.append(t_matCentroidRR.row(i).transpose());
+        }
+
+        t_qListClusterInfo.append(t_clusterInfo);
+    }
+
+    p_matData = t_matData;
+    p_qListClusterInfo = t_qListClusterInfo;
+    p_D = t_D;
+
+    printf("Read clustering from cache %s.\n", t_pStream->streamName().toUtf8().constData());
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEClusterCache::write(const QString& p_sKey, const MatrixXd& p_matData, const QList<MNEClusterInfo>& p_qListClusterInfo, const MatrixXd& p_D) const
+{
+    if(!QDir().mkpath(m_sCacheDir))
+    {
+        printf("Could not create cluster cache directory %s\n", m_sCacheDir.toUtf8().constData());
+        return false;
+    }
+
+    QString t_sFileName = fileName(p_sKey);
+    QSaveFile t_file(t_sFileName);
+
+    FiffStream::SPtr t_pStream = FiffStream::start_file(t_file);
+    if(!t_pStream)
+        return false;
+
+    t_pStream->start_block(FIFFB_MNE_CLUSTER_CACHE);
+
+    t_pStream->write_string(FIFF_MNE_CLUSTER_CACHE_KEY, p_sKey);
+
+    //
+    //   Clustered data
+    //
+    fiff_int_t t_iRows = p_matData.rows();
+    fiff_int_t t_iCols = p_matData.cols();
+    t_pStream->write_int(FIFF_MNE_NROW, &t_iRows);
+    t_pStream->write_int(FIFF_MNE_NCOL, &t_iCols);
+    t_pStream->write_double(FIFF_MNE_CLUSTER_DATA, p_matData.data(), p_matData.size());
+
+    //
+    //   Cluster operator
+    //   (non-zero entries in double precision, so a cache hit returns the same D as the clustering)
+    //
+    QVector<fiff_int_t> t_qVecRows, t_qVecCols;
+    QVector<double> t_qVecValues;
+    for(qint32 j = 0; j < p_D.cols(); ++j)
+    {
+        for(qint32 i = 0; i < p_D.rows(); ++i)
+        {
+            if(p_D(i,j) != 0.0)
+            {
+                t_qVecRows.append(i);
+                t_qVecCols.append(j);
+                t_qVecValues.append(p_D(i,j));
+            }
+        }
+    }
+    fiff_int_t t_iDim[2] = {(fiff_int_t)p_D.rows(), (fiff_int_t)p_D.cols()};
+    t_pStream->write_int(FIFF_MNE_CLUSTER_OPERATOR_DIM, t_iDim, 2);
+    t_pStream->write_int(FIFF_MNE_CLUSTER_OPERATOR_ROWS, t_qVecRows.data(), t_qVecRows.size());
+    t_pStream->write_int(FIFF_MNE_CLUSTER_OPERATOR_COLS, t_qVecCols.data(), t_qVecCols.size());
+    t_pStream->write_double(FIFF_MNE_CLUSTER_OPERATOR, t_qVecValues.data(), t_qVecValues.size());
+
+    //
+    //   Cluster information of each hemisphere
+    //
+    for(qint32 h = 0; h < p_qListClusterInfo.size(); ++h)
+    {
+        const MNEClusterInfo& t_clusterInfo = p_qListClusterInfo[h];
+        qint32 t_iNumClust = t_clusterInfo.clusterVertnos.size();
+
+        t_pStream->start_block(FIFFB_MNE_CLUSTER_INFO);
+
+        VectorXi t_vecNVert(t_iNumClust);
+        for(qint32 i = 0; i < t_iNumClust; ++i)
+            t_vecNVert[i] = t_clusterInfo.clusterVertnos[i].size();
+        qint32 t_iNumVert = t_vecNVert.sum();
+
+        VectorXi t_vecVertnos(t_iNumVert);
+        VectorXd t_vecDistances(t_iNumVert);
+        MatrixXf t_matSourceRR(t_iNumVert, 3);
+        bool t_bDistances = t_clusterInfo.clusterDistances.size() == t_iNumClust;
+        bool t_bSourceRR = t_clusterInfo.clusterSource_rr.size() == t_iNumClust;
+
+        qint32 t_iOffset = 0;
+        for(qint32 i = 0; i < t_iNumClust; ++i)
+        {
+            t_vecVertnos.segment(t_iOffset, t_vecNVert[i]) = t_clusterInfo.clusterVertnos[i];
+            if(t_bDistances)
+                t_vecDistances.segment(t_iOffset, t_vecNVert[i]) = t_clusterInfo.clusterDistances[i];
+            if(t_bSourceRR)
+                t_matSourceRR.block(t_iOffset, 0, t_vecNVert[i], 3) = t_clusterInfo.clusterSource_rr[i];
+            t_iOffset += t_vecNVert[i];
+        }
+
+        t_pStream->write_int(FIFF_MNE_CLUSTER_NVERT, t_vecNVert.data(), t_vecNVert.size());
+        t_pStream->write_int(FIFF_MNE_CLUSTER_VERTNOS, t_vecVertnos.data(), t_vecVertnos.size());
+        if(t_bDistances)
+            t_pStream->write_double(FIFF_MNE_CLUSTER_DISTANCES, t_vecDistances.data(), t_vecDistances.size());
+        if(t_bSourceRR)
+            t_pStream->write_float_matrix(FIFF_MNE_CLUSTER_SOURCE_RR, t_matSourceRR);
+
+        if(!t_clusterInfo.clusterLabelIds.isEmpty())
+        {
+            QVector<qint32> t_qVecLabelIds = t_clusterInfo.clusterLabelIds.toVector();
+            t_pStream->write_int(FIFF_MNE_CLUSTER_LABEL_IDS, t_qVecLabelIds.data(), t_qVecLabelIds.size());
+        }
+        if(!t_clusterInfo.clusterLabelNames.isEmpty())
+            t_pStream->write_name_list(FIFF_MNE_CLUSTER_LABEL_NAMES, QStringList(t_clusterInfo.clusterLabelNames));
+
+        if(!t_clusterInfo.centroidVertno.isEmpty())
+        {
+            QVector<qint32> t_qVecCentroidVertno = t_clusterInfo.centroidVertno.toVector();
+            t_pStream->write_int(FIFF_MNE_CLUSTER_CENTROID_VERTNO, t_qVecCentroidVertno.data(), t_qVecCentroidVertno.size());
+        }
+        if(!t_clusterInfo.centroidSource_rr.isEmpty())
+        {
+            MatrixXf t_matCentroidRR(t_clusterInfo.centroidSource_rr.size(), 3);
+            for(qint32 i = 0; i < t_clusterInfo.centroidSource_rr.size(); ++i)
+                t_matCentroidRR.row(i) = t_clusterInfo.centroidSource_rr[i].transpose();
+            t_pStream->write_float_matrix(FIFF_MNE_CLUSTER_CENTROID_RR, t_matCentroidRR);
+        }
+
+        t_pStream->end_block(FIFFB_MNE_CLUSTER_INFO);
+    }
+
+    t_pStream->end_block(FIFFB_MNE_CLUSTER_CACHE);
+    t_pStream->end_file();
+
+    //
+    //   Publish the complete entry, the save file replaces the entry only when everything was written
+    //
+    if(t_pStream->status() != QDataStream::Ok || !t_file.commit())
+    {
+        printf("Could not write cluster cache entry %s\n", t_sFileName.toUtf8().constData());
+        return false;
+    }
+
+    printf("Wrote clustering to cache %s.\n", t_sFileName.toUtf8().constData());
+
+    return true;
+}
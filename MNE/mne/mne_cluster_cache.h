@@ -0,0 +1,210 @@
+//=============================================================================================================
+/**
+* @file     mne_cluster_cache.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    MNEClusterCache class declaration.
+*
+*/
+
+#ifndef MNE_CLUSTER_CACHE_H
+#define MNE_CLUSTER_CACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "mne_global.h"
+#include "mne_sourcespace.h"
+#include "mne_cluster_info.h"
+
+#include <fiff/fiff_cov.h>
+#include <fiff/fiff_info.h>
+#include <fs/annotationset.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QList>
+#include <QString>
+#include <QCryptographicHash>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNELIB
+//=============================================================================================================
+
+namespace MNELIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace FIFFLIB;
+using namespace FSLIB;
+
+
+//=============================================================================================================
+/**
+* On-disk cache of clustering results (MNEForwardSolution::cluster_forward_solution and
+* MNEInverseOperator::cluster_kernel). Every result is stored in its own FIFF file, named after a hash of
+* everything the clustering depends on: the gain matrix or kernel, the source space, the annotation, the cluster
+* size, the distance measure and the whitening inputs. A changed input therefore never hits a stale entry.
+*
+* @brief On-disk cache of clustered forward solutions and kernels
+*/
+class MNESHARED_EXPORT MNEClusterCache
+{
+public:
+    typedef QSharedPointer<MNEClusterCache> SPtr;            /**< Shared pointer type for MNEClusterCache. */
+    typedef QSharedPointer<const MNEClusterCache> ConstSPtr; /**< Const shared pointer type for MNEClusterCache. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the cache.
+    *
+    * @param[in] p_sCacheDir    Directory of the cache files. It's created on the first write.
+    */
+    explicit MNEClusterCache(const QString& p_sCacheDir);
+
+    //=========================================================================================================
+    /**
+    * Computes the cache key of a clustering.
+    *
+    * @param[in] p_matData          Gain matrix or kernel which is clustered.
+    * @param[in] p_src              Source space of the gain matrix or kernel.
+    * @param[in] p_AnnotationSet    Annotation set which defines the clustered regions.
+    * @param[in] p_iClusterSize     Maximal cluster size.
+    * @param[in] p_sMethod          Distance measure of the clustering.
+    * @param[in] p_noiseCov         Noise covariance used for whitening, empty if not whitened.
+    * @param[in] p_info             Measurement info used for whitening, empty if not whitened.
+    *
+    * @return the key (hex encoded SHA-1 hash).
+    */
+    static QString key(const MatrixXd& p_matData, const MNESourceSpace& p_src, const AnnotationSet& p_AnnotationSet, qint32 p_iClusterSize, const QString& p_sMethod, const FiffCov& p_noiseCov, const FiffInfo& p_info);
+
+    //=========================================================================================================
+    /**
+    * Returns the file which holds the entry of a key.
+    *
+    * @param[in] p_sKey     The cache key.
+    *
+    * @return the file name.
+    */
+    QString fileName(const QString& p_sKey) const;
+
+    //=========================================================================================================
+    /**
+    * Reads a clustering result.
+    *
+    * @param[in] p_sKey                 The cache key.
+    * @param[out] p_matData             Clustered gain matrix or kernel.
+    * @param[out] p_qListClusterInfo    Cluster information of each hemisphere.
+    * @param[out] p_D                   Cluster operator (sources x clusters).
+    *
+    * @return true if the entry exists and could be read, false otherwise.
+    */
+    bool read(const QString& p_sKey, MatrixXd& p_matData, QList<MNEClusterInfo>& p_qListClusterInfo, MatrixXd& p_D) const;
+
+    //=========================================================================================================
+    /**
+    * Writes a clustering result. The file is written under a temporary name and renamed when complete, so a
+    * concurrent reader never sees a partial entry.
+    *
+    * @param[in] p_sKey                 The cache key.
+    * @param[in] p_matData              Clustered gain matrix or kernel.
+    * @param[in] p_qListClusterInfo     Cluster information of each hemisphere.
+    * @param[in] p_D                    Cluster operator (sources x clusters), its non-zero entries are stored in double precision.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool write(const QString& p_sKey, const MatrixXd& p_matData, const QList<MNEClusterInfo>& p_qListClusterInfo, const MatrixXd& p_D) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the cache directory.
+    *
+    * @return the cache directory.
+    */
+    inline QString cacheDir() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Adds the dimensions and the coefficients of a matrix to a hash.
+    *
+    * @param[in, out] p_hash    The hash.
+    * @param[in] p_mat          The matrix.
+    */
+    template<typename T>
+    static void addMatrix(QCryptographicHash& p_hash, const T& p_mat);
+
+    QString m_sCacheDir;    /**< Directory of the cache files. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline QString MNEClusterCache::cacheDir() const
+{
+    return m_sCacheDir;
+}
+
+
+//*************************************************************************************************************
+
+template<typename T>
+void MNEClusterCache::addMatrix(QCryptographicHash& p_hash, const T& p_mat)
+{
+    qint64 t_dims[2] = { (qint64)p_mat.rows(), (qint64)p_mat.cols() };
+    p_hash.addData((const char*)t_dims, sizeof(t_dims));
+    p_hash.addData((const char*)p_mat.data(), p_mat.size()*sizeof(typename T::Scalar));
+}
+
+} // NAMESPACE
+
+#endif // MNE_CLUSTER_CACHE_H
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "mne_forwardsolution.h"
+#include "mne_cluster_cache.h"
 
 
 //*************************************************************************************************************
@@ -166,7 +167,7 @@ void MNEForwardSolution::clear()
 
 //*************************************************************************************************************
 
-MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, const FiffCov &p_pNoise_cov, const FiffInfo &p_pInfo, QString p_sMethod) const
+MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, const FiffCov &p_pNoise_cov, const FiffInfo &p_pInfo, QString p_sMethod, const QString &p_sCacheDir) const
 {
     MNEForwardSolution p_fwdOut = MNEForwardSolution(*this);
 
@@ -192,6 +193,37 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
 //        }
 //    }
 
+    //
+    // Look up the cluster cache
+    //
+    QString t_sCacheKey;
+    if(!p_sCacheDir.isEmpty())
+    {
+        t_sCacheKey = MNEClusterCache::key(this->sol->data, this->src, p_AnnotationSet, p_iClusterSize, p_sMethod, p_pNoise_cov, p_pInfo);
+
+        MatrixXd t_G_cached;
+        QList<MNEClusterInfo> t_qListClusterInfo;
+        if(MNEClusterCache(p_sCacheDir).read(t_sCacheKey, t_G_cached, t_qListClusterInfo, p_D) && t_qListClusterInfo.size() == this->src.size())
+        {
+            for(qint32 h = 0; h < this->src.size(); ++h)
+            {
+                p_fwdOut.src[h].cluster_info = t_qListClusterInfo[h];
+
+                // vertno holds the label IDs of the clusters (Option 2 below)
+                p_fwdOut.src[h].vertno.resize(t_qListClusterInfo[h].clusterLabelIds.size());
+                for(qint32 i = 0; i < p_fwdOut.src[h].vertno.size(); ++i)
+                    p_fwdOut.src[h].vertno[i] = t_qListClusterInfo[h].clusterLabelIds[i];
+            }
+
+            p_fwdOut.sol->data = t_G_cached;
+            p_fwdOut.sol->ncol = t_G_cached.cols();
+
+            p_fwdOut.nsource = p_fwdOut.sol->ncol/3;
+
+            return p_fwdOut;
+        }
+    }
+
     MatrixXd t_G_Whitened(0,0);
     bool t_bUseWhitened = false;
     //
@@ -694,6 +726,15 @@ MNEForwardSolution MNEForwardSolution::cluster_forward_solution(const Annotation
 
     p_fwdOut.nsource = p_fwdOut.sol->ncol/3;
 
+    if(!p_sCacheDir.isEmpty())
+    {
+        QList<MNEClusterInfo> t_qListClusterInfo;
+        for(qint32 h = 0; h < p_fwdOut.src.size(); ++h)
+            t_qListClusterInfo.append(p_fwdOut.src[h].cluster_info);
+
+        MNEClusterCache(p_sCacheDir).write(t_sCacheKey, t_G_new, t_qListClusterInfo, p_D);
+    }
+
     return p_fwdOut;
 }
 
@@ -156,7 +156,7 @@ struct RegionData
         // Kmeans Reduction
         RegionDataOut p_RegionDataOut;
 
-        KMeans t_kMeans(t_sDistMeasure, QString("sample"), 5);
+        KMeans t_kMeans(t_sDistMeasure, QString("plus"), 5);
 
         if(bUseWhitened)
         {
@@ -260,10 +260,13 @@ public:
     * @param[in]    p_pNoise_cov
     * @param[in]    p_pInfo
     * @param[in]    p_sMethod           "cityblock" or "sqeuclidean"
+    * @param[in]    p_sCacheDir         Directory of the cluster cache (see MNEClusterCache). A cached result for the
+    *                                   same inputs is read instead of clustering again, a new result is added.
+    *                                   Empty disables the cache (default).
     *
     * @return clustered MNE forward solution
     */
-    MNEForwardSolution cluster_forward_solution(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D = defaultD, const FiffCov &p_pNoise_cov = defaultCov, const FiffInfo &p_pInfo = defaultInfo, QString p_sMethod = "cityblock") const;
+    MNEForwardSolution cluster_forward_solution(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D = defaultD, const FiffCov &p_pNoise_cov = defaultCov, const FiffInfo &p_pInfo = defaultInfo, QString p_sMethod = "cityblock", const QString &p_sCacheDir = QString()) const;
 
     //=========================================================================================================
     /**
@@ -39,6 +39,7 @@
 //=============================================================================================================
 
 #include "mne_inverse_operator.h"
+#include "mne_cluster_cache.h"
 #include <fs/label.h>
 #include <QFuture>
 #include <QtConcurrent>
@@ -87,9 +88,9 @@ MNEInverseOperator::MNEInverseOperator(QIODevice& p_IODevice)
 
 //*************************************************************************************************************
 
-MNEInverseOperator::MNEInverseOperator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose, float depth, bool fixed, bool limit_depth_chs)
+MNEInverseOperator::MNEInverseOperator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose, float depth, bool fixed, bool limit_depth_chs, SvdMethod svd_method, qint32 svd_rank)
 {
-    *this = MNEInverseOperator::make_inverse_operator(info, forward, p_noise_cov, loose, depth, fixed, limit_depth_chs);
+    *this = MNEInverseOperator::make_inverse_operator(info, forward, p_noise_cov, loose, depth, fixed, limit_depth_chs, svd_method, svd_rank);
 }
 
 
@@ -327,7 +328,7 @@ bool MNEInverseOperator::check_ch_names(const FiffInfo &info) const
 
 //*************************************************************************************************************
 
-MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, QString p_sMethod) const
+MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, QString p_sMethod, const QString &p_sCacheDir) const
 {
     printf("Cluster kernel using %s.\n", p_sMethod.toUtf8().constData());
 
@@ -347,6 +348,19 @@ MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet
         return p_outMT;
     }
 
+    //
+    // Look up the cluster cache
+    //
+    QString t_sCacheKey;
+    if(!p_sCacheDir.isEmpty())
+    {
+        t_sCacheKey = MNEClusterCache::key(this->m_K, this->src, p_AnnotationSet, p_iClusterSize, p_sMethod, FiffCov(), FiffInfo());
+
+        MatrixXd t_MT_cached;
+        if(MNEClusterCache(p_sCacheDir).read(t_sCacheKey, t_MT_cached, t_qListMNEClusterInfo, p_D))
+            return t_MT_cached;
+    }
+
 //    qDebug() << "p_outMT" << p_outMT.rows() << "x" << p_outMT.cols();
 
 //    MatrixXd t_G_Whitened(0,0);
@@ -657,13 +671,16 @@ MatrixXd MNEInverseOperator::cluster_kernel(const AnnotationSet &p_AnnotationSet
     //
     p_outMT = t_MT_new;
 
+    if(!p_sCacheDir.isEmpty())
+        MNEClusterCache(p_sCacheDir).write(t_sCacheKey, p_outMT, t_qListMNEClusterInfo, p_D);
+
     return p_outMT;
 }
 
 
 //*************************************************************************************************************
 
-MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov &p_noise_cov, float loose, float depth, bool fixed, bool limit_depth_chs)
+MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov &p_noise_cov, float loose, float depth, bool fixed, bool limit_depth_chs, SvdMethod svd_method, qint32 svd_rank)
 {
     bool is_fixed_ori = forward.isFixedOrient();
     MNEInverseOperator p_MNEInverseOperator;
@@ -800,7 +817,7 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     for(qint32 i = 0; i < gain.rows(); ++i)
         gain.row(i) = gain.row(i).array() * source_std.array();
 
-    double trace_GRGT = (gain * gain.transpose()).trace();//pow(gain.norm(), 2);
+    double trace_GRGT = gain.squaredNorm();// == (gain * gain.transpose()).trace()
     double scaling_source_cov = (double)n_nzero / trace_GRGT;
 
     p_source_cov->data.array() *= scaling_source_cov;
@@ -813,23 +830,36 @@ MNEInverseOperator MNEInverseOperator::make_inverse_operator(const FiffInfo &inf
     //
     // 12. Decompose the combined matrix
     //
-    printf("Computing SVD of whitened and weighted lead field matrix.\n");
-    JacobiSVD<MatrixXd> svd(gain, ComputeThinU | ComputeThinV);
-    std::cout << "ToDo Sorting Necessary?" << std::endl;
-    VectorXd p_sing = svd.singularValues();
-    MatrixXd t_U = svd.matrixU();
-    MNEMath::sort<double>(p_sing, t_U);
-    FiffNamedMatrix::SDPtr p_eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( svd.matrixU().cols(),
-                                                                                        svd.matrixU().rows(),
+    VectorXd p_sing;
+    MatrixXd t_U, t_V;
+    switch(svd_method)
+    {
+    case SvdGram:
+        printf("Computing SVD of whitened and weighted lead field matrix from its Gram matrix.\n");
+        MNEMath::gram_svd(gain, p_sing, t_U, t_V);
+        break;
+    case SvdRandomized:
+        printf("Computing randomized SVD (rank %d) of whitened and weighted lead field matrix.\n", svd_rank);
+        MNEMath::randomized_svd(gain, svd_rank, p_sing, t_U, t_V);
+        break;
+    default:
+    {
+        printf("Computing SVD of whitened and weighted lead field matrix.\n");
+        JacobiSVD<MatrixXd> svd(gain, ComputeThinU | ComputeThinV);
+        p_sing = svd.singularValues();
+        t_U = svd.matrixU();
+        t_V = svd.matrixV();
+    }
+    }
+    //All decompositions return the singular values in decreasing order
+    FiffNamedMatrix::SDPtr p_eigen_fields = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( t_U.cols(),
+                                                                                        t_U.rows(),
                                                                                         defaultQStringList,
                                                                                         gain_info.ch_names,
                                                                                         t_U.transpose() ));
 
-    p_sing = svd.singularValues();
-    MatrixXd t_V = svd.matrixV();
-    MNEMath::sort<double>(p_sing, t_V);
-    FiffNamedMatrix::SDPtr p_eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( svd.matrixV().rows(),
-                                                                                       svd.matrixV().cols(),
+    FiffNamedMatrix::SDPtr p_eigen_leads = FiffNamedMatrix::SDPtr(new FiffNamedMatrix( t_V.rows(),
+                                                                                       t_V.cols(),
                                                                                        defaultQStringList,
                                                                                        defaultQStringList,
                                                                                        t_V ));
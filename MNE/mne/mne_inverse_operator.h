@@ -146,7 +146,7 @@ struct RegionMT
         // Kmeans Reduction
         RegionMTOut p_RegionMTOut;
 
-        KMeans t_kMeans(t_sDistMeasure, QString("sample"), 5);
+        KMeans t_kMeans(t_sDistMeasure, QString("plus"), 5);
 
         t_kMeans.calculate(this->matRoiMT, this->nClusters, p_RegionMTOut.roiIdx, p_RegionMTOut.ctrs, p_RegionMTOut.sumd, p_RegionMTOut.D);
 
@@ -169,6 +169,17 @@ public:
     typedef QSharedPointer<MNEInverseOperator> SPtr;            /**< Shared pointer type for MNEInverseOperator. */
     typedef QSharedPointer<const MNEInverseOperator> ConstSPtr; /**< Const shared pointer type for MNEInverseOperator. */
 
+    //=========================================================================================================
+    /**
+    * Decomposition used for the whitened and weighted lead field in make_inverse_operator.
+    */
+    enum SvdMethod
+    {
+        SvdJacobi,          /**< Full thin SVD with JacobiSVD. Accurate but slow for large source spaces. */
+        SvdGram,            /**< Eigen decomposition of the sensors x sensors Gram matrix. */
+        SvdRandomized       /**< Randomized truncated SVD of the given rank. */
+    };
+
     //=========================================================================================================
     /**
     * Default constructor
@@ -194,8 +205,10 @@ public:
     * @param[in] depth              float in [0, 1]. Depth weighting coefficients. If None, no depth weighting is performed.
     * @param[in] fixed              Use fixed source orientations normal to the cortical mantle. If True, the loose parameter is ignored.
     * @param[in] limit_depth_chs    If True, use only grad channels in depth weighting (equivalent to MNE C code). If grad chanels aren't present, only mag channels will be used (if no mag, then eeg). If False, use all channels.
+    * @param[in] svd_method       Decomposition of the whitened lead field (optional, default = SvdJacobi).
+    * @param[in] svd_rank         Number of components kept by SvdRandomized, <= 0 keeps all (optional, default = -1).
     */
-    MNEInverseOperator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true);
+    MNEInverseOperator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true, SvdMethod svd_method = SvdJacobi, qint32 svd_rank = -1);
 
     //=========================================================================================================
     /**
@@ -248,10 +261,12 @@ public:
     * @param[in]    p_iClusterSize      Maximal cluster size per roi
     * @param[out]   p_D                 The cluster operator
     * @param[in]    p_sMethod           "cityblock" or "sqeuclidean"
+    * @param[in]    p_sCacheDir         Directory of the cluster cache (see MNEClusterCache), empty disables the
+    *                                   cache (default).
     *
     * @return the clustered kernel
     */
-    MatrixXd cluster_kernel(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, QString p_sMethod = "cityblock") const;
+    MatrixXd cluster_kernel(const AnnotationSet &p_AnnotationSet, qint32 p_iClusterSize, MatrixXd& p_D, QString p_sMethod = "cityblock", const QString &p_sCacheDir = QString()) const;
 
     //=========================================================================================================
     /**
@@ -288,10 +303,12 @@ public:
     * @param[in] depth              float in [0, 1]. Depth weighting coefficients. If None, no depth weighting is performed.
     * @param[in] fixed              Use fixed source orientations normal to the cortical mantle. If True, the loose parameter is ignored.
     * @param[in] limit_depth_chs    If True, use only grad channels in depth weighting (equivalent to MNE C code). If grad chanels aren't present, only mag channels will be used (if no mag, then eeg). If False, use all channels.
+    * @param[in] svd_method       Decomposition of the whitened lead field (optional, default = SvdJacobi).
+    * @param[in] svd_rank         Number of components kept by SvdRandomized, <= 0 keeps all (optional, default = -1).
     *
     * @return the assembled inverse operator
     */
-    static MNEInverseOperator make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true);
+    static MNEInverseOperator make_inverse_operator(const FiffInfo &info, MNEForwardSolution forward, const FiffCov& p_noise_cov, float loose = 0.2f, float depth = 0.8f, bool fixed = false, bool limit_depth_chs = true, SvdMethod svd_method = SvdJacobi, qint32 svd_rank = -1);
 
     //=========================================================================================================
     /**
@@ -248,7 +248,7 @@ void MNESourceEstimate::update_times()
 {
     if(data.cols() > 0)
     {
-        this->times = RowVectorXf(data.cols());
+        this->times.resize(data.cols());
         this->times[0] = this->tmin;
         for(float i = 1; i < this->times.size(); ++i)
             this->times[i] = this->times[i-1] + this->tstep;
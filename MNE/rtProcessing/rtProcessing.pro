@@ -39,6 +39,7 @@ include(../../mne-cpp.pri)
 TEMPLATE = lib
 
 QT       -= gui
+QT       += concurrent
 
 DEFINES += RTPROCESSING_LIBRARY
 
@@ -82,17 +82,15 @@ RtAve::RtAve(quint32 numAverages, quint32 p_iPreStimSamples, quint32 p_iPostStim
 , m_bIsRunning(false)
 , m_bAutoAspect(true)
 , m_fTriggerThreshold(0.5)
-, m_bFillingBackBuffer(false)
 , m_iTriggerIndex(-1)
 , m_iNewTriggerIndex(p_iTriggerIndex)
-, m_iTriggerPos(-1)
 , m_iAverageMode(0)
 , m_iNewAverageMode(0)
 , m_bDoBaselineCorrection(false)
 , m_pairBaselineSec(qMakePair(QVariant(QString::number(p_iBaselineFromSecs)),QVariant(QString::number(p_iBaselineToSecs))))
+, m_bConditionsChanged(false)
 , m_pStimEvoked(FiffEvoked::SPtr(new FiffEvoked))
-, m_iMatDataPostIdx(0)
-, m_iNumberCalcAverages(0)
+, m_iNumSamplesReceived(0)
 {
     qRegisterMetaType<FiffEvoked::SPtr>("FiffEvoked::SPtr");
 
@@ -177,6 +175,17 @@ void RtAve::setTriggerChIndx(qint32 idx)
 }
 
 
+//*************************************************************************************************************
+
+void RtAve::setConditions(const QList<Condition>& p_qListConditions)
+{
+    m_qMutex.lock();
+    m_qListNewConditions = p_qListConditions;
+    m_bConditionsChanged = true;
+    m_qMutex.unlock();
+}
+
+
 //*************************************************************************************************************
 
 void RtAve::setBaselineActive(bool activate)
@@ -250,9 +259,11 @@ bool RtAve::stop()
     m_bIsRunning = false;
     m_qMutex.unlock();
 
-    m_pRawMatrixBuffer->releaseFromPop();
-
-    m_pRawMatrixBuffer->clear();
+    if(m_pRawMatrixBuffer)
+    {
+        m_pRawMatrixBuffer->releaseFromPop();
+        m_pRawMatrixBuffer->clear();
+    }
 
     return true;
 }
@@ -265,6 +276,8 @@ void RtAve::run()
     //Do initial reset
     reset();
 
+    MatrixXd rawSegment;
+
     //Enter the main loop
     while(m_bIsRunning) {
         bool doProcessing = false;
@@ -279,76 +292,41 @@ void RtAve::run()
                     || m_iNewPostStimSamples != m_iPostStimSamples
                     || m_iNewTriggerIndex != m_iTriggerIndex
                     || m_iNewAverageMode != m_iAverageMode
-                    || m_iNewNumAverages != m_iNumAverages)
+                    || m_iNewNumAverages != m_iNumAverages
+                    || m_bConditionsChanged)
                 reset();
 
             //Acquire Data
-            MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
-
-            //Fill back buffer and decide when to do the data packing of the different buffers
-            if(m_bFillingBackBuffer) {
-                if(m_iMatDataPostIdx == m_iPostStimSamples) {
-                    m_iMatDataPostIdx = 0;
-
-                    //Merge the different buffers
-                    mergeData();
+            m_pRawMatrixBuffer->pop(rawSegment);
 
-                    //Calculate the actual average
-                    generateEvoked();
+            if(!m_bIsRunning || rawSegment.cols() == 0)
+                continue;
 
-                    //If number of averages was reached emit new average
-                    if(m_qListStimAve.size() > 0)
-                        emit evokedStim(m_pStimEvoked);
+            qint64 iFirstSample = m_iNumSamplesReceived;
 
-                    m_bFillingBackBuffer = false;
+            appendToHistory(rawSegment);
 
-                    qDebug()<<"RtAve::run() - Number of calculated averages:"<<m_iNumberCalcAverages;
-                    qDebug()<<"RtAve::run() - m_qListStimAve.size():"<<m_qListStimAve.size();
-                } else {
-                    fillBackBuffer(rawSegment);
-                }
-            } else {
-                clearDetectedTriggers();
-
-                //Detect trigger for all stim channels.
-                m_iTriggerPos = -1;
-                DetectTrigger::detectTriggerFlanksGrad(rawSegment, m_iTriggerIndex, m_iTriggerPos, 0, m_fTriggerThreshold, true, "Rising");
+            //Detect the events of all conditions, epochs may overlap
+            detectEvents(rawSegment, iFirstSample);
 
-                //If number of averages is equals zero do not perform averages
-                if(m_iNumAverages == 0) {
-                    m_iTriggerPos = rawSegment.cols()-1;
-                }
+            //If number of averages is equals zero do not perform averages, show the latest data instead
+            if(m_iNumAverages == 0) {
+                for(qint32 i = 0; i < m_qListConditions.size(); ++i) {
+                    bool bPending = false;
+                    for(qint32 j = 0; j < m_qListPendingEpochs.size(); ++j)
+                        if(m_qListPendingEpochs[j].iCondition == i)
+                            bPending = true;
 
-                //If detected turn on filling of the back / post stim buffer
-                if(m_iTriggerPos != -1) {
-                    //Do front buffer stuff
-                    MatrixXd tempMat;
-
-                    if(m_iTriggerPos >= m_iPreStimSamples) {
-                        tempMat = rawSegment.block(0,m_iTriggerPos-m_iPreStimSamples,rawSegment.rows(),m_iPreStimSamples);
-                        fillFrontBuffer(tempMat);
-                    } else {
-                        tempMat = rawSegment.block(0,0,rawSegment.rows(),m_iTriggerPos);
-                        fillFrontBuffer(tempMat);
+                    if(!bPending) {
+                        PendingEpoch epoch;
+                        epoch.iCondition = i;
+                        epoch.iTriggerSample = m_iNumSamplesReceived - 1;
+                        m_qListPendingEpochs.append(epoch);
                     }
-
-                    //Do back buffer stuff
-                    if(rawSegment.cols()-m_iTriggerPos >= m_matDataPost.cols()) {
-                        m_matDataPost = rawSegment.block(0,m_iTriggerPos,m_matDataPost.rows(),m_matDataPost.cols());
-                        m_iMatDataPostIdx = m_iPostStimSamples;
-                    } else {
-                        m_matDataPost.block(0,0,m_matDataPost.rows(),rawSegment.cols()-m_iTriggerPos) = rawSegment.block(0,m_iTriggerPos,rawSegment.rows(),rawSegment.cols()-m_iTriggerPos);
-                        m_iMatDataPostIdx = rawSegment.cols()-m_iTriggerPos;
-                    }
-
-                    m_bFillingBackBuffer = true;
-                } else {
-                    //Fill front / pre stim buffer
-                    fillFrontBuffer(rawSegment);
                 }
-
-                //qDebug()<<"Trigger channel "<<m_iTriggerIndex<<" found at "<<m_iTriggerPos;
             }
+
+            processPendingEpochs();
         }
     }
 }
@@ -356,104 +334,151 @@ void RtAve::run()
 
 //*************************************************************************************************************
 
-void RtAve::clearDetectedTriggers()
+void RtAve::appendToHistory(const MatrixXd &data)
 {
-    QMutableMapIterator<int,QList<int> > i(m_qMapDetectedTrigger);
-    while (i.hasNext()) {
-        i.next();
-        i.value().clear();
+    qint32 iMinCols = m_iPreStimSamples + m_iPostStimSamples + data.cols();
+
+    //Grow the ring such that every pending epoch is still available when it is completed
+    if(m_matHistory.rows() != data.rows() || m_matHistory.cols() < iMinCols) {
+        MatrixXd matHistory = MatrixXd::Zero(data.rows(), 2*iMinCols);
+
+        if(m_matHistory.rows() == data.rows()) {
+            qint64 iFirst = qMax((qint64)0, m_iNumSamplesReceived - m_matHistory.cols());
+            for(qint64 i = iFirst; i < m_iNumSamplesReceived; ++i)
+                matHistory.col(i % matHistory.cols()) = m_matHistory.col(i % m_matHistory.cols());
+        }
+
+        m_matHistory = matHistory;
     }
+
+    for(qint32 i = 0; i < data.cols(); ++i)
+        m_matHistory.col((m_iNumSamplesReceived + i) % m_matHistory.cols()) = data.col(i);
+
+    m_iNumSamplesReceived += data.cols();
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::fillBackBuffer(MatrixXd &data)
+void RtAve::detectEvents(const MatrixXd &data, qint64 iFirstSample)
 {
-    int iResidualCols = data.cols();
-    if(m_iMatDataPostIdx+data.cols() > m_iPostStimSamples) {
-        iResidualCols = m_iPostStimSamples-m_iMatDataPostIdx;
-        m_matDataPost.block(0,m_iMatDataPostIdx,m_matDataPost.rows(),iResidualCols) = data.block(0,0,data.rows(),iResidualCols);
-    } else
-        m_matDataPost.block(0,m_iMatDataPostIdx,m_matDataPost.rows(),iResidualCols) = data;
-
-    m_iMatDataPostIdx += iResidualCols;
-}
+    for(qint32 i = 0; i < m_qListConditions.size(); ++i) {
+        const Condition& condition = m_qListConditions.at(i);
 
+        if(condition.iStimChannel < 0 || condition.iStimChannel >= data.rows())
+            continue;
 
-//*************************************************************************************************************
+        double dPrev = m_qMapLastStimValue.value(condition.iStimChannel, data(condition.iStimChannel, 0));
 
-void RtAve::fillFrontBuffer(MatrixXd &data)
-{
-    if(m_matDataPre.cols() <= data.cols()) {
-        m_matDataPre = data.block(0,data.cols()-m_iPreStimSamples,data.rows(),m_iPreStimSamples);
-    } else {
-        int residual = m_matDataPre.cols()-data.cols();
+        for(qint32 j = 0; j < data.cols(); ++j) {
+            double dCur = data(condition.iStimChannel, j);
 
-        //Copy shift data
-        m_matDataPre.block(0,0,m_matDataPre.rows(),residual) = m_matDataPre.block(0,m_matDataPre.cols()-residual,m_matDataPre.rows(),residual);
+            bool bEvent = condition.iEventCode == 0
+                    ? dCur - dPrev > m_fTriggerThreshold
+                    : qRound(dCur) == condition.iEventCode && qRound(dPrev) != condition.iEventCode;
 
-        //Copy new data in
-        m_matDataPre.block(0,residual,m_matDataPre.rows(),data.cols()) = data;
+            if(bEvent) {
+                PendingEpoch epoch;
+                epoch.iCondition = i;
+                epoch.iTriggerSample = iFirstSample + j;
+                m_qListPendingEpochs.append(epoch);
+            }
+
+            dPrev = dCur;
+        }
+    }
+
+    //Remember the last values only after all conditions scanned this block, several may share a channel
+    for(qint32 i = 0; i < m_qListConditions.size(); ++i) {
+        qint32 iStimChannel = m_qListConditions.at(i).iStimChannel;
+        if(iStimChannel >= 0 && iStimChannel < data.rows())
+            m_qMapLastStimValue.insert(iStimChannel, data(iStimChannel, data.cols()-1));
     }
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::mergeData()
+void RtAve::processPendingEpochs()
 {
-    MatrixXd mergedData(m_matDataPre.rows(), m_matDataPre.cols()+m_matDataPost.cols());
+    qint32 iEpochLength = m_iPreStimSamples + m_iPostStimSamples;
+    qint64 iOldest = m_iNumSamplesReceived - m_matHistory.cols();
 
-    mergedData << m_matDataPre, m_matDataPost;
+    QMutableListIterator<PendingEpoch> it(m_qListPendingEpochs);
+    while(it.hasNext()) {
+        const PendingEpoch& pending = it.next();
 
-    //Add cut data to average buffer
-    m_qListStimAve.append(mergedData);
-    if(m_qListStimAve.size()>m_iNumAverages && m_iNumAverages >= 1) {
-        m_qListStimAve.pop_front();
-    }
+        if(pending.iTriggerSample + m_iPostStimSamples > m_iNumSamplesReceived)
+            continue;
+
+        qint64 iStart = pending.iTriggerSample - m_iPreStimSamples;
+
+        if(iStart < iOldest) {
+            qWarning() << "RtAve::processPendingEpochs() - Epoch is no longer available in the history, dropping it.";
+            it.remove();
+            continue;
+        }
 
-    //Proceed a bit different if we use zero number of averages
-    if(m_qListStimAve.size() > 1 && m_iNumAverages == 0) {
-        m_qListStimAve.pop_front();
+        //Cut the epoch by index, samples before the start of the stream are zero
+        MatrixXd epoch(m_matHistory.rows(), iEpochLength);
+        for(qint32 i = 0; i < iEpochLength; ++i) {
+            if(iStart + i < 0)
+                epoch.col(i).setZero();
+            else
+                epoch.col(i) = m_matHistory.col((iStart + i) % m_matHistory.cols());
+        }
+
+        qint32 iCondition = pending.iCondition;
+        it.remove();
+
+        addEpoch(iCondition, epoch);
     }
 }
 
 
 //*************************************************************************************************************
 
-void RtAve::generateEvoked()
+void RtAve::addEpoch(qint32 iCondition, const MatrixXd &epoch)
 {
-    if(m_qListStimAve.isEmpty())
-        return;
-
-    // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_qListStimAve.first().rows(), m_iPreStimSamples+m_iPostStimSamples);
+    ConditionState& state = m_qListConditionStates[iCondition];
 
     if(m_iAverageMode == 0) {
-        for(int i = 0; i<m_qListStimAve.size(); i++) {
-            finalAverage += m_qListStimAve.at(i);
+        //Running average over the last m_iNumAverages epochs
+        state.qListStimAve.append(epoch);
+        state.matStimSum += epoch;
+
+        if((state.qListStimAve.size() > m_iNumAverages && m_iNumAverages >= 1)
+                || (state.qListStimAve.size() > 1 && m_iNumAverages == 0)) {
+            state.matStimSum -= state.qListStimAve.first();
+            state.qListStimAve.pop_front();
         }
-        finalAverage = finalAverage/m_qListStimAve.size();
+
+        MatrixXd finalAverage = state.matStimSum / state.qListStimAve.size();
 
         if(m_bDoBaselineCorrection)
-            finalAverage = MNEMath::rescale(finalAverage, m_pStimEvoked->times, m_pairBaselineSec, QString("mean"));
+            finalAverage = MNEMath::rescale(finalAverage, state.pEvoked->times, m_pairBaselineSec, QString("mean"));
 
-        m_pStimEvoked->data = finalAverage;
-        m_pStimEvoked->nave = m_iNumAverages;
+        state.pEvoked->data = finalAverage;
+        state.pEvoked->nave = m_iNumAverages;
 
-        if(m_iNumberCalcAverages<m_iNumAverages)
-            m_iNumberCalcAverages++;
+        if(state.iNumberCalcAverages < m_iNumAverages)
+            state.iNumberCalcAverages++;
     } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_qListStimAve.last();
+        MatrixXd tempMatrix = epoch;
 
         if(m_bDoBaselineCorrection)
-            tempMatrix = MNEMath::rescale(tempMatrix, m_pStimEvoked->times, m_pairBaselineSec, QString("mean"));
+            tempMatrix = MNEMath::rescale(tempMatrix, state.pEvoked->times, m_pairBaselineSec, QString("mean"));
 
-        *m_pStimEvoked.data() += tempMatrix;
+        *state.pEvoked.data() += tempMatrix;
 
-        m_iNumberCalcAverages++;
+        state.iNumberCalcAverages++;
     }
+
+    state.pEvoked->baseline = m_pStimEvoked->baseline;
+
+    if(iCondition == 0)
+        emit evokedStim(state.pEvoked);
+    emit evokedCondition(iCondition, state.pEvoked);
 }
 
 
@@ -472,13 +497,16 @@ void RtAve::reset()
     m_iAverageMode = m_iNewAverageMode;
     m_iNumAverages = m_iNewNumAverages;
 
-    m_iNumberCalcAverages = 0;
+    m_qListConditions = m_qListNewConditions;
+    m_bConditionsChanged = false;
 
-    //Resize data matrices
-    m_matDataPre.resize(m_pFiffInfo->chs.size(), m_iPreStimSamples);
-    m_matDataPre.setZero();
-    m_matDataPost.resize(m_pFiffInfo->chs.size(), m_iPostStimSamples);
-    m_matDataPost.setZero();
+    //Default condition: any rising flank on the trigger channel
+    if(m_qListConditions.isEmpty()) {
+        Condition condition;
+        condition.iStimChannel = m_iTriggerIndex;
+        condition.iEventCode = 0;
+        m_qListConditions.append(condition);
+    }
 
     //Full real-time evoked response
     m_pStimEvoked->setInfo(*m_pFiffInfo.data());
@@ -496,10 +524,21 @@ void RtAve::reset()
     else
         m_pStimEvoked->nave = 0;
 
-    m_qListStimAve.clear();
-    clearDetectedTriggers();
+    //Per condition evoked, all share the time axis and info of m_pStimEvoked
+    m_qListConditionStates.clear();
+    for(qint32 i = 0; i < m_qListConditions.size(); ++i) {
+        ConditionState state;
+        state.pEvoked = FiffEvoked::SPtr(new FiffEvoked(*m_pStimEvoked));
+        state.pEvoked->comment = m_qListConditions.at(i).sComment;
+        state.matStimSum = MatrixXd::Zero(m_pFiffInfo->chs.size(), m_iPreStimSamples+m_iPostStimSamples);
+        state.iNumberCalcAverages = 0;
+        m_qListConditionStates.append(state);
+    }
 
-    m_bFillingBackBuffer = false;
+    m_qListPendingEpochs.clear();
+    m_qMapLastStimValue.clear();
+    m_matHistory.resize(0,0);
+    m_iNumSamplesReceived = 0;
 
     m_qMutex.unlock();
 }
@@ -511,22 +550,10 @@ void RtAve::init()
 {
     m_qMutex.lock();
 
-    QList<int> tempList;
-    for(int i = 0; i < m_pFiffInfo->nchan; ++i) {
-        if(m_pFiffInfo->chs[i].kind == FIFFV_STIM_CH && (m_pFiffInfo->chs[i].ch_name != QString("STI 014")))
-            m_qMapDetectedTrigger.insert(i,tempList);
-    }
-
     m_iNewPreStimSamples = m_iPreStimSamples;
     m_iNewPostStimSamples = m_iPostStimSamples;
     m_iNewNumAverages = m_iNumAverages;
 
-    //Resize data matrices
-    m_matDataPre.resize(m_pFiffInfo->chs.size(), m_iPreStimSamples);
-    m_matDataPre.setZero();
-    m_matDataPost.resize(m_pFiffInfo->chs.size(), m_iPostStimSamples);
-    m_matDataPost.setZero();
-
     m_qMutex.unlock();
 }
 
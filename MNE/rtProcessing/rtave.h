@@ -74,6 +74,7 @@
 #include <QSharedPointer>
 #include <QSet>
 #include <QList>
+#include <QMap>
 #include <QVariant>
 
 
@@ -117,6 +118,16 @@ public:
     typedef QSharedPointer<RtAve> SPtr;             /**< Shared pointer type for RtCov. */
     typedef QSharedPointer<const RtAve> ConstSPtr;  /**< Const shared pointer type for RtCov. */
 
+    //=========================================================================================================
+    /**
+    * A stimulus condition which is averaged separately.
+    */
+    struct Condition {
+        qint32  iStimChannel;       /**< Row index of the stim channel which is scanned for the event. */
+        qint32  iEventCode;         /**< Event value which starts an epoch, 0 for any rising flank above the trigger threshold. */
+        QString sComment;           /**< Comment of the resulting evoked, e.g. the condition name. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time covariance estimation object.
@@ -188,6 +199,16 @@ public:
     */
     void setTriggerChIndx(qint32 idx);
 
+    //=========================================================================================================
+    /**
+    * Sets the conditions which are averaged. Each condition is averaged separately from the same pass over the
+    * data and epochs of all conditions may overlap. An empty list (the default) averages any rising flank on the
+    * trigger channel set by setTriggerChIndx.
+    *
+    * @param[in] p_qListConditions    the conditions
+    */
+    void setConditions(const QList<Condition>& p_qListConditions);
+
     //=========================================================================================================
     /**
     * Sets the baseline correction on or off
@@ -251,6 +272,16 @@ signals:
     */
     void evokedStim(FIFFLIB::FiffEvoked::SPtr p_pEvokedStim);
 
+    //=========================================================================================================
+    /**
+    * Signal which is emitted when new evoked data of a condition are available. evokedStim is emitted for the
+    * first condition only.
+    *
+    * @param[out] p_iCondition      Index of the condition
+    * @param[out] p_pEvokedStim     The evoked data of the condition
+    */
+    void evokedCondition(qint32 p_iCondition, FIFFLIB::FiffEvoked::SPtr p_pEvokedStim);
+
     //=========================================================================================================
     /**
     * Emitted when number of averages changed
@@ -267,40 +298,54 @@ protected:
     virtual void run();
 
 private:
-    void clearDetectedTriggers();               /**< Clears already detected trigger*/
-
-    void fillFrontBuffer(MatrixXd &data);       /**< Prepends incoming data to front/pre stim buffer*/
-    void fillBackBuffer(MatrixXd &data);        /**< Prepends incoming data to back/post stim buffer*/
-    void mergeData();                           /**< Packs the buffers togehter as one and calcualtes the current running average and emits the result if number of averages has been reached*/
-    void generateEvoked();                      /**< Generates the final evoke variable*/
+    //=========================================================================================================
+    /**
+    * Averaging state of one condition
+    */
+    struct ConditionState {
+        FiffEvoked::SPtr    pEvoked;                /**< The evoked of this condition. */
+        QList<MatrixXd>     qListStimAve;           /**< The epochs of the running average. Holds m_iNumAverages epochs. */
+        MatrixXd            matStimSum;             /**< Sum of the epochs in qListStimAve. */
+        qint32              iNumberCalcAverages;    /**< The number of currently calculated averages. */
+    };
 
+    //=========================================================================================================
+    /**
+    * An epoch which waits for its post stimulus samples
+    */
+    struct PendingEpoch {
+        qint32  iCondition;         /**< Index of the condition. */
+        qint64  iTriggerSample;     /**< Absolute sample index of the trigger. */
+    };
+
+    void appendToHistory(const MatrixXd &data);             /**< Appends incoming data to the raw history ring*/
+    void detectEvents(const MatrixXd &data, qint64 iFirstSample);   /**< Detects the events of all conditions in the incoming data and queues their epochs*/
+    void processPendingEpochs();                            /**< Cuts all complete epochs from the history and averages them*/
+    void addEpoch(qint32 iCondition, const MatrixXd &epoch);    /**< Adds an epoch to the average of a condition and emits the result*/
     void init();
 
     QMutex  m_qMutex;                   /**< Provides access serialization between threads*/
 
     qint32  m_iNumAverages;             /**< Number of averages */
     qint32  m_iNewNumAverages;          /**< Number of averages */
-    qint32  m_iCurrentBlockSize;        /**< Current block size of the incoming data */
+
     qint32  m_iPreStimSamples;          /**< Amount of samples averaged before the stimulus. */
     qint32  m_iPostStimSamples;         /**< Amount of samples averaged after the stimulus, including the stimulus sample.*/
     qint32  m_iNewPreStimSamples;       /**< New amount of samples averaged before the stimulus. */
     qint32  m_iNewPostStimSamples;      /**< New amount of samples averaged after the stimulus, including the stimulus sample.*/
     qint32  m_iPreStimSeconds;          /**< Amount of seconds averaged before the stimulus. */
     qint32  m_iPostStimSeconds;         /**< Amount of seconds averaged after the stimulus, including the stimulus sample.*/
-    qint32  m_iMatDataPostIdx;          /**< Current index inside of the matrix m_matDataPost */
     qint32  m_iTriggerIndex;            /**< Current row index of the data matrix which is to be scanned for triggers */
     qint32  m_iNewTriggerIndex;         /**< Old row index of the data matrix which is to be scanned for triggers */
-    qint32  m_iTriggerPos;              /**< Last found trigger postion */
     qint32  m_iNewAverageMode;          /**< The new averaging mode 0-running 1-cumulative. */
     qint32  m_iAverageMode;             /**< The averaging mode 0-running 1-cumulative. */
-    qint32  m_iNumberCalcAverages;      /**< The number of currently calculated averages. */
 
     float   m_fTriggerThreshold;        /**< Threshold to detect trigger */
 
     bool    m_bIsRunning;               /**< Holds if real-time Covariance estimation is running.*/
     bool    m_bAutoAspect;              /**< Auto aspect detection on or off. */
-    bool    m_bFillingBackBuffer;       /**< Whether the back buffer is currently getting filled. */
     bool    m_bDoBaselineCorrection;    /**< Whether to perform baseline correction. */
+    bool    m_bConditionsChanged;       /**< Whether m_qListNewConditions has to be applied. */
 
     QPair<QVariant,QVariant>    m_pairBaselineSec;     /**< Baseline information in seconds form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
     QPair<QVariant,QVariant>    m_pairBaselineSamp;     /**< Baseline information in samples form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
@@ -310,12 +355,14 @@ private:
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;      /**< The Circular Raw Matrix Buffer. */
 
-    QMap<int,QList<int> >   m_qMapDetectedTrigger;              /**< Detected trigger for each trigger channel. */
-
-    MatrixXd                m_matDataPre;                       /**< The matrix holding the pre stim data. */
-    MatrixXd                m_matDataPost;                      /**< The matrix holding the post stim data. */
+    QList<Condition>        m_qListConditions;                  /**< The conditions which are averaged. */
+    QList<Condition>        m_qListNewConditions;               /**< The conditions set by setConditions. */
+    QList<ConditionState>   m_qListConditionStates;             /**< The averaging state of each condition. */
+    QList<PendingEpoch>     m_qListPendingEpochs;               /**< Detected epochs which wait for their post stimulus samples. */
+    QMap<qint32,double>     m_qMapLastStimValue;                /**< Last sample of each scanned stim channel, to detect events across blocks. */
 
-    QList<MatrixXd>         m_qListStimAve;                     /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    MatrixXd                m_matHistory;                       /**< Ring of the most recent raw samples, column (sample % cols). */
+    qint64                  m_iNumSamplesReceived;              /**< Absolute number of samples received since the last reset. */
 };
 
 //*************************************************************************************************************
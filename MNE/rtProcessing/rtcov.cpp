@@ -54,6 +54,14 @@
 #include <QDebug>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <math.h>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -63,6 +71,58 @@ using namespace RTINVLIB;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Updates the weighted sums of the covariance estimate, sum = lambda * sum + data * data'. Only the lower
+* triangle of the sum is kept up to date.
+*/
+template<typename T>
+void updateSums(Matrix<T,Dynamic,Dynamic>& p_matSum, Matrix<T,Dynamic,1>& p_vecSum, const Matrix<T,Dynamic,Dynamic>& p_matData, T p_lambda)
+{
+    if(p_matSum.rows() != p_matData.rows())
+    {
+        p_matSum = Matrix<T,Dynamic,Dynamic>::Zero(p_matData.rows(), p_matData.rows());
+        p_vecSum = Matrix<T,Dynamic,1>::Zero(p_matData.rows());
+    }
+    else if(p_lambda != 1)
+    {
+        p_matSum.template triangularView<Lower>() *= p_lambda;
+        p_vecSum *= p_lambda;
+    }
+
+    p_matSum.template selfadjointView<Lower>().rankUpdate(p_matData);
+    p_vecSum += p_matData.rowwise().sum();
+}
+
+
+//*************************************************************************************************************
+
+/**
+* Builds the full, mean corrected covariance from the weighted sums.
+*/
+template<typename T>
+void sumsToCov(const Matrix<T,Dynamic,Dynamic>& p_matSum, const Matrix<T,Dynamic,1>& p_vecSum, double p_dWeight, MatrixXd& p_matCov)
+{
+    p_matCov = p_matSum.template cast<double>();
+    for(qint32 j = 1; j < p_matCov.cols(); ++j)
+        p_matCov.col(j).head(j) = p_matCov.row(j).head(j).transpose();
+
+    VectorXd mu = p_vecSum.template cast<double>() / p_dWeight;
+    p_matCov.noalias() -= p_dWeight * (mu * mu.transpose());
+    p_matCov /= (p_dWeight - 1);
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -71,7 +131,11 @@ using namespace FIFFLIB;
 RtCov::RtCov(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 : QThread(parent)
 , m_iMaxSamples(p_iMaxSamples)
+, m_iNewMaxSamples(p_iMaxSamples)
 , m_pFiffInfo(p_pFiffInfo)
+, m_estimationMode(Batch)
+, m_iEmitSamples(0)
+, m_bSinglePrecision(false)
 , m_bIsRunning(false)
 {
     qRegisterMetaType<FiffCov::SPtr>("FiffCov::SPtr");
@@ -108,6 +172,25 @@ void RtCov::setSamples(qint32 samples)
 }
 
 
+//*************************************************************************************************************
+
+void RtCov::setEstimationMode(EstimationMode p_mode, qint32 p_iEmitSamples)
+{
+    QMutexLocker locker(&mutex);
+    m_estimationMode = p_mode;
+    m_iEmitSamples = p_iEmitSamples > 0 ? p_iEmitSamples : 0;
+}
+
+
+//*************************************************************************************************************
+
+void RtCov::setSinglePrecision(bool p_bSinglePrecision)
+{
+    QMutexLocker locker(&mutex);
+    m_bSinglePrecision = p_bSinglePrecision;
+}
+
+
 //*************************************************************************************************************
 
 bool RtCov::start()
@@ -129,9 +212,11 @@ bool RtCov::stop()
 {
     m_bIsRunning = false;
 
-    m_pRawMatrixBuffer->releaseFromPop();
-
-    m_pRawMatrixBuffer->clear();
+    if(m_pRawMatrixBuffer)
+    {
+        m_pRawMatrixBuffer->releaseFromPop();
+        m_pRawMatrixBuffer->clear();
+    }
 
     return true;
 }
@@ -150,34 +235,58 @@ void RtCov::run()
     }
     bool doProj = true;
 
-    quint32 n_samples = 0;
+    mutex.lock();
+    EstimationMode t_mode = m_estimationMode;
+    quint32 t_iMaxSamples = m_iMaxSamples;
+    quint32 t_iEmitSamples = (t_mode == Sliding && m_iEmitSamples > 0) ? m_iEmitSamples : m_iMaxSamples;
+    bool t_bSinglePrecision = m_bSinglePrecision;
+    mutex.unlock();
+
+    quint32 n_samples = 0;      // samples since the last emitted covariance
+    double t_dWeight = 0.0;     // effective number of samples within the (weighted) sums
 
-    FiffCov::SPtr cov(new FiffCov());
-    VectorXd mu;
+    MatrixXd t_matSum;
+    VectorXd t_vecSum;
+    MatrixXf t_matSumF;
+    VectorXf t_vecSumF;
+    MatrixXf t_matDataF;
+
+    FiffCov::RegularizePlan t_regPlan;
+    MatrixXd rawSegment;
 
     while(m_bIsRunning)
     {
         if(m_pRawMatrixBuffer)
         {
-            MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
+            m_pRawMatrixBuffer->pop(rawSegment);
+
+            if(!m_bIsRunning || rawSegment.cols() == 0)
+                continue;
 
-            if(n_samples == 0)
+            double t_dLambda = 1.0;
+            if(t_mode == Sliding)
+                t_dLambda = exp(-(double)rawSegment.cols() / (double)t_iMaxSamples);
+
+            if(t_bSinglePrecision)
             {
-                mu = rawSegment.rowwise().sum();
-                cov->data = rawSegment * rawSegment.transpose();
+                t_matDataF = rawSegment.cast<float>();
+                updateSums<float>(t_matSumF, t_vecSumF, t_matDataF, (float)t_dLambda);
             }
             else
-            {
-                mu.array() += rawSegment.rowwise().sum().array();
-                cov->data += rawSegment * rawSegment.transpose();
-            }
+                updateSums<double>(t_matSum, t_vecSum, rawSegment, t_dLambda);
+
+            t_dWeight = t_dLambda * t_dWeight + rawSegment.cols();
             n_samples += rawSegment.cols();
 
-            if(n_samples > m_iMaxSamples)
+            bool t_bEmit = (t_mode == Batch) ? n_samples > t_iMaxSamples : n_samples >= t_iEmitSamples;
+            if(t_bEmit && t_dWeight > 1.0)
             {
-                mu /= (float)n_samples;
-                cov->data.array() -= n_samples * (mu * mu.transpose()).array();
-                cov->data.array() /= (n_samples - 1);
+                FiffCov::SPtr cov(new FiffCov());
+
+                if(t_bSinglePrecision)
+                    sumsToCov<float>(t_matSumF, t_vecSumF, t_dWeight, cov->data);
+                else
+                    sumsToCov<double>(t_matSum, t_vecSum, t_dWeight, cov->data);
 
                 cov->kind = FIFFV_MNE_NOISE_COV;
                 cov->diag = false;
@@ -187,15 +296,25 @@ void RtCov::run()
                 cov->names = m_pFiffInfo->ch_names;
                 cov->projs = m_pFiffInfo->projs;
                 cov->bads = m_pFiffInfo->bads;
-                cov->nfree = n_samples;
+                cov->nfree = (fiff_int_t)t_dWeight;
 
-                // regularize noise covariance
-                *cov.data() = cov->regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+                // regularize noise covariance, the channel blocks and SSP bases are set up again only if the
+                // channels, bads or projectors changed
+                if(!cov->fits_regularization(t_regPlan, *m_pFiffInfo))
+                    cov->prepare_regularization(t_regPlan, *m_pFiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+                cov->apply_regularization(t_regPlan);
 
                 emit covCalculated(cov);
 
-                cov = FiffCov::SPtr(new FiffCov());
                 n_samples = 0;
+                if(t_mode == Batch)
+                {
+                    t_matSum.setZero();
+                    t_vecSum.setZero();
+                    t_matSumF.setZero();
+                    t_vecSumF.setZero();
+                    t_dWeight = 0.0;
+                }
             }
 
 
@@ -111,6 +111,16 @@ public:
     typedef QSharedPointer<RtCov> SPtr;             /**< Shared pointer type for RtCov. */
     typedef QSharedPointer<const RtCov> ConstSPtr;  /**< Const shared pointer type for RtCov. */
 
+    //=========================================================================================================
+    /**
+    * How the covariance is estimated from the incoming data.
+    */
+    enum EstimationMode
+    {
+        Batch,              /**< Estimate from a block of max samples, emit and start from scratch. */
+        Sliding             /**< Keep an exponentially weighted estimate with an effective window of max samples and emit it at the emit interval. */
+    };
+
     //=========================================================================================================
     /**
     * Creates the real-time covariance estimation object.
@@ -151,6 +161,25 @@ public:
     */
     void setSamples(qint32 samples);
 
+    //=========================================================================================================
+    /**
+    * Sets the estimation mode. Has to be set before start().
+    *
+    * @param[in] p_mode             The estimation mode
+    * @param[in] p_iEmitSamples     Sliding mode only: number of samples between two emitted covariances. 0 emits
+    *                               every max samples.
+    */
+    void setEstimationMode(EstimationMode p_mode, qint32 p_iEmitSamples = 0);
+
+    //=========================================================================================================
+    /**
+    * Accumulates the covariance in single precision, which halves the memory traffic of the update. The emitted
+    * covariance is always double. Has to be set before start().
+    *
+    * @param[in] p_bSinglePrecision     Whether to accumulate in single precision
+    */
+    void setSinglePrecision(bool p_bSinglePrecision);
+
     //=========================================================================================================
     /**
     * Starts the RtCov by starting the producer's thread.
@@ -194,6 +223,12 @@ private:
 
     FiffInfo::SPtr  m_pFiffInfo;        /**< Holds the fiff measurement information. */
 
+    EstimationMode  m_estimationMode;   /**< The estimation mode.*/
+
+    quint32      m_iEmitSamples;        /**< Sliding mode: number of samples between two emitted covariances.*/
+
+    bool        m_bSinglePrecision;     /**< Whether the covariance is accumulated in single precision.*/
+
     bool        m_bIsRunning;           /**< Holds if real-time Covariance estimation is running.*/
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
@@ -45,6 +45,7 @@
 #include "rthpis.h"
 
 #include <iostream>
+#include <cstring>
 #include <fiff/fiff_cov.h>
 
 
@@ -54,6 +55,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QtConcurrent/QtConcurrentMap>
 
 
 //*************************************************************************************************************
@@ -65,6 +67,15 @@ using namespace RTINVLIB;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define RTHPIS_RESTART_ERROR    0.1     /**< Relative residual above which a warm-started coil fit is restarted. */
+#define RTHPIS_INWARD_SHIFT     0.03    /**< Distance [m] below the strongest sensor used as additional start. */
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -74,6 +85,8 @@ RtHPIS::RtHPIS(FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 : QThread(parent)
 , m_pFiffInfo(p_pFiffInfo)
 , m_bIsRunning(false)
+, m_dWindowLength(0.25)
+, m_dFitInterval(0.1)
 {
     qRegisterMetaType<Eigen::MatrixXd>("Eigen::MatrixXd");
     //qRegisterMetaType<QVector<double>>("QVector<double>");
@@ -104,6 +117,15 @@ void RtHPIS::append(const MatrixXd &p_DataSegment)
 }
 
 
+//*************************************************************************************************************
+
+void RtHPIS::setFitTiming(double p_dWindowLength, double p_dFitInterval)
+{
+    m_dWindowLength = p_dWindowLength;
+    m_dFitInterval = p_dFitInterval;
+}
+
+
 //*************************************************************************************************************
 
 bool RtHPIS::start()
@@ -125,9 +147,11 @@ bool RtHPIS::stop()
 {
     m_bIsRunning = false;
 
-    m_pRawMatrixBuffer->releaseFromPop();
-
-    m_pRawMatrixBuffer->clear();
+    if(m_pRawMatrixBuffer)
+    {
+        m_pRawMatrixBuffer->releaseFromPop();
+        m_pRawMatrixBuffer->clear();
+    }
 
     qDebug()<<" RtHPIS Thread is stopped.";
 
@@ -145,8 +169,8 @@ void RtHPIS::run()
     int numCoils = 4;
     int numCh = m_pFiffInfo->nchan;
     int samF = m_pFiffInfo->sfreq;
-    int numLoc = 1, numBlock, samLoc; // numLoc : Number of times to localize in a second
-    samLoc = samF/numLoc; // minimum samples required to localize numLoc times in a second
+    int samWin = qMax(1, (int)(samF * m_dWindowLength));    // samples of the demodulation window
+    int samStep = qMax(1, (int)(samF * m_dFitInterval));    // samples between two localizations
     Eigen::VectorXd coilfreq(numCoils);
     coilfreq[0] = 154;coilfreq[1] = 158;coilfreq[2] = 162;coilfreq[3] = 166;
 
@@ -155,18 +179,21 @@ void RtHPIS::run()
     coil.mom = Eigen::MatrixXd::Zero(numCoils,3);
 
     // Generate simulated data
-    Eigen::MatrixXd simsig(samLoc,numCoils*2);
-    Eigen::VectorXd time(samLoc);
+    Eigen::MatrixXd simsig(samWin,numCoils*2);
+    Eigen::VectorXd time(samWin);
 
-    for (int i = 0;i < samLoc;i++) time[i] = i*1.0/samF;
+    for (int i = 0;i < samWin;i++) time[i] = i*1.0/samF;
 
     for(int i=0;i<numCoils;i++) {
-        for(int j=0;j<samLoc;j++) {
+        for(int j=0;j<samWin;j++) {
             simsig(j,i) = sin(2*M_PI*coilfreq[i]*time[j]);
             simsig(j,i+numCoils) = cos(2*M_PI*coilfreq[i]*time[j]);
         }
     }
 
+    // The lock-in demodulation weights only depend on the window, not on the data
+    Eigen::MatrixXd demod = pinv(simsig).transpose();
+
 
     // Get the indices of inner layer channels
     QVector<int> innerind(0);
@@ -213,9 +240,9 @@ void RtHPIS::run()
     Eigen::MatrixXd amp(innerind.size(),numCoils);
     Eigen::Matrix4d trans;
 
-
-    QVector<MatrixXd> buffer;
-    double phase;
+    // Sliding window of the inner layer channels, newest sample in the last column
+    Eigen::MatrixXd innerdata = Eigen::MatrixXd::Zero(innerind.size(),samWin);
+    int numFilled = 0, numSinceFit = 0;
 
     while(m_bIsRunning)
     {
@@ -223,75 +250,52 @@ void RtHPIS::run()
         {
             MatrixXd t_mat = m_pRawMatrixBuffer->pop();
 
-            buffer.append(t_mat);
+            if(!m_bIsRunning || t_mat.cols() == 0)
+                continue;
 
-            if(buffer.size()*t_mat.cols() >= samLoc) {
+            int numNew = qMin((int)t_mat.cols(), samWin);
+            int numKeep = samWin - numNew;
 
-                Eigen::MatrixXd alldata(t_mat.rows(),buffer.size()*t_mat.cols());
+            // Shift the window left, the columns are contiguous
+            if(numKeep > 0)
+                memmove(innerdata.data(), innerdata.data() + numNew*innerdata.rows(), numKeep*innerdata.rows()*sizeof(double));
 
-                // Concatenate data into a matrix
-                for(int i=0;i<buffer.size();i++) alldata << buffer[i];
+            for(int j = 0;j < innerind.size();j++)
+                innerdata.block(j,numKeep,1,numNew) = t_mat.block(innerind[j],t_mat.cols()-numNew,1,numNew);
 
-                // Get the data from inner layer channels
-                Eigen::MatrixXd innerdata(innerind.size(),samLoc);
+            numFilled = qMin(samWin, numFilled + (int)t_mat.cols());
+            numSinceFit += t_mat.cols();
 
-                numBlock = alldata.cols()/samLoc;
+            if(numFilled < samWin || numSinceFit < samStep)
+                continue;
 
-                // Loop for localizing coils
-                for(int i = 0;i<numBlock;i++) {
-                    for(int j = 0;j < innerind.size();j++)
-                        innerdata.row(j) << alldata.block(innerind[j],i*samLoc,1,samLoc);
-
-
-                    topo = innerdata * pinv(simsig).transpose();
+            numSinceFit = 0;
 
-                    amp = (topo.leftCols(numCoils).array().square() + topo.rightCols(numCoils).array().square()).array().sqrt();
+            topo = innerdata * demod;
 
+            // The amplitude of each coil is the projection onto the principal sin/cos direction, which does not
+            // depend on the phase of the coil drive relative to the window. The remaining sign ambiguity only
+            // flips the fitted moment.
+            for (int i = 0;i < numCoils;i++) {
+                Eigen::MatrixXd sincos(innerind.size(),2);
+                sincos.col(0) = topo.col(i);
+                sincos.col(1) = topo.col(i+numCoils);
 
-                    for (int i = 0;i < numCoils;i++) {
-                        for (int j = 0;j < innerind.size();j++) {
-                            phase = atan2(topo(j,i+numCoils),topo(j,i)) * 180/M_PI;
-                            if(phase < 0) phase = 360 + phase;
-                            if(phase <= 90) phase = 1;
-                            else if(phase > 90 || phase <= 270) phase = -1;
-                            else phase = 1;
-
-                            amp(j,i) = amp(j,i) * phase;
-
-                        }
-                    }
-
-
-                    coil = dipfit(coil, sensors, amp, numCoils);
-
-                    qDebug()<<"HPI head "<<headHPI(0,0)<<" "<<headHPI(0,1)<<" "<<headHPI(0,2);
-                    qDebug()<<"HPI head "<<headHPI(1,0)<<" "<<headHPI(1,1)<<" "<<headHPI(1,2);
-                    qDebug()<<"HPI head "<<headHPI(2,0)<<" "<<headHPI(2,1)<<" "<<headHPI(2,2);
-                    qDebug()<<"HPI head "<<headHPI(3,0)<<" "<<headHPI(3,1)<<" "<<headHPI(3,2);
-
+                Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> eig(sincos.transpose() * sincos);
+                amp.col(i) = sincos * eig.eigenvectors().col(1);
+            }
 
-                    qDebug()<<"HPI device "<<coil.pos(0,0)<<" "<<coil.pos(0,1)<<" "<<coil.pos(0,2);
-                    qDebug()<<"HPI device "<<coil.pos(1,0)<<" "<<coil.pos(1,1)<<" "<<coil.pos(1,2);
-                    qDebug()<<"HPI device "<<coil.pos(2,0)<<" "<<coil.pos(2,1)<<" "<<coil.pos(2,2);
-                    qDebug()<<"HPI device "<<coil.pos(3,0)<<" "<<coil.pos(3,1)<<" "<<coil.pos(3,2);
+            coil = dipfitLM(coil, sensors, amp, numCoils);
 
-                    trans = computeTransformation(coil.pos,headHPI);
+            trans = computeTransformation(coil.pos,headHPI);
 
-                    for(int ti =0; ti<4;ti++)
-                        for(int tj=0;tj<4;tj++)
+            for(int ti =0; ti<4;ti++)
+                for(int tj=0;tj<4;tj++)
                     m_pFiffInfo->dev_head_t.trans(ti,tj) = trans(ti,tj);
 
-                }
-                buffer.clear();
-            }
-
-
+            emit HPICalculated(coil.pos);
         }//m_pRawMatrixBuffer
-
-
-
     } //m_bIsRunning
-
 }
 
 //*************************************************************************************************************
@@ -459,7 +463,7 @@ void RtHPIS::test()
 //                    std::cout << ampreal.rows() << std::endl;
 //                    std::cout << ampreal.cols() << std::endl;
 
-                    coil = dipfit(coil, sensors, ampreal, numCoils);
+                    coil = dipfitLM(coil, sensors, ampreal, numCoils);
 
                     qDebug()<<"HPI head "<<headHPI(0,0)<<" "<<headHPI(0,1)<<" "<<headHPI(0,2);
                     qDebug()<<"HPI head "<<headHPI(1,0)<<" "<<headHPI(1,1)<<" "<<headHPI(1,2);
@@ -515,6 +519,191 @@ coilParam RtHPIS::dipfit(struct coilParam coil, struct sens sensors, Eigen::Matr
     return coil;
 }
 
+/*********************************************************************************
+ * dipfitLM fits all coils in parallel, see fitCoil
+ *********************************************************************************/
+
+coilParam RtHPIS::dipfitLM(const struct coilParam& coil, const struct sens& sensors, const Eigen::MatrixXd& data, int numCoils)
+{
+    QVector<coilFit> fits(numCoils);
+    coilParam result;
+
+    for(int i = 0;i < numCoils;i++) {
+        fits[i].pos = coil.pos.row(i).transpose();
+        fits[i].error = coil.pos.row(i).isZero() ? -1 : 0;
+        fits[i].data = data.col(i);
+        fits[i].sensors = &sensors;
+    }
+
+    QtConcurrent::blockingMap(fits, fitCoil);
+
+    result.pos.resize(numCoils,3);
+    result.mom.resize(numCoils,3);
+    for(int i = 0;i < numCoils;i++) {
+        result.pos.row(i) = fits[i].pos.transpose();
+        result.mom.row(i) = fits[i].mom.transpose();
+    }
+
+    return result;
+}
+
+/*********************************************************************************
+ * fitCoil warm-starts from the previous position and falls back to several
+ * start positions if there is no previous fit or the warm-started fit is poor
+ *********************************************************************************/
+
+void RtHPIS::fitCoil(coilFit& fit)
+{
+    Eigen::Vector3d pos = fit.pos, mom;
+    bool warm = fit.error >= 0;
+    double error;
+
+    if(warm) {
+        fit.error = fitDipoleLM(*fit.sensors, fit.data, pos, mom);
+        fit.pos = pos;
+        fit.mom = mom;
+        if(fit.error <= RTHPIS_RESTART_ERROR)
+            return;
+    }
+    else
+        fit.error = std::numeric_limits<double>::max();
+
+    // Start from the device origin and from below the sensor which sees the coil best
+    Eigen::MatrixXd::Index maxSensor;
+    fit.data.cwiseAbs().maxCoeff(&maxSensor);
+    Eigen::Vector3d sensorPos = fit.sensors->coilpos.row(maxSensor).transpose();
+
+    Eigen::Vector3d starts[2];
+    starts[0].setZero();
+    starts[1] = sensorPos * qMax(0.0, 1.0 - RTHPIS_INWARD_SHIFT / sensorPos.norm());
+
+    for(int i = 0;i < 2;i++) {
+        pos = starts[i];
+        error = fitDipoleLM(*fit.sensors, fit.data, pos, mom);
+        if(error < fit.error) {
+            fit.error = error;
+            fit.pos = pos;
+            fit.mom = mom;
+        }
+    }
+}
+
+/*********************************************************************************
+ * fitDipoleLM fits position and moment of a magnetic dipole with
+ * Levenberg-Marquardt (Marquardt scaling of the normal equations)
+ *********************************************************************************/
+
+double RtHPIS::fitDipoleLM(const struct sens& sensors, const Eigen::VectorXd& data, Eigen::Vector3d& pos, Eigen::Vector3d& mom, int maxIter)
+{
+    Eigen::VectorXd field, fieldNew;
+    Eigen::MatrixXd J;
+    Eigen::Matrix<double,6,6> JtJ, A;
+    Eigen::Matrix<double,6,1> g, delta;
+    Eigen::Vector3d posNew, momNew;
+    double lambda = 1e-3, cost, costNew;
+    double dataNorm = data.squaredNorm();
+    bool applyTra = !sensors.tra.isIdentity();
+
+    if(dataNorm == 0) {
+        mom.setZero();
+        return 0;
+    }
+
+    // The moment is linear - start with its least squares estimate at the start position
+    mom.setZero();
+    dipoleField(sensors, pos, mom, field, &J, applyTra);
+    mom = (J.rightCols(3).transpose() * J.rightCols(3)).ldlt().solve(J.rightCols(3).transpose() * data);
+
+    dipoleField(sensors, pos, mom, field, &J, applyTra);
+    field -= data;
+    cost = field.squaredNorm();
+
+    for(int iter = 0;iter < maxIter;iter++) {
+        JtJ = J.transpose() * J;
+        g = J.transpose() * field;
+
+        bool accepted = false;
+        while(!accepted && lambda < 1e10) {
+            A = JtJ;
+            A.diagonal() *= 1 + lambda;
+            delta = -A.ldlt().solve(g);
+
+            posNew = pos + delta.head<3>();
+            momNew = mom + delta.tail<3>();
+
+            dipoleField(sensors, posNew, momNew, fieldNew, 0, applyTra);
+            fieldNew -= data;
+            costNew = fieldNew.squaredNorm();
+
+            if(costNew < cost)
+                accepted = true;
+            else
+                lambda *= 10;
+        }
+
+        if(!accepted)
+            break;
+
+        double costChange = (cost - costNew) / cost;
+
+        pos = posNew;
+        mom = momNew;
+        cost = costNew;
+        lambda = qMax(lambda * 0.1, 1e-12);
+
+        if(delta.head<3>().norm() < 1e-7 && costChange < 1e-10)
+            break;
+
+        dipoleField(sensors, pos, mom, field, &J, applyTra);
+        field -= data;
+    }
+
+    return cost / dataNorm;
+}
+
+/*********************************************************************************
+ * dipoleField computes the field of a magnetic dipole in an infinite medium
+ * (same model as magnetic_dipole) and its analytic Jacobian
+ *********************************************************************************/
+
+void RtHPIS::dipoleField(const struct sens& sensors, const Eigen::Vector3d& pos, const Eigen::Vector3d& mom, Eigen::VectorXd& field, Eigen::MatrixXd* jacobian, bool applyTra)
+{
+    const double c = 1e-7 / (4 * M_PI);
+    int nchan = sensors.coilpos.rows();
+    Eigen::Vector3d R, o;
+    double r2, r5, Rm, Ro, mo, b;
+
+    field.resize(nchan);
+    if(jacobian)
+        jacobian->resize(nchan,6);
+
+    for(int i = 0;i < nchan;i++) {
+        R = sensors.coilpos.row(i).transpose() - pos;
+        o = sensors.coilori.row(i).transpose();
+
+        r2 = R.squaredNorm();
+        r5 = r2 * r2 * std::sqrt(r2);
+        Rm = R.dot(mom);
+        Ro = R.dot(o);
+        mo = mom.dot(o);
+
+        b = c * (3 * Rm * Ro - mo * r2) / r5;
+        field(i) = b;
+
+        if(jacobian) {
+            // d/dpos = -d/dR
+            jacobian->block(i,0,1,3) = -(c * (3 * (mom * Ro + o * Rm) - 2 * mo * R) / r5 - 5 * b * R / r2).transpose();
+            jacobian->block(i,3,1,3) = (c * (3 * R * Ro - o * r2) / r5).transpose();
+        }
+    }
+
+    if(applyTra) {
+        field = sensors.tra * field;
+        if(jacobian)
+            *jacobian = sensors.tra * *jacobian;
+    }
+}
+
 /*********************************************************************************
  * fminsearch Multidimensional unconstrained nonlinear minimization (Nelder-Mead).
  * X = fminsearch(X0, maxiter, maxfun, display, data, sensors) starts at X0 and
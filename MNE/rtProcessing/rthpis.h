@@ -118,6 +118,14 @@ struct sens {
     Eigen::MatrixXd tra;
 };
 
+struct coilFit {
+    Eigen::Vector3d pos;            /**< Fitted coil position (in: start position). */
+    Eigen::Vector3d mom;            /**< Fitted coil moment. */
+    double error;                   /**< Relative residual of the fit (in: error of the previous fit, < 0 if none). */
+    Eigen::VectorXd data;           /**< Demodulated coil amplitudes per sensor. */
+    const struct sens* sensors;     /**< Sensors the amplitudes belong to. */
+};
+
 
 //=============================================================================================================
 /**
@@ -164,6 +172,17 @@ public:
     */
     inline bool isRunning();
 
+    //=========================================================================================================
+    /**
+    * Sets the length of the data window the coil amplitudes are demodulated from and how often the coils are
+    * localized. Overlapping windows are allowed, i.e. p_dFitInterval can be shorter than p_dWindowLength.
+    * Has to be set before start().
+    *
+    * @param[in] p_dWindowLength    Length of the demodulation window in seconds (default 0.25)
+    * @param[in] p_dFitInterval     Time between two localizations in seconds (default 0.1)
+    */
+    void setFitTiming(double p_dWindowLength, double p_dFitInterval);
+
 
     //=========================================================================================================
     /**
@@ -185,6 +204,36 @@ public:
     Eigen::MatrixXd ft_compute_leadfield(Eigen::MatrixXd, struct sens);
     Eigen::MatrixXd magnetic_dipole(Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd);
     coilParam dipfit(struct coilParam, struct sens, Eigen::MatrixXd, int numCoils);
+
+    //=========================================================================================================
+    /**
+    * Fits all coils in parallel with Levenberg-Marquardt. Each fit is warm-started from the coil position of the
+    * previous call; coils without a valid previous fit, or whose warm-started fit is poor, are additionally
+    * started from the origin and from below the strongest sensor.
+    *
+    * @param[in] coil       Coil positions and moments of the previous fit.
+    * @param[in] sensors    The sensors.
+    * @param[in] data       Demodulated amplitudes (sensors x coils).
+    * @param[in] numCoils   Number of coils.
+    *
+    * @return the fitted coil positions and moments.
+    */
+    coilParam dipfitLM(const struct coilParam& coil, const struct sens& sensors, const Eigen::MatrixXd& data, int numCoils);
+
+    //=========================================================================================================
+    /**
+    * Fits a single magnetic dipole with Levenberg-Marquardt, using the analytic Jacobian of the dipole field with
+    * respect to position and moment.
+    *
+    * @param[in] sensors    The sensors.
+    * @param[in] data       Measured field per sensor.
+    * @param[in, out] pos   Start position, replaced by the fitted position.
+    * @param[out] mom       The fitted moment.
+    * @param[in] maxIter    Maximal number of iterations.
+    *
+    * @return the relative residual of the fit.
+    */
+    static double fitDipoleLM(const struct sens& sensors, const Eigen::VectorXd& data, Eigen::Vector3d& pos, Eigen::Vector3d& mom, int maxIter = 50);
     Eigen::MatrixXd fminsearch(Eigen::MatrixXd,int, int, int, Eigen::MatrixXd, struct sens);
     static bool compar (int, int);
     Eigen::MatrixXd pinv(Eigen::MatrixXd);
@@ -211,6 +260,21 @@ protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Field of a magnetic dipole at the sensors and, optionally, its Jacobian with respect to position (first
+    * three columns) and moment (last three columns). The sensor transformation sens::tra is applied if applyTra
+    * is set.
+    */
+    static void dipoleField(const struct sens& sensors, const Eigen::Vector3d& pos, const Eigen::Vector3d& mom, Eigen::VectorXd& field, Eigen::MatrixXd* jacobian, bool applyTra);
+
+    //=========================================================================================================
+    /**
+    * Multi-start fit of one coil, used as QtConcurrent map function by dipfitLM.
+    */
+    static void fitCoil(coilFit& fit);
+
+
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
     quint32      m_iMaxSamples;         /**< Maximal amount of samples received, before covariance is estimated.*/
@@ -223,6 +287,9 @@ private:
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 
+    double      m_dWindowLength;        /**< Length of the demodulation window in seconds. */
+    double      m_dFitInterval;         /**< Time between two localizations in seconds. */
+
 //    QVector <float> m_fWin;
 
 //    double m_Fs;
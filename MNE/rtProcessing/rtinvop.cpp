@@ -65,6 +65,9 @@ using namespace RTINVLIB;
 
 RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo, MNEForwardSolution::SPtr &p_pFwd, QObject *parent)
 : QThread(parent)
+, m_bIsRunning(false)
+, m_svdMethod(MNEInverseOperator::SvdGram)
+, m_iSvdRank(-1)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
 {
@@ -94,6 +97,16 @@ void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 }
 
 
+//*************************************************************************************************************
+
+void RtInvOp::setSvdMethod(MNEInverseOperator::SvdMethod p_svdMethod, qint32 p_iSvdRank)
+{
+    QMutexLocker locker(&mutex);
+    m_svdMethod = p_svdMethod;
+    m_iSvdRank = p_iSvdRank;
+}
+
+
 //*************************************************************************************************************
 
 bool RtInvOp::stop()
@@ -111,19 +124,31 @@ void RtInvOp::run()
 {
     m_bIsRunning = true;
 
+    // Restrict forward solution as necessary for MEG
+    MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
+
     while(m_bIsRunning)
     {
-        if(m_vecNoiseCov.size() > 0)
+        mutex.lock();
+        bool t_bNewCov = m_vecNoiseCov.size() > 0;
+        FiffCov t_noiseCov;
+        if(t_bNewCov)
         {
-            // Restrict forward solution as necessary for MEG
-            MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
+            // Only the latest covariance is of interest, older ones are outdated
+            t_noiseCov = m_vecNoiseCov.last();
+            m_vecNoiseCov.clear();
+        }
+        MNEInverseOperator::SvdMethod t_svdMethod = m_svdMethod;
+        qint32 t_iSvdRank = m_iSvdRank;
+        mutex.unlock();
 
-            mutex.lock();
-            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, m_vecNoiseCov[0], 0.2f, 0.8f));
-            m_vecNoiseCov.pop_front();
-            mutex.unlock();
+        if(t_bNewCov)
+        {
+            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, t_noiseCov, 0.2f, 0.8f, false, true, t_svdMethod, t_iSvdRank));
 
             emit invOperatorCalculated(t_invOpMeg);
         }
+        else
+            QThread::msleep(10);
     }
 }
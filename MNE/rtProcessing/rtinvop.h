@@ -134,6 +134,16 @@ public:
     */
     void appendNoiseCov(FiffCov &p_NoiseCov);
 
+    //=========================================================================================================
+    /**
+    * Sets the decomposition used to build the inverse operators. Defaults to the Gram matrix decomposition,
+    * which is fast enough to rebuild the operator for every incoming noise covariance.
+    *
+    * @param[in] p_svdMethod    Decomposition of the whitened lead field
+    * @param[in] p_iSvdRank     Number of components kept by the randomized SVD, <= 0 keeps all
+    */
+    void setSvdMethod(MNEInverseOperator::SvdMethod p_svdMethod, qint32 p_iSvdRank = -1);
+
     //=========================================================================================================
     /**
     * Stops the RtInv by stopping the producer's thread.
@@ -174,6 +184,9 @@ private:
 
     QVector<FiffCov> m_vecNoiseCov;     /**< Noise covariance matrices. */
 
+    MNEInverseOperator::SvdMethod m_svdMethod;  /**< Decomposition of the whitened lead field. */
+    qint32      m_iSvdRank;             /**< Number of components kept by the randomized SVD. */
+
     FiffInfo::SPtr m_pFiffInfo;         /**< The fiff measurement information. */
     MNEForwardSolution::SPtr m_pFwd;    /**< The forward solution. */
 };
@@ -82,14 +82,6 @@ RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_data
     m_Fs = m_pFiffInfo->sfreq;
 
     SendDataToBuffer = true;
-
-    m_fWin.clear();
-
-    //create a hanning window
-    m_fWin = hanning(m_iFFTlength,0);
-
-    qDebug()<<"Hanning window is created.";
-
 }
 
 
@@ -104,52 +96,6 @@ RtNoise::~RtNoise()
 
 //*************************************************************************************************************
 
-QVector <float> RtNoise::hanning(int N, short itype)
-{
-    int half, i, idx, n;
-    QVector <float> w(N,0.0);
-
-    if(itype==1)    //periodic function
-        n = N-1;
-    else
-        n = N;
-
-    if(n%2==0)
-    {
-        half = n/2;
-        for(i=0; i<half; i++) //CALC_HANNING   Calculates Hanning window samples.
-            w[i] = 0.5 * (1 - cos(2*3.14159265*(i+1) / (n+1)));
-
-        idx = half-1;
-        for(i=half; i<n; i++) {
-            w[i] = w[idx];
-            idx--;
-        }
-    }
-    else
-    {
-        half = (n+1)/2;
-        for(i=0; i<half; i++) //CALC_HANNING   Calculates Hanning window samples.
-            w[i] = 0.5 * (1 - cos(23.14159265*(i+1) / (n+1)));
-
-        idx = half-2;
-        for(i=half; i<n; i++) {
-            w[i] = w[idx];
-            idx--;
-        }
-    }
-
-    if(itype==1)    //periodic function
-    {
-        for(i=N-1; i>=1; i--)
-            w[i] = w[i-1];
-        w[0] = 0.0;
-    }
-    return(w);
-}
-
-//*************************************************************************************************************
-
 void RtNoise::append(const MatrixXd &p_DataSegment)
 {
     if(!m_pRawMatrixBuffer)
@@ -168,6 +114,9 @@ bool RtNoise::start()
     if(this->isRunning())
         QThread::wait();
 
+    //The estimator is created with the first block of the new run
+    m_pWelchPsd.clear();
+
     m_bIsRunning = true;
     QThread::start();
 
@@ -181,9 +130,11 @@ bool RtNoise::stop()
 {
     m_bIsRunning = false;
 
-    m_pRawMatrixBuffer->releaseFromPop();
-
-    m_pRawMatrixBuffer->clear();
+    if(m_pRawMatrixBuffer)
+    {
+        m_pRawMatrixBuffer->releaseFromPop();
+        m_pRawMatrixBuffer->clear();
+    }
 
     qDebug()<<" RtNoise Thread is stopped.";
 
@@ -195,114 +146,37 @@ bool RtNoise::stop()
 
 void RtNoise::run()
 {
-    bool FirstStart = true;
-
     while(m_bIsRunning)
     {
         if(m_pRawMatrixBuffer)
         {
             MatrixXd block = m_pRawMatrixBuffer->pop();
 
-            if(FirstStart){
-                //init the circ buffer and parameters
-                if(m_dataLength < 0) m_dataLength = 10;
-                NumOfBlocks = m_dataLength;//60;
-                BlockSize =  block.cols();
-                Sensors =  block.rows();
+            if(!m_bIsRunning || block.size() == 0)
+                continue;
+
+            if(!m_pWelchPsd)
+            {
+                //At least 50% overlap and at least one new segment per block -> the spectrum is refreshed with every block
+                qint32 t_iStep = qMax(1, qMin(m_iFFTlength/2, (qint32)block.cols()));
 
-                CircBuf.resize(Sensors,NumOfBlocks*BlockSize);
+                //Average over the requested data length
+                if(m_dataLength < 0) m_dataLength = 10;
+                qint32 t_iNumAverages = qMax(1, (qint32)(m_dataLength*block.cols()/t_iStep));
 
-                BlockIndex = 0;
-                FirstStart = false;
+                m_pWelchPsd = WelchPsd::SPtr(new WelchPsd(block.rows(), m_iFFTlength, m_Fs, 1.0 - (double)t_iStep/m_iFFTlength, WelchPsd::Hanning, t_iNumAverages));
             }
-            //concate blocks
-            for (int i=0; i< Sensors; i++)
-                for (int j=0; j< BlockSize; j++)
-                    CircBuf(i,j+BlockIndex*BlockSize) = block(i,j);
-
-
-            BlockIndex ++;
-            if (BlockIndex >= NumOfBlocks){
-
-                //m_pRawMatrixBuffer.clear(); //empty the buffer
-
-                SendDataToBuffer = false;
-                //stop collect block and start to calculate the spectrum
-                BlockIndex = 0;
-
-                MatrixXd sum_psdx = MatrixXd::Zero(Sensors,m_iFFTlength/2+1);
-
-                int nb = floor(NumOfBlocks*BlockSize/m_iFFTlength)+1;
-                qDebug()<<"nb"<<nb<<"NumOfBlocks"<<NumOfBlocks<<"BlockSize"<<BlockSize;
-                MatrixXd t_mat(Sensors,m_iFFTlength);
-                MatrixXd t_psdx(Sensors,m_iFFTlength/2+1);
-                for (int n = 0; n<nb; n++){
-                    //collect a data block with data length of m_iFFTlength;
-                    if(n==nb-1)
-                    {
-                        for(qint32 ii=0; ii<Sensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            if(jj+n*m_iFFTlength<NumOfBlocks*BlockSize)
-                                t_mat(ii,jj) = CircBuf(ii,jj+n*m_iFFTlength);
-                            else
-                                t_mat(ii,jj) = 0.0;
-
-                    }
-                    else
-                    {
-                        for(qint32 ii=0; ii<Sensors; ii++)
-                        for(qint32 jj=0; jj<m_iFFTlength; jj++)
-                            t_mat(ii,jj) = CircBuf(ii,jj+n*m_iFFTlength);
-                    }
-
-                    //FFT calculation by row
-                    for(qint32 i = 0; i < t_mat.rows(); i++){
-                        RowVectorXd data;
-
-                        data = t_mat.row(i);
-
-                        //zero-pad data to m_iFFTlength
-                        RowVectorXd t_dataZeroPad = RowVectorXd::Zero(m_iFFTlength);
-                        t_dataZeroPad.head(data.cols()) = data;
-
-                        for (qint32 lk = 0; lk<m_iFFTlength; lk++)
-                            t_dataZeroPad[lk] = t_dataZeroPad[lk]*m_fWin[lk];
-
-                        //generate fft object
-                        Eigen::FFT<double> fft;
-                        fft.SetFlag(fft.HalfSpectrum);
-
-                        //fft-transform data sequence
-                        RowVectorXcd t_freqData(m_iFFTlength/2+1);
-                        fft.fwd(t_freqData,t_dataZeroPad);
-
-                        // calculate spectrum from FFT
-                        for(qint32 j=0; j<m_iFFTlength/2+1;j++)
-                        {
-                            double mag_abs = sqrt(t_freqData(j).real()* t_freqData(j).real() +  t_freqData(j).imag()*t_freqData(j).imag());
-                            double spower = (1.0/(m_Fs*m_iFFTlength))* mag_abs;
-                            if (j>0&&j<m_iFFTlength/2) spower = 2.0*spower;
-                            sum_psdx(i,j) = sum_psdx(i,j) + spower;
-                        }
-                     }//row computing is done
-                }//nb
 
+            if(m_pWelchPsd->append(block) > 0)
+            {
                 //DB-calculation
-                for(qint32 ii=0; ii<Sensors; ii++)
-                    for(qint32 jj=0; jj<m_iFFTlength/2+1; jj++)
-                        t_psdx(ii,jj) = 10.0*log10(sum_psdx(ii,jj)/nb);
+                MatrixXd t_psdx = m_pWelchPsd->psd();
+                for(qint32 ii = 0; ii < t_psdx.rows(); ++ii)
+                    for(qint32 jj = 0; jj < t_psdx.cols(); ++jj)
+                        t_psdx(ii,jj) = 10.0*log10(t_psdx(ii,jj));
 
-                qDebug()<<"Send spectrum to Noise Estimator";
                 emit SpecCalculated(t_psdx); //send back the spectrum result
-                if(m_pRawMatrixBuffer->size()>0)
-                    m_pRawMatrixBuffer->clear();
-
-                SendDataToBuffer = true;
             }
-
         }
-
     }
-
 }
-
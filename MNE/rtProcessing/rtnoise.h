@@ -62,6 +62,14 @@
 #include <generics/circularmatrixbuffer.h>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// UTILS INCLUDES
+//=============================================================================================================
+
+#include <utils/welchpsd.h>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
@@ -78,7 +86,6 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
-#include <unsupported/Eigen/FFT>
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -97,11 +104,13 @@ namespace RTINVLIB
 using namespace Eigen;
 using namespace IOBuffer;
 using namespace FIFFLIB;
+using namespace UTILSLIB;
 
 
 //=============================================================================================================
 /**
-* Real-time noise Spectrum estimation
+* Real-time noise Spectrum estimation. The spectrum is estimated after Welch with 50% overlapping Hanning
+* windowed segments and updated with every incoming block.
 *
 * @brief Real-time Noise estimation
 */
@@ -116,8 +125,9 @@ public:
     /**
     * Creates the real-time covariance estimation object.
     *
-    * @param[in] p_iMaxSamples      Number of samples to use for each data chunk
+    * @param[in] p_iMaxSamples      FFT length, number of samples of each segment
     * @param[in] p_pFiffInfo        Associated Fiff Information
+    * @param[in] p_dataLen          Number of blocks the spectrum is averaged over
     * @param[in] parent     Parent QObject (optional)
     */
     explicit RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_dataLen, QObject *parent = 0);
@@ -164,9 +174,9 @@ public:
 signals:
     //=========================================================================================================
     /**
-    * Signal which is emitted when a new data Matrix is estimated.
+    * Signal which is emitted when a new spectrum is estimated.
     *
-    * @param[out]
+    * @param[out] the power spectral density in dB (channels x FFT length/2+1)
     */
     void SpecCalculated(Eigen::MatrixXd);
 
@@ -179,8 +189,6 @@ protected:
     */
     virtual void run();
 
-    QVector <float> hanning(int N, short itype);
-
 private:
     QMutex      mutex;                  /**< Provides access serialization between threads*/
 
@@ -194,21 +202,13 @@ private:
 
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 
-    QVector <float> m_fWin;
+    WelchPsd::SPtr m_pWelchPsd;         /**< Welch spectrum estimator, created with the first block. */
 
     double m_Fs;
 
     qint32 m_iFFTlength;
     qint32 m_dataLength;
 
-protected:
-    int NumOfBlocks;
-    int BlockSize  ;
-    int Sensors    ;
-    int BlockIndex ;
-
-    MatrixXd CircBuf;
-
 public:
     MatrixXd SpecData;
     QMutex ReadMutex;
@@ -0,0 +1,321 @@
+//=============================================================================================================
+/**
+* @file     babymegparser.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    BabyMEGParser class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "babymegparser.h"
+
+#include <string.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QIODevice>
+#include <QtEndian>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+BabyMEGParser::BabyMEGParser(qint32 p_iCapacity)
+: m_iHead(0)
+, m_iSize(0)
+, m_bHeaderValid(false)
+, m_iFrameLength(0)
+{
+    m_baRing.resize(qMax(p_iCapacity, 16));
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::clear()
+{
+    m_iHead = 0;
+    m_iSize = 0;
+    m_bHeaderValid = false;
+    m_iFrameLength = 0;
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::append(const char* p_pData, qint64 p_iSize)
+{
+    if(p_iSize <= 0)
+        return;
+
+    reserve(p_iSize);
+
+    qint64 t_iCapacity = m_baRing.size();
+    qint64 t_iTail = (m_iHead + m_iSize) % t_iCapacity;
+    qint64 t_iFirst = qMin(p_iSize, t_iCapacity - t_iTail);
+
+    char* t_pRing = m_baRing.data();
+    memcpy(t_pRing + t_iTail, p_pData, t_iFirst);
+    memcpy(t_pRing, p_pData + t_iFirst, p_iSize - t_iFirst);
+
+    m_iSize += p_iSize;
+}
+
+
+//*************************************************************************************************************
+
+qint64 BabyMEGParser::readFrom(QIODevice* p_pDevice)
+{
+    qint64 t_iAvailable = p_pDevice->bytesAvailable();
+    if(t_iAvailable <= 0)
+        return 0;
+
+    reserve(t_iAvailable);
+
+    qint64 t_iCapacity = m_baRing.size();
+    qint64 t_iTail = (m_iHead + m_iSize) % t_iCapacity;
+    qint64 t_iFirst = qMin(t_iAvailable, t_iCapacity - t_iTail);
+
+    //Read into the free span(s) of the ring, no intermediate byte array
+    char* t_pRing = m_baRing.data();
+    qint64 t_iRead = p_pDevice->read(t_pRing + t_iTail, t_iFirst);
+    if(t_iRead < 0)
+        return -1;
+
+    if(t_iRead == t_iFirst && t_iAvailable > t_iFirst)
+    {
+        qint64 t_iSecond = p_pDevice->read(t_pRing, t_iAvailable - t_iFirst);
+        if(t_iSecond > 0)
+            t_iRead += t_iSecond;
+    }
+
+    m_iSize += t_iRead;
+
+    return t_iRead;
+}
+
+
+//*************************************************************************************************************
+
+bool BabyMEGParser::hasFrame()
+{
+    if(!m_bHeaderValid)
+    {
+        if(m_iSize < 8)
+            return false;
+
+        uchar t_header[8];
+        peek(0, (char*)t_header, 8);
+
+        memcpy(m_cCommand, t_header, 4);
+        m_iFrameLength = qFromBigEndian<qint32>(t_header + 4);
+        m_bHeaderValid = true;
+
+        if(m_iFrameLength < 0)
+        {
+            qWarning("BabyMEGParser::hasFrame: Invalid frame length %d, discarding the buffer.", m_iFrameLength);
+            clear();
+            return false;
+        }
+    }
+
+    return m_iSize >= 8 + (qint64)m_iFrameLength;
+}
+
+
+//*************************************************************************************************************
+
+QByteArray BabyMEGParser::command() const
+{
+    return QByteArray(m_cCommand, 4);
+}
+
+
+//*************************************************************************************************************
+
+QByteArray BabyMEGParser::takeBody()
+{
+    QByteArray t_baBody(m_iFrameLength, Qt::Uninitialized);
+    peek(8, t_baBody.data(), m_iFrameLength);
+
+    skipFrame();
+
+    return t_baBody;
+}
+
+
+//*************************************************************************************************************
+
+bool BabyMEGParser::takeData(MatrixXf& p_matData, qint32 p_iNumChannels)
+{
+    if(m_iFrameLength < 1 || p_iNumChannels <= 0)
+    {
+        skipFrame();
+        return false;
+    }
+
+    //The first body byte holds the number of bytes per sample as ascii digit
+    char t_cFormat;
+    peek(8, &t_cFormat, 1);
+    qint32 t_iFormat = t_cFormat - '0';
+
+    if(t_iFormat != (qint32)sizeof(float))
+    {
+        qWarning("BabyMEGParser::takeData: Data format %d is not supported.", t_iFormat);
+        skipFrame();
+        return false;
+    }
+
+    qint32 t_iNumSamples = (m_iFrameLength - 1)/t_iFormat/p_iNumChannels;
+    if(p_matData.rows() != p_iNumChannels || p_matData.cols() != t_iNumSamples)
+        p_matData.resize(p_iNumChannels, t_iNumSamples);
+
+    //Convert the contiguous parts of the ring directly into the matrix, a float split by the ring end is
+    //assembled separately
+    qint64 t_iCapacity = m_baRing.size();
+    const uchar* t_pRing = (const uchar*)m_baRing.constData();
+    float* t_pDst = p_matData.data();
+    qint64 t_iCount = (qint64)p_iNumChannels*t_iNumSamples;
+    qint64 t_iOffset = 9;
+
+    while(t_iCount > 0)
+    {
+        qint64 t_iPos = (m_iHead + t_iOffset) % t_iCapacity;
+        qint64 t_iContiguous = qMin(t_iCount, (t_iCapacity - t_iPos)/4);
+
+        if(t_iContiguous > 0)
+        {
+            fromBigEndian(t_pRing + t_iPos, t_pDst, t_iContiguous);
+        }
+        else
+        {
+            uchar t_value[4];
+            peek(t_iOffset, (char*)t_value, 4);
+            fromBigEndian(t_value, t_pDst, 1);
+            t_iContiguous = 1;
+        }
+
+        t_pDst += t_iContiguous;
+        t_iOffset += 4*t_iContiguous;
+        t_iCount -= t_iContiguous;
+    }
+
+    skipFrame();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::skipFrame()
+{
+    if(!m_bHeaderValid)
+        return;
+
+    consume(qMin(m_iSize, 8 + (qint64)m_iFrameLength));
+    m_bHeaderValid = false;
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::fromBigEndian(const uchar* p_pSrc, float* p_pDst, qint64 p_iCount)
+{
+    quint32* t_pDst = (quint32*)p_pDst;
+
+    for(qint64 i = 0; i < p_iCount; ++i)
+        t_pDst[i] = qFromBigEndian<quint32>(p_pSrc + 4*i);
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::peek(qint64 p_iOffset, char* p_pDst, qint64 p_iSize) const
+{
+    qint64 t_iCapacity = m_baRing.size();
+    qint64 t_iPos = (m_iHead + p_iOffset) % t_iCapacity;
+    qint64 t_iFirst = qMin(p_iSize, t_iCapacity - t_iPos);
+
+    const char* t_pRing = m_baRing.constData();
+    memcpy(p_pDst, t_pRing + t_iPos, t_iFirst);
+    memcpy(p_pDst + t_iFirst, t_pRing, p_iSize - t_iFirst);
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::reserve(qint64 p_iSize)
+{
+    qint64 t_iCapacity = m_baRing.size();
+    if(m_iSize + p_iSize <= t_iCapacity)
+        return;
+
+    qint64 t_iNewCapacity = t_iCapacity;
+    while(t_iNewCapacity < m_iSize + p_iSize)
+        t_iNewCapacity *= 2;
+
+    //Only happens for frames larger than the ring, the pending bytes are linearized once
+    QByteArray t_baRing(t_iNewCapacity, Qt::Uninitialized);
+    peek(0, t_baRing.data(), m_iSize);
+
+    m_baRing = t_baRing;
+    m_iHead = 0;
+}
+
+
+//*************************************************************************************************************
+
+void BabyMEGParser::consume(qint64 p_iSize)
+{
+    m_iHead = (m_iHead + p_iSize) % m_baRing.size();
+    m_iSize -= p_iSize;
+
+    if(m_iSize == 0)
+        m_iHead = 0;
+}
@@ -0,0 +1,257 @@
+//=============================================================================================================
+/**
+* @file     babymegparser.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    BabyMEGParser class declaration.
+*
+*/
+
+#ifndef BABYMEGPARSER_H
+#define BABYMEGPARSER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+#include <QSharedPointer>
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Incremental parser of the BabyMEG TCP protocol. Each frame consists of a 4 byte command, a 4 byte big endian
+* body length and the body. Received bytes are read straight into a ring buffer, headers are decoded in place
+* and consumed frames only move the read position, so no pending data is shifted or reallocated. Data frames
+* (a format byte followed by big endian floats, channels x samples) are converted directly into a caller
+* provided matrix.
+*
+* @brief Ring buffer based frame parser of the BabyMEG protocol
+*/
+class UTILSSHARED_EXPORT BabyMEGParser
+{
+public:
+    typedef QSharedPointer<BabyMEGParser> SPtr;             /**< Shared pointer type for BabyMEGParser. */
+    typedef QSharedPointer<const BabyMEGParser> ConstSPtr;  /**< Const shared pointer type for BabyMEGParser. */
+
+    //=========================================================================================================
+    /**
+    * Creates the parser.
+    *
+    * @param[in] p_iCapacity    Initial ring buffer size in bytes, the buffer grows if a frame doesn't fit.
+    */
+    explicit BabyMEGParser(qint32 p_iCapacity = 4*1024*1024);
+
+    //=========================================================================================================
+    /**
+    * Discards all buffered bytes.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Appends received bytes.
+    *
+    * @param[in] p_pData    Received bytes.
+    * @param[in] p_iSize    Number of bytes.
+    */
+    void append(const char* p_pData, qint64 p_iSize);
+
+    //=========================================================================================================
+    /**
+    * Reads all available bytes of a device directly into the ring buffer.
+    *
+    * @param[in] p_pDevice  Device to read from, e.g. a connected QTcpSocket.
+    *
+    * @return the number of bytes read, -1 on a read error.
+    */
+    qint64 readFrom(QIODevice* p_pDevice);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the next frame is completely buffered.
+    *
+    * @return true if the next frame can be taken.
+    */
+    bool hasFrame();
+
+    //=========================================================================================================
+    /**
+    * Returns the command of the next frame. Requires hasFrame().
+    *
+    * @return the 4 byte command, e.g. "DATR".
+    */
+    QByteArray command() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the body length of the next frame. Requires hasFrame().
+    *
+    * @return the body length in bytes.
+    */
+    inline qint32 frameLength() const;
+
+    //=========================================================================================================
+    /**
+    * Copies the body of the next frame and consumes it. Meant for the small text frames (INFO, COMD, ...).
+    *
+    * @return the frame body.
+    */
+    QByteArray takeBody();
+
+    //=========================================================================================================
+    /**
+    * Converts the body of the next data frame into a channels x samples matrix and consumes the frame. The
+    * matrix is only resized if the block size changed.
+    *
+    * @param[out] p_matData         Decoded samples.
+    * @param[in] p_iNumChannels     Number of channels (rows).
+    *
+    * @return true if the frame contained float samples of the given channel count.
+    */
+    bool takeData(MatrixXf& p_matData, qint32 p_iNumChannels);
+
+    //=========================================================================================================
+    /**
+    * Consumes the next frame without decoding it.
+    */
+    void skipFrame();
+
+    //=========================================================================================================
+    /**
+    * Returns the number of buffered bytes.
+    *
+    * @return buffered bytes.
+    */
+    inline qint64 size() const;
+
+    //=========================================================================================================
+    /**
+    * Converts big endian 32 bit floats to host floats. Written as a plain loop so the compiler can vectorize
+    * the byte swap.
+    *
+    * @param[in] p_pSrc     Big endian source bytes.
+    * @param[out] p_pDst    Host order destination.
+    * @param[in] p_iCount   Number of floats.
+    */
+    static void fromBigEndian(const uchar* p_pSrc, float* p_pDst, qint64 p_iCount);
+
+private:
+    //=========================================================================================================
+    /**
+    * Copies buffered bytes without consuming them.
+    *
+    * @param[in] p_iOffset  Offset to the read position.
+    * @param[out] p_pDst    Destination.
+    * @param[in] p_iSize    Number of bytes.
+    */
+    void peek(qint64 p_iOffset, char* p_pDst, qint64 p_iSize) const;
+
+    //=========================================================================================================
+    /**
+    * Makes sure that p_iSize bytes can be appended, grows and linearizes the ring buffer if necessary.
+    *
+    * @param[in] p_iSize    Number of bytes to append.
+    */
+    void reserve(qint64 p_iSize);
+
+    //=========================================================================================================
+    /**
+    * Consumes bytes.
+    *
+    * @param[in] p_iSize    Number of bytes.
+    */
+    void consume(qint64 p_iSize);
+
+    QByteArray  m_baRing;           /**< Ring buffer. */
+    qint64      m_iHead;            /**< Read position. */
+    qint64      m_iSize;            /**< Number of buffered bytes. */
+
+    bool        m_bHeaderValid;     /**< Whether the header of the next frame is decoded. */
+    char        m_cCommand[4];      /**< Command of the next frame. */
+    qint32      m_iFrameLength;     /**< Body length of the next frame. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 BabyMEGParser::frameLength() const
+{
+    return m_iFrameLength;
+}
+
+
+//*************************************************************************************************************
+
+inline qint64 BabyMEGParser::size() const
+{
+    return m_iSize;
+}
+
+} // NAMESPACE
+
+#endif // BABYMEGPARSER_H
@@ -0,0 +1,251 @@
+//=============================================================================================================
+/**
+* @file     overlapsavefilter.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    OverlapSaveFilter class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "overlapsavefilter.h"
+
+#include <math.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+OverlapSaveFilter::OverlapSaveFilter(const RowVectorXd& p_vecCoeffs, qint32 p_iNumChannels, PhaseMode p_mode)
+: m_mode(p_mode)
+, m_vecCoeffs(p_vecCoeffs)
+, m_iDelay(p_vecCoeffs.cols()/2)
+{
+    init(p_iNumChannels);
+}
+
+
+//*************************************************************************************************************
+
+OverlapSaveFilter::OverlapSaveFilter(const QList<FilterData>& p_filters, qint32 p_iNumChannels, PhaseMode p_mode)
+: m_mode(p_mode)
+, m_vecCoeffs(RowVectorXd::Ones(1))
+, m_iDelay(0)
+{
+    //Cascaded FIR filters are one FIR filter with the convolved coefficients
+    for(qint32 i = 0; i < p_filters.size(); ++i)
+    {
+        const RowVectorXd& t_vecCoeffs = p_filters[i].m_dCoeffA;
+        if(t_vecCoeffs.cols() == 0)
+            continue;
+
+        RowVectorXd t_vecCascade = RowVectorXd::Zero(m_vecCoeffs.cols() + t_vecCoeffs.cols() - 1);
+        for(qint32 k = 0; k < t_vecCoeffs.cols(); ++k)
+            t_vecCascade.segment(k, m_vecCoeffs.cols()) += t_vecCoeffs[k]*m_vecCoeffs;
+
+        m_vecCoeffs = t_vecCascade;
+        m_iDelay += t_vecCoeffs.cols()/2;
+    }
+
+    init(p_iNumChannels);
+}
+
+
+//*************************************************************************************************************
+
+void OverlapSaveFilter::reset()
+{
+    m_matHistory.setZero();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd OverlapSaveFilter::process(const MatrixXd& p_matData)
+{
+    MatrixXd t_matFiltered;
+    process(p_matData, t_matFiltered);
+
+    return t_matFiltered;
+}
+
+
+//*************************************************************************************************************
+
+void OverlapSaveFilter::process(const MatrixXd& p_matData, MatrixXd& p_matFiltered)
+{
+    if(p_matData.rows() != m_iNumChannels)
+    {
+        qWarning("OverlapSaveFilter::process: Number of rows (%d) doesn't match the number of channels (%d).", (int)p_matData.rows(), m_iNumChannels);
+        p_matFiltered = p_matData;
+        return;
+    }
+
+    if(p_matFiltered.rows() != p_matData.rows() || p_matFiltered.cols() != p_matData.cols())
+        p_matFiltered.resize(p_matData.rows(), p_matData.cols());
+
+    if(p_matData.cols() == 0)
+        return;
+
+    //Keep the plan as long as the block length doesn't change
+    if(p_matData.cols() != m_iBlockLength)
+        plan(p_matData.cols());
+
+    m_pData = &p_matData;
+    m_pFiltered = &p_matFiltered;
+
+    if(m_qVecChunks.size() == 1)
+        processChunk(m_qVecChunks[0]);
+    else
+        QtConcurrent::blockingMap(m_qVecChunks, processChunk);
+
+    m_pData = 0;
+    m_pFiltered = 0;
+}
+
+
+//*************************************************************************************************************
+
+void OverlapSaveFilter::init(qint32 p_iNumChannels)
+{
+    m_iNumChannels = p_iNumChannels > 0 ? p_iNumChannels : 1;
+    m_iBlockLength = 0;
+    m_iFFTLength = 0;
+    m_pData = 0;
+    m_pFiltered = 0;
+
+    if(m_vecCoeffs.cols() == 0)
+    {
+        qWarning("OverlapSaveFilter: No filter coefficients, data is passed through.");
+        m_vecCoeffs = RowVectorXd::Ones(1);
+        m_iDelay = 0;
+    }
+
+    m_matHistory = MatrixXd::Zero(m_iNumChannels, m_vecCoeffs.cols() - 1);
+
+    //One work package with its own FFT plan per thread
+    qint32 t_iNumChunks = qMax(1, qMin(QThread::idealThreadCount(), m_iNumChannels));
+    m_qVecChunks.resize(t_iNumChunks);
+
+    qint32 t_iStart = 0;
+    for(qint32 i = 0; i < t_iNumChunks; ++i)
+    {
+        ChannelChunk& t_chunk = m_qVecChunks[i];
+        t_chunk.Filter = this;
+        t_chunk.StartChannel = t_iStart;
+        t_chunk.NumChannels = m_iNumChannels/t_iNumChunks + (i < m_iNumChannels%t_iNumChunks ? 1 : 0);
+        t_chunk.Fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+        t_iStart += t_chunk.NumChannels;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void OverlapSaveFilter::plan(qint32 p_iBlockLength)
+{
+    //history + block has to fit into the FFT, otherwise the circular convolution wraps into the valid samples
+    qint32 t_iHistory = m_vecCoeffs.cols() - 1;
+    m_iFFTLength = 16;
+    while(m_iFFTLength < t_iHistory + p_iBlockLength)
+        m_iFFTLength *= 2;
+
+    m_iBlockLength = p_iBlockLength;
+
+    VectorXd t_vecCoeffs = VectorXd::Zero(m_iFFTLength);
+    t_vecCoeffs.head(m_vecCoeffs.cols()) = m_vecCoeffs.transpose();
+
+    Eigen::FFT<double> t_fft;
+    t_fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    t_fft.fwd(m_vecFreqCoeffs, t_vecCoeffs);
+
+    for(qint32 i = 0; i < m_qVecChunks.size(); ++i)
+    {
+        m_qVecChunks[i].Filter = this;
+        m_qVecChunks[i].TimeData = VectorXd::Zero(m_iFFTLength);
+        m_qVecChunks[i].FreqData = VectorXcd::Zero(m_iFFTLength/2+1);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void OverlapSaveFilter::processChunk(ChannelChunk& p_chunk)
+{
+    OverlapSaveFilter* t_pFilter = p_chunk.Filter;
+
+    const MatrixXd& t_matData = *t_pFilter->m_pData;
+    MatrixXd& t_matFiltered = *t_pFilter->m_pFiltered;
+    MatrixXd& t_matHistory = t_pFilter->m_matHistory;
+
+    const qint32 t_iHistory = t_matHistory.cols();
+    const qint32 t_iLength = t_matData.cols();
+
+    for(qint32 ch = p_chunk.StartChannel; ch < p_chunk.StartChannel + p_chunk.NumChannels; ++ch)
+    {
+        //[history | block | zeros] -> the samples after the history are the linear convolution of the block
+        p_chunk.TimeData.head(t_iHistory) = t_matHistory.row(ch).transpose();
+        p_chunk.TimeData.segment(t_iHistory, t_iLength) = t_matData.row(ch).transpose();
+        p_chunk.TimeData.tail(t_pFilter->m_iFFTLength - t_iHistory - t_iLength).setZero();
+
+        //Keep the last taps-1 samples for the next block
+        if(t_iHistory > 0)
+            t_matHistory.row(ch) = p_chunk.TimeData.segment(t_iLength, t_iHistory).transpose();
+
+        p_chunk.Fft.fwd(p_chunk.FreqData, p_chunk.TimeData);
+        p_chunk.FreqData = p_chunk.FreqData.cwiseProduct(t_pFilter->m_vecFreqCoeffs);
+        p_chunk.Fft.inv(p_chunk.TimeData.data(), p_chunk.FreqData.data(), t_pFilter->m_iFFTLength);
+
+        t_matFiltered.row(ch) = p_chunk.TimeData.segment(t_iHistory, t_iLength).transpose();
+    }
+}
@@ -0,0 +1,271 @@
+//=============================================================================================================
+/**
+* @file     overlapsavefilter.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    OverlapSaveFilter class declaration.
+*
+*/
+
+#ifndef OVERLAPSAVEFILTER_H
+#define OVERLAPSAVEFILTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+#include "filterdata.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QVector>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Streaming multichannel FIR filter using the overlap-save method. The last taps-1 input samples of each channel
+* are kept across calls, so consecutive blocks of arbitrary length are filtered as one continuous signal without
+* any overlap bookkeeping by the caller. The FFT length is planned for the block length and kept until the block
+* length changes. The channels are filtered in parallel, each worker owns its FFT plan and work buffers.
+*
+* @brief Stateful overlap-save FIR filter for channel x sample blocks
+*/
+class UTILSSHARED_EXPORT OverlapSaveFilter
+{
+public:
+    typedef QSharedPointer<OverlapSaveFilter> SPtr;             /**< Shared pointer type for OverlapSaveFilter. */
+    typedef QSharedPointer<const OverlapSaveFilter> ConstSPtr;  /**< Const shared pointer type for OverlapSaveFilter. */
+
+    /**
+    * Alignment of the filtered samples.
+    */
+    enum PhaseMode {
+        Causal,         /**< Output sample n is the filter response at input sample n. */
+        ZeroPhase       /**< Output sample n belongs to input sample n-delay(), the group delay of the linear phase filter is compensated by a fixed latency. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the filter from FIR coefficients.
+    *
+    * @param[in] p_vecCoeffs        FIR coefficients.
+    * @param[in] p_iNumChannels     Number of channels (rows) of the filtered blocks.
+    * @param[in] p_mode             Alignment of the output (default ZeroPhase). The latency is half the number of taps.
+    */
+    OverlapSaveFilter(const RowVectorXd& p_vecCoeffs, qint32 p_iNumChannels, PhaseMode p_mode = ZeroPhase);
+
+    //=========================================================================================================
+    /**
+    * Creates the filter as cascade of FIR filters, i.e. the convolution of their coefficients.
+    *
+    * @param[in] p_filters          The filters which are applied one after the other.
+    * @param[in] p_iNumChannels     Number of channels (rows) of the filtered blocks.
+    * @param[in] p_mode             Alignment of the output (default ZeroPhase). The latency is the sum of the half
+    *                               filter lengths.
+    */
+    OverlapSaveFilter(const QList<FilterData>& p_filters, qint32 p_iNumChannels, PhaseMode p_mode = ZeroPhase);
+
+    //=========================================================================================================
+    /**
+    * Discards the channel history, the next block is filtered as if it was preceded by zeros.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Filters the next block of all channels.
+    *
+    * @param[in] p_matData      Block (channels x samples) of arbitrary length.
+    *
+    * @return the filtered block of the same size, aligned according to the phase mode.
+    */
+    MatrixXd process(const MatrixXd& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Filters the next block of all channels into a preallocated matrix.
+    *
+    * @param[in] p_matData          Block (channels x samples) of arbitrary length.
+    * @param[out] p_matFiltered     The filtered block, resized if it doesn't match the block size.
+    */
+    void process(const MatrixXd& p_matData, MatrixXd& p_matFiltered);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples the output lags behind the input.
+    *
+    * @return 0 in causal mode, the group delay in zero phase mode.
+    */
+    inline qint32 delay() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of filter taps.
+    *
+    * @return the number of taps.
+    */
+    inline qint32 numTaps() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of channels.
+    *
+    * @return the number of channels.
+    */
+    inline qint32 numChannels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the FFT length which is currently planned.
+    *
+    * @return the FFT length, 0 before the first block.
+    */
+    inline qint32 fftLength() const;
+
+private:
+    /**
+    * Work package of one worker: a range of channels with its own FFT plan and work buffers.
+    */
+    struct ChannelChunk
+    {
+        OverlapSaveFilter* Filter;  /**< The filter the chunk belongs to. */
+        qint32 StartChannel;        /**< First channel of the chunk. */
+        qint32 NumChannels;         /**< Number of channels of the chunk. */
+        Eigen::FFT<double> Fft;     /**< Persistent FFT plan of the worker. */
+        VectorXd TimeData;          /**< History followed by the new samples, zero padded to the FFT length. */
+        VectorXcd FreqData;         /**< Half spectrum of TimeData. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Initializes the history and the work packages.
+    */
+    void init(qint32 p_iNumChannels);
+
+    //=========================================================================================================
+    /**
+    * Plans the FFT length for a block length and transforms the coefficients.
+    *
+    * @param[in] p_iBlockLength     Number of samples per block.
+    */
+    void plan(qint32 p_iBlockLength);
+
+    //=========================================================================================================
+    /**
+    * Filters the current block for the channels of one chunk.
+    *
+    * @param[in, out] p_chunk   The chunk to process.
+    */
+    static void processChunk(ChannelChunk& p_chunk);
+
+    PhaseMode   m_mode;             /**< Alignment of the output. */
+    RowVectorXd m_vecCoeffs;        /**< FIR coefficients. */
+    qint32      m_iDelay;           /**< Group delay of the filter in samples. */
+    qint32      m_iNumChannels;     /**< Number of channels. */
+    qint32      m_iBlockLength;     /**< Block length the FFT is planned for. */
+    qint32      m_iFFTLength;       /**< FFT length. */
+
+    VectorXcd   m_vecFreqCoeffs;    /**< Half spectrum of the zero padded coefficients. */
+    MatrixXd    m_matHistory;       /**< Last taps-1 input samples of each channel (channels x taps-1). */
+
+    const MatrixXd* m_pData;        /**< Block which is currently filtered. */
+    MatrixXd*   m_pFiltered;        /**< Output of the block which is currently filtered. */
+
+    QVector<ChannelChunk> m_qVecChunks; /**< Work packages, one per worker thread. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 OverlapSaveFilter::delay() const
+{
+    return m_mode == ZeroPhase ? m_iDelay : 0;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 OverlapSaveFilter::numTaps() const
+{
+    return m_vecCoeffs.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 OverlapSaveFilter::numChannels() const
+{
+    return m_iNumChannels;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 OverlapSaveFilter::fftLength() const
+{
+    return m_iFFTLength;
+}
+
+} // NAMESPACE
+
+#endif // OVERLAPSAVEFILTER_H
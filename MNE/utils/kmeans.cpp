@@ -59,6 +59,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QtConcurrent/QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -148,45 +149,58 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
     //
     // Done with input argument processing, begin clustering
     //
+    m_vecXSqNorm = X.rowwise().squaredNorm();
+
     if (m_bOnline)
     {
         Del = MatrixXd(n,k);
         Del.fill(std::numeric_limits<double>::quiet_NaN());// reassignment criterion
     }
 
-    double totsumDBest = std::numeric_limits<double>::max();
     emptyErrCnt = 0;
 
-    VectorXi idxBest;
-    MatrixXd Cbest;
-    VectorXd sumDBest;
-    MatrixXd Dbest;
+    //
+    // Draw the starting centroids (rand() is shared, so this is done sequentially), each replicate is then run
+    // on its own copy of this object in parallel
+    //
+    QVector<KMeans> t_qVecEngines(m_iReps, *this);
+    QVector<Replicate> t_qVecReplicates(m_iReps);
 
     for(qint32 rep = 0; rep < m_iReps; ++rep)
     {
+        Replicate& t_replicate = t_qVecReplicates[rep];
+        t_replicate.Engine = &t_qVecEngines[rep];
+        t_replicate.X = &X;
+        t_replicate.Index = rep;
+        t_replicate.totsumD = std::numeric_limits<double>::max();
+
         if (m_sStart.compare("uniform") == 0)
         {
-            C = MatrixXd::Zero(k,p);
+            t_replicate.C = MatrixXd::Zero(k,p);
             for(qint32 i = 0; i < k; ++i)
                 for(qint32 j = 0; j < p; ++j)
-                    C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
+                    t_replicate.C(i,j) = unifrnd(Xmins[j], Xmaxs[j]);
             // For 'cosine' and 'correlation', these are uniform inside a subset
             // of the unit hypersphere.  Still need to center them for
             // 'correlation'.  (Re)normalization for 'cosine'/'correlation' is
             // done at each iteration.
             if (m_sDistance.compare("correlation") == 0)
-                C.array() -= (C.array().rowwise().sum()/p).replicate(1, p).array();
+                t_replicate.C.array() -= (t_replicate.C.array().rowwise().sum()/p).replicate(1, p).array();
         }
         else if (m_sStart.compare("sample") == 0)
         {
-            C = MatrixXd::Zero(k,p);
+            t_replicate.C = MatrixXd::Zero(k,p);
             for(qint32 i = 0; i < k; ++i)
-                C.block(i,0,1,p) = X.block(rand() % n, 0, 1, p);
+                t_replicate.C.block(i,0,1,p) = X.block(rand() % n, 0, 1, p);
             // DEBUG
 //            C.block(0,0,1,p) = X.block(2, 0, 1, p);
 //            C.block(1,0,1,p) = X.block(7, 0, 1, p);
 //            C.block(2,0,1,p) = X.block(17, 0, 1, p);
         }
+        else if (m_sStart.compare("plus") == 0)
+        {
+            t_replicate.C = plusStart(X);
+        }
     //    else if (start.compare("cluster") == 0)
     //    {
     //        Xsubset = X(randsample(n,floor(.1*n)),:);
@@ -196,127 +210,323 @@ bool KMeans::calculate( MatrixXd X, qint32 kClusters, VectorXi& idx, MatrixXd& C
     //    {
     //        C = CC(:,:,rep);
     //    }
+        else
+        {
+            printf("Error: Unknown Start %s\n", m_sStart.toUtf8().constData());
+            return false;
+        }
+    }
 
-        // Compute the distance from every point to each cluster centroid and the
-        // initial assignment of points to clusters
-        D = distfun(X, C);//, 0);
-        idx = VectorXi::Zero(D.rows());
-        d = VectorXd::Zero(D.rows());
+    if (m_iReps == 1)
+        processReplicate(t_qVecReplicates[0]);
+    else
+        QtConcurrent::blockingMap(t_qVecReplicates, processReplicate);
 
-        for(qint32 i = 0; i < D.rows(); ++i)
-            d[i] = D.row(i).minCoeff(&idx[i]);
+    // Return the best solution
+    qint32 t_iBest = 0;
+    for(qint32 rep = 1; rep < m_iReps; ++rep)
+        if (t_qVecReplicates[rep].totsumD < t_qVecReplicates[t_iBest].totsumD)
+            t_iBest = rep;
 
-        m = VectorXi::Zero(k);
-        for(qint32 i = 0; i < k; ++i)
-            for (qint32 j = 0; j < idx.rows(); ++j)
-                if(idx[j] == i)
-                    ++ m[i];
+    idx = t_qVecReplicates[t_iBest].idx;
+    C = t_qVecReplicates[t_iBest].C;
+    sumD = t_qVecReplicates[t_iBest].sumD;
+    D = t_qVecReplicates[t_iBest].D;
+
+//if hadNaNs
+//    idx = statinsertnan(wasnan, idx);
+//end
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void KMeans::processReplicate(Replicate& p_replicate)
+{
+    p_replicate.totsumD = p_replicate.Engine->runReplicate(*p_replicate.X, p_replicate.Index, p_replicate.C, p_replicate.idx, p_replicate.sumD, p_replicate.D);
+}
+
+
+//*************************************************************************************************************
 
-        try // catch empty cluster errors and move on to next rep
+double KMeans::runReplicate(const MatrixXd& X, qint32 rep, MatrixXd& C, VectorXi& idx, VectorXd& sumD, MatrixXd& D)
+{
+    // Compute the distance from every point to each cluster centroid and the
+    // initial assignment of points to clusters
+    D = distfun(X, C);//, 0);
+    idx = VectorXi::Zero(D.rows());
+    d = VectorXd::Zero(D.rows());
+
+    for(qint32 i = 0; i < D.rows(); ++i)
+        d[i] = D.row(i).minCoeff(&idx[i]);
+
+    m = VectorXi::Zero(k);
+    for (qint32 j = 0; j < idx.rows(); ++j)
+        ++ m[idx[j]];
+
+    // Begin phase one:  batch reassignments
+    bool converged;
+    if (m_sDistance.compare("sqeuclidean") == 0 || m_sDistance.compare("cityblock") == 0)
+        converged = boundedUpdate(X, C, idx);
+    else
+        converged = batchUpdate(X, C, idx);
+
+    // Begin phase two:  single reassignments
+    if (m_bOnline)
+        converged = onlineUpdate(X, C, idx);
+
+    if (!converged)
+        printf("Failed To Converge during replicate %d\n", rep);
+
+    // Calculate cluster-wise sums of distances
+    VectorXi nonempties = VectorXi::Zero(m.rows());
+    quint32 count = 0;
+    for(qint32 i = 0; i < m.rows(); ++i)
+    {
+        if(m[i] > 0)
         {
-            // Begin phase one:  batch reassignments
-            bool converged = batchUpdate(X, C, idx);
+            nonempties[i] = 1;
+            ++count;
+        }
+    }
+    MatrixXd C_tmp(count,C.cols());
+    count = 0;
+    for(qint32 i = 0; i < nonempties.rows(); ++i)
+    {
+        if(nonempties[i])
+        {
+            C_tmp.row(count) = C.row(i);
+            ++count;
+        }
+    }
+
+    MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
+    count = 0;
+    for(qint32 i = 0; i < nonempties.rows(); ++i)
+    {
+        if(nonempties[i])
+        {
+            D.col(i) = D_tmp.col(count);
+            C.row(i) = C_tmp.row(count);
+            ++count;
+        }
+    }
 
-            // Begin phase two:  single reassignments
-            if (m_bOnline)
-                converged = onlineUpdate(X, C, idx);
+    d = VectorXd::Zero(n);
+    for(qint32 i = 0; i < n; ++i)
+        d[i] += D.array()(idx[i]*n+i);//Colum Major
 
-            if (!converged)
-                printf("Failed To Converge during replicate %d\n", rep);
+    sumD = VectorXd::Zero(k);
+    for (qint32 j = 0; j < idx.rows(); ++j)
+        sumD[idx[j]] += d[j];
 
-            // Calculate cluster-wise sums of distances
-            VectorXi nonempties = VectorXi::Zero(m.rows());
-            quint32 count = 0;
-            for(qint32 i = 0; i < m.rows(); ++i)
+    totsumD = sumD.array().sum();
+
+//    printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+
+    return totsumD;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd KMeans::plusStart(const MatrixXd& X)
+{
+    MatrixXd C(k,p);
+    C.row(0) = X.row(rand() % n);
+
+    // Distance of each point to its closest centroid so far
+    VectorXd minD = distfun(X, C.topRows(1));
+
+    for(qint32 i = 1; i < k; ++i)
+    {
+        double sum = minD.sum();
+
+        qint32 sel = rand() % n;
+        if (sum > 0)
+        {
+            // Draw with probability minD/sum
+            double r = (double)rand() / ((double)RAND_MAX + 1.0) * sum;
+            double cumsum = 0;
+            for(sel = 0; sel < n-1; ++sel)
             {
-                if(m[i] > 0)
-                {
-                    nonempties[i] = 1;
-                    ++count;
-                }
+                cumsum += minD[sel];
+                if (cumsum > r)
+                    break;
             }
-            MatrixXd C_tmp(count,C.cols());
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
+        }
+
+        C.row(i) = X.row(sel);
+        minD = minD.cwiseMin(distfun(X, C.row(i)).col(0));
+    }
+
+    return C;
+}
+
+
+//*************************************************************************************************************
+
+bool KMeans::boundedUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
+{
+    qint32 i, j;
+    bool bCityblock = m_sDistance.compare("cityblock") == 0;
+
+    VectorXi all(k);
+    for(i = 0; i < k; ++i)
+        all[i] = i;
+
+    // Upper bound of the distance to the own centroid, lower bound of the distance to all other centroids,
+    // the first pass compares every point with all centroids
+    VectorXd upper = VectorXd::Constant(n, std::numeric_limits<double>::infinity());
+    VectorXd lower = VectorXd::Zero(n);
+
+    VectorXi changed = all;
+    std::vector<qint32> check;
+    check.reserve(n);
+
+    //
+    // Begin phase one:  batch reassignments
+    //
+    iter = 0;
+    bool converged = false;
+    while(true)
+    {
+        ++iter;
+
+        // Calculate the new cluster centroids and counts, empty clusters keep their centroid
+        MatrixXd C_old = C;
+        MatrixXd C_new;
+        VectorXi m_new;
+        gcentroids(X, idx, changed, C_new, m_new);
+
+        bool empty = false;
+        for(i = 0; i < changed.rows(); ++i)
+        {
+            m[changed[i]] = m_new[i];
+            if (m_new[i] > 0)
+                C.row(changed[i]) = C_new.row(i);
+            else
+                empty = true;
+        }
+
+        if (empty && m_sEmptyact.compare("error") == 0)
+            break;
+
+        // Move the bounds along with the centroids
+        VectorXd delta = VectorXd::Zero(k);
+        for(i = 0; i < changed.rows(); ++i)
+        {
+            RowVectorXd shift = C.row(changed[i]) - C_old.row(changed[i]);
+            delta[changed[i]] = bCityblock ? shift.cwiseAbs().sum() : shift.norm();
+        }
+
+        qint32 maxIdx;
+        double maxDelta = delta.maxCoeff(&maxIdx);
+        double maxDelta2 = 0;
+        for(i = 0; i < k; ++i)
+            if (i != maxIdx && delta[i] > maxDelta2)
+                maxDelta2 = delta[i];
+
+        for(i = 0; i < n; ++i)
+        {
+            upper[i] += delta[idx[i]];
+            lower[i] -= idx[i] == maxIdx ? maxDelta2 : maxDelta;
+        }
+
+        if (iter >= m_iMaxit)
+            break;
+
+        // Half the distance of each centroid to its closest other centroid
+        MatrixXd CC = metricDist(C, C.rowwise().squaredNorm(), C);
+        CC.diagonal().fill(std::numeric_limits<double>::infinity());
+        VectorXd s = 0.5 * CC.rowwise().minCoeff();
+
+        // Points whose assignment isn't proven by the bounds
+        check.clear();
+        for(i = 0; i < n; ++i)
+            if (upper[i] > std::max(s[idx[i]], lower[i]))
+                check.push_back(i);
+
+        previdx = idx;
+        qint32 count = 0;
+
+        if (!check.empty())
+        {
+            qint32 nCheck = (qint32)check.size();
+            MatrixXd Xcheck(nCheck, p);
+            VectorXd XcheckSqNorm(nCheck);
+            for(i = 0; i < nCheck; ++i)
             {
-                if(nonempties[i])
-                {
-                    C_tmp.row(count) = C.row(i);
-                    ++count;
-                }
+                Xcheck.row(i) = X.row(check[i]);
+                XcheckSqNorm[i] = m_vecXSqNorm[check[i]];
             }
 
-            MatrixXd D_tmp = distfun(X, C_tmp);//, iter);
-            count = 0;
-            for(qint32 i = 0; i < nonempties.rows(); ++i)
+            MatrixXd Dcheck = metricDist(Xcheck, XcheckSqNorm, C);
+
+            for(i = 0; i < nCheck; ++i)
             {
-                if(nonempties[i])
+                qint32 pt = check[i];
+
+                // Closest centroid, ties are resolved in favor of not moving
+                qint32 best = idx[pt];
+                for(j = 0; j < k; ++j)
+                    if (Dcheck(i,j) < Dcheck(i,best))
+                        best = j;
+
+                double second = std::numeric_limits<double>::infinity();
+                for(j = 0; j < k; ++j)
+                    if (j != best && Dcheck(i,j) < second)
+                        second = Dcheck(i,j);
+
+                upper[pt] = Dcheck(i,best);
+                lower[pt] = second;
+
+                if (best != idx[pt])
                 {
-                    D.col(i) = D_tmp.col(count);
-                    C.row(i) = C_tmp.row(count);
+                    idx[pt] = best;
                     ++count;
                 }
             }
+        }
 
-            d = VectorXd::Zero(n);
-            for(qint32 i = 0; i < n; ++i)
-                d[i] += D.array()(idx[i]*n+i);//Colum Major
-
-            sumD = VectorXd::Zero(k);
-            for(qint32 i = 0; i < k; ++i)
-                for (qint32 j = 0; j < idx.rows(); ++j)
-                    if(idx[j] == i)
-                        sumD[i] += d[j];
-
-            totsumD = sumD.array().sum();
-
-//            printf("%d iterations, total sum of distances = %f\n", iter, totsumD);
+//        printf("%6d\t%6d\t%8d\n",iter,1,count);
+        if (count == 0)
+        {
+            converged = true;
+            break;
+        }
 
-            // Save the best solution so far
-            if (totsumD < totsumDBest)
+        // Find clusters that gained or lost members
+        std::vector<int> tmp;
+        for(i = 0; i < n; ++i)
+        {
+            if (idx[i] != previdx[i])
             {
-                totsumDBest = totsumD;
-                idxBest = idx;
-                Cbest = C;
-                sumDBest = sumD;
-                Dbest = D;
+                tmp.push_back(idx[i]);
+                tmp.push_back(previdx[i]);
             }
         }
-        catch (int e)
-        {
-            if(e == 0)
-            {
-                // If an empty cluster error occurred in one of multiple replicates, catch
-                // it, warn, and move on to next replicate.  Error only when all replicates
-                // fail.  Rethrow an other kind of error.
-                if (m_iReps == 1)
-                    return false;
-                else
-                {
-                    emptyErrCnt = emptyErrCnt + 1;
-//                    printf("Replicate %d terminated: empty cluster created at iteration %d.\n", rep, iter);
-                    if (emptyErrCnt == m_iReps)
-                    {
-//                        error(message('EmptyClusterAllReps'));
-                        return false;
-                    }
 
-                }
-            }
-        } // catch
+        std::sort(tmp.begin(),tmp.end());
+        tmp.erase(std::unique(tmp.begin(),tmp.end()), tmp.end());
 
-    } // replicates
+        changed.resize(tmp.size());
+        for(j = 0; j < changed.rows(); ++j)
+            changed[j] = tmp[j];
+    } // phase one
 
-    // Return the best solution
-    idx = idxBest;
-    C = Cbest;
-    sumD = sumDBest;
-    D = Dbest;
+    // Total sum of distances of the final configuration
+    totsumD = 0;
+    for(i = 0; i < n; ++i)
+    {
+        if (bCityblock)
+            totsumD += (X.row(i) - C.row(idx[i])).cwiseAbs().sum();
+        else
+            totsumD += (X.row(i) - C.row(idx[i])).squaredNorm();
+    }
 
-//if hadNaNs
-//    idx = statinsertnan(wasnan, idx);
-//end
-    return true;
+    return converged;
 }
 
 
@@ -587,6 +797,11 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
     qint32 nummoved = 0;
     qint32 iter1 = iter;
     bool converged = false;
+
+    // Best possible move of each point, kept up to date for the columns of Del which change
+    VectorXi bestidx = VectorXi::Zero(n);
+    VectorXd bestDel = VectorXd::Zero(n);
+    bool firstpass = true;
     while (iter < m_iMaxit)
     {
         // Calculate distances to each cluster from each point, and the
@@ -619,7 +834,7 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
                 Del.col(i) = ((double)m[i] / ((double)m[i] + sgn.cast<double>().array()));
 
-                Del.col(i).array() *= (X - C.row(i).replicate(n,1)).array().pow(2).rowwise().sum().array();
+                Del.col(i).array() *= (X.rowwise() - C.row(i)).rowwise().squaredNorm().array();
             }
         }
         else if (m_sDistance.compare("cityblock") == 0)
@@ -711,11 +926,33 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
         previdx = idx;
         prevtotsumD = totsumD;
 
-        VectorXi nidx = VectorXi::Zero(Del.rows());
-        VectorXd minDel = VectorXd::Zero(Del.rows());
-
         for(qint32 i = 0; i < Del.rows(); ++i)
-            minDel[i] = Del.row(i).minCoeff(&nidx[i]);
+        {
+            // Search the whole row only if its minimum was in a changed column
+            bool search = firstpass;
+            for(qint32 j = 0; j < changed.rows() && !search; ++j)
+                if(bestidx[i] == changed[j])
+                    search = true;
+
+            if(search)
+                bestDel[i] = Del.row(i).minCoeff(&bestidx[i]);
+            else
+            {
+                for(qint32 j = 0; j < changed.rows(); ++j)
+                {
+                    qint32 c = changed[j];
+                    if(Del(i,c) < bestDel[i] || (Del(i,c) == bestDel[i] && c < bestidx[i]))
+                    {
+                        bestDel[i] = Del(i,c);
+                        bestidx[i] = c;
+                    }
+                }
+            }
+        }
+        firstpass = false;
+
+        VectorXi nidx = bestidx;
+        const VectorXd& minDel = bestDel;
 
         VectorXi moved = VectorXi::Zero(previdx.rows());
         qint32 count = 0;
@@ -874,31 +1111,18 @@ bool KMeans::onlineUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx)
 
 //*************************************************************************************************************
 //DISTFUN Calculate point to cluster centroid distances.
-MatrixXd KMeans::distfun(const MatrixXd& X, MatrixXd& C)//, qint32 iter)
+MatrixXd KMeans::distfun(const MatrixXd& X, const MatrixXd& C)//, qint32 iter)
 {
     MatrixXd D = MatrixXd::Zero(n,C.rows());
     qint32 nclusts = C.rows();
 
     if (m_sDistance.compare("sqeuclidean") == 0)
     {
-        for(qint32 i = 0; i < nclusts; ++i)
-        {
-            D.col(i) = (X.col(0).array() - C(i,0)).pow(2);
-
-            for(qint32 j = 1; j < p; ++j)
-                D.col(i) = D.col(i).array() + (X.col(j).array() - C(i,j)).pow(2);
-        }
+        D = sqEuclidean(X, m_vecXSqNorm, C);
     }
     else if (m_sDistance.compare("cityblock") == 0)
     {
-        for(qint32 i = 0; i < nclusts; ++i)
-        {
-            D.col(i) = (X.col(0).array() - C(i,0)).array().abs();
-            for(qint32 j = 1; j < p; ++j)
-            {
-                D.col(i).array() += (X.col(j).array() - C(i,j)).array().abs();
-            }
-        }
+        D = cityBlock(X, C);
     }
     else if (m_sDistance.compare("cosine") == 0 || m_sDistance.compare("correlation") == 0)
     {
@@ -929,6 +1153,45 @@ MatrixXd KMeans::distfun(const MatrixXd& X, MatrixXd& C)//, qint32 iter)
 } // function
 
 
+//*************************************************************************************************************
+
+MatrixXd KMeans::sqEuclidean(const MatrixXd& X, const VectorXd& XSqNorm, const MatrixXd& C)
+{
+    MatrixXd D(X.rows(), C.rows());
+    D.noalias() = -2.0 * X * C.transpose();
+    D.colwise() += XSqNorm;
+    D.rowwise() += C.rowwise().squaredNorm().transpose();
+
+    // Cancellation may produce tiny negative values
+    return D.cwiseMax(0.0);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd KMeans::cityBlock(const MatrixXd& X, const MatrixXd& C)
+{
+    MatrixXd D = MatrixXd::Zero(X.rows(), C.rows());
+
+    for(qint32 i = 0; i < C.rows(); ++i)
+        for(qint32 j = 0; j < X.cols(); ++j)
+            D.col(i).array() += (X.col(j).array() - C(i,j)).abs();
+
+    return D;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd KMeans::metricDist(const MatrixXd& X, const VectorXd& XSqNorm, const MatrixXd& C) const
+{
+    if (m_sDistance.compare("cityblock") == 0)
+        return cityBlock(X, C);
+    else
+        return sqEuclidean(X, XSqNorm, C).cwiseSqrt();
+}
+
+
 //*************************************************************************************************************
 //GCENTROIDS Centroids and counts stratified by group.
 void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi& clusts,
@@ -939,23 +1202,24 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
     centroids.fill(std::numeric_limits<double>::quiet_NaN());
     counts = VectorXi::Zero(num);
 
+    // Members of each cluster, collected in one pass over the points
+    std::vector< std::vector<qint32> > clusterMembers(k);
+    for(qint32 j = 0; j < index.rows(); ++j)
+        if(index[j] >= 0 && index[j] < k)
+            clusterMembers[index[j]].push_back(j);
+
     VectorXi members;
 
     qint32 c;
 
     for(qint32 i = 0; i < num; ++i)
     {
-        c = 0;
-        members = VectorXi::Zero(index.rows());
-        for(qint32 j = 0; j < index.rows(); ++j)
-        {
-            if(index[j] == clusts[i])
-            {
-                members[c] = j;
-                ++c;
-            }
-        }
-        members.conservativeResize(c);
+        const std::vector<qint32>& t_members = clusterMembers[clusts[i]];
+        c = (qint32)t_members.size();
+        members = VectorXi(c);
+        for(qint32 j = 0; j < c; ++j)
+            members[j] = t_members[j];
+
         if (c > 0)
         {
             counts[i] = c;
@@ -973,16 +1237,8 @@ void KMeans::gcentroids(const MatrixXd& X, const VectorXi& index, const VectorXi
                 // Separate out sorted coords for points in i'th cluster,
                 // and use to compute a fast median, component-wise
                 MatrixXd Xsorted(counts[i],p);
-                c = 0;
-
-                for(qint32 j = 0; j < index.rows(); ++j)
-                {
-                    if(index[j] == clusts[i])
-                    {
-                        Xsorted.row(c) = X.row(j);
-                        ++c;
-                    }
-                }
+                for(qint32 j = 0; j < members.rows(); ++j)
+                    Xsorted.row(j) = X.row(members[j]);
 
                 for(qint32 j = 0; j < Xsorted.cols(); ++j)
                     std::sort(Xsorted.col(j).data(),Xsorted.col(j).data()+Xsorted.rows());
@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <QString>
+#include <QVector>
 #include <QSharedPointer>
 
 
@@ -79,7 +80,9 @@ using namespace Eigen;
 
 //=============================================================================================================
 /**
-* K-Means Clustering
+* K-Means Clustering. Squared euclidean distances are evaluated as ||x||^2 - 2*x*c' + ||c||^2 with one matrix product,
+* the batch phase of "sqeuclidean" and "cityblock" skips points whose assignment can't change (Hamerly's bounds)
+* and the replicates run in parallel.
 *
 * @brief K-Means Clustering
 */
@@ -90,7 +93,7 @@ public:
     typedef QSharedPointer<const KMeans> ConstSPtr; /**< Const shared pointer type for KMeans. */
 
     //distance {'sqeuclidean','cityblock','cosine','correlation','hamming'};
-    //startNames = {'uniform','sample','cluster'};
+    //startNames = {'uniform','sample','plus','cluster'};
     //emptyactNames = {'error','drop','singleton'};
 
     //=========================================================================================================
@@ -98,7 +101,7 @@ public:
     * Constructs a KMeans algorithm object.
     *
     * @param[in] distance   (optional) K-Means distance measure: "sqeuclidean" (default), "cityblock" , "cosine", "correlation", "hamming"
-    * @param[in] start      (optional) Cluster initialization: "sample" (default), "uniform", "cluster"
+    * @param[in] start      (optional) Cluster initialization: "sample" (default), "uniform", "plus" (k-means++), "cluster"
     * @param[in] replicates (optional) Number of K-Means replicates, which are generated. Best is returned.
     * @param[in] emptyact   (optional) What happens if a cluster wents empty: "error" (default), "drop", "singleton"
     * @param[in] online     (optional) If centroids should be updated during iterations: true (default), false
@@ -121,16 +124,115 @@ public:
 
 
 private:
+    /**
+    * Work package of one replicate: a copy of the algorithm object (holds the iteration state) and the results.
+    */
+    struct Replicate
+    {
+        KMeans* Engine;         /**< The algorithm object of the replicate. */
+        const MatrixXd* X;      /**< Input data. */
+        qint32 Index;           /**< Number of the replicate. */
+        MatrixXd C;             /**< Initial and final cluster centroids. */
+        VectorXi idx;           /**< Cluster indeces of the points. */
+        VectorXd sumD;          /**< Within-cluster sums of the distances. */
+        MatrixXd D;             /**< Point to centroid distances. */
+        double totsumD;         /**< Total sum of the distances. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Runs one replicate.
+    *
+    * @param[in, out] p_replicate   The replicate to run.
+    */
+    static void processReplicate(Replicate& p_replicate);
+
+    //=========================================================================================================
+    /**
+    * Clusters the data starting from given centroids.
+    *
+    * @param[in] X          Input data
+    * @param[in] rep        Number of the replicate
+    * @param[in, out] C     Initial and final cluster centroids
+    * @param[out] idx       The cluster indeces to which cluster the input points belong to
+    * @param[out] sumD      Summation of the distances to the centroid within one cluster
+    * @param[out] D         Cluster distances to the centroid
+    *
+    * @return the total sum of distances
+    */
+    double runReplicate(const MatrixXd& X, qint32 rep, MatrixXd& C, VectorXi& idx, VectorXd& sumD, MatrixXd& D);
+
+    //=========================================================================================================
+    /**
+    * k-means++ initialization: the first centroid is a random point, each further one is a point drawn with a
+    * probability proportional to its distance to the closest centroid chosen so far.
+    *
+    * @param[in] X  Input data
+    *
+    * @return Initial cluster centroids
+    */
+    MatrixXd plusStart(const MatrixXd& X);
+
     //=========================================================================================================
     /**
     * Calculate point to cluster centroid distances.
     *
-    * @param[in] X  Input data (rows = points; cols = p dimensional space)
+    * @param[in] X  Input data (rows = points; cols = p dimensional space), the squared norms of its points have
+    *               to be stored in m_vecXSqNorm
     * @param[in] C  Cluster centroids
     *
     * @return Cluster centroid distances
     */
-    MatrixXd distfun(const MatrixXd& X, MatrixXd& C);//, qint32 iter);
+    MatrixXd distfun(const MatrixXd& X, const MatrixXd& C);//, qint32 iter);
+
+    //=========================================================================================================
+    /**
+    * Squared euclidean distances ||x||^2 - 2*x*c' + ||c||^2, evaluated with one matrix product.
+    *
+    * @param[in] X          Points (rows)
+    * @param[in] XSqNorm    Squared norms of the points
+    * @param[in] C          Centroids (rows)
+    *
+    * @return Point to centroid distances
+    */
+    static MatrixXd sqEuclidean(const MatrixXd& X, const VectorXd& XSqNorm, const MatrixXd& C);
+
+    //=========================================================================================================
+    /**
+    * Cityblock distances.
+    *
+    * @param[in] X  Points (rows)
+    * @param[in] C  Centroids (rows)
+    *
+    * @return Point to centroid distances
+    */
+    static MatrixXd cityBlock(const MatrixXd& X, const MatrixXd& C);
+
+    //=========================================================================================================
+    /**
+    * Distances which satisfy the triangle inequality: euclidean for "sqeuclidean", cityblock for "cityblock".
+    *
+    * @param[in] X          Points (rows)
+    * @param[in] XSqNorm    Squared norms of the points
+    * @param[in] C          Centroids (rows)
+    *
+    * @return Point to centroid distances
+    */
+    MatrixXd metricDist(const MatrixXd& X, const VectorXd& XSqNorm, const MatrixXd& C) const;
+
+    //=========================================================================================================
+    /**
+    * Batch reassignments for "sqeuclidean" and "cityblock" (Hamerly). Each point keeps an upper bound of the
+    * distance to its centroid and a lower bound of the distance to all other centroids, only points for which
+    * the bounds don't prove the assignment are compared against all centroids.
+    *
+    * @param[in] X          Input data
+    * @param[in, out] C     Cluster centroids
+    * @param[in, out] idx   The cluster indeces to which cluster the input points belong to
+    *
+    * @return true if converged, false otherwise
+    */
+    bool boundedUpdate(const MatrixXd& X, MatrixXd& C, VectorXi& idx);
 
     //=========================================================================================================
     /**
@@ -206,6 +308,8 @@ private:
 
     VectorXi previdx;       /**< Previous point cluster indeces */
 
+    VectorXd m_vecXSqNorm;  /**< Squared norms of the points to be clustered */
+
 };
 
 } // NAMESPACE
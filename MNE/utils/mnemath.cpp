@@ -153,6 +153,55 @@ void MNEMath::get_whitener(MatrixXd &A, bool pca, QString ch_type, VectorXd &eig
 }
 
 
+//*************************************************************************************************************
+
+void MNEMath::gram_svd(const MatrixXd& A, VectorXd& s, MatrixXd& U, MatrixXd& V, double tol)
+{
+    bool t_bWide = A.rows() <= A.cols();
+
+    //Gram matrix of the short dimension, only the lower triangle is needed by the eigen solver
+    qint32 n = t_bWide ? A.rows() : A.cols();
+    MatrixXd t_matGram = MatrixXd::Zero(n, n);
+    if(t_bWide)
+        t_matGram.selfadjointView<Lower>().rankUpdate(A);
+    else
+        t_matGram.selfadjointView<Lower>().rankUpdate(A.transpose());
+
+    SelfAdjointEigenSolver<MatrixXd> t_eig(t_matGram);
+
+    //Eigenvalues are ascending -> reverse
+    s.resize(n);
+    MatrixXd t_matShort(n, n);
+    for(qint32 i = 0; i < n; ++i)
+    {
+        double ev = t_eig.eigenvalues()(n-1-i);
+        s(i) = ev > 0 ? sqrt(ev) : 0;
+        t_matShort.col(i) = t_eig.eigenvectors().col(n-1-i);
+    }
+
+    MatrixXd t_matLong = t_bWide ? MatrixXd(A.transpose() * t_matShort) : MatrixXd(A * t_matShort);
+    double t_dMin = n > 0 ? s(0) * tol : 0;
+    for(qint32 i = 0; i < n; ++i)
+    {
+        if(s(i) > t_dMin)
+            t_matLong.col(i) /= s(i);
+        else
+            t_matLong.col(i).setZero();
+    }
+
+    if(t_bWide)
+    {
+        U = t_matShort;
+        V = t_matLong;
+    }
+    else
+    {
+        U = t_matLong;
+        V = t_matShort;
+    }
+}
+
+
 //*************************************************************************************************************
 
 VectorXi MNEMath::intersect(const VectorXi &v1, const VectorXi &v2, VectorXi &idx_sel)
@@ -343,6 +392,44 @@ int MNEMath::nchoose2(int n)
 }
 
 
+//*************************************************************************************************************
+
+void MNEMath::randomized_svd(const MatrixXd& A, qint32 p_iRank, VectorXd& s, MatrixXd& U, MatrixXd& V, qint32 p_iOversample, qint32 p_iPowerIter)
+{
+    qint32 t_iMaxRank = A.rows() < A.cols() ? A.rows() : A.cols();
+    if(p_iRank <= 0 || p_iRank > t_iMaxRank)
+        p_iRank = t_iMaxRank;
+    qint32 l = p_iRank + p_iOversample < t_iMaxRank ? p_iRank + p_iOversample : t_iMaxRank;
+
+    //Orthonormal basis Q of the sampled range of A
+    HouseholderQR<MatrixXd> t_qr;
+    MatrixXd Q = A * MatrixXd::Random(A.cols(), l);
+    t_qr.compute(Q);
+    Q = t_qr.householderQ() * MatrixXd::Identity(A.rows(), l);
+
+    MatrixXd Z;
+    for(qint32 i = 0; i < p_iPowerIter; ++i)
+    {
+        Z.noalias() = A.transpose() * Q;
+        t_qr.compute(Z);
+        Z = t_qr.householderQ() * MatrixXd::Identity(A.cols(), l);
+
+        Q.noalias() = A * Z;
+        t_qr.compute(Q);
+        Q = t_qr.householderQ() * MatrixXd::Identity(A.rows(), l);
+    }
+
+    //Decompose the small projected matrix B = Q' * A
+    MatrixXd B = Q.transpose() * A;
+    MatrixXd t_matUB;
+    gram_svd(B, s, t_matUB, V);
+
+    U = Q * t_matUB.leftCols(p_iRank);
+    s.conservativeResize(p_iRank);
+    V.conservativeResize(Eigen::NoChange, p_iRank);
+}
+
+
 //*************************************************************************************************************
 
 qint32 MNEMath::rank(const MatrixXd& A, double tol)
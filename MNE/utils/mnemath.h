@@ -163,6 +163,21 @@ public:
     */
     static void get_whitener(MatrixXd& A, bool pca, QString ch_type, VectorXd& eig, MatrixXd& eigvec);
 
+    //=========================================================================================================
+    /**
+    * Thin singular value decomposition A = U * diag(s) * V' computed from the eigen decomposition of the small
+    * Gram matrix (A*A' for wide, A'*A for tall matrices). Much faster than JacobiSVD for strongly rectangular
+    * matrices like lead fields. Singular values below tol times the largest one lose accuracy since the Gram
+    * matrix squares the condition number; their singular vectors of the long dimension are set to zero.
+    *
+    * @param[in] A      Matrix to decompose
+    * @param[out] s     Singular values in decreasing order
+    * @param[out] U     Left singular vectors
+    * @param[out] V     Right singular vectors
+    * @param[in] tol    Relative threshold below which singular values are considered to be zero
+    */
+    static void gram_svd(const MatrixXd& A, VectorXd& s, MatrixXd& U, MatrixXd& V, double tol = 1e-8);
+
 
     //=========================================================================================================
     /**
@@ -228,6 +243,21 @@ public:
     */
     static int nchoose2(int n);
 
+    //=========================================================================================================
+    /**
+    * Truncated singular value decomposition using a randomized range finder (Halko et al., 2011). Only the
+    * leading p_iRank singular triplets are computed.
+    *
+    * @param[in] A              Matrix to decompose
+    * @param[in] p_iRank        Number of singular values to compute
+    * @param[out] s             Singular values in decreasing order
+    * @param[out] U             Left singular vectors
+    * @param[out] V             Right singular vectors
+    * @param[in] p_iOversample  Additional random samples of the range (optional, default = 10)
+    * @param[in] p_iPowerIter   Number of power iterations, improves accuracy for slowly decaying spectra (optional, default = 2)
+    */
+    static void randomized_svd(const MatrixXd& A, qint32 p_iRank, VectorXd& s, MatrixXd& U, MatrixXd& V, qint32 p_iOversample = 10, qint32 p_iPowerIter = 2);
+
     //=========================================================================================================
     /**
     * ToDo make this a template function
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include <vector>
+#include <string.h>
 #include "fixdictmp.h"
 
 //*************************************************************************************************************
@@ -52,6 +53,56 @@
 
 using namespace UTILSLIB;
 
+//*************************************************************************************************************
+//=============================================================================================================
+// BINARY DICTIONARY LAYOUT
+//=============================================================================================================
+
+// file:        BinDictFileHeader, followed by dict_count dictionary sections
+// dictionary:  BinDictHeader | source (utf8) | formula (utf8) | pad to 8 bytes
+//              | BinDictAtomParams x atom_count
+//              | float atom samples (matrix_rows x atom_count, column major) | pad to 8 bytes
+//              | complex<float> atom spectra (spectra_length/2+1 x atom_count, column major) if spectra_length > 0
+// all values are stored in host byte order, byte_order_mark tells whether the file was written on a host with
+// the same byte order
+
+#define BIN_DICT_MAGIC      "MNEMPDCT"
+#define BIN_DICT_VERSION    1
+#define BIN_DICT_BOM        0x01020304
+
+struct BinDictFileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 byte_order_mark;
+    qint32 dict_count;
+    qint32 reserved;
+};
+
+struct BinDictHeader
+{
+    qint32 type;
+    qint32 sample_count;
+    qint32 atom_count;
+    qint32 matrix_rows;
+    qint32 spectra_length;
+    qint32 source_size;
+    qint32 formula_size;
+    qint32 reserved;
+};
+
+struct BinDictAtomParams
+{
+    qint32 id;
+    qint32 sample_count;
+    double params[8];       // gabor: scale, modu, phase | chirp: scale, modu, phase, chirp | formula: a - h
+};
+
+static inline qint64 bin_dict_align(qint64 size)
+{
+    return (size + 7) & ~qint64(7);
+}
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -64,7 +115,9 @@ FixDictMp::FixDictMp()
 
 FixDictMp::~FixDictMp(){}
 
-Dictionary::Dictionary(){}
+Dictionary::Dictionary()
+: sample_count(0)
+, spectra_length(0){}
 
 Dictionary::~Dictionary(){}
 
@@ -88,7 +141,12 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     bool sample_count_mismatch = false;
 
     this->residuum = signal;
-    parsed_dicts = parse_xml_dict(path);
+    parsed_dicts = parse_dict(path);
+
+    //the atoms are transformed once for the whole decomposition, binary dictionaries may already hold the spectra
+    for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        if(parsed_dicts.at(i).spectra_length != sample_count)
+            parsed_dicts[i].calc_atom_spectra(sample_count);
 
     //calculate signal_energy
     for(qint32 channel = 0; channel < channel_count; channel++)
@@ -106,28 +164,18 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     {
         FixDictAtom global_best_matching;
 
-        QList<find_best_matching> list_of_best;
+        //the residuum is transformed once per iteration, the atoms of each dictionary are searched in parallel
+        MatrixXcd resid_spectra = calc_resid_spectra(this->residuum, boost);
+
         for(qint32 i = 0; i < parsed_dicts.length(); i++)
         {
-            find_best_matching current_best_matching;
-            current_best_matching.pdict = parsed_dicts.at(i);
-            current_best_matching.current_resid = this->residuum;
-            current_best_matching.boost = boost;
-            list_of_best.append(current_best_matching);
-        }
+            FixDictAtom current_best_matching = correlation(parsed_dicts.at(i), resid_spectra, sample_count);
 
-        QFuture<FixDictAtom> mapped_best_matchings = QtConcurrent::mapped(list_of_best, &find_best_matching::parallel_correlation);// parse_threads;
-        mapped_best_matchings.waitForFinished();
-
-        QFuture<FixDictAtom>::const_iterator i;
-        for (i = mapped_best_matchings.constBegin(); i != mapped_best_matchings.constEnd(); i++)
-        {
-            //FixDictAtom current_best_matching = correlation(parsed_dicts.at(i));
-            if(i == mapped_best_matchings.constBegin())
-                global_best_matching = *i;
+            if(i == 0)
+                global_best_matching = current_best_matching;
 
-            else if(abs(i->max_scalar_product) > abs(global_best_matching.max_scalar_product))
-                global_best_matching = *i;
+            else if(fabs(current_best_matching.max_scalar_product) > fabs(global_best_matching.max_scalar_product))
+                global_best_matching = current_best_matching;
         }
 
         global_best_matching.display_text = create_display_text(global_best_matching);
@@ -229,92 +277,133 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
 // calc scalarproduct of Atom and Signal
 FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost)
 {
-    qint32 channel_count = current_resid.cols() * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
-    if(boost == 0 || channel_count == 0)
-        channel_count = 1;
+    if(current_pdict.spectra_length != current_resid.rows())
+        current_pdict.calc_atom_spectra(current_resid.rows());
 
-    Eigen::FFT<double> fft;
-    std::ptrdiff_t max_index;
-    VectorXcd fft_atom = VectorXcd::Zero(current_resid.rows());
+    return correlation(current_pdict, calc_resid_spectra(current_resid, boost), current_resid.rows());
+}
 
+//*************************************************************************************************************
+
+FixDictAtom FixDictMp::correlation(const Dictionary& current_pdict, const MatrixXcd& resid_spectra, qint32 signal_length)
+{
     FixDictAtom best_matching;
-    qreal max_scalar_product = 0;
 
-    for(qint32 i = 0; i < current_pdict.atoms.length(); i++)
+    if(current_pdict.spectra_length != signal_length)
     {
-        VectorXd fitted_atom = VectorXd::Zero(current_resid.rows());
-        qint32 p = floor(current_resid.rows() / 2);//translation
+        qWarning("FixDictMp::correlation: atom spectra are not calculated for %d samples.", signal_length);
+        return best_matching;
+    }
 
-        VectorXd resized_atom = VectorXd::Zero(current_resid.rows());
+    //split the atoms across the cores, each chunk keeps its best match
+    qint32 atom_count = current_pdict.atom_spectra.cols();
+    qint32 chunk_count = qMax(1, qMin(QThread::idealThreadCount(), atom_count));
 
-        if(current_pdict.atoms.at(i).atom_samples.rows() > current_resid.rows())
-            for(qint32 k = 0; k < current_resid.rows(); k++)
-                resized_atom[k] = current_pdict.atoms.at(i).atom_samples[k + floor(current_pdict.atoms.at(i).atom_samples.rows() / 2) - floor(current_resid.rows() / 2)];
-        else resized_atom = current_pdict.atoms.at(i).atom_samples;
+    QList<CorrelationChunk> chunks;
+    for(qint32 i = 0; i < chunk_count; i++)
+    {
+        CorrelationChunk chunk;
+        chunk.dict = &current_pdict;
+        chunk.resid_spectra = &resid_spectra;
+        chunk.signal_length = signal_length;
+        chunk.first_atom = (qint64)atom_count * i / chunk_count;
+        chunk.atom_count = (qint64)atom_count * (i + 1) / chunk_count - chunk.first_atom;
+        chunk.best_atom = -1;
+        chunk.best_index = 0;
+        chunk.best_scalar_product = 0;
+        chunks.append(chunk);
+    }
 
-        if(resized_atom.rows() < current_resid.rows())
-            for(qint32 k = 0; k < resized_atom.rows(); k++)
-                fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
-        else fitted_atom = resized_atom;
+    QtConcurrent::blockingMap(chunks, correlate_chunk);
 
-        //normalization
-        qreal norm = 0;
-        norm = fitted_atom.norm();
-        if(norm != 0) fitted_atom /= norm;
+    //argmax reduction in atom order -> on equal products the first atom wins like in the serial search
+    qint32 best_chunk = -1;
+    for(qint32 i = 0; i < chunks.length(); i++)
+    {
+        if(chunks.at(i).best_atom < 0)
+            continue;
 
-        fft.fwd(fft_atom, fitted_atom);
+        if(best_chunk < 0 || fabs(chunks.at(i).best_scalar_product) > fabs(chunks.at(best_chunk).best_scalar_product))
+            best_chunk = i;
+    }
 
-        for(qint32 chn = 0; chn < channel_count; chn++)
-        {
-            p = floor(current_resid.rows() / 2);//translation
-            VectorXd corr_coeffs = VectorXd::Zero(current_resid.rows());
-            VectorXcd fft_signal = VectorXcd::Zero(current_resid.rows());
-            VectorXcd fft_sig_atom = VectorXcd::Zero(current_resid.rows());
+    if(best_chunk >= 0)
+    {
+        const CorrelationChunk& best = chunks.at(best_chunk);
 
-            fft.fwd(fft_signal, current_resid.col(chn));
+        best_matching = current_pdict.atoms.at(best.best_atom);
+        best_matching.max_scalar_product = best.best_scalar_product;
 
-            for( qint32 m = 0; m < current_resid.rows(); m++)
-                fft_sig_atom[m] = fft_signal[m] * conj(fft_atom[m]);
+        //adapting translation p to create atomtranslation correctly
+        qint32 p = floor(signal_length / 2);
+        if(best.best_index >= p && signal_length % (2) == 0) p = best.best_index - p;
+        else if(best.best_index >= p && signal_length % (2) != 0) p = best.best_index - p - 1;
+        else p = best.best_index + p;
 
-            fft.inv(corr_coeffs, fft_sig_atom);
+        best_matching.translation = p;
+    }
 
-            //find index of maximum correlation-coefficient to use in translation
-            max_scalar_product = corr_coeffs.maxCoeff(&max_index);
+    best_matching.atom_formula = current_pdict.atom_formula;
+    best_matching.dict_source = current_pdict.source;
+    best_matching.type = current_pdict.type;
+    best_matching.sample_count = current_pdict.sample_count;
 
-            if(i == 0)
-            {
-                best_matching = current_pdict.atoms.at(i);
-                best_matching.max_scalar_product = max_scalar_product;
+    return best_matching;
+}
 
-                //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
-                else p = max_index + p;
+//*************************************************************************************************************
 
-                best_matching.translation = p;
-            }
+void FixDictMp::correlate_chunk(CorrelationChunk& chunk)
+{
+    const MatrixXcd& atom_spectra = chunk.dict->atom_spectra;
+    const MatrixXcd& resid_spectra = *chunk.resid_spectra;
 
-            else if(abs(max_scalar_product) > abs(best_matching.max_scalar_product))
-            {
-                best_matching = current_pdict.atoms.at(i);
-                best_matching.max_scalar_product = max_scalar_product;
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
 
-                //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
-                else p = max_index + p;
+    VectorXcd fft_sig_atom = VectorXcd::Zero(resid_spectra.rows());
+    VectorXd corr_coeffs = VectorXd::Zero(chunk.signal_length);
+    std::ptrdiff_t max_index;
 
-                best_matching.translation = p;
+    for(qint32 i = chunk.first_atom; i < chunk.first_atom + chunk.atom_count; i++)
+    {
+        for(qint32 chn = 0; chn < resid_spectra.cols(); chn++)
+        {
+            fft_sig_atom = resid_spectra.col(chn).cwiseProduct(atom_spectra.col(i).conjugate());
+
+            fft.inv(corr_coeffs.data(), fft_sig_atom.data(), chunk.signal_length);
+
+            //find index of maximum correlation-coefficient to use in translation
+            qreal max_scalar_product = corr_coeffs.maxCoeff(&max_index);
+
+            if(chunk.best_atom < 0 || fabs(max_scalar_product) > fabs(chunk.best_scalar_product))
+            {
+                chunk.best_atom = i;
+                chunk.best_index = max_index;
+                chunk.best_scalar_product = max_scalar_product;
             }
         }
     }
-    best_matching.atom_formula = current_pdict.atom_formula;
-    best_matching.dict_source = current_pdict.source;
-    best_matching.type = current_pdict.type;
-    best_matching.sample_count = current_pdict.sample_count;
+}
 
-    return best_matching;
+//*************************************************************************************************************
+
+MatrixXcd FixDictMp::calc_resid_spectra(const MatrixXd& current_resid, qint32 boost)
+{
+    qint32 channel_count = current_resid.cols() * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
+    if(boost == 0 || channel_count == 0)
+        channel_count = 1;
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    MatrixXcd resid_spectra(current_resid.rows() / 2 + 1, channel_count);
+    for(qint32 chn = 0; chn < channel_count; chn++)
+        fft.fwd(resid_spectra.col(chn).data(), current_resid.col(chn).data(), current_resid.rows());
+
+    return resid_spectra;
 }
+
 //*************************************************************************************************************
 
 QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
@@ -365,6 +454,291 @@ QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
 }
 //*************************************************************************************************************
 
+QList<Dictionary> FixDictMp::parse_dict(QString path)
+{
+    QFile dict_file(path);
+    char magic[8];
+    bool is_binary = dict_file.open(QIODevice::ReadOnly) && dict_file.read(magic, 8) == 8 && memcmp(magic, BIN_DICT_MAGIC, 8) == 0;
+    dict_file.close();
+
+    if(is_binary)
+        return parse_bin_dict(path);
+
+    //use the binary version of the xml dictionary if it is up to date
+    QFileInfo xml_info(path);
+    QFileInfo bin_info(xml_info.absolutePath() + "/" + xml_info.completeBaseName() + ".bdict");
+
+    if(bin_info.exists() && bin_info.lastModified() >= xml_info.lastModified())
+    {
+        QList<Dictionary> parsed_dict = parse_bin_dict(bin_info.absoluteFilePath());
+        if(!parsed_dict.isEmpty())
+            return parsed_dict;
+    }
+
+    return parse_xml_dict(path);
+}
+
+//*************************************************************************************************************
+
+QList<Dictionary> FixDictMp::parse_bin_dict(QString path)
+{
+    QList<Dictionary> parsed_dict;
+
+    QFile dict_file(path);
+    if(!dict_file.open(QIODevice::ReadOnly))
+    {
+        qWarning("FixDictMp::parse_bin_dict: could not open %s.", qPrintable(path));
+        return parsed_dict;
+    }
+
+    qint64 file_size = dict_file.size();
+    const uchar* data = file_size > 0 ? dict_file.map(0, file_size) : 0;
+    if(!data)
+    {
+        qWarning("FixDictMp::parse_bin_dict: could not map %s.", qPrintable(path));
+        return parsed_dict;
+    }
+
+    BinDictFileHeader file_header;
+    if(file_size < (qint64)sizeof(BinDictFileHeader))
+    {
+        qWarning("FixDictMp::parse_bin_dict: %s is too small.", qPrintable(path));
+        return parsed_dict;
+    }
+    memcpy(&file_header, data, sizeof(BinDictFileHeader));
+
+    if(memcmp(file_header.magic, BIN_DICT_MAGIC, 8) != 0 || file_header.version != BIN_DICT_VERSION || file_header.byte_order_mark != BIN_DICT_BOM)
+    {
+        qWarning("FixDictMp::parse_bin_dict: %s is no binary dictionary of version %d in host byte order.", qPrintable(path), BIN_DICT_VERSION);
+        return parsed_dict;
+    }
+
+    qint64 pos = sizeof(BinDictFileHeader);
+    bool is_emitted = false;
+
+    for(qint32 i = 0; i < file_header.dict_count; i++)
+    {
+        BinDictHeader header;
+        if(pos + (qint64)sizeof(BinDictHeader) > file_size)
+            break;
+        memcpy(&header, data + pos, sizeof(BinDictHeader));
+        pos += sizeof(BinDictHeader);
+
+        qint64 spectra_rows = header.spectra_length > 0 ? header.spectra_length / 2 + 1 : 0;
+        qint64 params_pos = bin_dict_align(pos + header.source_size + header.formula_size);
+        qint64 samples_pos = params_pos + (qint64)header.atom_count * sizeof(BinDictAtomParams);
+        qint64 spectra_pos = bin_dict_align(samples_pos + (qint64)header.matrix_rows * header.atom_count * sizeof(float));
+        qint64 end_pos = bin_dict_align(spectra_pos + spectra_rows * header.atom_count * 2 * sizeof(float));
+
+        if(header.atom_count < 0 || header.matrix_rows < 0 || header.source_size < 0 || header.formula_size < 0 || end_pos > file_size)
+        {
+            qWarning("FixDictMp::parse_bin_dict: dictionary %d of %s is corrupt.", i, qPrintable(path));
+            parsed_dict.clear();
+            return parsed_dict;
+        }
+
+        Dictionary current_dict;
+        current_dict.type = (AtomType)header.type;
+        current_dict.sample_count = header.sample_count;
+        current_dict.source = QString::fromUtf8((const char*)(data + pos), header.source_size);
+        current_dict.atom_formula = QString::fromUtf8((const char*)(data + pos + header.source_size), header.formula_size);
+
+        //the atom samples are one contiguous matrix -> copy them column by column without any parsing
+        Map<const MatrixXf> atom_matrix((const float*)(data + samples_pos), header.matrix_rows, header.atom_count);
+
+        for(qint32 k = 0; k < header.atom_count; k++)
+        {
+            BinDictAtomParams params;
+            memcpy(&params, data + params_pos + k * sizeof(BinDictAtomParams), sizeof(BinDictAtomParams));
+
+            FixDictAtom current_atom;
+            current_atom.id = params.id;
+            current_atom.atom_samples = atom_matrix.col(k).head(qBound(0, params.sample_count, header.matrix_rows)).cast<double>();
+
+            if(current_dict.type == GABORATOM)
+            {
+                current_atom.gabor_atom.scale = params.params[0];
+                current_atom.gabor_atom.modulation = params.params[1];
+                current_atom.gabor_atom.phase = params.params[2];
+            }
+            else if(current_dict.type == CHIRPATOM)
+            {
+                current_atom.chirp_atom.scale = params.params[0];
+                current_atom.chirp_atom.modulation = params.params[1];
+                current_atom.chirp_atom.phase = params.params[2];
+                current_atom.chirp_atom.chirp = params.params[3];
+            }
+            else
+            {
+                current_atom.formula_atom.a = params.params[0];
+                current_atom.formula_atom.b = params.params[1];
+                current_atom.formula_atom.c = params.params[2];
+                current_atom.formula_atom.d = params.params[3];
+                current_atom.formula_atom.e = params.params[4];
+                current_atom.formula_atom.f = params.params[5];
+                current_atom.formula_atom.g = params.params[6];
+                current_atom.formula_atom.h = params.params[7];
+            }
+
+            current_dict.atoms.append(current_atom);
+        }
+
+        if(spectra_rows > 0)
+        {
+            Map<const MatrixXcf> spectra_matrix((const std::complex<float>*)(data + spectra_pos), spectra_rows, header.atom_count);
+            current_dict.atom_spectra = spectra_matrix.cast<std::complex<double> >();
+            current_dict.spectra_length = header.spectra_length;
+        }
+
+        if(current_dict.sample_count != this->residuum.rows() && !is_emitted)
+        {
+            is_emitted = true;
+            emit send_warning(2);
+        }
+
+        parsed_dict.append(current_dict);
+        pos = end_pos;
+    }
+
+    if(parsed_dict.length() != file_header.dict_count)
+    {
+        qWarning("FixDictMp::parse_bin_dict: %s is truncated.", qPrintable(path));
+        parsed_dict.clear();
+    }
+
+    return parsed_dict;
+}
+
+//*************************************************************************************************************
+
+bool FixDictMp::save_bin_dict(const QList<Dictionary>& dicts, QString path, qint32 spectra_length)
+{
+    QFile dict_file(path);
+    if(!dict_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning("FixDictMp::save_bin_dict: could not open %s.", qPrintable(path));
+        return false;
+    }
+
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+    BinDictFileHeader file_header;
+    memcpy(file_header.magic, BIN_DICT_MAGIC, 8);
+    file_header.version = BIN_DICT_VERSION;
+    file_header.byte_order_mark = BIN_DICT_BOM;
+    file_header.dict_count = dicts.length();
+    file_header.reserved = 0;
+
+    bool ok = dict_file.write((const char*)&file_header, sizeof(BinDictFileHeader)) == sizeof(BinDictFileHeader);
+
+    for(qint32 i = 0; i < dicts.length() && ok; i++)
+    {
+        Dictionary current_dict = dicts.at(i);
+
+        if(spectra_length > 0 && current_dict.spectra_length != spectra_length)
+            current_dict.calc_atom_spectra(spectra_length);
+
+        QByteArray source = current_dict.source.toUtf8();
+        QByteArray formula = current_dict.atom_formula.toUtf8();
+
+        BinDictHeader header;
+        header.type = current_dict.type;
+        header.sample_count = current_dict.sample_count;
+        header.atom_count = current_dict.atoms.length();
+        header.matrix_rows = 0;
+        for(qint32 k = 0; k < current_dict.atoms.length(); k++)
+            header.matrix_rows = qMax(header.matrix_rows, (qint32)current_dict.atoms.at(k).atom_samples.rows());
+        header.spectra_length = spectra_length > 0 ? spectra_length : 0;
+        header.source_size = source.size();
+        header.formula_size = formula.size();
+        header.reserved = 0;
+
+        MatrixXf atom_matrix = MatrixXf::Zero(header.matrix_rows, header.atom_count);
+        QVector<BinDictAtomParams> params(header.atom_count);
+
+        for(qint32 k = 0; k < header.atom_count; k++)
+        {
+            const FixDictAtom& current_atom = current_dict.atoms.at(k);
+
+            atom_matrix.col(k).head(current_atom.atom_samples.rows()) = current_atom.atom_samples.cast<float>();
+
+            memset(&params[k], 0, sizeof(BinDictAtomParams));
+            params[k].id = current_atom.id;
+            params[k].sample_count = current_atom.atom_samples.rows();
+
+            if(current_dict.type == GABORATOM)
+            {
+                params[k].params[0] = current_atom.gabor_atom.scale;
+                params[k].params[1] = current_atom.gabor_atom.modulation;
+                params[k].params[2] = current_atom.gabor_atom.phase;
+            }
+            else if(current_dict.type == CHIRPATOM)
+            {
+                params[k].params[0] = current_atom.chirp_atom.scale;
+                params[k].params[1] = current_atom.chirp_atom.modulation;
+                params[k].params[2] = current_atom.chirp_atom.phase;
+                params[k].params[3] = current_atom.chirp_atom.chirp;
+            }
+            else
+            {
+                params[k].params[0] = current_atom.formula_atom.a;
+                params[k].params[1] = current_atom.formula_atom.b;
+                params[k].params[2] = current_atom.formula_atom.c;
+                params[k].params[3] = current_atom.formula_atom.d;
+                params[k].params[4] = current_atom.formula_atom.e;
+                params[k].params[5] = current_atom.formula_atom.f;
+                params[k].params[6] = current_atom.formula_atom.g;
+                params[k].params[7] = current_atom.formula_atom.h;
+            }
+        }
+
+        qint64 strings_size = header.source_size + header.formula_size;
+        qint64 samples_size = (qint64)atom_matrix.size() * sizeof(float);
+
+        ok = dict_file.write((const char*)&header, sizeof(BinDictHeader)) == sizeof(BinDictHeader)
+                && dict_file.write(source) == source.size()
+                && dict_file.write(formula) == formula.size()
+                && dict_file.write(padding, bin_dict_align(strings_size) - strings_size) == bin_dict_align(strings_size) - strings_size
+                && dict_file.write((const char*)params.constData(), params.size() * sizeof(BinDictAtomParams)) == (qint64)(params.size() * sizeof(BinDictAtomParams))
+                && dict_file.write((const char*)atom_matrix.data(), samples_size) == samples_size
+                && dict_file.write(padding, bin_dict_align(samples_size) - samples_size) == bin_dict_align(samples_size) - samples_size;
+
+        if(ok && header.spectra_length > 0)
+        {
+            MatrixXcf spectra_matrix = current_dict.atom_spectra.cast<std::complex<float> >();
+            qint64 spectra_size = (qint64)spectra_matrix.size() * 2 * sizeof(float);
+
+            ok = dict_file.write((const char*)spectra_matrix.data(), spectra_size) == spectra_size;
+        }
+    }
+
+    dict_file.close();
+
+    if(!ok)
+    {
+        qWarning("FixDictMp::save_bin_dict: could not write %s.", qPrintable(path));
+        dict_file.remove();
+    }
+
+    return ok;
+}
+
+//*************************************************************************************************************
+
+bool FixDictMp::convert_xml_dict(QString xml_path, QString bin_path, qint32 spectra_length)
+{
+    QList<Dictionary> parsed_dict = parse_xml_dict(xml_path);
+    if(parsed_dict.isEmpty())
+    {
+        qWarning("FixDictMp::convert_xml_dict: %s holds no dictionaries.", qPrintable(xml_path));
+        return false;
+    }
+
+    return save_bin_dict(parsed_dict, bin_path, spectra_length);
+}
+
+//*************************************************************************************************************
+
 Dictionary FixDictMp::fill_dict(const QDomNode &pdict)
 {
     Dictionary current_dict;
@@ -522,10 +896,77 @@ qint32 Dictionary::atom_count()
      this->atom_formula = "";
      this->sample_count = 0;
      this->source = "";
+     this->atom_spectra.resize(0, 0);
+     this->spectra_length = 0;
  }
 
  //*************************************************************************************************************
 
+VectorXd Dictionary::fit_atom(const VectorXd& atom_samples, qint32 signal_length)
+{
+    VectorXd fitted_atom = VectorXd::Zero(signal_length);
+    qint32 p = floor(signal_length / 2);//translation
+
+    VectorXd resized_atom = VectorXd::Zero(signal_length);
+
+    if(atom_samples.rows() > signal_length)
+        for(qint32 k = 0; k < signal_length; k++)
+            resized_atom[k] = atom_samples[k + floor(atom_samples.rows() / 2) - floor(signal_length / 2)];
+    else resized_atom = atom_samples;
+
+    if(resized_atom.rows() < signal_length)
+        for(qint32 k = 0; k < resized_atom.rows(); k++)
+            fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
+    else fitted_atom = resized_atom;
+
+    //normalization
+    qreal norm = 0;
+    norm = fitted_atom.norm();
+    if(norm != 0) fitted_atom /= norm;
+
+    return fitted_atom;
+}
+
+//*************************************************************************************************************
+
+void Dictionary::calc_atom_spectra(qint32 signal_length)
+{
+    atom_spectra.resize(signal_length / 2 + 1, atoms.length());
+    spectra_length = signal_length;
+
+    qint32 chunk_count = qMax(1, qMin(QThread::idealThreadCount(), atoms.length()));
+
+    QList<SpectraChunk> chunks;
+    for(qint32 i = 0; i < chunk_count; i++)
+    {
+        SpectraChunk chunk;
+        chunk.dict = this;
+        chunk.first_atom = (qint64)atoms.length() * i / chunk_count;
+        chunk.atom_count = (qint64)atoms.length() * (i + 1) / chunk_count - chunk.first_atom;
+        chunks.append(chunk);
+    }
+
+    QtConcurrent::blockingMap(chunks, calc_spectra_chunk);
+}
+
+//*************************************************************************************************************
+
+void Dictionary::calc_spectra_chunk(SpectraChunk& chunk)
+{
+    Dictionary* dict = chunk.dict;
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    for(qint32 i = chunk.first_atom; i < chunk.first_atom + chunk.atom_count; i++)
+    {
+        VectorXd fitted_atom = fit_atom(dict->atoms.at(i).atom_samples, dict->spectra_length);
+        fft.fwd(dict->atom_spectra.col(i).data(), fitted_atom.data(), dict->spectra_length);
+    }
+}
+
+ //*************************************************************************************************************
+
 /*
 void FixDictMp::create_tree_dict(QString save_path)
 {
@@ -75,6 +75,7 @@
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
 #include <QFile>
+#include <QFileInfo>
 #include <QStringList>
 #include <QtXml/QtXml>
 
@@ -134,10 +135,55 @@ public:
     QString atom_formula;
     qint32 sample_count;
 
+    MatrixXcd atom_spectra;     /**< half spectra of the fitted and normalized atoms (signal_length/2+1 x atoms) */
+    qint32 spectra_length;      /**< signal length the atom spectra are calculated for, 0 if not calculated */
+
     qint32 atom_count();
 
     void clear();
 
+    //=========================================================================================================
+    /**
+    * dicitionary_calc_atom_spectra
+    *
+    * ### MP toolbox function ###
+    *
+    * fits all atoms to the signal length (centered and cut or zero padded), normalizes them and stores their
+    * half spectra, so the correlation doesn't need to transform the atoms again. The atoms are processed in
+    * parallel.
+    *
+    * @param[in] signal_length  number of samples of the signal the dictionary is applied to
+    */
+    void calc_atom_spectra(qint32 signal_length);
+
+    //=========================================================================================================
+    /**
+    * dicitionary_fit_atom
+    *
+    * ### MP toolbox function ###
+    *
+    * centers the atom samples in a vector of the signal length and normalizes them
+    *
+    * @param[in] atom_samples   samples of the atom
+    * @param[in] signal_length  number of samples of the signal
+    *
+    * @return the fitted atom
+    */
+    static VectorXd fit_atom(const VectorXd& atom_samples, qint32 signal_length);
+
+private:
+    /**
+    * Range of atoms whose spectra are calculated by one thread.
+    */
+    struct SpectraChunk
+    {
+        Dictionary* dict;       /**< the dictionary */
+        qint32 first_atom;      /**< first atom of the chunk */
+        qint32 atom_count;      /**< number of atoms of the chunk */
+    };
+
+    static void calc_spectra_chunk(SpectraChunk& chunk);
+
 };//class
 
 
@@ -195,6 +241,38 @@ public:
 
     FixDictAtom correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost);
 
+    //=========================================================================================================
+    /**
+    * fixdictMp_correlation
+    *
+    * ### MP toolbox function ###
+    *
+    * finds the atom and translation with the largest cross correlation to the residuum. The cross correlations
+    * are calculated out of the precalculated atom and residuum spectra, the atoms are searched in parallel.
+    *
+    * @param[in] current_pdict      dictionary with calculated atom spectra (Dictionary::calc_atom_spectra)
+    * @param[in] resid_spectra      half spectra of the observed residuum channels (signal_length/2+1 x channels)
+    * @param[in] signal_length      number of samples of the residuum
+    *
+    * @return best matching atom
+    */
+    static FixDictAtom correlation(const Dictionary& current_pdict, const MatrixXcd& resid_spectra, qint32 signal_length);
+
+    //=========================================================================================================
+    /**
+    * fixdictMp_calc_resid_spectra
+    *
+    * ### MP toolbox function ###
+    *
+    * calculates the half spectra of the residuum channels which are observed with the given boost
+    *
+    * @param[in] current_resid      residuum (samples x channels)
+    * @param[in] boost              percentage of observed channels
+    *
+    * @return half spectra of the observed channels (samples/2+1 x channels)
+    */
+    static MatrixXcd calc_resid_spectra(const MatrixXd& current_resid, qint32 boost);
+
     //=========================================================================================================
 
     //static void create_tree_dict(QString save_path);
@@ -222,6 +300,72 @@ public:
 
     QList<Dictionary> parse_xml_dict(QString path);
 
+    //=========================================================================================================
+    /**
+    * fixdictMp_parse_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * loads the dictionaries of a binary (.bdict) or xml (.dict) file. For a xml file the binary file next to it
+    * (same base name, suffix .bdict) is used when it is up to date, otherwise the xml is parsed. No file is
+    * written, binary files are created by convert_xml_dict.
+    *
+    * @param[in] path   path of the binary or xml dictionary file
+    *
+    * @return the parsed dictionaries
+    */
+    QList<Dictionary> parse_dict(QString path);
+
+    //=========================================================================================================
+    /**
+    * fixdictMp_parse_bin_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * loads the dictionaries of a binary dictionary file. The file is memory mapped and the atom matrices and
+    * spectra are copied in one pass, no text parsing is involved. Stored atom spectra are taken over as
+    * Dictionary::atom_spectra.
+    *
+    * @param[in] path   path of the binary dictionary file
+    *
+    * @return the parsed dictionaries, empty if the file is not a valid binary dictionary
+    */
+    QList<Dictionary> parse_bin_dict(QString path);
+
+    //=========================================================================================================
+    /**
+    * fixdictMp_save_bin_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * writes dictionaries to a binary dictionary file. Each dictionary is stored as a table of atom parameters,
+    * a contiguous float matrix of the atom samples (one column per atom) and optionally the float half spectra
+    * of the fitted atoms (see Dictionary::calc_atom_spectra).
+    *
+    * @param[in] dicts              dictionaries to store
+    * @param[in] path               path of the binary dictionary file
+    * @param[in] spectra_length     signal length the atom spectra are stored for, 0 stores no spectra
+    *
+    * @return true if the file was written
+    */
+    static bool save_bin_dict(const QList<Dictionary>& dicts, QString path, qint32 spectra_length = 0);
+
+    //=========================================================================================================
+    /**
+    * fixdictMp_convert_xml_dict
+    *
+    * ### MP toolbox function ###
+    *
+    * converts a xml dictionary file into a binary dictionary file
+    *
+    * @param[in] xml_path           path of the xml dictionary file
+    * @param[in] bin_path           path of the binary dictionary file
+    * @param[in] spectra_length     signal length the atom spectra are stored for, 0 stores no spectra
+    *
+    * @return true if the binary file was written
+    */
+    bool convert_xml_dict(QString xml_path, QString bin_path, qint32 spectra_length = 0);
+
     //=========================================================================================================
 
     Dictionary fill_dict(const QDomNode &pdict);
@@ -234,6 +378,24 @@ public:
 
     //static void build_molecule_xml_file(qint32 level_counter);
 
+private:
+    /**
+    * Range of atoms which is searched by one thread, holds the best match of the range.
+    */
+    struct CorrelationChunk
+    {
+        const Dictionary* dict;             /**< the dictionary */
+        const MatrixXcd* resid_spectra;     /**< half spectra of the residuum channels */
+        qint32 signal_length;               /**< number of samples of the residuum */
+        qint32 first_atom;                  /**< first atom of the chunk */
+        qint32 atom_count;                  /**< number of atoms of the chunk */
+        qint32 best_atom;                   /**< best matching atom of the chunk, -1 if none */
+        qint32 best_index;                  /**< lag of the maximal cross correlation */
+        qreal best_scalar_product;          /**< maximal cross correlation */
+    };
+
+    static void correlate_chunk(CorrelationChunk& chunk);
+
 
 public slots:
 
@@ -41,6 +41,16 @@
 #include "math.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent/QtConcurrent>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -68,33 +78,154 @@ VectorXd Spectrogram::gauss_window (qint32 sample_count, qreal scale, quint32 tr
 
 MatrixXd Spectrogram::make_spectrogram(VectorXd signal, qint32 window_size = 0)
 {
-    if(window_size == 0)
-        window_size = signal.rows()/4;
+    //one frame per sample translation with a full length fft
+    return make_spectrogram(signal, window_size, 1, signal.rows(), 1);
+}
 
-    Eigen::FFT<double> fft;
-    MatrixXd tf_matrix = MatrixXd::Zero(signal.rows()/2, signal.rows());
+//-----------------------------------------------------------------------------------------------------------------
+
+MatrixXd Spectrogram::make_spectrogram(const VectorXd& signal, qint32 window_size, qint32 hop, qint32 fft_length, qint32 freq_decimation)
+{
+    VectorXd window;
+    MatrixXd tf_matrix;
+    FrameChunk all_frames = setup_chunk(signal.rows(), window_size, hop, fft_length, freq_decimation, window, tf_matrix);
+    all_frames.signal = &signal;
+
+    //distribute the frames over the threads, each thread creates its fft plan once
+    qint32 frame_count = tf_matrix.cols();
+    qint32 chunk_count = qMax(1, qMin(QThread::idealThreadCount(), frame_count));
 
-    for(qint32 translate = 0; translate < signal.rows(); translate++)
+    QList<FrameChunk> chunks;
+    for(qint32 i = 0; i < chunk_count; i++)
     {
-        VectorXd envelope = gauss_window(signal.rows(), window_size, translate);
+        FrameChunk chunk = all_frames;
+        chunk.first_frame = (qint64)frame_count * i / chunk_count;
+        chunk.frame_count = (qint64)frame_count * (i + 1) / chunk_count - chunk.first_frame;
+        chunks.append(chunk);
+    }
 
-        VectorXd windowed_sig = VectorXd::Zero(signal.rows());
-        VectorXcd fft_win_sig = VectorXcd::Zero(signal.rows());
+    QtConcurrent::blockingMap(chunks, compute_frames);
 
-        VectorXd real_coeffs = VectorXd::Zero(signal.rows()/2);
+    return tf_matrix;
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+QList<MatrixXd> Spectrogram::make_spectrograms(const MatrixXd& signals, qint32 window_size, qint32 hop, qint32 fft_length, qint32 freq_decimation)
+{
+    QList<MatrixXd> tf_matrices;
 
-        for(qint32 sample = 0; sample < signal.rows(); sample++)
-            windowed_sig[sample] = signal[sample] * envelope[sample];
+    if(signals.cols() == 0)
+        return tf_matrices;
+
+    VectorXd window;
+    MatrixXd tf_matrix;
+    FrameChunk all_frames = setup_chunk(signals.rows(), window_size, hop, fft_length, freq_decimation, window, tf_matrix);
+
+    QVector<VectorXd> channel_signals(signals.cols());
+    for(qint32 channel = 0; channel < signals.cols(); channel++)
+    {
+        channel_signals[channel] = signals.col(channel);
+        tf_matrices.append(tf_matrix);
+    }
+
+    //one chunk per channel, the channels are processed in parallel
+    QList<FrameChunk> chunks;
+    for(qint32 channel = 0; channel < signals.cols(); channel++)
+    {
+        FrameChunk chunk = all_frames;
+        chunk.signal = &channel_signals[channel];
+        chunk.tf_matrix = &tf_matrices[channel];
+        chunks.append(chunk);
+    }
+
+    QtConcurrent::blockingMap(chunks, compute_frames);
+
+    return tf_matrices;
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+Spectrogram::FrameChunk Spectrogram::setup_chunk(qint32 signal_length, qint32 window_size, qint32 hop, qint32 fft_length, qint32 freq_decimation, VectorXd& window, MatrixXd& tf_matrix)
+{
+    if(window_size <= 0)
+        window_size = qMax(1, signal_length/4);
+    if(hop < 1)
+        hop = 1;
+    if(freq_decimation < 1)
+        freq_decimation = 1;
+
+    //exp(-3.14 * 3^2) < 1e-12 -> the window is truncated at 3 times its scale
+    qint32 half_width = (qint32)ceil(3.0 * window_size);
+    window = gauss_window(2 * half_width + 1, window_size, half_width);
+
+    //the fft has to hold the part of the window which overlaps the signal
+    qint32 support = qMax(2, qMin(2 * half_width + 1, signal_length));
+    qint32 nfft = 2;
+    if(fft_length > 0)
+        nfft = qMax(fft_length, support);
+    else
+        while(nfft < support)
+            nfft *= 2;
+
+    qint32 rows = (nfft/2 + freq_decimation - 1) / freq_decimation;
+    qint32 frames = (signal_length + hop - 1) / hop;
+    tf_matrix = MatrixXd::Zero(rows, frames);
+
+    FrameChunk chunk;
+    chunk.signal = 0;
+    chunk.window = &window;
+    chunk.half_width = half_width;
+    chunk.hop = hop;
+    chunk.fft_length = nfft;
+    chunk.freq_decimation = freq_decimation;
+    chunk.first_frame = 0;
+    chunk.frame_count = frames;
+    chunk.tf_matrix = &tf_matrix;
+
+    return chunk;
+}
+
+//-----------------------------------------------------------------------------------------------------------------
+
+void Spectrogram::compute_frames(FrameChunk& chunk)
+{
+    const VectorXd& signal = *chunk.signal;
+    const VectorXd& window = *chunk.window;
+    MatrixXd& tf_matrix = *chunk.tf_matrix;
+
+    qint32 signal_length = signal.rows();
+    qint32 bins = chunk.fft_length/2;
+
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    VectorXd windowed_sig = VectorXd::Zero(chunk.fft_length);
+    VectorXcd fft_win_sig = VectorXcd::Zero(bins + 1);
+
+    for(qint32 frame = chunk.first_frame; frame < chunk.first_frame + chunk.frame_count; frame++)
+    {
+        //part of the truncated window which overlaps the signal
+        qint32 center = frame * chunk.hop;
+        qint32 start = qMax(0, center - chunk.half_width);
+        qint32 end = qMin(signal_length - 1, center + chunk.half_width);
+        qint32 length = end - start + 1;
+
+        windowed_sig.setZero();
+        windowed_sig.head(length) = signal.segment(start, length).cwiseProduct(window.segment(start - center + chunk.half_width, length));
 
         fft.fwd(fft_win_sig, windowed_sig);
 
-        for(qint32 i= 0; i<signal.rows()/2; i++)
+        for(qint32 row = 0; row < tf_matrix.rows(); row++)
         {
-            qreal value = pow(abs(fft_win_sig[i]), 2.0);
-            real_coeffs[i] = value;
-        }
+            qint32 first_bin = row * chunk.freq_decimation;
+            qint32 last_bin = qMin(first_bin + chunk.freq_decimation, bins);
 
-        tf_matrix.col(translate) = real_coeffs;
+            qreal value = 0;
+            for(qint32 bin = first_bin; bin < last_bin; bin++)
+                value += std::norm(fft_win_sig[bin]);
+
+            tf_matrix(row, frame) = value / (last_bin - first_bin);
+        }
     }
-    return tf_matrix;
 }
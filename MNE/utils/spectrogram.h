@@ -47,6 +47,8 @@
 // Qt INCLUDES
 //=============================================================================================================
 
+#include <QList>
+
 //*************************************************************************************************************
 //=============================================================================================================
 // Eigen INCLUDES
@@ -85,7 +87,87 @@ public:
     */
     static MatrixXd make_spectrogram(VectorXd signal, qint32 window_size);
 
+    //=========================================================================================================
+    /**
+    * Spectrogram_make_spectrogram
+    *
+    * ### TF plot root function ###
+    *
+    * calculates the short-time spectrogram of a given signal. The gaussean window is truncated where it is
+    * negligible, the frames are distributed over the available threads and each thread reuses one FFT plan.
+    *
+    * @param[in] signal             input-signal to calculate spectrogram of
+    * @param[in] window_size        size (scale) of the window, 0 for signal length/4
+    * @param[in] hop                number of samples between the centers of succeeding frames
+    * @param[in] fft_length         minimal fft length, 0 to use the next power of two of the truncated window
+    * @param[in] freq_decimation    number of neighbouring frequency bins which are averaged to one row
+    *
+    * @return spectrogram-matrix (fft_length/2/freq_decimation x signal length/hop)
+    */
+    static MatrixXd make_spectrogram(const VectorXd& signal, qint32 window_size, qint32 hop, qint32 fft_length = 0, qint32 freq_decimation = 1);
+
+    //=========================================================================================================
+    /**
+    * Spectrogram_make_spectrograms
+    *
+    * ### TF plot root function ###
+    *
+    * calculates the short-time spectrograms of several channels in parallel
+    *
+    * @param[in] signals            input-signals (samples x channels)
+    * @param[in] window_size        size (scale) of the window, 0 for signal length/4
+    * @param[in] hop                number of samples between the centers of succeeding frames
+    * @param[in] fft_length         minimal fft length, 0 to use the next power of two of the truncated window
+    * @param[in] freq_decimation    number of neighbouring frequency bins which are averaged to one row
+    *
+    * @return one spectrogram-matrix per channel
+    */
+    static QList<MatrixXd> make_spectrograms(const MatrixXd& signals, qint32 window_size, qint32 hop, qint32 fft_length = 0, qint32 freq_decimation = 1);
+
 private:
+    /**
+    * Frames of one signal which are computed by one thread.
+    */
+    struct FrameChunk
+    {
+        const VectorXd* signal;         /**< input-signal */
+        const VectorXd* window;         /**< truncated window, centered at sample half_width */
+        qint32 half_width;              /**< half width of the truncated window */
+        qint32 hop;                     /**< samples between the frame centers */
+        qint32 fft_length;              /**< fft length */
+        qint32 freq_decimation;         /**< averaged bins per row */
+        qint32 first_frame;             /**< first frame of the chunk */
+        qint32 frame_count;             /**< number of frames of the chunk */
+        MatrixXd* tf_matrix;            /**< destination spectrogram-matrix */
+    };
+
+    //=========================================================================================================
+    /**
+    * Spectrogram_compute_frames
+    *
+    * computes the frames of one chunk with its own fft plan
+    *
+    * @param[in, out] chunk     the frames to compute
+    */
+    static void compute_frames(FrameChunk& chunk);
+
+    //=========================================================================================================
+    /**
+    * Spectrogram_setup_chunk
+    *
+    * calculates the truncated window and the fft length and allocates the spectrogram-matrix
+    *
+    * @param[in] signal_length      number of samples of the signal
+    * @param[in] window_size        size (scale) of the window, 0 for signal length/4
+    * @param[in] hop                number of samples between the centers of succeeding frames
+    * @param[in] fft_length         minimal fft length, 0 to use the next power of two of the truncated window
+    * @param[in] freq_decimation    number of neighbouring frequency bins which are averaged to one row
+    * @param[out] window            the truncated window
+    * @param[out] tf_matrix         the allocated spectrogram-matrix
+    *
+    * @return chunk which covers all frames
+    */
+    static FrameChunk setup_chunk(qint32 signal_length, qint32 window_size, qint32 hop, qint32 fft_length, qint32 freq_decimation, VectorXd& window, MatrixXd& tf_matrix);
 
     //=========================================================================================================
     /**
@@ -75,6 +75,7 @@ SOURCES += \
     kmeans.cpp \
     mnemath.cpp \
     ioutils.cpp \
+    babymegparser.cpp \
     layoutloader.cpp \
     layoutmaker.cpp \
     mp/adaptivemp.cpp \
@@ -86,8 +87,10 @@ SOURCES += \
     filterTools/parksmcclellan.cpp \
     filterTools/filterdata.cpp \
     filterTools/filterio.cpp \
+    filterTools/overlapsavefilter.cpp \
     detecttrigger.cpp \
     spectrogram.cpp \
+    welchpsd.cpp \
     warp.cpp \
     filterTools/sphara.cpp
 
@@ -96,6 +99,7 @@ HEADERS += \
     utils_global.h \
     mnemath.h \
     ioutils.h \
+    babymegparser.h \
     layoutloader.h \
     layoutmaker.h \
     mp/adaptivemp.h \
@@ -108,8 +112,10 @@ HEADERS += \
     filterTools/parksmcclellan.h \
     filterTools/filterdata.h \
     filterTools/filterio.h \
+    filterTools/overlapsavefilter.h \
     detecttrigger.h \
     spectrogram.h \
+    welchpsd.h \
     warp.h \
     filterTools/sphara.h
 
@@ -0,0 +1,268 @@
+//=============================================================================================================
+/**
+* @file     welchpsd.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    WelchPsd class definition.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "welchpsd.h"
+
+#include <math.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrent>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+WelchPsd::WelchPsd(qint32 p_iNumChannels, qint32 p_iFFTLength, double p_dSFreq, double p_dOverlap, WindowType p_window, qint32 p_iNumAverages)
+: m_iNumChannels(p_iNumChannels > 0 ? p_iNumChannels : 1)
+, m_iFFTLength(p_iFFTLength > 1 ? p_iFFTLength : 2)
+, m_iNumAverages(p_iNumAverages > 0 ? p_iNumAverages : 1)
+, m_dSFreq(p_dSFreq)
+, m_iNumSamples(0)
+, m_iNextSegment(0)
+, m_iNumSegments(0)
+{
+    if(p_dOverlap < 0.0 || p_dOverlap >= 1.0)
+    {
+        qWarning("WelchPsd: Overlap %f is out of [0, 1), segments won't overlap.", p_dOverlap);
+        p_dOverlap = 0.0;
+    }
+
+    m_iStep = qMax(1, (qint32)floor(m_iFFTLength*(1.0 - p_dOverlap) + 0.5));
+
+    m_vecWindow = window(p_window, m_iFFTLength);
+    m_dScale = 1.0/(m_dSFreq*m_vecWindow.squaredNorm());
+
+    //The latest two segment lengths are kept -> append() writes at most one segment length at once
+    m_matRing = MatrixXd::Zero(2*m_iFFTLength, m_iNumChannels);
+    m_matPsd = MatrixXd::Zero(m_iFFTLength/2+1, m_iNumChannels);
+
+    //One work package with its own FFT plan per thread
+    qint32 t_iNumChunks = qMax(1, qMin(QThread::idealThreadCount(), m_iNumChannels));
+    m_qVecChunks.resize(t_iNumChunks);
+
+    qint32 t_iStart = 0;
+    for(qint32 i = 0; i < t_iNumChunks; ++i)
+    {
+        ChannelChunk& t_chunk = m_qVecChunks[i];
+        t_chunk.Psd = this;
+        t_chunk.StartChannel = t_iStart;
+        t_chunk.NumChannels = m_iNumChannels/t_iNumChunks + (i < m_iNumChannels%t_iNumChunks ? 1 : 0);
+        t_chunk.Fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+        t_chunk.TimeData = VectorXd::Zero(m_iFFTLength);
+        t_chunk.FreqData = VectorXcd::Zero(m_iFFTLength/2+1);
+
+        t_iStart += t_chunk.NumChannels;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void WelchPsd::reset()
+{
+    m_iNumSamples = 0;
+    m_iNextSegment = 0;
+    m_iNumSegments = 0;
+    m_qVecPending.clear();
+    m_matPsd.setZero();
+}
+
+
+//*************************************************************************************************************
+
+qint32 WelchPsd::append(const MatrixXd& p_matData)
+{
+    if(p_matData.rows() != m_iNumChannels)
+    {
+        qWarning("WelchPsd::append: Number of rows (%d) doesn't match the number of channels (%d).", (int)p_matData.rows(), m_iNumChannels);
+        return 0;
+    }
+
+    qint32 t_iRingSize = m_matRing.rows();
+    qint32 t_iNumAdded = 0;
+
+    qint32 t_iOffset = 0;
+    while(t_iOffset < p_matData.cols())
+    {
+        //Copy at most one segment length, so the pending segments are still in the ring
+        qint32 t_iLength = qMin(m_iFFTLength, (qint32)p_matData.cols() - t_iOffset);
+        qint32 t_iPos = (qint32)(m_iNumSamples % t_iRingSize);
+        qint32 t_iFirst = qMin(t_iLength, t_iRingSize - t_iPos);
+
+        m_matRing.block(t_iPos, 0, t_iFirst, m_iNumChannels) = p_matData.block(0, t_iOffset, m_iNumChannels, t_iFirst).transpose();
+        if(t_iFirst < t_iLength)
+            m_matRing.block(0, 0, t_iLength - t_iFirst, m_iNumChannels) = p_matData.block(0, t_iOffset + t_iFirst, m_iNumChannels, t_iLength - t_iFirst).transpose();
+
+        m_iNumSamples += t_iLength;
+        t_iOffset += t_iLength;
+
+        //Collect the segments completed by this piece
+        m_qVecPending.clear();
+        while(m_iNextSegment + m_iFFTLength <= m_iNumSamples)
+        {
+            m_qVecPending.append(m_iNextSegment);
+            m_iNextSegment += m_iStep;
+        }
+
+        if(m_qVecPending.isEmpty())
+            continue;
+
+        for(qint32 i = 0; i < m_qVecChunks.size(); ++i)
+            m_qVecChunks[i].Psd = this;
+
+        if(m_qVecChunks.size() == 1)
+            processChunk(m_qVecChunks[0]);
+        else
+            QtConcurrent::blockingMap(m_qVecChunks, processChunk);
+
+        m_iNumSegments += m_qVecPending.size();
+        t_iNumAdded += m_qVecPending.size();
+    }
+
+    return t_iNumAdded;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd WelchPsd::psd() const
+{
+    return m_matPsd.transpose();
+}
+
+
+//*************************************************************************************************************
+
+RowVectorXd WelchPsd::frequencies() const
+{
+    RowVectorXd t_vecFreqs(m_iFFTLength/2+1);
+    for(qint32 i = 0; i < t_vecFreqs.size(); ++i)
+        t_vecFreqs[i] = i*m_dSFreq/m_iFFTLength;
+
+    return t_vecFreqs;
+}
+
+
+//*************************************************************************************************************
+
+VectorXd WelchPsd::window(WindowType p_window, qint32 p_iLength)
+{
+    VectorXd t_vecWin(p_iLength);
+
+    for(qint32 n = 0; n < p_iLength; ++n)
+    {
+        double t_dPhi = 2.0*M_PI*n/p_iLength;
+
+        switch(p_window)
+        {
+            case Hanning:
+                t_vecWin[n] = 0.5 - 0.5*cos(t_dPhi);
+                break;
+            case Hamming:
+                t_vecWin[n] = 0.54 - 0.46*cos(t_dPhi);
+                break;
+            case Blackman:
+                t_vecWin[n] = 0.42 - 0.5*cos(t_dPhi) + 0.08*cos(2.0*t_dPhi);
+                break;
+            default:
+                t_vecWin[n] = 1.0;
+                break;
+        }
+    }
+
+    return t_vecWin;
+}
+
+
+//*************************************************************************************************************
+
+void WelchPsd::processChunk(ChannelChunk& p_chunk)
+{
+    WelchPsd* t_pPsd = p_chunk.Psd;
+
+    const qint32 t_iLength = t_pPsd->m_iFFTLength;
+    const qint32 t_iRingSize = t_pPsd->m_matRing.rows();
+    const qint32 t_iNumBins = t_iLength/2+1;
+
+    for(qint32 k = 0; k < t_pPsd->m_qVecPending.size(); ++k)
+    {
+        qint32 t_iStart = (qint32)(t_pPsd->m_qVecPending[k] % t_iRingSize);
+        qint32 t_iFirst = qMin(t_iLength, t_iRingSize - t_iStart);
+
+        //Linear mean for the first segments, exponential decay afterwards
+        double t_dWeight = 1.0/qMin(t_pPsd->m_iNumSegments + k + 1, (qint64)t_pPsd->m_iNumAverages);
+
+        for(qint32 ch = p_chunk.StartChannel; ch < p_chunk.StartChannel + p_chunk.NumChannels; ++ch)
+        {
+            p_chunk.TimeData.head(t_iFirst) = t_pPsd->m_matRing.col(ch).segment(t_iStart, t_iFirst).cwiseProduct(t_pPsd->m_vecWindow.head(t_iFirst));
+            if(t_iFirst < t_iLength)
+                p_chunk.TimeData.tail(t_iLength - t_iFirst) = t_pPsd->m_matRing.col(ch).head(t_iLength - t_iFirst).cwiseProduct(t_pPsd->m_vecWindow.tail(t_iLength - t_iFirst));
+
+            p_chunk.Fft.fwd(p_chunk.FreqData, p_chunk.TimeData);
+
+            //One-sided density: all bins except DC and Nyquist carry the power of the negative frequencies
+            double* t_pPsdCol = t_pPsd->m_matPsd.col(ch).data();
+            for(qint32 j = 0; j < t_iNumBins; ++j)
+            {
+                double t_dPower = std::norm(p_chunk.FreqData[j])*t_pPsd->m_dScale;
+                if(j > 0 && !(j == t_iLength/2 && t_iLength%2 == 0))
+                    t_dPower *= 2.0;
+
+                t_pPsdCol[j] += t_dWeight*(t_dPower - t_pPsdCol[j]);
+            }
+        }
+    }
+}
@@ -0,0 +1,242 @@
+//=============================================================================================================
+/**
+* @file     welchpsd.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    WelchPsd class declaration.
+*
+*/
+
+#ifndef WELCHPSD_H
+#define WELCHPSD_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QVector>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Multichannel power spectral density estimation after Welch. The data is appended block by block, every
+* completed (overlapping) segment is windowed, transformed with a real-to-complex FFT and averaged into the
+* spectrum. The channels are processed in parallel, each worker keeps its own FFT plan and work buffers, so
+* no allocations happen after the first block.
+*
+* @brief Incremental Welch power spectral density estimation
+*/
+class UTILSSHARED_EXPORT WelchPsd
+{
+public:
+    typedef QSharedPointer<WelchPsd> SPtr;             /**< Shared pointer type for WelchPsd. */
+    typedef QSharedPointer<const WelchPsd> ConstSPtr;  /**< Const shared pointer type for WelchPsd. */
+
+    /**
+    * Window which is applied to each segment.
+    */
+    enum WindowType {
+        Rectangular,    /**< No tapering. */
+        Hanning,        /**< Periodic Hann window. */
+        Hamming,        /**< Periodic Hamming window. */
+        Blackman        /**< Periodic Blackman window. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Creates the Welch estimator.
+    *
+    * @param[in] p_iNumChannels     Number of channels (rows) of the appended data.
+    * @param[in] p_iFFTLength       Segment and FFT length in samples.
+    * @param[in] p_dSFreq           Sampling frequency in Hz.
+    * @param[in] p_dOverlap         Overlap of succeeding segments [0, 1) (default 0.5).
+    * @param[in] p_window           Window applied to each segment (default Hanning).
+    * @param[in] p_iNumAverages     Number of segments the spectrum is averaged over. The first segments are
+    *                               averaged linearly, afterwards older segments decay exponentially with this
+    *                               time constant (default 10).
+    */
+    WelchPsd(qint32 p_iNumChannels, qint32 p_iFFTLength, double p_dSFreq, double p_dOverlap = 0.5, WindowType p_window = Hanning, qint32 p_iNumAverages = 10);
+
+    //=========================================================================================================
+    /**
+    * Discards all appended data and the current spectrum.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Appends a new data block. Each segment which is completed by this block is added to the spectrum.
+    *
+    * @param[in] p_matData      Data block (channels x samples).
+    *
+    * @return the number of segments which were added to the spectrum.
+    */
+    qint32 append(const MatrixXd& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Returns the one-sided power spectral density (channels x FFT length/2+1) in units^2/Hz.
+    *
+    * @return the current spectrum.
+    */
+    MatrixXd psd() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the frequencies of the spectrum bins.
+    *
+    * @return frequency of each column of psd() in Hz.
+    */
+    RowVectorXd frequencies() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of segments added since the last reset.
+    *
+    * @return the number of segments.
+    */
+    inline qint64 numSegments() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of samples between the starts of two succeeding segments.
+    *
+    * @return the segment step in samples.
+    */
+    inline qint32 stepSize() const;
+
+    //=========================================================================================================
+    /**
+    * Creates a periodic window as used for spectral estimation.
+    *
+    * @param[in] p_window       Window type.
+    * @param[in] p_iLength      Window length.
+    *
+    * @return the window samples.
+    */
+    static VectorXd window(WindowType p_window, qint32 p_iLength);
+
+private:
+    /**
+    * Work package of one worker: a range of channels with its own FFT plan and work buffers.
+    */
+    struct ChannelChunk
+    {
+        WelchPsd* Psd;              /**< The estimator the chunk belongs to. */
+        qint32 StartChannel;        /**< First channel of the chunk. */
+        qint32 NumChannels;         /**< Number of channels of the chunk. */
+        Eigen::FFT<double> Fft;     /**< Persistent FFT plan of the worker. */
+        VectorXd TimeData;          /**< Windowed segment. */
+        VectorXcd FreqData;         /**< Half spectrum of the windowed segment. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Adds all pending segments of the channels of one chunk to the spectrum.
+    *
+    * @param[in, out] p_chunk   The chunk to process.
+    */
+    static void processChunk(ChannelChunk& p_chunk);
+
+    qint32      m_iNumChannels;     /**< Number of channels. */
+    qint32      m_iFFTLength;       /**< Segment and FFT length. */
+    qint32      m_iStep;            /**< Samples between the starts of two succeeding segments. */
+    qint32      m_iNumAverages;     /**< Number of averaged segments. */
+    double      m_dSFreq;           /**< Sampling frequency. */
+    double      m_dScale;           /**< Density scaling 1/(fs * sum(w^2)). */
+
+    VectorXd    m_vecWindow;        /**< Segment window. */
+
+    MatrixXd    m_matRing;          /**< Latest samples (2*FFT length x channels), row = absolute sample % rows. */
+    qint64      m_iNumSamples;      /**< Number of received samples. */
+    qint64      m_iNextSegment;     /**< Absolute start sample of the next segment. */
+    qint64      m_iNumSegments;     /**< Number of segments added to the spectrum. */
+
+    QVector<qint64> m_qVecPending;  /**< Absolute start samples of the segments which are processed next. */
+
+    MatrixXd    m_matPsd;           /**< Averaged spectrum (FFT length/2+1 x channels). */
+
+    QVector<ChannelChunk> m_qVecChunks; /**< Work packages, one per worker thread. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint64 WelchPsd::numSegments() const
+{
+    return m_iNumSegments;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 WelchPsd::stepSize() const
+{
+    return m_iStep;
+}
+
+} // NAMESPACE
+
+#endif // WELCHPSD_H
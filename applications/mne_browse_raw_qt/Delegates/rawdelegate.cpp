@@ -131,7 +131,7 @@ void RawDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, c
 
         const RawModel* t_rawModel = (static_cast<const RawModel*>(index.model()));
 
-        QPainterPath path(QPointF(option.rect.x()+t_rawModel->relFiffCursor()-1,option.rect.y()));
+        QPainterPath path(QPointF(option.rect.x()+t_rawModel->relFiffCursor()*m_dDx-1,option.rect.y()));
 
         //Plot grid
         painter->setRenderHint(QPainter::Antialiasing, false);
@@ -146,7 +146,7 @@ void RawDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, c
         painter->restore();
 
         //Plot data path
-        path = QPainterPath(QPointF(option.rect.x()+t_rawModel->relFiffCursor(), option.rect.y()));
+        path = QPainterPath(QPointF(option.rect.x()+t_rawModel->relFiffCursor()*m_dDx, option.rect.y()));
         createPlotPath(index, option, path, listPairs, channelMean);
 
         if(option.state & QStyle::State_Selected) {
@@ -263,6 +263,19 @@ void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionVie
 
     path.moveTo(path.currentPosition().x(), -(y_base + ((*(listPairs[0].first) - channelMean)*dScaleY)));
 
+    //plot the min/max per pixel column if more than one sample falls onto a pixel
+    const RawModel* t_rawModel = static_cast<const RawModel*>(index.model());
+    int level = m_dDx > 0 ? t_rawModel->lodLevel(1.0/m_dDx) : 0;
+
+    if(level > 0) {
+        QList<MinMaxRowPair> listMinMax = t_rawModel->minMaxData(index.row(), level);
+
+        if(listMinMax.size() == listPairs.size()) {
+            createMinMaxPlotPath(path, listPairs, listMinMax, level, y_base, channelMean, dScaleY);
+            return;
+        }
+    }
+
     //plot all rows from list of pairs
     for(qint8 i=0; i < listPairs.size(); ++i) {
         //create lines from one to the next sample
@@ -286,6 +299,71 @@ void RawDelegate::createPlotPath(const QModelIndex &index, const QStyleOptionVie
 }
 
 
+//*************************************************************************************************************
+
+void RawDelegate::createMinMaxPlotPath(QPainterPath& path, const QList<RowVectorPair>& listPairs, const QList<MinMaxRowPair>& listMinMax, int level, double y_base, double channelMean, double dScaleY) const
+{
+    qint32 bucketSize = 1 << level;
+    double x0 = path.currentPosition().x();
+    double lastValue = *(listPairs[0].first);
+
+    //draw a vertical line from min to max, start at the end which is closer to the last value to keep the trace connected
+    auto addColumn = [&](double x, double minValue, double maxValue) {
+        double first = minValue;
+        double second = maxValue;
+        if(lastValue - minValue > maxValue - lastValue) {
+            first = maxValue;
+            second = minValue;
+        }
+
+        path.lineTo(x, -(y_base + (first - channelMean)*dScaleY));
+        if(second != first)
+            path.lineTo(x, -(y_base + (second - channelMean)*dScaleY));
+
+        lastValue = second;
+    };
+
+    bool bColumn = false;
+    int column = 0;
+    double columnX = x0;
+    double columnMin = 0;
+    double columnMax = 0;
+
+    qint32 sampleOffset = 0;
+
+    for(qint8 i=0; i < listPairs.size(); ++i) {
+        const double* pMin = listMinMax[i].first.first;
+        const double* pMax = listMinMax[i].second.first;
+
+        for(qint32 j=0; j < listMinMax[i].first.second; ++j) {
+            //x position of the first sample of the bucket, the same as in createPlotPath
+            double x = x0 + (sampleOffset + j*bucketSize + 1)*m_dDx;
+            int bucketColumn = (int)floor(x);
+
+            if(bColumn && bucketColumn == column) {
+                columnMin = qMin(columnMin, pMin[j]);
+                columnMax = qMax(columnMax, pMax[j]);
+                continue;
+            }
+
+            if(bColumn)
+                addColumn(columnX, columnMin, columnMax);
+
+            bColumn = true;
+            column = bucketColumn;
+            columnX = x;
+            columnMin = pMin[j];
+            columnMax = pMax[j];
+        }
+
+        sampleOffset += listPairs[i].second;
+    }
+
+    if(bColumn)
+        addColumn(columnX, columnMin, columnMax);
+}
+
+
 //*************************************************************************************************************
 
 void RawDelegate::createGridPath(QPainterPath& path, const QStyleOptionViewItem &option, QList<RowVectorPair>& listPairs) const
@@ -337,7 +415,7 @@ void RawDelegate::plotEvents(const QModelIndex &index, const QStyleOptionViewIte
                 painter->setPen(pen);
 
                 //Draw line from sample position (x) and highest to lowest y position of the column widget - Add -m_qSettings.value("EventDesignParameters/event_marker_width").toInt() to avoid painting ovre the edge of the column widget
-                painter->drawLine(option.rect.x() + sampleValue, option.rect.y(), option.rect.x() + sampleValue, option.rect.y() + option.rect.height() - EVENT_MARKER_WIDTH);
+                painter->drawLine(option.rect.x() + sampleValue*m_dDx, option.rect.y(), option.rect.x() + sampleValue*m_dDx, option.rect.y() + option.rect.height() - EVENT_MARKER_WIDTH);
             } // END for statement
         } // END if statement event in data range
     } // END if statement plot all
@@ -362,7 +440,7 @@ void RawDelegate::plotEvents(const QModelIndex &index, const QStyleOptionViewIte
                 painter->setPen(pen);
 
                 //Draw line from sample position (x) and highest to lowest y position of the column widget - Add +m_qSettings.value("EventDesignParameters/event_marker_width").toInt() to avoid painting ovre the edge of the column widget
-                painter->drawLine(option.rect.x() + sampleValue, option.rect.y(), option.rect.x() + sampleValue, option.rect.y() - option.rect.height() + EVENT_MARKER_WIDTH);
+                painter->drawLine(option.rect.x() + sampleValue*m_dDx, option.rect.y(), option.rect.x() + sampleValue*m_dDx, option.rect.y() - option.rect.height() + EVENT_MARKER_WIDTH);
             } // END for statement
         } // END if statement
     } // END else statement
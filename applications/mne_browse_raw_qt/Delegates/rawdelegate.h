@@ -163,7 +163,7 @@ public:
     // Scaling
     double      m_dMaxValue;                /**< Maximum value of the data to plot. */
     double      m_dScaleY;                  /**< Maximum amplitude of plot (max is m_dPlotHeight/2). */
-    double      m_dDx;                      /**< pixel difference to the next sample. */
+    double      m_dDx;                      /**< pixel difference to the next sample (plot resolution), below one the traces are plotted from the min/max pyramids. Set it through DataWindow::setPlotResolution. */
 
 private:
     //=========================================================================================================
@@ -175,6 +175,22 @@ private:
     */
     void createPlotPath(const QModelIndex &index, const QStyleOptionViewItem &option, QPainterPath& path, QList<RowVectorPair>& listPairs, double channelMean) const;
 
+    //=========================================================================================================
+    /**
+    * createMinMaxPlotPath creates the QPointer path for the data plot if several samples fall onto one pixel column.
+    * Each pixel column is plotted as one vertical line from the minimum to the maximum of its samples, which are
+    * taken from the min/max pyramids of the model.
+    *
+    * @param[in,out] path The QPointerPath to create for the data plot, positioned at the first sample.
+    * @param[in] listPairs The loaded windows of the channel.
+    * @param[in] listMinMax The bucket minima and maxima of the loaded windows.
+    * @param[in] level The pyramid level, i.e. the buckets hold 2^level samples.
+    * @param[in] y_base The y position of the zero line.
+    * @param[in] channelMean The mean which is subtracted from the data.
+    * @param[in] dScaleY The scaling from data to pixels.
+    */
+    void createMinMaxPlotPath(QPainterPath& path, const QList<RowVectorPair>& listPairs, const QList<MinMaxRowPair>& listMinMax, int level, double y_base, double channelMean, double dScaleY) const;
+
     //=========================================================================================================
     /**
     * createGridPath Creates the QPointer path for the grid plot.
@@ -61,7 +61,16 @@ RawModel::RawModel(QObject *parent)
 , m_bFileloaded(false)
 , m_bStartReached(false)
 , m_bEndReached(false)
+, m_bReloadBefore(false)
 , m_bReloading(false)
+, m_bReloadPending(false)
+, m_iReloadStart(0)
+, m_iReloadEnd(0)
+, m_iReloadTicket(0)
+, m_iPrefetchStart(-1)
+, m_iPrefetchTicket(0)
+, m_iLoadTicket(0)
+, m_windowCache((qint64)MODEL_CACHE_MEMORY*1024*1024)
 , m_bProcessing(false)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
@@ -70,6 +79,7 @@ RawModel::RawModel(QObject *parent)
     m_iWindowSize = MODEL_WINDOW_SIZE;
     m_reloadPos = MODEL_RELOAD_POS;
     m_maxWindows = MODEL_MAX_WINDOWS;
+    m_iVisibleSamples = 0;
     m_iFilterTaps = MODEL_NUM_FILTER_TAPS;
 
     //Set default sampling freq to 1024
@@ -79,14 +89,15 @@ RawModel::RawModel(QObject *parent)
     genStdFilterOps();
 
     //connect data reloading - this is done concurrently
-    connect(&m_reloadFutureWatcher,&QFutureWatcher<QPair<MatrixXd,MatrixXd> >::finished,[this](){
-        insertReloadedData(m_reloadFutureWatcher.future().result());
+    connect(&m_reloadFutureWatcher,&QFutureWatcher<QSharedPointer<DataPackage> >::finished,[this](){
+        //a reset of the position or a reload which was handed to a prefetch makes the result obsolete
+        if(m_bReloading && !m_bReloadPending)
+            insertReloadedData(m_reloadFutureWatcher.future().result());
     });
 
-    //connect filtering reloading - this is done after a new block has been loaded
-    connect(this,&RawModel::dataReloaded,[this](){
-        if(!m_assignedOperators.empty())
-            updateOperatorsConcurrently();
+    //connect read-ahead - the processing is done together with the loading in the background-thread
+    connect(&m_prefetchFutureWatcher,&QFutureWatcher<QSharedPointer<DataPackage> >::finished,[this](){
+        insertPrefetchedData(m_prefetchFutureWatcher.future().result());
     });
 
 //    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::resultReadyAt,[this](int index){
@@ -108,7 +119,16 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
 , m_bFileloaded(false)
 , m_bStartReached(false)
 , m_bEndReached(false)
+, m_bReloadBefore(false)
 , m_bReloading(false)
+, m_bReloadPending(false)
+, m_iReloadStart(0)
+, m_iReloadEnd(0)
+, m_iReloadTicket(0)
+, m_iPrefetchStart(-1)
+, m_iPrefetchTicket(0)
+, m_iLoadTicket(0)
+, m_windowCache((qint64)MODEL_CACHE_MEMORY*1024*1024)
 , m_bProcessing(false)
 , m_pFiffInfo(new FiffInfo())
 , m_pfiffIO(QSharedPointer<FiffIO>(new FiffIO()))
@@ -117,6 +137,7 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
     m_iWindowSize = MODEL_WINDOW_SIZE;
     m_reloadPos = MODEL_RELOAD_POS;
     m_maxWindows = MODEL_MAX_WINDOWS;
+    m_iVisibleSamples = 0;
     m_iFilterTaps = MODEL_NUM_FILTER_TAPS;
 
     //read fiff data
@@ -126,13 +147,13 @@ RawModel::RawModel(QFile &qFile, QObject *parent)
     genStdFilterOps();
 
     //connect signal and slots
-    connect(&m_reloadFutureWatcher,&QFutureWatcher<QPair<MatrixXd,MatrixXd> >::finished,[this](){
-        insertReloadedData(m_reloadFutureWatcher.future().result());
+    connect(&m_reloadFutureWatcher,&QFutureWatcher<QSharedPointer<DataPackage> >::finished,[this](){
+        if(m_bReloading && !m_bReloadPending)
+            insertReloadedData(m_reloadFutureWatcher.future().result());
     });
 
-    connect(this,&RawModel::dataReloaded,[this](){
-        if(!m_assignedOperators.empty())
-            updateOperatorsConcurrently();
+    connect(&m_prefetchFutureWatcher,&QFutureWatcher<QSharedPointer<DataPackage> >::finished,[this](){
+        insertPrefetchedData(m_prefetchFutureWatcher.future().result());
     });
 
 //    connect(&m_operatorFutureWatcher,&QFutureWatcher<QPair<int,RowVectorXd> >::resultReadyAt,[this](int index){
@@ -191,7 +212,7 @@ QVariant RawModel::data(const QModelIndex &index, int role) const
 
                 for(qint16 i=0; i < m_data.size(); ++i) {
                     //if channel is not filtered or background Processing pending...
-                    if(!m_assignedOperators.contains(index.row()) || (m_bProcessing && m_bReloadBefore && i==0) || (m_bProcessing && !m_bReloadBefore && i==m_data.size()-1)) {
+                    if(!showProcessedData(index.row(), i)) {
                         rowVectorPair.first = m_data[i]->dataRaw().data() + index.row()*m_data[i]->dataRaw().cols();
                         rowVectorPair.second  = m_data[i]->dataRaw().cols();
                     }
@@ -364,7 +385,6 @@ bool RawModel::loadFiffData(QFile* qFile)
     beginResetModel();
     clearModel();
 
-    MatrixXd t_data,t_times; //type is later on (when append to m_data) casted into MatrixXdR (Row-Major)
     QSharedPointer<DataPackage> newDataPackage;
 
     m_pfiffIO = QSharedPointer<FiffIO>(new FiffIO(*qFile));
@@ -376,11 +396,10 @@ bool RawModel::loadFiffData(QFile* qFile)
         int start = m_iAbsFiffCursor;
         int end = start + m_iWindowSize - 1;
 
-        if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(t_data, t_times, start, end))
+        newDataPackage = loadWindow(start, end, -1, m_assignedOperators, m_iCurrentFFTLength);
+        if(!newDataPackage)
             return false;
 
-        newDataPackage = QSharedPointer<DataPackage>(new DataPackage(t_data, (MatrixXdR)t_times));
-
         m_bFileloaded = true;
     }
     else {
@@ -403,6 +422,8 @@ bool RawModel::loadFiffData(QFile* qFile)
     emit fileLoaded(m_pFiffInfo);
     emit assignedOperatorsChanged(m_assignedOperators);
 
+    prefetchWindows();
+
     return true;
 }
 
@@ -464,6 +485,60 @@ bool RawModel::writeFiffData(QIODevice *p_IODevice)
 }
 
 
+//*************************************************************************************************************
+
+int RawModel::lodLevel(double samplesPerPixel) const
+{
+    if(m_data.isEmpty())
+        return 0;
+
+    //Raw and processed pyramids of a window have the same levels. Don't touch the pyramids, they are built on demand.
+    int level = MinMaxPyramid::level(m_data[0]->dataRaw().cols(), samplesPerPixel);
+    for(int i = 1; i < m_data.size(); ++i)
+        level = qMin(level, MinMaxPyramid::level(m_data[i]->dataRaw().cols(), samplesPerPixel));
+
+    return level;
+}
+
+
+//*************************************************************************************************************
+
+QList<MinMaxRowPair> RawModel::minMaxData(int row, int level) const
+{
+    QList<MinMaxRowPair> listMinMax;
+
+    for(int i = 0; i < m_data.size(); ++i) {
+        const MinMaxPyramid& pyramid = showProcessedData(row, i) ? m_data[i]->pyramidProc() : m_data[i]->pyramidRaw();
+
+        if(level < 1 || level >= pyramid.levels())
+            return QList<MinMaxRowPair>();
+
+        listMinMax.append(MinMaxRowPair(pyramid.minima(level, row), pyramid.maxima(level, row)));
+    }
+
+    return listMinMax;
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::setWindowCacheBudget(qint64 memoryBudget)
+{
+    m_windowCache.setMemoryBudget(memoryBudget);
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::setVisibleSamples(qint32 samples)
+{
+    m_iVisibleSamples = qMax(0, samples);
+
+    //the windows are aligned, so covering the view and m_reloadPos at both ends takes at most two windows more than the view itself
+    m_maxWindows = qMax(MODEL_MAX_WINDOWS, (int)ceil((double)m_iVisibleSamples/m_iWindowSize) + 2);
+}
+
+
 //*************************************************************************************************************
 //non-virtual functions
 //private
@@ -478,10 +553,29 @@ void RawModel::loadFiffInfos()
 }
 
 
+//*************************************************************************************************************
+
+bool RawModel::showProcessedData(int row, int window) const
+{
+    //if channel is not filtered or background Processing pending...
+    if(!m_assignedOperators.contains(row) || (m_bProcessing && m_bReloadBefore && window==0) || (m_bProcessing && !m_bReloadBefore && window==m_data.size()-1))
+        return false;
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 void RawModel::clearModel()
 {
+    //cancel and wait for background loading, it still accesses the old FiffIO object
+    invalidateWindowCache();
+    m_reloadFutureWatcher.waitForFinished();
+    m_prefetchFutureWatcher.waitForFinished();
+    m_bReloading = false;
+    m_bReloadPending = false;
+
     //FiffIO object
     m_pfiffIO.clear();
     m_chInfolist.clear();
@@ -514,42 +608,44 @@ void RawModel::resetPosition(qint32 position)
     m_bStartReached = false;
     m_bEndReached = false;
     m_bReloading = false;
+    m_bReloadPending = false;
     m_bProcessing = false;
 
+    //cancel read-ahead of the old position
+    m_iLoadTicket.ref();
+
     //calculate multiple integer of m_iWindowSize from beginning of Fiff file (rounded down)
     qint32 distance = position - firstSample();
     qint32 mult = floor(distance / m_iWindowSize);
 
     m_iAbsFiffCursor = firstSample() + mult*m_iWindowSize;
 
-    MatrixXd t_data,t_times; //type is later on (when append to m_data) casted into MatrixXdR (Row-Major)
-
     int start = m_iAbsFiffCursor;
     int end = start + m_iWindowSize - 1;
 
-    m_Mutex.lock();
-    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(t_data, t_times, start, end))
-        qDebug() << "RawModel: Error resetting position of Fiff file!";
-    m_Mutex.unlock();
-
-    //build data package
-    QSharedPointer<DataPackage> newDataPackage;
-    newDataPackage = QSharedPointer<DataPackage>(new DataPackage((MatrixXdR)t_data, (MatrixXdR)t_times));
+    //build data package, cached windows are already processed
+    QSharedPointer<DataPackage> newDataPackage = m_windowCache.take(start);
+    if(!newDataPackage) {
+        newDataPackage = loadWindow(start, end, -1, m_assignedOperators, m_iCurrentFFTLength);
+        if(!newDataPackage) {
+            qDebug() << "RawModel: Error resetting position of Fiff file!";
+            newDataPackage = QSharedPointer<DataPackage>(new DataPackage());
+        }
+    }
 
     //append loaded block
     m_data.append(newDataPackage);
 
-    if(!m_assignedOperators.empty())
-        updateOperators();
-
     endResetModel();
 
 //    if(!(m_iAbsFiffCursor<=firstSample()))
 //        updateScrollPos(m_iCurAbsScrollPos-firstSample()); //little hack: if the m_iCurAbsScrollPos is now close to the edge -> force reloading w/o scrolling
 
-    qDebug() << "RawModel: Model Position RESET, samples from " << m_iAbsFiffCursor << "to" << m_iAbsFiffCursor+m_iWindowSize-1 << "reloaded. actual loaded t_data cols: " << t_data.cols();
+    qDebug() << "RawModel: Model Position RESET, samples from " << m_iAbsFiffCursor << "to" << m_iAbsFiffCursor+m_iWindowSize-1 << "reloaded. actual loaded data cols: " << newDataPackage->dataRaw().cols();
 
     emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size(),1));
+
+    prefetchWindows();
 }
 
 
@@ -557,6 +653,10 @@ void RawModel::resetPosition(qint32 position)
 
 void RawModel::reloadFiffData(bool before)
 {
+    //the read-ahead of the other direction is of no use anymore
+    if(before != m_bReloadBefore)
+        m_iLoadTicket.ref();
+
     m_bReloadBefore = before;
 
     //update scroll position
@@ -594,13 +694,35 @@ void RawModel::reloadFiffData(bool before)
     }
 
     m_bReloading = true;
+    m_iReloadStart = start;
+    m_iReloadEnd = end;
+
+    //the window was prefetched already
+    QSharedPointer<DataPackage> cachedDataPackage = m_windowCache.take(start);
+    if(cachedDataPackage) {
+        m_iReloadTicket = m_iLoadTicket.load();
+        insertReloadedData(cachedDataPackage);
+        return;
+    }
+
+    //the window is being prefetched -> insertPrefetchedData hands it over
+    if(m_prefetchFutureWatcher.isRunning() && m_iPrefetchStart == start && m_iPrefetchTicket == m_iLoadTicket.load()) {
+        m_bReloadPending = true;
+        return;
+    }
+
+    startReload(start, end);
+}
 
-    //read data with respect to start and end point
-    QFuture<QPair<MatrixXd,MatrixXd> > future = QtConcurrent::run(this,&RawModel::readSegment,start,end);
 
-    //Wait for thread reloading is finished, then insert reloaded data
-    //future.waitForFinished();
-    //insertReloadedData(future.result());
+//*************************************************************************************************************
+
+void RawModel::startReload(fiff_int_t from, fiff_int_t to)
+{
+    m_iReloadTicket = m_iLoadTicket.load();
+
+    //read and process data with respect to start and end point, the reload itself is never cancelled
+    QFuture<QSharedPointer<DataPackage> > future = QtConcurrent::run(this,&RawModel::loadWindow,from,to,-1,m_assignedOperators,m_iCurrentFFTLength);
 
     m_reloadFutureWatcher.setFuture(future);
 }
@@ -608,18 +730,126 @@ void RawModel::reloadFiffData(bool before)
 
 //*************************************************************************************************************
 
-QPair<MatrixXd,MatrixXd> RawModel::readSegment(fiff_int_t from, fiff_int_t to)
+void RawModel::prefetchWindows()
+{
+    if(!m_bFileloaded || m_data.empty() || m_prefetchFutureWatcher.isRunning())
+        return;
+
+    for(int i = 0; i < MODEL_PREFETCH_WINDOWS; ++i) {
+        fiff_int_t start,end;
+        if(m_bReloadBefore) {
+            start = m_iAbsFiffCursor - (i+1)*m_iWindowSize;
+            if(start < firstSample())
+                return;
+            end = start + m_iWindowSize - 1;
+        }
+        else {
+            start = m_iAbsFiffCursor + sizeOfPreloadedData() + i*m_iWindowSize;
+            if(start > lastSample())
+                return;
+            end = qMin(start + m_iWindowSize - 1, lastSample());
+        }
+
+        //skip windows which are cached or reloaded right now
+        if(m_windowCache.contains(start) || (m_bReloading && start == m_iReloadStart))
+            continue;
+
+        m_iPrefetchStart = start;
+        m_iPrefetchTicket = m_iLoadTicket.load();
+
+        QFuture<QSharedPointer<DataPackage> > future = QtConcurrent::run(this,&RawModel::loadWindow,start,end,m_iPrefetchTicket,m_assignedOperators,m_iCurrentFFTLength);
+        m_prefetchFutureWatcher.setFuture(future);
+
+        return;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::invalidateWindowCache()
+{
+    m_iLoadTicket.ref();
+    m_windowCache.clear();
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<DataPackage> RawModel::loadWindow(fiff_int_t from, fiff_int_t to, int ticket, QMap<int,QSharedPointer<MNEOperator> > assignedOperators, int fftLength)
 {
-    QPair<MatrixXd,MatrixXd> datatime;
+    //Read data - the reader decodes into a column-major matrix which is turned into row-major once when building the data package
+    MatrixXd t_data;
+    double sfreq;
 
     m_Mutex.lock();
-    if(!m_pfiffIO->m_qlistRaw[0]->read_raw_segment(datatime.first, datatime.second, from, to)) {
-        printf("RawModel: Error when reading raw data!");
-        return datatime;
+    if(ticket >= 0 && ticket != m_iLoadTicket.load()) {
+        m_Mutex.unlock();
+        return QSharedPointer<DataPackage>();
     }
+
+    bool bRead = m_pfiffIO && !m_pfiffIO->m_qlistRaw.empty() && m_pfiffIO->m_qlistRaw[0]->read_raw_segment(t_data, from, to);
+    sfreq = bRead ? m_pfiffIO->m_qlistRaw[0]->info.sfreq : 0;
     m_Mutex.unlock();
 
-    return datatime;
+    if(!bRead) {
+        qDebug() << "RawModel: Error when reading raw data from" << from << "to" << to;
+        return QSharedPointer<DataPackage>();
+    }
+
+    MatrixXdR t_times(1, t_data.cols());
+    for(qint32 i = 0; i < t_times.cols(); ++i)
+        t_times(0,i) = ((float)(from+i)) / sfreq;
+
+    QSharedPointer<DataPackage> dataPackage = QSharedPointer<DataPackage>(new DataPackage(t_data, t_times));
+
+    if(assignedOperators.empty())
+        return dataPackage;
+
+    //Process data
+    if(ticket >= 0 && ticket != m_iLoadTicket.load())
+        return QSharedPointer<DataPackage>();
+
+    QList<int> listFilteredChs = assignedOperators.uniqueKeys();
+    QList<QPair<int,RowVectorXd> > listChData;
+    for(qint32 i=0; i < listFilteredChs.size(); ++i)
+        listChData.append(QPair<int,RowVectorXd>(listFilteredChs[i],dataPackage->dataRawOrig().row(listFilteredChs[i])));
+
+    QtConcurrent::blockingMap(listChData,[&assignedOperators](QPair<int,RowVectorXd>& chdata) {
+        applyOperators(chdata, assignedOperators);
+    });
+
+    //Set and cut original data to window size and calculate mean for filtered data
+    int dataLength = dataPackage->dataRaw().cols();
+    int cutFront = fftLength/4;
+    int cutBack = fftLength/4 + (listChData[0].second.cols()-fftLength/2-dataLength);
+
+    for(int i=0; i < listChData.size(); ++i)
+        dataPackage->setOrigProcData(listChData[i].second, listChData[i].first, cutFront, cutBack);
+
+    return dataPackage;
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::applyOperators(QPair<int,RowVectorXd>& chdata, const QMap<int,QSharedPointer<MNEOperator> >& assignedOperators)
+{
+    QSharedPointer<FilterOperator> filter;
+
+    QList<QSharedPointer<MNEOperator> > ops = assignedOperators.values(chdata.first);
+    for(qint32 i=0; i < ops.size(); ++i) {
+        switch(ops[i]->m_OperatorType) {
+        case MNEOperator::FILTER: {
+            filter = ops[i].staticCast<FilterOperator>();
+            RowVectorXd tmp = filter->applyFFTFilter(chdata.second);
+            chdata.second = tmp;
+        }
+        case MNEOperator::PCA: {
+            //do something
+        }
+        }
+    }
 }
 
 
@@ -630,10 +860,16 @@ void RawModel::updateScrollPos(int value)
     m_iCurAbsScrollPos = firstSample() + value;
     qDebug() << "RawModel: absolute Fiff Scroll Cursor" << m_iCurAbsScrollPos << "(m_iAbsFiffCursor" << m_iAbsFiffCursor << ", sizeOfPreloadedData" << sizeOfPreloadedData() << ", firstSample()" << firstSample() << ")";
 
+    //the reload at the end depends on the last visible sample, a zoomed out view spans several windows
+    qint32 t_iLastVisibleSample = m_iCurAbsScrollPos + m_iVisibleSamples;
+
     //if a scroll position is selected, which is not within the loaded data range -> reset position of model
     if(m_iCurAbsScrollPos > (m_iAbsFiffCursor+sizeOfPreloadedData()+m_iWindowSize) || m_iCurAbsScrollPos < m_iAbsFiffCursor) {
         qDebug() << "RawModel: Reset position requested, m_iAbsFiffCursor:" << m_iAbsFiffCursor << "m_iCurAbsScrollPos:" << m_iCurAbsScrollPos;
         resetPosition(m_iCurAbsScrollPos);
+
+        if(t_iLastVisibleSample > m_iAbsFiffCursor+sizeOfPreloadedData()-m_reloadPos && !m_bEndReached)
+            reloadFiffData(0);
         return;
     }
 
@@ -644,7 +880,7 @@ void RawModel::updateScrollPos(int value)
         reloadFiffData(1);
     }
     //end
-    else if(!m_bReloading && m_iCurAbsScrollPos > m_iAbsFiffCursor+sizeOfPreloadedData()-m_reloadPos && !m_bEndReached) {
+    else if(!m_bReloading && t_iLastVisibleSample > m_iAbsFiffCursor+sizeOfPreloadedData()-m_reloadPos && !m_bEndReached) {
         qDebug() << "RawModel: Reload requested at END of loaded fiff data, m_iAbsFiffCursor:" << m_iAbsFiffCursor << "m_iCurAbsScrollPos:" << m_iCurAbsScrollPos;
         reloadFiffData(0);
     }
@@ -701,6 +937,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
+    invalidateWindowCache();
+
     m_bProcessing = true;
 
     for(int i=0; i<m_data.size(); i++)
@@ -710,6 +948,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
 
     m_bProcessing = false;
 
+    prefetchWindows();
+
     emit assignedOperatorsChanged(m_assignedOperators);
 
     qDebug() << "RawModel: using FilterType" << operatorPtr->m_sName;
@@ -739,6 +979,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
         }
     }
 
+    invalidateWindowCache();
+
     m_bProcessing = true;
 
     for(int i=0; i<m_data.size(); i++)
@@ -748,6 +990,8 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
 
     m_bProcessing = false;
 
+    prefetchWindows();
+
     emit assignedOperatorsChanged(m_assignedOperators);
 
     qDebug() << "RawModel: using FilterType" << operatorPtr->m_sName;
@@ -758,24 +1002,7 @@ void RawModel::applyOperator(QModelIndexList chlist, const QSharedPointer<MNEOpe
 
 void RawModel::applyOperatorsConcurrently(QPair<int,RowVectorXd>& chdata) const
 {
-    QSharedPointer<FilterOperator> filter;
-
-    //QList<int> listFilteredChs = m_assignedOperators.keys();
-
-    QList<QSharedPointer<MNEOperator> > ops = m_assignedOperators.values(chdata.first);
-    for(qint32 i=0; i < ops.size(); ++i) {
-        switch(ops[i]->m_OperatorType) {
-        case MNEOperator::FILTER: {
-            filter = ops[i].staticCast<FilterOperator>();
-            RowVectorXd tmp = filter->applyFFTFilter(chdata.second);
-            chdata.second = tmp;
-        }
-        case MNEOperator::PCA: {
-            //do something
-        }
-        }
-    }
-//    return chdata;
+    applyOperators(chdata, m_assignedOperators);
 }
 
 
@@ -790,6 +1017,8 @@ void RawModel::updateOperators(QModelIndex chan)
         }
     }
 
+    invalidateWindowCache();
+
     m_bProcessing = true;
 
     for(int i=0; i<m_data.size(); i++)
@@ -799,6 +1028,8 @@ void RawModel::updateOperators(QModelIndex chan)
 
     m_bProcessing = false;
 
+    prefetchWindows();
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -818,6 +1049,8 @@ void RawModel::updateOperators(QModelIndexList chlist)
         }
     }
 
+    invalidateWindowCache();
+
     m_bProcessing = true;
 
     for(int i=0; i<m_data.size(); i++)
@@ -827,6 +1060,8 @@ void RawModel::updateOperators(QModelIndexList chlist)
 
     m_bProcessing = false;
 
+    prefetchWindows();
+
     emit assignedOperatorsChanged(m_assignedOperators);
 }
 
@@ -956,11 +1191,20 @@ void RawModel::updateProjections()
 //                matSparseProj.setFromTriplets(tripletList.begin(), tripletList.end());
 
             //set projection matrix for upcoming read raw segement calls
+            m_Mutex.lock();
             m_pfiffIO->m_qlistRaw[0]->proj = matProj;
+            m_pfiffIO->m_qlistRaw[0]->prepare_read_plan();
+            m_Mutex.unlock();
         } else {
+            m_Mutex.lock();
             m_pfiffIO->m_qlistRaw[0]->proj.resize(0,0);
+            m_pfiffIO->m_qlistRaw[0]->prepare_read_plan();
+            m_Mutex.unlock();
         }
 
+        //windows which were read with the old projector are outdated
+        invalidateWindowCache();
+
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
         else
@@ -992,7 +1236,13 @@ void RawModel::updateCompensator(int to)
         this->m_pFiffInfo->set_current_comp(to);
 
         //set compensator for upcoming read raw segement calls
+        m_Mutex.lock();
         m_pfiffIO->m_qlistRaw[0]->comp = newComp;
+        m_pfiffIO->m_qlistRaw[0]->prepare_read_plan();
+        m_Mutex.unlock();
+
+        //windows which were read with the old compensator are outdated
+        invalidateWindowCache();
 
         if(m_iCurAbsScrollPos == 0)
             resetPosition(m_iCurAbsScrollPos + firstSample());
@@ -1004,35 +1254,96 @@ void RawModel::updateCompensator(int to)
 
 //*************************************************************************************************************
 //private SLOTS
-void RawModel::insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair)
+void RawModel::insertReloadedData(QSharedPointer<DataPackage> dataPackage)
 {
-    QSharedPointer<DataPackage> newDataPackage = QSharedPointer<DataPackage>(new DataPackage((MatrixXdR)dataTimesPair.first, (MatrixXdR)dataTimesPair.second));
+    m_bReloading = false;
+
+    //reading failed -> restore the cursor so the reload can be requested again
+    if(!dataPackage) {
+        if(m_bReloadBefore)
+            m_iAbsFiffCursor += m_iWindowSize;
+        return;
+    }
 
-    //extend m_data with reloaded data
+    //extend m_data with reloaded data, dropped windows are kept in the cache
     if(m_bReloadBefore) {
-        m_data.prepend(newDataPackage);
+        m_data.prepend(dataPackage);
 
-        //maintain at maximum m_maxWindows data windows and drop the rest
-        if(m_data.size() > m_maxWindows) {
+        //maintain at maximum m_maxWindows data windows and drop the rest, zooming in may have lowered m_maxWindows
+        while(m_data.size() > m_maxWindows) {
+            m_windowCache.insert(m_iAbsFiffCursor + (m_data.size()-1)*m_iWindowSize, m_data.last());
             m_data.removeLast();
         }
     }
     else {
-        m_data.append(newDataPackage);
+        m_data.append(dataPackage);
 
-        //maintain at maximum m_maxWindows data windows and drop the rest
-        if(m_data.size() > m_maxWindows) {
+        //maintain at maximum m_maxWindows data windows and drop the rest, zooming in may have lowered m_maxWindows
+        while(m_data.size() > m_maxWindows) {
+            m_windowCache.insert(m_iAbsFiffCursor, m_data.first());
             m_data.removeFirst();
             m_iAbsFiffCursor += m_iWindowSize;
         }
     }
 
-    m_bReloading = false;
+    //the window was processed in the background-thread, only redo it if the operators changed in the meantime
+    if(!m_assignedOperators.empty()) {
+        if(m_iReloadTicket != m_iLoadTicket.load())
+            updateOperatorsConcurrently(m_bReloadBefore ? 0 : m_data.size()-1);
+
+        performOverlapAdd();
+    }
 
     emit dataChanged(createIndex(0,1),createIndex(m_chInfolist.size()-1,1));
     emit dataReloaded();
 
-    qDebug() << "RawModel: Fiff data Reloaded from " << dataTimesPair.second.coeff(0) << "secs to" << dataTimesPair.second.coeff(dataTimesPair.second.cols()-1) << "secs";
+    qDebug() << "RawModel: Fiff data Reloaded from " << m_iReloadStart << "to" << m_iReloadEnd << "(" << m_windowCache.memoryUsage()/(1024*1024) << "MB cached)";
+
+    //a zoomed out view spans several windows -> go on until the view is loaded
+    if(m_iCurAbsScrollPos + m_iVisibleSamples > m_iAbsFiffCursor+sizeOfPreloadedData()-m_reloadPos && !m_bEndReached) {
+        reloadFiffData(0);
+        return;
+    }
+
+    prefetchWindows();
+}
+
+
+//*************************************************************************************************************
+
+void RawModel::insertPrefetchedData(QSharedPointer<DataPackage> dataPackage)
+{
+    fiff_int_t start = m_iPrefetchStart;
+    m_iPrefetchStart = -1;
+
+    //a reload waits for this window
+    if(m_bReloadPending) {
+        m_bReloadPending = false;
+
+        if(dataPackage) {
+            m_iReloadTicket = m_iPrefetchTicket;
+            insertReloadedData(dataPackage);
+        }
+        else
+            startReload(m_iReloadStart, m_iReloadEnd);
+
+        return;
+    }
+
+    //drop results of cancelled prefetches and start over for the current position
+    if(m_iPrefetchTicket != m_iLoadTicket.load()) {
+        prefetchWindows();
+        return;
+    }
+
+    if(!dataPackage)
+        return;
+
+    m_windowCache.insert(start, dataPackage);
+
+    //go on as long as the next window fits into the budget without dropping cached windows
+    if(m_windowCache.contains(start) && m_windowCache.memoryUsage() + dataPackage->memorySize() <= m_windowCache.memoryBudget())
+        prefetchWindows();
 }
 
 
@@ -75,6 +75,7 @@
 #include "../Utils/filteroperator.h"
 #include "../Utils/rawsettings.h"
 #include "../Utils/datapackage.h"
+#include "../Utils/datapackagecache.h"
 
 
 //*************************************************************************************************************
@@ -175,6 +176,43 @@ public:
     */
     bool writeFiffData(QIODevice *p_IODevice);
 
+    //=========================================================================================================
+    /**
+    * lodLevel returns the level of the min/max pyramids which fits the plot resolution
+    *
+    * @param samplesPerPixel number of samples which are plotted into one pixel column
+    * @return the level which is available in all loaded windows, 0 if each sample is to be plotted
+    */
+    int lodLevel(double samplesPerPixel) const;
+
+    //=========================================================================================================
+    /**
+    * minMaxData returns the bucket minima and maxima of a channel for all loaded windows. The raw or processed data
+    * is chosen the same way as for the Qt::DisplayRole.
+    *
+    * @param row the channel index
+    * @param level the pyramid level, i.e. the buckets hold 2^level samples
+    * @return the minima and maxima of each loaded window
+    */
+    QList<MinMaxRowPair> minMaxData(int row, int level) const;
+
+    //=========================================================================================================
+    /**
+    * setWindowCacheBudget sets the memory budget of the cache which holds prefetched and dropped windows
+    *
+    * @param memoryBudget the maximal memory of the cached windows in bytes
+    */
+    void setWindowCacheBudget(qint64 memoryBudget);
+
+    //=========================================================================================================
+    /**
+    * setVisibleSamples sets the number of samples which are visible in the view. A zoomed out view spans several
+    * windows, so m_maxWindows is raised until the whole view plus the reload distance at both ends stays loaded.
+    *
+    * @param samples the number of visible samples, i.e. the viewport width divided by the plot resolution
+    */
+    void setVisibleSamples(qint32 samples);
+
     //VARIABLES
     bool                                        m_bFileloaded;  /**< true when a Fiff file is loaded */
     QList<FiffChInfo>                           m_chInfolist;   /**< List of FiffChInfo objects that holds the corresponding channels information */
@@ -202,6 +240,16 @@ private:
     */
     void clearModel();
 
+    //=========================================================================================================
+    /**
+    * showProcessedData checks whether the processed data of a window is plotted for a channel
+    *
+    * @param row the channel index
+    * @param window the index of the loaded window in m_data
+    * @return true if the channel is filtered and the window is not being processed in the background
+    */
+    bool showProcessedData(int row, int window) const;
+
     //=========================================================================================================
     /**
     * resetPosition reset the position of the current m_iAbsFiffCursor if a ScrollBar position is selected, whose data is not yet loaded.
@@ -220,13 +268,46 @@ private:
 
     //=========================================================================================================
     /**
-    * @brief readSegment is the wrapper method to read a segment from the raw fiff file
+    * startReload loads a window in a background-thread, insertReloadedData is called when it has finished
     *
     * @param from the start point to read from the file
     * @param to the end point to read from the file
-    * @return the data and times matrices
     */
-    QPair<MatrixXd,MatrixXd> readSegment(fiff_int_t from, fiff_int_t to);
+    void startReload(fiff_int_t from, fiff_int_t to);
+
+    //=========================================================================================================
+    /**
+    * prefetchWindows loads the next uncached window in scroll direction (at most MODEL_PREFETCH_WINDOWS ahead) in a background-thread
+    */
+    void prefetchWindows();
+
+    //=========================================================================================================
+    /**
+    * invalidateWindowCache cancels ongoing prefetches and drops all cached windows, e.g. because the operators or the projectors changed
+    */
+    void invalidateWindowCache();
+
+    //=========================================================================================================
+    /**
+    * @brief loadWindow reads a segment from the raw fiff file and builds a processed data package (this method runs in a background-thread)
+    *
+    * @param from the start point to read from the file
+    * @param to the end point to read from the file
+    * @param ticket the load ticket of the request, the load is cancelled when m_iLoadTicket has moved on (-1 never cancels)
+    * @param assignedOperators the operators which are applied to the channels
+    * @param fftLength the fft length used by the operators
+    * @return the data package, a null pointer if the load was cancelled or failed
+    */
+    QSharedPointer<DataPackage> loadWindow(fiff_int_t from, fiff_int_t to, int ticket, QMap<int,QSharedPointer<MNEOperator> > assignedOperators, int fftLength);
+
+    //=========================================================================================================
+    /**
+    * applyOperators applies the operators of a channel to the channel data in-place
+    *
+    * @param chdata[in,out] represents the channel data as a RowVectorXd
+    * @param assignedOperators the operators which are applied to the channels
+    */
+    static void applyOperators(QPair<int,RowVectorXd> &chdata, const QMap<int,QSharedPointer<MNEOperator> > &assignedOperators);
 
     //VARIABLES
     //Reload control
@@ -235,8 +316,19 @@ private:
     bool                                    m_bReloadBefore;            /**< bool value indicating if data was reloaded before (1) or after (0) the existing data. */
 
     //Concurrent reloading
-    QFutureWatcher<QPair<MatrixXd,MatrixXd> > m_reloadFutureWatcher;    /**< QFutureWatcher for watching process of reloading fiff data. */
+    QFutureWatcher<QSharedPointer<DataPackage> > m_reloadFutureWatcher; /**< QFutureWatcher for watching process of reloading fiff data. */
     bool                                    m_bReloading;               /**< signals when the reloading is ongoing. */
+    bool                                    m_bReloadPending;           /**< true when the reload waits for the ongoing prefetch of the same window. */
+    fiff_int_t                              m_iReloadStart;             /**< First sample of the window which is reloaded. */
+    fiff_int_t                              m_iReloadEnd;               /**< Last sample of the window which is reloaded. */
+    int                                     m_iReloadTicket;            /**< Load ticket of the ongoing reload. */
+
+    //Read-ahead
+    QFutureWatcher<QSharedPointer<DataPackage> > m_prefetchFutureWatcher; /**< QFutureWatcher for watching process of prefetching the next window in scroll direction. */
+    fiff_int_t                              m_iPrefetchStart;           /**< First sample of the window which is prefetched, -1 if none. */
+    int                                     m_iPrefetchTicket;          /**< Load ticket of the ongoing prefetch. */
+    QAtomicInt                              m_iLoadTicket;              /**< Moves on when loaded windows become invalid (jump, change of scroll direction, operators, projectors), loads with an older ticket are cancelled. */
+    DataPackageCache                        m_windowCache;              /**< LRU cache of prefetched and dropped windows, keyed by their first sample. */
 
     //Concurrent processing
 //    QFutureWatcher<QPair<int,RowVectorXd> > m_operatorFutureWatcher; /**< QFutureWatcher for watching process of applying Operators to reloaded fiff data. */
@@ -255,6 +347,7 @@ private:
 
     qint32                                  m_iAbsFiffCursor;           /**< Cursor that points to the current position in the fiff data file [in samples]. */
     qint32                                  m_iCurAbsScrollPos;         /**< the current (absolute) ScrollPosition in the fiff data file. */
+    qint32                                  m_iVisibleSamples;          /**< Number of samples which are visible in the view [in samples]. */
 
     qint32                                  m_iWindowSize;              /**< Length of window to load [in samples]. */
     qint32                                  m_reloadPos;                /**< Distance that the current window needs to be off the ends of m_data[i] [in samples]. */
@@ -294,7 +387,7 @@ public slots:
     /**
     * updateScrollPos checks, whether the actual position of the QScrollBar demands for a fiff data reload (depending on m_reloadPos and m_iCurAbsScrollPos)
     *
-    * @param value the position of QScrollBar
+    * @param value the first visible sample relative to firstSample(), i.e. the position of QScrollBar divided by the plot resolution
     */
     void updateScrollPos(int value);
 
@@ -405,9 +498,17 @@ private slots:
     /**
     * insertReloadedData inserts the reloaded data when the background has finished the operation
     *
-    * @param dataTimesPair contains the reloaded matrices of the data and times so it can be inserted into m_data and m_times
+    * @param dataPackage contains the reloaded and processed data and times so it can be inserted into m_data
+    */
+    void insertReloadedData(QSharedPointer<DataPackage> dataPackage);
+
+    //=========================================================================================================
+    /**
+    * insertPrefetchedData stores a prefetched window in the cache (or hands it to a waiting reload) when the background has finished the operation
+    *
+    * @param dataPackage contains the prefetched and processed data and times, a null pointer if the prefetch was cancelled
     */
-    void insertReloadedData(QPair<MatrixXd,MatrixXd> dataTimesPair);
+    void insertPrefetchedData(QSharedPointer<DataPackage> dataPackage);
 
     //=========================================================================================================
     /**
@@ -56,7 +56,9 @@ using namespace MNEBrowseRawQt;
 //=============================================================================================================
 
 DataPackage::DataPackage(const MatrixXdR &originalRawData, const MatrixXdR &originalRawTime, int cutFront, int cutBack)
-: m_iCutFrontRaw(cutFront)
+: m_bPyramidRawDirty(true)
+, m_bPyramidProcDirty(true)
+, m_iCutFrontRaw(cutFront)
 , m_iCutBackRaw(cutBack)
 , m_iCutFrontProc(cutFront)
 , m_iCutBackProc(cutBack)
@@ -78,6 +80,9 @@ DataPackage::DataPackage(const MatrixXdR &originalRawData, const MatrixXdR &orig
     //Init mean data
     m_dataRawMean = calculateMatMean(m_dataRawMapped);
     m_dataProcMean = calculateMatMean(m_dataProcMapped);
+
+    //Min/max pyramids are built on the first request
+    invalidatePyramids(true, true);
 }
 
 
@@ -97,8 +102,9 @@ void DataPackage::setOrigRawData(const MatrixXdR &originalRawData, int cutFront,
     if(cutBack != m_iCutBackRaw)
         m_iCutBackRaw = cutBack;
 
-    //Calculate mean
+    //Calculate mean, the min/max pyramid is rebuilt on demand
     m_dataRawMean = calculateMatMean(m_dataRawMapped);
+    invalidatePyramids(true, false);
 }
 
 
@@ -123,8 +129,10 @@ void DataPackage::setOrigRawData(const RowVectorXd &originalRawData, int row, in
     if(cutBack != m_iCutBackRaw)
         m_iCutBackRaw = cutBack;
 
-    //Calculate mean
+    //Calculate mean and min/max pyramid
     m_dataRawMean(row) = calculateRowMean(m_dataRawMapped.row(row));
+    if(!m_bPyramidRawDirty)
+        m_pyramidRaw.updateRow(m_dataRawMapped, row);
 }
 
 
@@ -144,8 +152,9 @@ void DataPackage::setOrigProcData(const MatrixXdR &originalProcData, int cutFron
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean, the min/max pyramid is rebuilt on demand
     m_dataProcMean = calculateMatMean(m_dataProcMapped);
+    invalidatePyramids(false, true);
 }
 
 
@@ -162,8 +171,9 @@ void DataPackage::setMappedProcData(const MatrixXdR &originalProcData, int cutFr
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean, the min/max pyramid is rebuilt on demand
     m_dataProcMean = calculateMatMean(m_dataProcMapped);
+    invalidatePyramids(false, true);
 }
 
 
@@ -188,8 +198,10 @@ void DataPackage::setOrigProcData(const RowVectorXd &originalProcData, int row,
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean and min/max pyramid
     m_dataProcMean(row) = calculateRowMean(m_dataProcMapped.row(row));
+    if(!m_bPyramidProcDirty)
+        m_pyramidProc.updateRow(m_dataProcMapped, row);
 }
 
 
@@ -211,8 +223,10 @@ void DataPackage::setMappedProcData(const RowVectorXd &originalProcData, int row
     if(cutBack != m_iCutBackProc)
         m_iCutBackProc = cutBack;
 
-    //Calculate mean
+    //Calculate mean and min/max pyramid
     m_dataProcMean(row) = calculateRowMean(m_dataProcMapped.row(row));
+    if(!m_bPyramidProcDirty)
+        m_pyramidProc.updateRow(m_dataProcMapped, row);
 }
 
 //*************************************************************************************************************
@@ -247,6 +261,32 @@ const MatrixXdR & DataPackage::dataProc()
 }
 
 
+//*************************************************************************************************************
+
+const MinMaxPyramid & DataPackage::pyramidRaw()
+{
+    if(m_bPyramidRawDirty) {
+        m_pyramidRaw.build(m_dataRawMapped);
+        m_bPyramidRawDirty = false;
+    }
+
+    return m_pyramidRaw;
+}
+
+
+//*************************************************************************************************************
+
+const MinMaxPyramid & DataPackage::pyramidProc()
+{
+    if(m_bPyramidProcDirty) {
+        m_pyramidProc.build(m_dataProcMapped);
+        m_bPyramidProcDirty = false;
+    }
+
+    return m_pyramidProc;
+}
+
+
 //*************************************************************************************************************
 
 double DataPackage::dataProcMean(int row)
@@ -269,6 +309,18 @@ double DataPackage::dataRawMean(int row)
 }
 
 
+//*************************************************************************************************************
+
+qint64 DataPackage::memorySize() const
+{
+    qint64 size = m_timeRawMapped.size() + m_timeRawOriginal.size()
+                + m_dataRawMapped.size() + m_dataRawOriginal.size() + m_dataRawMean.size()
+                + m_dataProcOriginal.size() + m_dataProcMapped.size() + m_dataProcMean.size();
+
+    return size*(qint64)sizeof(double) + m_pyramidRaw.memorySize() + m_pyramidProc.memorySize();
+}
+
+
 //*************************************************************************************************************
 
 void DataPackage::applyFFTFilter(int channelNumber, QSharedPointer<FilterOperator> filter, bool useRawData)
@@ -286,8 +338,9 @@ void DataPackage::applyFFTFilter(int channelNumber, QSharedPointer<FilterOperato
     //Cut filtered m_dataProcOriginal
     m_dataProcMapped = cutData(m_dataProcOriginal, m_iCutFrontProc, m_iCutBackProc);
 
-    //Calculate mean
+    //Calculate mean, the min/max pyramid is rebuilt on demand
     m_dataProcMean(channelNumber) = calculateRowMean(m_dataProcMapped);
+    invalidatePyramids(false, true);
 }
 
 
@@ -342,6 +395,22 @@ double DataPackage::calculateRowMean(const VectorXd &dataRow)
 }
 
 
+//*************************************************************************************************************
+
+void DataPackage::invalidatePyramids(bool raw, bool proc)
+{
+    if(raw) {
+        m_pyramidRaw.clear();
+        m_bPyramidRawDirty = true;
+    }
+
+    if(proc) {
+        m_pyramidProc.clear();
+        m_bPyramidProcDirty = true;
+    }
+}
+
+
 
 
 
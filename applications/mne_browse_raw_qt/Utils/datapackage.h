@@ -44,6 +44,7 @@
 
 #include "filteroperator.h"
 #include "types.h"
+#include "minmaxpyramid.h"
 
 
 //*************************************************************************************************************
@@ -195,6 +196,22 @@ public:
     */
     const MatrixXdR & dataProc();
 
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the mapped raw data.
+    *
+    * @return the pyramid
+    */
+    const MinMaxPyramid & pyramidRaw();
+
+    //=========================================================================================================
+    /**
+    * Returns the min/max pyramid of the mapped processed data.
+    *
+    * @return the pyramid
+    */
+    const MinMaxPyramid & pyramidProc();
+
     //=========================================================================================================
     /**
     * Returns the mean of the processed mapped data.
@@ -213,6 +230,14 @@ public:
     */
     double dataRawMean(int row);
 
+    //=========================================================================================================
+    /**
+    * Returns the memory of the data, time and pyramid matrices.
+    *
+    * @return the memory in bytes
+    */
+    qint64 memorySize() const;
+
     //=========================================================================================================
     /**
     * FilterOperator::FilterOperator
@@ -263,6 +288,16 @@ private:
     */
     double calculateRowMean(const VectorXd &dataRow);
 
+    //=========================================================================================================
+    /**
+    * invalidatePyramids frees the min/max pyramids of changed data. They are rebuilt by pyramidRaw() and
+    * pyramidProc() when the plot first needs them, so loading and filtering don't pay for them.
+    *
+    * @param raw whether the raw pyramid is to be invalidated
+    * @param proc whether the processed pyramid is to be invalidated
+    */
+    void invalidatePyramids(bool raw, bool proc);
+
     //Time data
     MatrixXdR   m_timeRawMapped;        /**< The mapped/cut time data */
     MatrixXdR   m_timeRawOriginal;      /**< the original time data */
@@ -271,11 +306,15 @@ private:
     MatrixXdR   m_dataRawMapped;        /**< The mapped/cut raw data */
     MatrixXdR   m_dataRawOriginal;      /**< The original raw data */
     VectorXd    m_dataRawMean;          /**< The mean of the mapped/cut raw data */
+    MinMaxPyramid m_pyramidRaw;         /**< The min/max pyramid of the mapped/cut raw data */
+    bool        m_bPyramidRawDirty;     /**< Whether m_pyramidRaw has to be rebuilt */
 
     //Processed data
     MatrixXdR   m_dataProcOriginal;     /**< The mapped/cut processed/filtered data */
     MatrixXdR   m_dataProcMapped;       /**< The original processed/filtered data */
     VectorXd    m_dataProcMean;         /**< The mean of the mapped/cut processed/filtered data */
+    MinMaxPyramid m_pyramidProc;        /**< The min/max pyramid of the mapped/cut processed/filtered data */
+    bool        m_bPyramidProcDirty;    /**< Whether m_pyramidProc has to be rebuilt */
 
     //Cutting parameters
     int m_iCutFrontRaw;                 /**< The last used cut front value of the raw data */
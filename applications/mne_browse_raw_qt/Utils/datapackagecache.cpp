@@ -0,0 +1,147 @@
+//=============================================================================================================
+/**
+* @file     datapackagecache.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the DataPackageCache class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "datapackagecache.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEBrowseRawQt;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+DataPackageCache::DataPackageCache(qint64 memoryBudget)
+: m_iMemoryBudget(memoryBudget)
+, m_iMemoryUsage(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void DataPackageCache::setMemoryBudget(qint64 memoryBudget)
+{
+    m_iMemoryBudget = memoryBudget;
+    shrink();
+}
+
+
+//*************************************************************************************************************
+
+qint64 DataPackageCache::memoryBudget() const
+{
+    return m_iMemoryBudget;
+}
+
+
+//*************************************************************************************************************
+
+qint64 DataPackageCache::memoryUsage() const
+{
+    return m_iMemoryUsage;
+}
+
+
+//*************************************************************************************************************
+
+void DataPackageCache::insert(qint32 firstSample, const QSharedPointer<DataPackage> &dataPackage)
+{
+    //a window which exceeds the whole budget would only flush the cache
+    if(!dataPackage || dataPackage->memorySize() > m_iMemoryBudget)
+        return;
+
+    take(firstSample);
+
+    m_mapPackages.insert(firstSample, dataPackage);
+    m_listLru.append(firstSample);
+    m_mapSizes.insert(firstSample, dataPackage->memorySize());
+    m_iMemoryUsage += m_mapSizes[firstSample];
+
+    shrink();
+}
+
+
+//*************************************************************************************************************
+
+bool DataPackageCache::contains(qint32 firstSample) const
+{
+    return m_mapPackages.contains(firstSample);
+}
+
+
+//*************************************************************************************************************
+
+QSharedPointer<DataPackage> DataPackageCache::take(qint32 firstSample)
+{
+    QSharedPointer<DataPackage> dataPackage = m_mapPackages.take(firstSample);
+
+    if(dataPackage) {
+        m_listLru.removeOne(firstSample);
+        m_iMemoryUsage -= m_mapSizes.take(firstSample);
+    }
+
+    return dataPackage;
+}
+
+
+//*************************************************************************************************************
+
+void DataPackageCache::clear()
+{
+    m_mapPackages.clear();
+    m_mapSizes.clear();
+    m_listLru.clear();
+    m_iMemoryUsage = 0;
+}
+
+
+//*************************************************************************************************************
+
+void DataPackageCache::shrink()
+{
+    while(m_iMemoryUsage > m_iMemoryBudget && !m_listLru.isEmpty())
+        take(m_listLru.first());
+}
@@ -0,0 +1,158 @@
+//=============================================================================================================
+/**
+* @file     datapackagecache.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the DataPackageCache class.
+*
+*/
+
+#ifndef DATAPACKAGECACHE_H
+#define DATAPACKAGECACHE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "datapackage.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QMap>
+#include <QList>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNEBrowseRawQt
+//=============================================================================================================
+
+namespace MNEBrowseRawQt
+{
+
+
+//=============================================================================================================
+/**
+* The cache holds loaded (and processed) data windows which are currently not shown, i.e. windows which were
+* prefetched ahead of the scroll position or dropped from the shown windows. The windows are identified by their
+* first sample. When the memory budget is exceeded, the least recently used windows are dropped.
+*
+* @brief The DataPackageCache class is a LRU cache of data windows with a memory budget.
+*/
+class DataPackageCache
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs a DataPackageCache.
+    *
+    * @param memoryBudget the maximal memory of the cached windows in bytes
+    */
+    DataPackageCache(qint64 memoryBudget);
+
+    //=========================================================================================================
+    /**
+    * Sets the memory budget and drops windows if it is exceeded.
+    *
+    * @param memoryBudget the maximal memory of the cached windows in bytes
+    */
+    void setMemoryBudget(qint64 memoryBudget);
+
+    //=========================================================================================================
+    /**
+    * Returns the memory budget.
+    *
+    * @return the maximal memory of the cached windows in bytes
+    */
+    qint64 memoryBudget() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the memory of the cached windows.
+    *
+    * @return the memory in bytes
+    */
+    qint64 memoryUsage() const;
+
+    //=========================================================================================================
+    /**
+    * Inserts a window as most recently used one. A cached window with the same first sample is replaced. Windows
+    * which are larger than the memory budget are not cached.
+    *
+    * @param firstSample the first sample of the window
+    * @param dataPackage the window
+    */
+    void insert(qint32 firstSample, const QSharedPointer<DataPackage> &dataPackage);
+
+    //=========================================================================================================
+    /**
+    * Checks whether a window is cached.
+    *
+    * @param firstSample the first sample of the window
+    * @return true if the window is cached
+    */
+    bool contains(qint32 firstSample) const;
+
+    //=========================================================================================================
+    /**
+    * Removes a window from the cache and returns it.
+    *
+    * @param firstSample the first sample of the window
+    * @return the window, a null pointer if it is not cached
+    */
+    QSharedPointer<DataPackage> take(qint32 firstSample);
+
+    //=========================================================================================================
+    /**
+    * Drops all cached windows.
+    */
+    void clear();
+
+private:
+    //=========================================================================================================
+    /**
+    * Drops the least recently used windows until the memory budget is met.
+    */
+    void shrink();
+
+    qint64                                  m_iMemoryBudget;    /**< The maximal memory of the cached windows in bytes. */
+    qint64                                  m_iMemoryUsage;     /**< The memory of the cached windows in bytes. */
+    QMap<qint32,QSharedPointer<DataPackage> > m_mapPackages;    /**< The cached windows, key is the first sample. */
+    QList<qint32>                           m_listLru;          /**< The first samples of the cached windows, least recently used first. */
+    QMap<qint32,qint64>                     m_mapSizes;         /**< The memory of the cached windows when they were inserted, their pyramids are built later. */
+};
+
+} // NAMESPACE
+
+#endif // DATAPACKAGECACHE_H
@@ -0,0 +1,201 @@
+//=============================================================================================================
+/**
+* @file     minmaxpyramid.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the implementation of the MinMaxPyramid class.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "minmaxpyramid.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEBrowseRawQt;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MinMaxPyramid::MinMaxPyramid()
+{
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::build(const MatrixXdR &data)
+{
+    clear();
+
+    int length = data.cols();
+    while(length > 1) {
+        length = (length+1)/2;
+        m_listMin.append(MatrixXdR(data.rows(), length));
+        m_listMax.append(MatrixXdR(data.rows(), length));
+    }
+
+    for(int row = 0; row < data.rows(); ++row)
+        updateRow(data, row);
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::updateRow(const MatrixXdR &data, int row)
+{
+    if(m_listMin.isEmpty() || row >= m_listMin.first().rows() || (data.cols()+1)/2 != m_listMin.first().cols())
+        return;
+
+    //Level 1 from the data, each further level from the level below
+    const double* srcMin = data.data() + row*data.cols();
+    const double* srcMax = srcMin;
+    int length = data.cols();
+
+    for(int i = 0; i < m_listMin.size(); ++i) {
+        double* dstMin = m_listMin[i].data() + row*m_listMin[i].cols();
+        double* dstMax = m_listMax[i].data() + row*m_listMax[i].cols();
+
+        decimate(srcMin, srcMax, length, dstMin, dstMax);
+
+        srcMin = dstMin;
+        srcMax = dstMax;
+        length = m_listMin[i].cols();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::clear()
+{
+    m_listMin.clear();
+    m_listMax.clear();
+}
+
+
+//*************************************************************************************************************
+
+qint64 MinMaxPyramid::memorySize() const
+{
+    qint64 size = 0;
+    for(int i = 0; i < m_listMin.size(); ++i)
+        size += 2*m_listMin[i].size();
+
+    return size*(qint64)sizeof(double);
+}
+
+
+//*************************************************************************************************************
+
+int MinMaxPyramid::levels() const
+{
+    return m_listMin.size()+1;
+}
+
+
+//*************************************************************************************************************
+
+int MinMaxPyramid::level(double samplesPerBucket) const
+{
+    int iLevel = 0;
+    while(iLevel+1 < levels() && (1 << (iLevel+1)) <= samplesPerBucket)
+        ++iLevel;
+
+    return iLevel;
+}
+
+
+//*************************************************************************************************************
+
+int MinMaxPyramid::level(int length, double samplesPerBucket)
+{
+    //Same number of levels as build() creates
+    int iLevels = 1;
+    while(length > 1) {
+        length = (length+1)/2;
+        ++iLevels;
+    }
+
+    int iLevel = 0;
+    while(iLevel+1 < iLevels && (1 << (iLevel+1)) <= samplesPerBucket)
+        ++iLevel;
+
+    return iLevel;
+}
+
+
+//*************************************************************************************************************
+
+RowVectorPair MinMaxPyramid::minima(int level, int row) const
+{
+    const MatrixXdR &mat = m_listMin[level-1];
+    return RowVectorPair(mat.data() + row*mat.cols(), mat.cols());
+}
+
+
+//*************************************************************************************************************
+
+RowVectorPair MinMaxPyramid::maxima(int level, int row) const
+{
+    const MatrixXdR &mat = m_listMax[level-1];
+    return RowVectorPair(mat.data() + row*mat.cols(), mat.cols());
+}
+
+
+//*************************************************************************************************************
+
+void MinMaxPyramid::decimate(const double* srcMin, const double* srcMax, int length, double* dstMin, double* dstMax)
+{
+    int pairs = length/2;
+
+    //Compare even and odd values
+    Map<const RowVectorXd, 0, InnerStride<2> > evenMin(srcMin, pairs);
+    Map<const RowVectorXd, 0, InnerStride<2> > oddMin(srcMin+1, pairs);
+    Map<const RowVectorXd, 0, InnerStride<2> > evenMax(srcMax, pairs);
+    Map<const RowVectorXd, 0, InnerStride<2> > oddMax(srcMax+1, pairs);
+
+    Map<RowVectorXd>(dstMin, pairs) = evenMin.cwiseMin(oddMin);
+    Map<RowVectorXd>(dstMax, pairs) = evenMax.cwiseMax(oddMax);
+
+    if(length%2 != 0) {
+        dstMin[pairs] = srcMin[length-1];
+        dstMax[pairs] = srcMax[length-1];
+    }
+}
@@ -0,0 +1,194 @@
+//=============================================================================================================
+/**
+* @file     minmaxpyramid.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Contains the declaration of the MinMaxPyramid class.
+*
+*/
+
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "types.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE MNEBrowseRawQt
+//=============================================================================================================
+
+namespace MNEBrowseRawQt
+{
+
+
+//=============================================================================================================
+/**
+* Level k of the pyramid holds the minimum and maximum of each bucket of 2^k samples of every channel. Level 1 is
+* decimated from the data, each further level from the level below, so building all levels costs about two passes
+* over the data. The delegates use it to draw one vertical min/max line per pixel column instead of one line per
+* sample when the plot is zoomed out.
+*
+* @brief The MinMaxPyramid class holds the min/max decimation levels of a data block.
+*/
+class MinMaxPyramid
+{
+public:
+    //=========================================================================================================
+    /**
+    * Constructs an empty MinMaxPyramid.
+    */
+    MinMaxPyramid();
+
+    //=========================================================================================================
+    /**
+    * Builds all levels of the data.
+    *
+    * @param data the data (channels x samples)
+    */
+    void build(const MatrixXdR &data);
+
+    //=========================================================================================================
+    /**
+    * Rebuilds all levels of one channel.
+    *
+    * @param data the data (channels x samples) the pyramid was built for
+    * @param row the row which was changed
+    */
+    void updateRow(const MatrixXdR &data, int row);
+
+    //=========================================================================================================
+    /**
+    * Removes all levels.
+    */
+    void clear();
+
+    //=========================================================================================================
+    /**
+    * Returns the memory of all levels.
+    *
+    * @return the memory in bytes
+    */
+    qint64 memorySize() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the number of levels. Level 0 is the data itself and is not stored.
+    *
+    * @return the number of levels including level 0
+    */
+    int levels() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the highest level whose buckets are not larger than the given number of samples.
+    *
+    * @param samplesPerBucket the number of samples which may be combined, i.e. the samples per pixel
+    * @return the level, 0 if the samples are to be plotted one by one
+    */
+    int level(double samplesPerBucket) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the level a pyramid of data with the given number of samples would use, without building it.
+    *
+    * @param length the number of samples per channel
+    * @param samplesPerBucket the number of samples which may be combined, i.e. the samples per pixel
+    * @return the level, 0 if the samples are to be plotted one by one
+    */
+    static int level(int length, double samplesPerBucket);
+
+    //=========================================================================================================
+    /**
+    * Returns the bucket minima of one channel.
+    *
+    * @param level the level, 1 <= level < levels()
+    * @param row the row index
+    * @return pointer to the first minimum and the number of buckets
+    */
+    RowVectorPair minima(int level, int row) const;
+
+    //=========================================================================================================
+    /**
+    * Returns the bucket maxima of one channel.
+    *
+    * @param level the level, 1 <= level < levels()
+    * @param row the row index
+    * @return pointer to the first maximum and the number of buckets
+    */
+    RowVectorPair maxima(int level, int row) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Halves the resolution of one row. The last bucket of an odd length row holds one sample only.
+    *
+    * @param srcMin minima of the lower level
+    * @param srcMax maxima of the lower level
+    * @param length number of values of the lower level
+    * @param dstMin minima of the level (length+1)/2
+    * @param dstMax maxima of the level (length+1)/2
+    */
+    static void decimate(const double* srcMin, const double* srcMax, int length, double* dstMin, double* dstMax);
+
+    QList<MatrixXdR>    m_listMin;      /**< The minima of the levels 1..levels()-1 (channels x buckets). */
+    QList<MatrixXdR>    m_listMax;      /**< The maxima of the levels 1..levels()-1 (channels x buckets). */
+};
+
+} // NAMESPACE
+
+#endif // MINMAXPYRAMID_H
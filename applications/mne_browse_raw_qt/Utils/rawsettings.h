@@ -82,11 +82,15 @@
 #define MODEL_MAX_WINDOWS 3 //number of windows that are at maximum remained in m_data
 #define MODEL_NUM_FILTER_TAPS 80 //number of filter taps, required to take into account because of FFT convolution (zero padding)
 #define MODEL_MAX_NUM_FILTER_TAPS 0 //number of maximal filter taps
+#define MODEL_PREFETCH_WINDOWS 2 //number of windows that are prefetched in scroll direction
+#define MODEL_CACHE_MEMORY 512 //memory budget of the cache for prefetched and dropped windows [in MB]
 
 //RawDelegate
 //Look
 #define DELEGATE_PLOT_HEIGHT 40 //height of a single plot (row)
 #define DELEGATE_DX 1 //each DX pixel a sample is plot -> plot resolution
+#define DELEGATE_MIN_DX 0.0625 //smallest plot resolution when zooming out, i.e. 16 samples per pixel -> bounds the number of loaded windows
+#define DELEGATE_ZOOM_FACTOR 2 //factor by which the plot resolution is changed per zoom step
 #define DELEGATE_NHLINES 6 //number of horizontal lines within a single plot (row)
 
 //maximum values for different channels types according to FiffChInfo
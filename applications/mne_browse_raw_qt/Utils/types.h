@@ -76,6 +76,7 @@ namespace MNEBrowseRawQt
 
 typedef Matrix<double,Dynamic,Dynamic,RowMajor> MatrixXdR;
 typedef QPair<const double*,qint32> RowVectorPair;
+typedef QPair<RowVectorPair,RowVectorPair> MinMaxRowPair;
 typedef QPair<const float*,qint32> RowVectorPairF;
 typedef QPair<int,int> QPairInts;
 
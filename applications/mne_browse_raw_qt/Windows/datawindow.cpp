@@ -62,6 +62,7 @@ DataWindow::DataWindow(QWidget *parent)
 , m_pDataMarker(new DataMarker(this))
 , m_pCurrentDataMarkerLabel(new QLabel(this))
 , m_iCurrentMarkerSample(0)
+, m_pRawDelegate(NULL)
 , m_bHideBadChannels(false)
 {
     ui->setupUi(this);
@@ -171,6 +172,52 @@ void DataWindow::changeRowHeight(int height)
 }
 
 
+//*************************************************************************************************************
+
+void DataWindow::setPlotResolution(double dx)
+{
+    if(!m_pRawDelegate)
+        return;
+
+    double dDx = qBound((double)DELEGATE_MIN_DX, dx, (double)DELEGATE_DX);
+    if(dDx == m_pRawDelegate->m_dDx)
+        return;
+
+    QScrollBar* horizontalScrollBar = ui->m_tableView_rawTableView->horizontalScrollBar();
+
+    //keep the first visible sample in place
+    int firstVisibleSample = qRound(horizontalScrollBar->value()/m_pRawDelegate->m_dDx);
+
+    m_pRawDelegate->m_dDx = dDx;
+    updateVisibleSamples();
+
+    //the column width is the number of samples times the plot resolution
+    ui->m_tableView_rawTableView->resizeColumnsToContents();
+    horizontalScrollBar->setValue(qRound(firstVisibleSample*dDx));
+
+    //the scroll bar value may not have changed, the model still has to load the now visible range
+    m_pRawModel->updateScrollPos(firstVisibleSample);
+
+    setRangeSampleLabels();
+    setMarkerSampleLabel();
+    updateDataTableViews();
+}
+
+
+//*************************************************************************************************************
+
+void DataWindow::zoom(bool zoomIn)
+{
+    if(!m_pRawDelegate)
+        return;
+
+    if(zoomIn)
+        setPlotResolution(m_pRawDelegate->m_dDx*DELEGATE_ZOOM_FACTOR);
+    else
+        setPlotResolution(m_pRawDelegate->m_dDx/DELEGATE_ZOOM_FACTOR);
+}
+
+
 //*************************************************************************************************************
 
 void DataWindow::hideBadChannels(bool hideChannels)
@@ -226,7 +273,8 @@ void DataWindow::initMVCSettings()
 
     //connect QScrollBar with model in order to reload data samples
     connect(ui->m_tableView_rawTableView->horizontalScrollBar(), &QScrollBar::valueChanged,
-            m_pRawModel, &RawModel::updateScrollPos);
+            this, &DataWindow::updateScrollPos);
+    updateVisibleSamples();
 
     //connect selection of a channel to selection manager
     connect(ui->m_tableView_rawTableView->selectionModel(), &QItemSelectionModel::selectionChanged,
@@ -367,6 +415,9 @@ void DataWindow::resizeEvent(QResizeEvent * event)
     //On every resize set sample informaiton
     setRangeSampleLabels();
 
+    //On every resize update the number of samples the model needs to keep loaded
+    updateVisibleSamples();
+
     return QWidget::resizeEvent(event);
 }
 
@@ -536,8 +587,9 @@ void DataWindow::setRangeSampleLabels()
 
     //calculate sample range which is currently displayed in the view
     //Note: the viewport holds the width of the area which is changed through scrolling
-    int minSampleRange = ui->m_tableView_rawTableView->horizontalScrollBar()->value()/* + m_pMainWindow->m_pRawModel->firstSample()*/;
-    int maxSampleRange = minSampleRange + ui->m_tableView_rawTableView->viewport()->width();
+    //Note: the scroll bar and the viewport are in pixels, each sample takes m_dDx pixels
+    int minSampleRange = ui->m_tableView_rawTableView->horizontalScrollBar()->value()/m_pRawDelegate->m_dDx/* + m_pMainWindow->m_pRawModel->firstSample()*/;
+    int maxSampleRange = minSampleRange + ui->m_tableView_rawTableView->viewport()->width()/m_pRawDelegate->m_dDx;
 
     //Set values as string
     QString stringTemp;
@@ -555,8 +607,8 @@ void DataWindow::setMarkerSampleLabel()
     m_pCurrentDataMarkerLabel->raise();
 
     //Update the text and position in the current sample marker label
-    m_iCurrentMarkerSample = ui->m_tableView_rawTableView->horizontalScrollBar()->value() +
-            (m_pDataMarker->geometry().x() - ui->m_tableView_rawTableView->geometry().x() - ui->m_tableView_rawTableView->verticalHeader()->width());
+    m_iCurrentMarkerSample = (ui->m_tableView_rawTableView->horizontalScrollBar()->value() +
+            (m_pDataMarker->geometry().x() - ui->m_tableView_rawTableView->geometry().x() - ui->m_tableView_rawTableView->verticalHeader()->width()))/m_pRawDelegate->m_dDx;
 
     int currentSeconds = (m_iCurrentMarkerSample/m_pRawModel->m_pFiffInfo->sfreq)*1000;
 
@@ -620,6 +672,25 @@ void DataWindow::highlightChannelsInSelectionManager()
 }
 
 
+//*************************************************************************************************************
+
+void DataWindow::updateScrollPos(int value)
+{
+    m_pRawModel->updateScrollPos(qRound(value/m_pRawDelegate->m_dDx));
+}
+
+
+//*************************************************************************************************************
+
+void DataWindow::updateVisibleSamples()
+{
+    if(!m_pRawDelegate)
+        return;
+
+    m_pRawModel->setVisibleSamples(ceil(ui->m_tableView_rawTableView->viewport()->width()/m_pRawDelegate->m_dDx));
+}
+
+
 //*************************************************************************************************************
 
 bool DataWindow::gestureEvent(QGestureEvent *event)
@@ -172,6 +172,23 @@ public:
     */
     void hideBadChannels(bool hideChannels);
 
+    //=========================================================================================================
+    /**
+    * Sets the plot resolution, i.e. the pixel distance of two samples. Below one several samples fall onto a pixel
+    * column and the traces are plotted from the min/max pyramids. The first visible sample is kept in place.
+    *
+    * @param [in] dx the plot resolution, bounded to [DELEGATE_MIN_DX, DELEGATE_DX]
+    */
+    void setPlotResolution(double dx);
+
+    //=========================================================================================================
+    /**
+    * Zooms the data view in or out
+    *
+    * @param [in] zoomIn true to zoom in, false to zoom out by DELEGATE_ZOOM_FACTOR
+    */
+    void zoom(bool zoomIn);
+
 private:
     //=========================================================================================================
     /**
@@ -280,6 +297,20 @@ protected slots:
     * Highlights the current selected channels in the 2D plot of selection manager
     */
     void highlightChannelsInSelectionManager();
+
+    //=========================================================================================================
+    /**
+    * Hands the first visible sample to the model, which reloads data if necessary
+    *
+    * @param [in] value the position of the horizontal scroll bar [in pixels]
+    */
+    void updateScrollPos(int value);
+
+    //=========================================================================================================
+    /**
+    * Hands the number of visible samples to the model
+    */
+    void updateVisibleSamples();
 };
 
 } // NAMESPACE MNEBrowseRawQt
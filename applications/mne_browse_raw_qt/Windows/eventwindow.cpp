@@ -269,14 +269,16 @@ void EventWindow::jumpToEvent(const QModelIndex & current, const QModelIndex & p
         int sample = m_pEventModel->data(index, Qt::DisplayRole).toInt();
 
         //Jump to sample - put sample in the middle of the view - the viewport holds the width of the are which is changed through scrolling
-        int rawTableViewColumnWidth = m_pMainWindow->m_pDataWindow->getDataTableView()->viewport()->width();
+        //the scroll bar and the viewport are in pixels, each sample takes m_dDx pixels
+        double dx = m_pMainWindow->m_pDataWindow->getDataDelegate()->m_dDx;
+        int rawTableViewColumnWidth = m_pMainWindow->m_pDataWindow->getDataTableView()->viewport()->width()/dx;
 
         if(sample-rawTableViewColumnWidth/2 < rawTableViewColumnWidth/2) //events lie in the first half of the data window at the beginning of the loaded data -> cannot centralize view on event
             m_pMainWindow->m_pDataWindow->getDataTableView()->horizontalScrollBar()->setValue(0);
         else if(sample+rawTableViewColumnWidth/2 > m_pMainWindow->m_pDataWindow->getDataModel()->lastSample()-rawTableViewColumnWidth/2) //events lie in the last half of the data window at the end of the loaded data -> cannot centralize view on event
             m_pMainWindow->m_pDataWindow->getDataTableView()->horizontalScrollBar()->setValue(m_pMainWindow->m_pDataWindow->getDataTableView()->maximumWidth());
         else //centralize view on event
-            m_pMainWindow->m_pDataWindow->getDataTableView()->horizontalScrollBar()->setValue(sample-rawTableViewColumnWidth/2);
+            m_pMainWindow->m_pDataWindow->getDataTableView()->horizontalScrollBar()->setValue((sample-rawTableViewColumnWidth/2)*dx);
 
         qDebug()<<"Jumping to Event at sample "<<sample<<"rawTableViewColumnWidth"<<rawTableViewColumnWidth;
 
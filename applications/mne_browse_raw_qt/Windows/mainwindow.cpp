@@ -267,6 +267,23 @@ void MainWindow::createToolBar()
     });
     toolBar->addAction(m_pHideBadAction);
 
+    //Add zoom actions, zoomed out traces are plotted from the min/max pyramids
+    QAction* zoomInAction = new QAction(QIcon::fromTheme("zoom-in"),tr("Zoom in"), this);
+    zoomInAction->setShortcut(QKeySequence::ZoomIn);
+    zoomInAction->setStatusTip(tr("Zoom in, i.e. plot less samples per pixel"));
+    connect(zoomInAction, &QAction::triggered, this, [=](){
+        m_pDataWindow->zoom(true);
+    });
+    toolBar->addAction(zoomInAction);
+
+    QAction* zoomOutAction = new QAction(QIcon::fromTheme("zoom-out"),tr("Zoom out"), this);
+    zoomOutAction->setShortcut(QKeySequence::ZoomOut);
+    zoomOutAction->setStatusTip(tr("Zoom out, i.e. plot more samples per pixel"));
+    connect(zoomOutAction, &QAction::triggered, this, [=](){
+        m_pDataWindow->zoom(false);
+    });
+    toolBar->addAction(zoomOutAction);
+
     toolBar->addSeparator();
 
     //Toggle visibility of the event manager
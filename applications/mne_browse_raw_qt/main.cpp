@@ -44,6 +44,8 @@
 #include "Windows/mainwindow.h"
 #include "Utils/info.h"
 
+#include <fiff/fiff_dir_index.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -54,6 +56,7 @@
 #include <QApplication>
 #include <QDateTime>
 #include <QSplashScreen>
+#include <QStandardPaths>
 #include <QThread>
 
 
@@ -63,6 +66,7 @@
 //=============================================================================================================
 
 using namespace MNEBrowseRawQt;
+using namespace FIFFLIB;
 
 
 //*************************************************************************************************************
@@ -117,6 +121,9 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationName(CInfo::OrganizationName());
     QCoreApplication::setApplicationName(CInfo::AppNameShort());
 
+    //keep the tag directories of rescanned fiff files in the user's cache, not next to the data
+    FiffDirIndex::setCacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/fiff_index");
+
     //show splash screen for 1 second
     QPixmap pixmap(":/Resources/Images/splashscreen_mne_browse_raw_qt.png");
     QSplashScreen splash(pixmap);
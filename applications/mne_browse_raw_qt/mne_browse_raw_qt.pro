@@ -103,6 +103,8 @@ SOURCES += \
     Windows/scalewindow.cpp \
     Windows/chinfowindow.cpp \
     Utils/datapackage.cpp \    
+    Utils/minmaxpyramid.cpp \
+    Utils/datapackagecache.cpp \
     Windows/noisereductionwindow.cpp
 
 HEADERS += \
@@ -131,6 +133,8 @@ HEADERS += \
     Windows/chinfowindow.h \
     Windows/noisereductionwindow.h \
     Utils/datapackage.h \
+    Utils/minmaxpyramid.h \
+    Utils/datapackagecache.h \
 
 FORMS += \
     Windows/eventwindowdock.ui \
@@ -2180,6 +2180,29 @@ void MainWindow::on_actionCreate_treebased_dictionary_triggered()
 
 //*****************************************************************************************************************
 
+// convert xml dictionary to binary
+void MainWindow::on_actionConvert_dictionary_triggered()
+{
+    QString xml_path = QFileDialog::getOpenFileName(this, "Convert dictionary to binary...", QDir::homePath() + "/" + "Matching-Pursuit-Toolbox", "(*.dict)");
+    if(xml_path.isEmpty())
+        return;
+
+    //the binary dictionary next to the xml is used by the calculation as long as it is newer than the xml
+    QFileInfo xml_info(xml_path);
+    QString bin_path = xml_info.absolutePath() + "/" + xml_info.completeBaseName() + ".bdict";
+
+    //store the atom spectra for the loaded signal, so that they needn't be calculated for each decomposition
+    qint32 spectra_length = _has_file ? _signal_matrix.rows() : 0;
+
+    FixDictMp fix_mp;
+    if(fix_mp.convert_xml_dict(xml_path, bin_path, spectra_length))
+        QMessageBox::information(this, "Information", QString("Binary dictionary %1 written.").arg(bin_path));
+    else
+        QMessageBox::warning(this, "Error", QString("Could not convert %1 to a binary dictionary.").arg(xml_path));
+}
+
+//*****************************************************************************************************************
+
 // open settings
 void MainWindow::on_actionSettings_triggered()
 {
@@ -3290,7 +3313,9 @@ void MainWindow::on_actionTFplot_triggered()
             }
         }
         */
-        tf_sum = Spectrogram::make_spectrogram(_signal_matrix.col(0), 0);
+        //short-time spectrogram, limited to about 1024 frames and frequency rows for long signals
+        qint32 tf_reduction = qMax(1, qint32(_signal_matrix.rows() / 1024));
+        tf_sum = Spectrogram::make_spectrogram(_signal_matrix.col(0), 0, tf_reduction, 0, tf_reduction);
 
         TFplot *tfplot = new TFplot(tf_sum, _sample_rate, 0, 600, Jet);
         ui->tabWidget->addTab(tfplot, "TF-Overview 0-500Hz");
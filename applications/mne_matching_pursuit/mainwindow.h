@@ -316,6 +316,18 @@ private slots:
     */
     void on_actionCreate_treebased_dictionary_triggered();
 
+    //==========================================================================================================
+    /**
+    * MainWindow_on_actionConvert_dictionary_triggered
+    *
+    * ### MP toolbox main window slots ###
+    *
+    * converts a xml dictionary into the binary dictionary next to it, which is then used for calculations
+    *
+    * @return void
+    */
+    void on_actionConvert_dictionary_triggered();
+
     //==========================================================================================================
     /**
     * MainWindow_on_dsb_from_editingFinished
@@ -56,6 +56,8 @@
 
 #include "babymeginfo.h"
 
+#include <utils/babymegparser.h>
+
 
 class QTcpSocket;
 class QNetworkSession;
@@ -86,7 +88,8 @@ public:
     bool DataAcqStartFlag;
     BabyMEGInfo *myBabyMEGInfo;
 
-    QByteArray buffer;
+    UTILSLIB::BabyMEGParser m_parser;   /**< Frame parser holding the received bytes. */
+    Eigen::MatrixXf m_matData;          /**< Decoded data block, reused for each block. */
     int numBlock;
     bool DataACK;
 
@@ -175,17 +178,9 @@ public:
     */
     void SetInfo(BabyMEGInfo *pInfo);
     /**
-    * Dispatch the data package
-    *
-    * @param[in] tmp -- block size
-    */
-    void DispatchDataPackage(int tmp);
-    /**
-    * Read next data block
-    *
-    * @param[in] tmp -- block size
+    * Decode the next data frame and dispatch it as data block
     */
-    void ReadNextBlock(int tmp);
+    void DispatchDataPackage();
     /**
     * Send command with command format as string
     *
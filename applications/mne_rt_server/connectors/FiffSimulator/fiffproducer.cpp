@@ -101,6 +101,7 @@ void FiffProducer::run()
     // reopen file in this thread
     QFile t_File(m_pFiffSimulator->m_RawInfo.info.filename);
     FiffStream::SPtr p_pStream(new FiffStream(&t_File));
+    p_pStream->setMemoryMapped(true);
     m_pFiffSimulator->m_RawInfo.file = p_pStream;
 
     //
@@ -124,10 +125,14 @@ void FiffProducer::run()
 
     fiff_int_t first, last;
     MatrixXd data;
-    MatrixXd times;
 
     first = from;
 
+    //
+    //   Calibration is fused into the decoding, data is reused between the reads
+    //
+    m_pFiffSimulator->m_RawInfo.prepare_read_plan();
+
     qint32 nchan = m_pFiffSimulator->m_RawInfo.info.nchan;
 
     MatrixXd cals(1,nchan);
@@ -154,7 +159,7 @@ void FiffProducer::run()
             last = to;
         }
 
-        if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last))
+        if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,first,last))
         {
             printf("error during read_raw_segment\n");
         }
@@ -171,7 +176,7 @@ void FiffProducer::run()
             first = from;
             last = first+t_iDiff-1;
 
-            if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,times,first,last))
+            if (!m_pFiffSimulator->m_RawInfo.read_raw_segment(data,first,last))
             {
                 printf("error during read_raw_segment\n");
             }
@@ -70,6 +70,7 @@
 #include <QtCore/QtPlugin>
 #include <QFile>
 #include <QCoreApplication>
+#include <QStandardPaths>
 #include <QDebug>
 
 
@@ -311,6 +312,12 @@ const char* FiffSimulator::getName() const
 
 void FiffSimulator::init()
 {
+    //
+    // Keep the tag directory of the simulation file in the user's cache, a restart then skips the scan of the whole file
+    //
+    if(FiffDirIndex::cacheDir().isEmpty())
+        FiffDirIndex::setCacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/fiff_index");
+
     //
     // Read cfg file
     //
@@ -407,6 +414,13 @@ bool FiffSimulator::readRawInfo()
             return false;
         }
 
+        //
+        //   Raw buffers are read in a tight loop by the producer -> read them from a memory-mapped file
+        //
+        m_RawInfo.file->setMemoryMapped(true);
+        for(qint32 i = 0; i < m_RawInfo.split_files.size(); ++i)
+            m_RawInfo.split_files[i]->setMemoryMapped(true);
+
         m_TrueSamplingRate = m_RawInfo.info.sfreq;
         m_RawInfo.info.sfreq *= m_AccelerationFactor;
 
@@ -373,10 +373,24 @@ void FiffStreamServer::forwardMeasInfo(qint32 ID, FiffInfo p_fiffInfo)
 
 
 //*************************************************************************************************************
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    if(m_qClientList.isEmpty())
+        return;
+
+    //
+    // Encode the tag once, all clients queue a reference to the same immutable block
+    //
+    qint32 t_iNel = m_pMatRawData->rows()*m_pMatRawData->cols();
+    QByteArray t_blockRawBuffer;
+    t_blockRawBuffer.reserve(4*sizeof(qint32) + t_iNel*sizeof(float));
+    {
+        FiffStream t_FiffStreamOut(&t_blockRawBuffer, QIODevice::WriteOnly);
+        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_pMatRawData->data(), t_iNel);
+    }
+
+    emit remitRawBuffer(t_blockRawBuffer);
 }
 
 
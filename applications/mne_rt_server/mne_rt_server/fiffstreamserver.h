@@ -132,7 +132,7 @@ signals:
     void stopMeasFiffStreamClient(qint32 ID);
 
     void remitMeasInfo(qint32 ID, FIFFLIB::FiffInfo p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitRawBuffer(QByteArray p_blockRawBuffer);
 
     void closeFiffStreamServer();
 
@@ -60,6 +60,7 @@
 //=============================================================================================================
 
 #include <QtNetwork>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -82,6 +83,7 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_bFlushPending(false)
 , m_bIsSendingRawBuffer(false)
 , m_bIsRunning(false)
 {
@@ -98,6 +100,7 @@ FiffStreamThread::~FiffStreamThread()
         t_pFiffStreamServer->m_qClientList.remove(m_iDataClientId);
 
     m_bIsRunning = false;
+    QThread::quit();
     QThread::wait();
 }
 
@@ -110,10 +113,13 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
         // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockStart;
+        FiffStream t_FiffStreamOut(&t_blockStart, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+
+        m_qMutex.lock();
+        enqueue(t_blockStart);
         m_bIsSendingRawBuffer = true;
         m_qMutex.unlock();
     }
@@ -129,9 +135,12 @@ void FiffStreamThread::stopMeas(qint32 ID)
     {
         qDebug() << "stop raw buffer sending.";
 
-        m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockEnd;
+        FiffStream t_FiffStreamOut(&t_blockEnd, QIODevice::WriteOnly);
         t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+
+        m_qMutex.lock();
+        enqueue(t_blockEnd);
         m_bIsSendingRawBuffer = false;
         m_qMutex.unlock();
     }
@@ -178,19 +187,17 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //*************************************************************************************************************
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+void FiffStreamThread::sendRawBuffer(QByteArray p_blockRawBuffer)
 {
     if(m_bIsSendingRawBuffer)
     {
 //        qDebug() << "Send RawBuffer to client";
 
+        //The block is already encoded by the server, only a reference is queued
         m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
-
+        if(m_bIsSendingRawBuffer)
+            enqueue(p_blockRawBuffer);
         m_qMutex.unlock();
-
     }
 //    else
 //    {
@@ -225,9 +232,8 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, FiffInfo p_fiffInfo)
 {
     if(ID == m_iDataClientId)
     {
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockMeasInfo;
+        FiffStream t_FiffStreamOut(&t_blockMeasInfo, QIODevice::WriteOnly);
 
 //        qint32 init_info[2];
 //        init_info[0] = FIFF_MNE_RT_CLIENT_ID;
@@ -238,6 +244,9 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, FiffInfo p_fiffInfo)
 //FiffStream::start_writing_raw
 
         p_fiffInfo.writeToStream(&t_FiffStreamOut);
+
+        m_qMutex.lock();
+        enqueue(t_blockMeasInfo);
         m_qMutex.unlock();
 
 //        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
@@ -249,9 +258,88 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, FiffInfo p_fiffInfo)
 
 void FiffStreamThread::writeClientId()
 {
-    FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+    QByteArray t_blockClientId;
+    FiffStream t_FiffStreamOut(&t_blockClientId, QIODevice::WriteOnly);
 
     t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+
+    m_qMutex.lock();
+    enqueue(t_blockClientId);
+    m_qMutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::enqueue(const QByteArray& p_blockTag)
+{
+    m_qSendQueue.enqueue(p_blockTag);
+
+    if(!m_bFlushPending)
+    {
+        m_bFlushPending = true;
+        emit sendQueueChanged();
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::writeQueue(QTcpSocket& p_qTcpSocket)
+{
+    if(p_qTcpSocket.state() != QAbstractSocket::ConnectedState)
+        return;
+
+    while(p_qTcpSocket.bytesToWrite() < FIFFSTREAMTHREAD_MAX_SOCKET_BACKLOG)
+    {
+        m_qMutex.lock();
+        if(m_qSendQueue.isEmpty())
+        {
+            m_bFlushPending = false;
+            m_qMutex.unlock();
+            return;
+        }
+        QByteArray t_blockTag = m_qSendQueue.dequeue();
+        m_qMutex.unlock();
+
+        p_qTcpSocket.write(t_blockTag);
+    }
+
+    //Backlog is full -> continue on bytesWritten
+    m_qMutex.lock();
+    m_bFlushPending = false;
+    m_qMutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::readCommands(QTcpSocket& p_qTcpSocket)
+{
+    FiffStream t_FiffStreamIn(&p_qTcpSocket);
+
+    while(p_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
+    {
+        //
+        // Wait until the whole tag is available, the data size is the third entry of the tag header
+        //
+        QByteArray t_blockHeader = p_qTcpSocket.peek(sizeof(qint32)*4);
+        qint32 t_iDataSize = qFromBigEndian<qint32>((const uchar*)t_blockHeader.constData() + 2*sizeof(qint32));
+        if(p_qTcpSocket.bytesAvailable() < (qint64)sizeof(qint32)*4 + t_iDataSize)
+            return;
+
+        FiffTag::SPtr t_pTag;
+        FiffTag::read_tag_info(&t_FiffStreamIn, t_pTag, false);
+        FiffTag::read_tag_data(&t_FiffStreamIn, t_pTag);
+
+        //
+        // Parse the tag
+        //
+        if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
+        {
+            parseCommand(t_pTag);
+        }
+    }
 }
 
 
@@ -322,64 +410,28 @@ void FiffStreamThread::run()
                t_qTcpSocket.peerPort());
     }
 
-    FiffStream t_FiffStreamIn(&t_qTcpSocket);
-
-//    int i = 0;
-    while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
-    {
-        //
-        // Write available data
-        //
-        m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
-        {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
-            t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
-            {
-                m_qSendBlock.clear();
-            }
-            else
-            {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
-            }
-        }
-        m_qMutex.unlock();
-
-        //
-        // Read: Wait 10ms for incomming tag header, read and continue
-        //
-        t_qTcpSocket.waitForReadyRead(10);
-
-        if (t_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
-        {
-//            qDebug() << "goes to read bytes " ;
-            FiffTag::SPtr t_pTag;
-            FiffTag::read_tag_info(&t_FiffStreamIn, t_pTag, false);
-
-            //
-            // wait until tag size data are available and read the data
-            //
-            while (t_qTcpSocket.bytesAvailable() < t_pTag->size())
-            {
-                t_qTcpSocket.waitForReadyRead(10);
-            }
-            FiffTag::read_tag_data(&t_FiffStreamIn, t_pTag);
-
-            //
-            // Parse the tag
-            //
-            if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
-            {
-                parseCommand(t_pTag);
-            }
-        }
-    }
+    //
+    // Event driven: write when data is queued or the socket drained, read when commands arrive
+    //
+    connect(this, &FiffStreamThread::sendQueueChanged, &t_qTcpSocket, [this, &t_qTcpSocket](){
+        writeQueue(t_qTcpSocket);
+    }, Qt::QueuedConnection);
+    connect(&t_qTcpSocket, &QTcpSocket::bytesWritten, [this, &t_qTcpSocket](){
+        writeQueue(t_qTcpSocket);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::readyRead, [this, &t_qTcpSocket](){
+        readCommands(t_qTcpSocket);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::disconnected, [this](){
+        QThread::quit();
+    });
+
+    //Data queued before the connection was set up
+    writeQueue(t_qTcpSocket);
+    readCommands(t_qTcpSocket);
+
+    if(m_bIsRunning && t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
+        exec();
 
     t_qTcpSocket.disconnectFromHost();
     if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
@@ -53,9 +53,18 @@
 #include <QThread>
 #include <QTcpSocket>
 #include <QMutex>
+#include <QQueue>
 #include <QSharedPointer>
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define FIFFSTREAMTHREAD_MAX_SOCKET_BACKLOG (4*1024*1024)   /**< Bytes handed to the socket before waiting for bytesWritten. */
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE NAMESPACE RTSERVER
@@ -103,14 +112,45 @@ public:
 signals:
     void error(QTcpSocket::SocketError socketError);
 
+    //=========================================================================================================
+    /**
+    * Emitted when the send queue got new data and no write is pending yet. Queued to the client thread.
+    */
+    void sendQueueChanged();
+
 private:
+    //=========================================================================================================
+    /**
+    * Appends an encoded tag block to the send queue. m_qMutex has to be locked by the caller.
+    *
+    * @param[in] p_blockTag     The encoded tag(s), shared and not modified.
+    */
+    void enqueue(const QByteArray& p_blockTag);
+
+    //=========================================================================================================
+    /**
+    * Hands queued blocks to the socket until its backlog is full.
+    *
+    * @param[in] p_qTcpSocket   The client socket.
+    */
+    void writeQueue(QTcpSocket& p_qTcpSocket);
+
+    //=========================================================================================================
+    /**
+    * Reads and parses all complete command tags available on the socket.
+    *
+    * @param[in] p_qTcpSocket   The client socket.
+    */
+    void readCommands(QTcpSocket& p_qTcpSocket);
+
     qint32 m_iDataClientId;
     QString m_sDataClientAlias;
 
     int m_iSocketDescriptor;
 
     QMutex m_qMutex;
-    QByteArray m_qSendBlock;
+    QQueue<QByteArray> m_qSendQueue;    /**< Encoded tags to send. Raw buffer blocks are shared between all clients. */
+    bool m_bFlushPending;               /**< Whether a sendQueueChanged() is not processed yet. */
 
     bool m_bIsSendingRawBuffer;
 
@@ -120,7 +160,7 @@ private:
     void startMeas(qint32 ID);
     void stopMeas(qint32 ID);
     void sendMeasurementInfo(qint32 ID, FiffInfo p_fiffInfo);
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    void sendRawBuffer(QByteArray p_blockRawBuffer);
     //void readToBuffer1();
 //    void readProc(QTcpSocket& p_qTcpSocket);
 };
@@ -143,7 +143,7 @@ void babymeghpidgl::ReadPolhemusDig(QString fileName)
     //
     //read_hpi_info(t_pStream,t_Tree, info);
     fiff_int_t kind = -1;
-    fiff_int_t pos = -1;
+    fiff_long_t pos = -1;
     FiffTag::SPtr t_pTag;
 
     //
@@ -478,21 +478,13 @@ void BabyMEG::toggleRecordingFile()
 
 //*************************************************************************************************************
 
-void BabyMEG::setFiffData(QByteArray DATA)
+void BabyMEG::setFiffData(const MatrixXf& rawData)
 {
-    //get the first byte -- the data format
-    int dformat = DATA.left(1).toInt();
+    //the client already decoded the samples into host byte order
+    qint32 rows = rawData.rows();
+    qint32 cols = rawData.cols();
 
-    DATA.remove(0,1);
-    qint32 rows = m_pFiffInfo->nchan;
-    qint32 cols = (DATA.size()/dformat)/rows;
-
-    qDebug() << "[BabyMEG] Matrix " << rows << "x" << cols << " [Data bytes:" << dformat << "]";
-
-    MatrixXf rawData(Map<MatrixXf>( (float*)DATA.data(),rows, cols ));
-
-    for(qint32 i = 0; i < rows*cols; ++i)
-        IOUtils::swap_floatp(rawData.data()+i);
+    qDebug() << "[BabyMEG] Matrix " << rows << "x" << cols;
 
 
     if(m_bIsRunning)
@@ -268,11 +268,11 @@ public:
 
     //=========================================================================================================
     /**
-    * Sets the Fiff Info data.
+    * Sets the Fiff data.
     *
-    * @param[in] DATA    the Fiff Info data.
+    * @param[in] DATA    the decoded data block (channels x samples).
     */
-    void setFiffData(QByteArray DATA);
+    void setFiffData(const MatrixXf& DATA);
 
     //=========================================================================================================
     /**
@@ -209,7 +209,7 @@ void BabyMEGClient::ConnectToBabyMEG()
             qDebug()<< "Send the initial parameter request";
             if (tcpSocket->state()==QAbstractSocket::ConnectedState)
             {
-                buffer.clear();
+                m_parser.clear();
 //                SendCommand("INFO");
                 SendCommand("DATA");
             }
@@ -301,24 +301,9 @@ void BabyMEGClient::SendCommandToBabyMEG()
 
 void BabyMEGClient::ReadToBuffer()
 {
-
-    QByteArray dat;
-
-    int numBytes = tcpSocket->bytesAvailable();
-//    qDebug() << "1.byte available: " << numBytes;
-    if (numBytes > 0){
-        dat = tcpSocket->read(numBytes); // read all pending data
-//        qDebug()<<"[dat Size]"<<dat.size();
-        if (!dat.isEmpty()){
-            buffer.append(dat); // and append it to your own buffer
-//            qDebug()<<"[ReadToBuffer: Buffer Size]"<<buffer.size();
-        }
-        else
-        {
-            qDebug()<<"[Empty dat: error]"<<tcpSocket->errorString();
-        }
-    }
-//    qDebug()<<"read buffer is done!";
+    // read all pending data straight into the ring buffer of the parser
+    if (m_parser.readFrom(tcpSocket) < 0)
+        qDebug()<<"[Read error]"<<tcpSocket->errorString();
 
     handleBuffer();
     return;
@@ -329,180 +314,127 @@ void BabyMEGClient::ReadToBuffer()
 
 void BabyMEGClient::handleBuffer()
 {
-    if(buffer.size()>= 8){
-        QByteArray CMD = buffer.left(4);
-        QByteArray DLEN = buffer.mid(4,4);
-        int tmp = MGH_LM_Byte2Int(DLEN);
-//        qDebug() << "First 4 bytes + length" << CMD << "["<<CMD.toHex()<<"]";
-//        qDebug() << "Command[" << CMD <<"]";
-//        qDebug() << "Body Length[" << tmp << "]";
-
-        if (tmp <= (buffer.size() - 8))
-        {
-            buffer.remove(0,8);
-
-            int OPT = 0;
-
-            if (CMD == "INFO")
-                OPT = 1;
-            else if (CMD == "DATR")
-                OPT = 2;
-            else if (CMD == "COMD")
-                OPT = 3;
-            else if (CMD == "QUIT")
-                OPT = 4;
-            else if (CMD == "COMS")
-                OPT = 5;
-            else if (CMD == "QUIS")
-                OPT = 6;
+    bool DataRequested = false;
+
+    // process all complete frames, the headers are decoded in place by the parser
+    while (m_parser.hasFrame())
+    {
+        QByteArray CMD = m_parser.command();
+
+        int OPT = 0;
+
+        if (CMD == "INFO")
+            OPT = 1;
+        else if (CMD == "DATR")
+            OPT = 2;
+        else if (CMD == "COMD")
+            OPT = 3;
+        else if (CMD == "QUIT")
+            OPT = 4;
+        else if (CMD == "COMS")
+            OPT = 5;
+        else if (CMD == "QUIS")
+            OPT = 6;
             else if (CMD == "INFG")
                 OPT = 7;
 
-            switch (OPT){
-            case 1:
-                // from buffer get data package
-                {
-                QByteArray PARA = buffer.left(tmp);
-                qDebug()<<"[INFO]"<<PARA;
-                //Parse parameters from PARA string
-                myBabyMEGInfo->MGH_LM_Parse_Para(PARA);
-                buffer.remove(0,tmp);
-                qDebug()<<"INFO has been received!!!!";
-//                qDebug()<<"ACQ Start";
-//                SendCommand("DATA");
-                }
-                break;
-            case 2:
-                // read data package from buffer
-                // Ask for the next data block
-
+        switch (OPT){
+        case 1:
+            // from buffer get data package
+            {
+            QByteArray PARA = m_parser.takeBody();
+            qDebug()<<"[INFO]"<<PARA;
+            //Parse parameters from PARA string
+            myBabyMEGInfo->MGH_LM_Parse_Para(PARA);
+            qDebug()<<"INFO has been received!!!!";
+            }
+            break;
+        case 2:
+            // Ask for the next data block once per received chunk of data blocks
+            if (!DataRequested)
+            {
                 SendCommand("DATA");
-                DispatchDataPackage(tmp);
+                DataRequested = true;
 
-                break;
-            case 3:
-                {
-                QByteArray RESP = buffer.left(tmp);
-                qDebug()<< "5.Readbytes:"<<RESP.size();
-                qDebug() << RESP;
-                }
-                buffer.remove(0,tmp);
+                // a reconnect discards the buffer
+                if (!m_parser.hasFrame())
+                    return;
+            }
+            DispatchDataPackage();
 
-                break;
-            case 4:  //quit
-                qDebug()<<"Quit";
-
-                SendCommand("QREL");
-                tcpSocket->disconnectFromHost();
-                if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
-                            tcpSocket->waitForDisconnected();
-                m_bSocketIsConnected = false;
-                qDebug()<< "Disconnect Server";
-                qDebug()<< "Client is End!";
-                qDebug()<< "You can close this application or restart to connect Server.";
+            break;
+        case 3:
+            {
+            QByteArray RESP = m_parser.takeBody();
+            qDebug()<< "5.Readbytes:"<<RESP.size();
+            qDebug() << RESP;
+            }
 
-                break;
-            case 5://command short connection
-                {
-                QByteArray RESP = buffer.left(tmp);
-                qDebug()<< "5.Readbytes:"<<RESP.size();
-                qDebug() << RESP;
-                myBabyMEGInfo->MGH_LM_Send_CMDPackage(RESP);
-                }
-                buffer.remove(0,tmp);
-                SendCommand("QUIT");
-                break;
-            case 6:  //quit
-                qDebug()<<"Quit";
-
-                SendCommand("QREL");
-                tcpSocket->disconnectFromHost();
-                if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
-                            tcpSocket->waitForDisconnected();
-                m_bSocketIsConnected = false;
-                qDebug()<< "Disconnect Server";
-                break;
+            break;
+        case 4:  //quit
+            qDebug()<<"Quit";
+            m_parser.skipFrame();
+
+            SendCommand("QREL");
+            tcpSocket->disconnectFromHost();
+            if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
+                        tcpSocket->waitForDisconnected();
+            m_bSocketIsConnected = false;
+            qDebug()<< "Disconnect Server";
+            qDebug()<< "Client is End!";
+            qDebug()<< "You can close this application or restart to connect Server.";
+
+            break;
+        case 5://command short connection
+            {
+            QByteArray RESP = m_parser.takeBody();
+            qDebug()<< "5.Readbytes:"<<RESP.size();
+            qDebug() << RESP;
+            myBabyMEGInfo->MGH_LM_Send_CMDPackage(RESP);
+            }
+            SendCommand("QUIT");
+            break;
+        case 6:  //quit
+            qDebug()<<"Quit";
+            m_parser.skipFrame();
+
+            SendCommand("QREL");
+            tcpSocket->disconnectFromHost();
+            if(tcpSocket->state() != QAbstractSocket::UnconnectedState)
+                        tcpSocket->waitForDisconnected();
+            m_bSocketIsConnected = false;
+            qDebug()<< "Disconnect Server";
+            break;
             case 7: //INFG
                 {
-                QByteArray PARA = buffer.left(tmp);
+                QByteArray PARA = m_parser.takeBody();
                 qDebug()<<"[INFG]"<<PARA;
                 //Parse parameters from PARA string
                 myBabyMEGInfo->MGH_LM_Parse_Para_Infg(PARA);
-                buffer.remove(0,tmp);
                 qDebug()<<"INFG has been received!!!!";
                 }
                 break;
 
-            default:
-                qDebug()<< "Unknow Type";
-                break;
-            }
-        }
-    }// buffer is not empty and larger than 8 bytes
 
+        default:
+            qDebug()<< "Unknow Type";
+            m_parser.skipFrame();
+            break;
+        }
+    }
 }
 
 
 //*************************************************************************************************************
 
-void BabyMEGClient::DispatchDataPackage(int tmp)
+void BabyMEGClient::DispatchDataPackage()
 {
+    // decode the samples straight into the reused block matrix
+    if (m_parser.takeData(m_matData, myBabyMEGInfo->chnNum))
+        myBabyMEGInfo->MGH_LM_Send_DataPackage(m_matData);
 
-//    qDebug()<<"Acq data from buffer  [buffer size() =" << buffer.size()<<"]";
-    QByteArray DATA = buffer.left(tmp);
-    qDebug()<< "5.Readbytes:"<<DATA.size();
-    myBabyMEGInfo->MGH_LM_Send_DataPackage(DATA);
-//    myBabyMEGInfo->EnQueue(DATA);
-    buffer.remove(0,tmp);
-//    qDebug()<<"Rest buffer  [buffer size() =" << buffer.size()<<"]";
     numBlock ++;
     qDebug()<< "Next Block ..." << numBlock;
-//    DATA.clear();
-
-    ReadNextBlock(tmp);
-}
-
-
-//*************************************************************************************************************
-
-void BabyMEGClient::ReadNextBlock(int tmp)
-{
-    QByteArray CMD1;
-    QByteArray DLEN1;
-    QByteArray DATA1;
-    int tmp1;
-    while (buffer.size()>=(tmp+8))
-    { // process the extra data block to reduce the load of data buffer
-        CMD1 = buffer.left(4);
-        qDebug()<<"CMD"<< CMD1;
-        if (CMD1 == "DATR")
-        {
-            DLEN1 = buffer.mid(4,4);
-            tmp1 = MGH_LM_Byte2Int(DLEN1);
-            qDebug() << "[2]First 4 bytes + length" << CMD1 << "["<<CMD1.toHex()<<"]";
-            qDebug() << "[2]Command[" << CMD1 <<"]";
-            qDebug() << "[2]Body Length[" << tmp1 << "]";
-
-            buffer.remove(0,8);
-            DATA1 = buffer.left(tmp1);
-            myBabyMEGInfo->MGH_LM_Send_DataPackage(DATA1);
-//            myBabyMEGInfo->EnQueue(DATA1);
-            buffer.remove(0,tmp1);
-            qDebug()<<"End of DataPackeage" << buffer.left(3);
-            qDebug()<<"[2]Rest buffer  [buffer size() =" << buffer.size()<<"]";
-            numBlock ++;
-            qDebug()<< "[2]Next Block ..." << numBlock;
-        }
-        else
-        {
-            qDebug()<<"[CMD1]"<<CMD1.toHex();
-            break;
-        }
-        qDebug()<<"[ReadNextBlock:buffer size]"<<buffer.size();
-    }
-    DATA1.clear();
-    CMD1.clear();
-    DLEN1.clear();
 }
 
 
@@ -540,7 +472,7 @@ void BabyMEGClient::SendCommand(QString s)
             qDebug()<<"Not in Connected state";
             //re-connect to server
             ConnectToBabyMEG();
-            buffer.clear();
+            m_parser.clear();
             SendCommand("DATA");
         }
 //    sleep(1);
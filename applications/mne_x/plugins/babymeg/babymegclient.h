@@ -56,6 +56,8 @@
 
 #include "babymeginfo.h"
 
+#include <utils/babymegparser.h>
+
 
 class QTcpSocket;
 class QNetworkSession;
@@ -125,19 +127,9 @@ public:
 
     //=========================================================================================================
     /**
-    * Dispatch the data package
-    *
-    * @param[in] tmp -- block size
-    */
-    void DispatchDataPackage(int tmp);
-
-    //=========================================================================================================
-    /**
-    * Read next data block
-    *
-    * @param[in] tmp -- block size
+    * Decode the next data frame and dispatch it as data block
     */
-    void ReadNextBlock(int tmp);
+    void DispatchDataPackage();
 
     //=========================================================================================================
     /**
@@ -211,7 +203,8 @@ public:
     bool DataAcqStartFlag;
     QSharedPointer<BabyMEGInfo> myBabyMEGInfo;
 
-    QByteArray buffer;
+    UTILSLIB::BabyMEGParser m_parser;   /**< Frame parser holding the received bytes. */
+    Eigen::MatrixXf m_matData;          /**< Decoded data block, reused for each block. */
     int numBlock;
     bool DataACK;
 
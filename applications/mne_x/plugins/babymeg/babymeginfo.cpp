@@ -41,7 +41,9 @@
 //*************************************************************************************************************
 
 BabyMEGInfo::BabyMEGInfo()
-: g_maxlen(500)
+: chnNum(0)
+, dataLength(0)
+, g_maxlen(500)
 {
 }
 //*************************************************************************************************************
@@ -53,9 +55,9 @@ void BabyMEGInfo::MGH_LM_Send_CMDPackage(QByteArray DATA)
 }
 //*************************************************************************************************************
 
-void BabyMEGInfo::MGH_LM_Send_DataPackage(QByteArray DATA)
+void BabyMEGInfo::MGH_LM_Send_DataPackage(const Eigen::MatrixXf& DATA)
 {
-//    qDebug()<<"[BabyMEGInfo]Data Size:"<<DATA.size();
+//    qDebug()<<"[BabyMEGInfo]Data Size:"<<DATA.rows()<<"x"<<DATA.cols();
     emit SendDataPackage(DATA);
 }
 
@@ -113,7 +113,7 @@ public:
 
 signals:
     void fiffInfoAvailable(FIFFLIB::FiffInfo);
-    void SendDataPackage(QByteArray DATA);
+    void SendDataPackage(const Eigen::MatrixXf& DATA);
     void SendCMDPackage(QByteArray DATA);
     void GainInfoUpdate(QStringList);
 
@@ -152,9 +152,9 @@ public:
     /**
     * Send data package
     *
-    * @param[in] DATA - QByteArray contains MEG data.
+    * @param[in] DATA - MatrixXf contains the decoded MEG data block (channels x samples).
     */
-    void MGH_LM_Send_DataPackage(QByteArray DATA);
+    void MGH_LM_Send_DataPackage(const Eigen::MatrixXf& DATA);
     //=========================================================================================================
     /**
     * Send command reply package
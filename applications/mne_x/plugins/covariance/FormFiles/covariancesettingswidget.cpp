@@ -5,6 +5,7 @@
 #include <QGridLayout>
 #include <QSpinBox>
 #include <QLabel>
+#include <QCheckBox>
 
 
 //*************************************************************************************************************
@@ -40,6 +41,33 @@ CovarianceSettingsWidget::CovarianceSettingsWidget(Covariance *toolbox, QWidget
     m_pSpinBoxNumSamples->setValue(toolbox->m_iEstimationSamples);
     connect(m_pSpinBoxNumSamples, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_pCovarianceToolbox, &Covariance::changeSamples);
     t_pGridLayout->addWidget(m_pSpinBoxNumSamples,0,1,1,1);
+
+    //Estimation mode, takes effect on the next start
+    m_pCheckBoxSliding = new QCheckBox("Sliding estimation");
+    m_pCheckBoxSliding->setToolTip("Keep a running estimate over the number of samples and emit it at the emit interval (applied on the next start)");
+    m_pCheckBoxSliding->setChecked(toolbox->m_bSlidingEstimation);
+    connect(m_pCheckBoxSliding, &QCheckBox::toggled, m_pCovarianceToolbox, &Covariance::changeSlidingEstimation);
+    t_pGridLayout->addWidget(m_pCheckBoxSliding,1,0,1,2);
+
+    QLabel* t_pLabelEmitSamples = new QLabel;
+    t_pLabelEmitSamples->setText("Emit every (samples)");
+    t_pGridLayout->addWidget(t_pLabelEmitSamples,2,0,1,1);
+
+    m_pSpinBoxEmitSamples = new QSpinBox;
+    m_pSpinBoxEmitSamples->setMinimum(100);
+    m_pSpinBoxEmitSamples->setMaximum(minSamples*60);
+    m_pSpinBoxEmitSamples->setSingleStep(100);
+    m_pSpinBoxEmitSamples->setValue(toolbox->m_iEmitSamples);
+    m_pSpinBoxEmitSamples->setEnabled(toolbox->m_bSlidingEstimation);
+    connect(m_pSpinBoxEmitSamples, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), m_pCovarianceToolbox, &Covariance::changeEmitSamples);
+    connect(m_pCheckBoxSliding, &QCheckBox::toggled, m_pSpinBoxEmitSamples, &QSpinBox::setEnabled);
+    t_pGridLayout->addWidget(m_pSpinBoxEmitSamples,2,1,1,1);
+
+    m_pCheckBoxSinglePrecision = new QCheckBox("Single precision");
+    m_pCheckBoxSinglePrecision->setToolTip("Accumulate the covariance in single precision (applied on the next start)");
+    m_pCheckBoxSinglePrecision->setChecked(toolbox->m_bSinglePrecision);
+    connect(m_pCheckBoxSinglePrecision, &QCheckBox::toggled, m_pCovarianceToolbox, &Covariance::changeSinglePrecision);
+    t_pGridLayout->addWidget(m_pCheckBoxSinglePrecision,3,0,1,2);
 //    }
     this->setLayout(t_pGridLayout);
 }
@@ -55,6 +55,9 @@ public slots:
 private:
     Covariance* m_pCovarianceToolbox;
     QSpinBox* m_pSpinBoxNumSamples;
+    QCheckBox* m_pCheckBoxSliding;
+    QSpinBox* m_pSpinBoxEmitSamples;
+    QCheckBox* m_pCheckBoxSinglePrecision;
 };
 
 } // NAMESPACE
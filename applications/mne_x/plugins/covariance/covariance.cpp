@@ -74,6 +74,9 @@ Covariance::Covariance()
 , m_pCovarianceOutput(NULL)
 , m_pCovarianceBuffer(CircularMatrixBuffer<double>::SPtr())
 , m_iEstimationSamples(5000)
+, m_bSlidingEstimation(false)
+, m_iEmitSamples(1000)
+, m_bSinglePrecision(false)
 {
     m_pActionShowAdjustment = new QAction(QIcon(":/images/covadjustments.png"), tr("Covariance Adjustments"),this);
 //    m_pActionSetupProject->setShortcut(tr("F12"));
@@ -114,6 +117,9 @@ void Covariance::init()
     //
     QSettings settings;
     m_iEstimationSamples = settings.value(QString("Plugin/%1/estimationSamples").arg(this->getName()), 5000).toInt();
+    m_bSlidingEstimation = settings.value(QString("Plugin/%1/slidingEstimation").arg(this->getName()), false).toBool();
+    m_iEmitSamples = settings.value(QString("Plugin/%1/emitSamples").arg(this->getName()), 1000).toInt();
+    m_bSinglePrecision = settings.value(QString("Plugin/%1/singlePrecision").arg(this->getName()), false).toBool();
 
     // Input
     m_pCovarianceInput = PluginInputData<NewRealTimeMultiSampleArray>::create(this, "CovarianceIn", "Covariance input data");
@@ -139,6 +145,9 @@ void Covariance::unload()
     //
     QSettings settings;
     settings.setValue(QString("Plugin/%1/estimationSamples").arg(this->getName()), m_iEstimationSamples);
+    settings.setValue(QString("Plugin/%1/slidingEstimation").arg(this->getName()), m_bSlidingEstimation);
+    settings.setValue(QString("Plugin/%1/emitSamples").arg(this->getName()), m_iEmitSamples);
+    settings.setValue(QString("Plugin/%1/singlePrecision").arg(this->getName()), m_bSinglePrecision);
 }
 
 
@@ -263,6 +272,30 @@ void Covariance::changeSamples(qint32 samples)
 }
 
 
+//*************************************************************************************************************
+
+void Covariance::changeSlidingEstimation(bool sliding)
+{
+    m_bSlidingEstimation = sliding;
+}
+
+
+//*************************************************************************************************************
+
+void Covariance::changeEmitSamples(qint32 samples)
+{
+    m_iEmitSamples = samples;
+}
+
+
+//*************************************************************************************************************
+
+void Covariance::changeSinglePrecision(bool singlePrecision)
+{
+    m_bSinglePrecision = singlePrecision;
+}
+
+
 //*************************************************************************************************************
 
 void Covariance::run()
@@ -282,6 +315,8 @@ void Covariance::run()
     // Init Real-Time Covariance estimator
     //
     m_pRtCov = RtCov::SPtr(new RtCov(m_iEstimationSamples, m_pFiffInfo));
+    m_pRtCov->setEstimationMode(m_bSlidingEstimation ? RtCov::Sliding : RtCov::Batch, m_iEmitSamples);
+    m_pRtCov->setSinglePrecision(m_bSinglePrecision);
     connect(m_pRtCov.data(), &RtCov::covCalculated, this, &Covariance::appendCovariance);
 
     //
@@ -160,6 +160,12 @@ public:
 
     void changeSamples(qint32 samples);
 
+    void changeSlidingEstimation(bool sliding);
+
+    void changeEmitSamples(qint32 samples);
+
+    void changeSinglePrecision(bool singlePrecision);
+
 signals:
     //=========================================================================================================
     /**
@@ -188,6 +194,9 @@ private:
     bool m_bProcessData;                        /**< If data should be received for processing */
 
     qint32 m_iEstimationSamples;
+    bool m_bSlidingEstimation;                  /**< If the covariance is estimated over a sliding window, takes effect on the next start */
+    qint32 m_iEmitSamples;                      /**< Samples between two covariances of the sliding estimation */
+    bool m_bSinglePrecision;                    /**< If the covariance is accumulated in single precision, takes effect on the next start */
 
     QSharedPointer<CovarianceSettingsWidget> m_pCovarianceWidget;
 
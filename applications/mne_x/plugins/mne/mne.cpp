@@ -51,6 +51,7 @@
 #include <QtCore/QtPlugin>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QFileInfo>
 
 
 //*************************************************************************************************************
@@ -253,7 +254,10 @@ void MNE::doClustering()
 
     m_qMutex.lock();
     m_bFinishedClustering = false;
-    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution(*m_pAnnotationSet.data(), 40)));
+    //Cache the clustering next to the forward solution, the next start only reads it
+    MatrixXd D;
+    QString t_sCacheDir = QFileInfo(m_qFileFwdSolution).absolutePath() + "/cluster-cache";
+    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution(*m_pAnnotationSet.data(), 40, D, FiffCov(), FiffInfo(), "cityblock", t_sCacheDir)));
     //m_pClusteredFwd = m_pFwd;
     m_pRTSEOutput->data()->setFwdSolution(m_pClusteredFwd);
 
@@ -497,6 +501,9 @@ void MNE::run()
 
     qint32 skip_count = 0;
 
+    MNESourceEstimate sourceEstimate;
+    MatrixXd rawSegment;
+
     while(m_bIsRunning)
     {
         m_qMutex.lock();
@@ -516,7 +523,7 @@ void MNE::run()
 
         if(m_pMatrixDataBuffer)
         {
-            MatrixXd rawSegment = m_pMatrixDataBuffer->pop();
+            m_pMatrixDataBuffer->pop(rawSegment);
             qDebug()<<"MNE::run - Processing RTMSA data";
             if(m_pMinimumNorm && ((skip_count % m_iDownSample) == 0))
             {
@@ -524,10 +531,11 @@ void MNE::run()
                 float tstep = 1 / m_pFiffInfo->sfreq;
 
                 m_qMutex.lock();
-                MNESourceEstimate sourceEstimate = m_pMinimumNorm->calculateInverse(rawSegment, tmin, tstep);
+                bool t_bSuccess = m_pMinimumNorm->calculateInverse(rawSegment, tmin, tstep, sourceEstimate);
                 m_qMutex.unlock();
 
-                m_pRTSEOutput->data()->setValue(sourceEstimate);
+                if(t_bSuccess)
+                    m_pRTSEOutput->data()->setValue(sourceEstimate);
             }
             else
             {
@@ -552,10 +560,11 @@ void MNE::run()
                 float tstep = 1/t_fiffEvoked.info.sfreq;
 
                 m_qMutex.lock();
-                MNESourceEstimate sourceEstimate = m_pMinimumNorm->calculateInverse(t_fiffEvoked.data, tmin, tstep);
+                bool t_bSuccess = m_pMinimumNorm->calculateInverse(t_fiffEvoked.data, tmin, tstep, sourceEstimate);
                 m_qMutex.unlock();
 
-                m_pRTSEOutput->data()->setValue(sourceEstimate);
+                if(t_bSuccess)
+                    m_pRTSEOutput->data()->setValue(sourceEstimate);
             }
             else
             {
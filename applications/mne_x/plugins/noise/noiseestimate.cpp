@@ -281,12 +281,12 @@ void NoiseEstimate::update(XMEASLIB::NewMeasurement::SPtr pMeasurement)
 //*************************************************************************************************************
 
 void NoiseEstimate::appendNoiseSpectrum(MatrixXd t_send)
-{ 
-    qDebug()<<"Spectrum"<<t_send(0,1)<<t_send(0,2)<<t_send(0,3);
+{
+    //The spectrum is refreshed with every block -> only the latest one is displayed
     m_qMutex.lock();
+    m_qVecSpecData.clear();
     m_qVecSpecData.push_back(t_send);
     m_qMutex.unlock();
-    qDebug()<<"---------------------------------appendNoiseSpectrum--------------------------------";
 }
 
 
@@ -343,16 +343,14 @@ void NoiseEstimate::run()
             //ToDo: Implement your algorithm here
             m_pRtNoise->append(t_mat);
 
+           m_qMutex.lock();
            if(m_qVecSpecData.size() > 0)
            {
-               m_qMutex.lock();
-               qDebug()<<"%%%%%%%%%%%%%%%% send spectrum for display %%%%%%%%%%%%%%%%%%%";
                 //send spectrum to the output data
                m_pFSOutput->data()->setValue(m_qVecSpecData[0]);
                m_qVecSpecData.pop_front();
-               m_qMutex.unlock();
-
-            }
+           }
+           m_qMutex.unlock();
         }//m_bProcessData
     }//m_bIsRunning
     qDebug()<<"noise estimation [Run] is done!";
@@ -51,6 +51,7 @@
 #include <QtCore/QtPlugin>
 #include <QtConcurrent>
 #include <QDebug>
+#include <QFileInfo>
 
 
 //*************************************************************************************************************
@@ -172,7 +173,10 @@ void RapMusicToolbox::doClustering()
 
     m_qMutex.lock();
     m_bFinishedClustering = false;
-    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution(*m_pAnnotationSet.data(), 40)));
+    //Cache the clustering next to the forward solution, the next start only reads it
+    MatrixXd D;
+    QString t_sCacheDir = QFileInfo(m_qFileFwdSolution).absolutePath() + "/cluster-cache";
+    m_pClusteredFwd = MNEForwardSolution::SPtr(new MNEForwardSolution(m_pFwd->cluster_forward_solution(*m_pAnnotationSet.data(), 40, D, FiffCov(), FiffInfo(), "cityblock", t_sCacheDir)));
     m_qMutex.unlock();
 
     finishedClustering();
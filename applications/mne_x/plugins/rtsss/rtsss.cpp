@@ -52,6 +52,7 @@
 #include <QFuture>
 #include <QtConcurrent/QtConcurrentMap>
 #include <QSettings>
+#include <QStandardPaths>
 
 RtSssAlgo rsss;
 
@@ -75,6 +76,7 @@ RtSss::RtSss()
 : m_bIsRunning(false)
 , m_bReceiveData(false)
 , m_bProcessData(false)
+, m_bHeadOriginChanged(false)
 {
 }
 
@@ -222,6 +224,29 @@ QWidget* RtSss::setupWidget()
 }
 
 
+//*************************************************************************************************************
+
+void RtSss::setHeadOrigin(const Eigen::Vector3d& origin)
+{
+    QMutexLocker locker(&m_qMutex);
+    m_vecHeadOrigin = origin;
+    m_bHeadOriginChanged = true;
+}
+
+
+//*************************************************************************************************************
+
+void RtSss::updateHeadOrigin()
+{
+    //The head frame origin in device coordinates, dev_head_t maps device to head coordinates
+    Matrix4d devHeadT = m_pHpiFiffInfo->dev_head_t.trans.cast<double>();
+    Vector4d headOrigin(0.0, 0.0, RTSSS_HEAD_ORIGIN_Z, 1.0);
+    Vector4d devOrigin = devHeadT.inverse() * headOrigin;
+
+    setHeadOrigin(devOrigin.head<3>());
+}
+
+
 //*************************************************************************************************************
 
 void RtSss::setLinRR(int val)
@@ -392,10 +417,25 @@ void RtSss::run()
 //        }
     //qDebug() << "strat id: " << startID_MEGch;
 
-    //  Build linear equation
+    //  Build linear equation, the basis is cached on disk per coil set, expansion order and origin - in the user's cache, the plugin directory is often read-only
     qDebug() << "building an initial SSS linear equation .....";
+    rsss.setBasisCacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/rtsss/basis_cache");
     lineqn = rsss.buildLinearEqn();
 
+    // Follow the head with a continuous HPI fit, on a copy of the info so that the shared dev_head_t stays untouched
+    qint32 nHpiPoints = 0;
+    for(int i = 0; i < m_pFiffInfo->dig.size(); ++i)
+        if(m_pFiffInfo->dig[i].kind == FIFFV_POINT_HPI)
+            ++nHpiPoints;
+
+    if(nHpiPoints >= 4)
+    {
+        m_pHpiFiffInfo = FiffInfo::SPtr(new FiffInfo(*m_pFiffInfo.data()));
+        m_pRtHPIS = RtHPIS::SPtr(new RtHPIS(m_pHpiFiffInfo));
+        connect(m_pRtHPIS.data(), &RtHPIS::HPICalculated, this, &RtSss::updateHeadOrigin, Qt::DirectConnection);
+        m_pRtHPIS->start();
+    }
+
     //qDebug() << "..finished !!";
 
     // start processing data
@@ -408,6 +448,16 @@ void RtSss::run()
 
     while(m_bIsRunning)
     {
+        // Head movement: only the internal basis is rebuilt, and only if the head moved far enough
+        m_qMutex.lock();
+        bool bHeadOriginChanged = m_bHeadOriginChanged;
+        Vector3d vecHeadOrigin = m_vecHeadOrigin;
+        m_bHeadOriginChanged = false;
+        m_qMutex.unlock();
+
+        if(bHeadOriginChanged && rsss.updateOrigin(vecHeadOrigin, RTSSS_REORIGIN_THRESHOLD))
+            qDebug() << "rebuilt SSS internal basis for the new head origin";
+
 //        if (m_bIsHeadMov)
 //        {
 //            lineqn = rsss.buildLinearEqn();
@@ -425,6 +475,9 @@ void RtSss::run()
         {
             // * Dispatch the inputs * //
             MatrixXd in_mat = m_pRtSssBuffer->pop();
+
+            if(m_pRtHPIS)
+                m_pRtHPIS->append(in_mat);
 //            qDebug() << "size of in_mat (run): " << in_mat.rows() << " x " << in_mat.cols();
 
             //Generate new matrix from picked channels
@@ -482,6 +535,13 @@ void RtSss::run()
         }
     }
 
+    if(m_pRtHPIS)
+    {
+        m_pRtHPIS->stop();
+        m_pRtHPIS->wait();
+        m_pRtHPIS.clear();
+    }
+
     m_bProcessData = false;
     m_bReceiveData = false;
     //qDebug() << "rtSSS stopped.";
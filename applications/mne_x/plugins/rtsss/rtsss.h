@@ -55,6 +55,8 @@
 #include <fiff/fiff_info.h>
 #include <fiff/fiff_evoked.h>
 
+#include <rtProcessing/rthpis.h>
+
 #include <Eigen/Dense>
 
 //*************************************************************************************************************
@@ -83,6 +85,7 @@ using namespace MNEX;
 using namespace FIFFLIB;
 using namespace XMEASLIB;
 using namespace IOBuffer;
+using namespace RTINVLIB;
 
 
 //*************************************************************************************************************
@@ -153,10 +156,26 @@ public:
     void setLin(int);
     void setLout(int);
 
+    //=========================================================================================================
+    /**
+    * Sets a new head origin. The internal SSS basis is rebuilt by the processing thread as soon as the origin
+    * moved by more than the re-origin threshold. Called by updateHeadOrigin() for each continuous HPI fit.
+    *
+    * @param[in] origin     Head origin in device coordinates [m].
+    */
+    void setHeadOrigin(const Eigen::Vector3d& origin);
+
 protected:
     virtual void run();
 
 private:
+    //=========================================================================================================
+    /**
+    * Moves the head origin to the latest continuous HPI fit. Called in the RtHPIS thread right after the fit
+    * was written to m_pHpiFiffInfo.
+    */
+    void updateHeadOrigin();
+
 //    PluginInputData<NewRealTimeSampleArray>::SPtr   m_pDummyInput;      /**< The RealTimeSampleArray of the DummyToolbox input.*/
 //    PluginOutputData<NewRealTimeSampleArray>::SPtr  m_pDummyOutput;    /**< The RealTimeSampleArray of the DummyToolbox output.*/
     PluginInputData<NewRealTimeSampleArray>::SPtr   m_pRTSAInput;      /**< The RealTimeSampleArray of the RtSss input.*/
@@ -176,6 +195,12 @@ private:
 
     int LinRR, LoutRR, Lin, Lout;
 
+    Eigen::Vector3d m_vecHeadOrigin;    /**< Latest head origin, guarded by m_qMutex. */
+    bool m_bHeadOriginChanged;          /**< If m_vecHeadOrigin was set since the last basis update. */
+
+    RtHPIS::SPtr m_pRtHPIS;             /**< Continuous HPI fit, only if the HPI coils were digitized. */
+    FiffInfo::SPtr m_pHpiFiffInfo;      /**< Copy of the fiff info the HPI fit writes its dev_head_t to. */
+
     QMutex m_qMutex;
 
     //    dBuffer::SPtr   m_pRtSssBuffer;      /**< Holds incoming data.*/
@@ -38,6 +38,12 @@
 
 #include "rtsssalgo.h"
 #include <QFuture>
+#include <QThread>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
 #include <QtConcurrent/QtConcurrentMap>
 //#include "FormFiles/rtssssetupwidget.h"
 
@@ -56,8 +62,7 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 {
     //qDebug() << "buildLinearEqn START";
 
-    QList<MatrixXd> Eqn, EqnRR;
-    QList<MatrixXd> LinEqn;
+    QList<MatrixXd> Eqn;
     qint32 LIn, LOut;
 //    MatrixXd EqnInRR, EqnOutRR, EqnIn, EqnOut;
 
@@ -81,17 +86,16 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 
 
 //  Compute SSS equation
-    LIn = LInRR;
-    LOut = LOutRR;
-    EqnRR = getSSSEqn(LIn, LOut);
-    EqnInRR = EqnRR[0];
-    EqnOutRR = EqnRR[1];
-
-    LIn = LInOLS;
-    LOut = LOutOLS;
-    Eqn = getSSSEqn(LIn, LOut);
-    EqnIn = Eqn[0];
-    EqnOut = Eqn[1];
+//  the basis functions are ordered by degree, so the subspace (RR) and the full (OLS)
+//  equations are the leading columns of a single basis of the larger expansion order
+    LIn = qMax(LInRR, LInOLS);
+    LOut = qMax(LOutRR, LOutOLS);
+    Eqn = getSSSEqnCached(LIn, LOut);
+
+    EqnInRR = Eqn[0].leftCols(LInRR*LInRR + 2*LInRR);
+    EqnOutRR = Eqn[1].leftCols(LOutRR*LOutRR + 2*LOutRR);
+    EqnIn = Eqn[0].leftCols(LInOLS*LInOLS + 2*LInOLS);
+    EqnOut = Eqn[1].leftCols(LOutOLS*LOutOLS + 2*LOutOLS);
 
 //
 //    Vector2i  LexpRR, LexpOLS;
@@ -109,6 +113,19 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 //    res.waitForFinished();
 
 
+    //qDebug() << "buildLinearEqn END";
+
+//    return LinEqn;
+    return assembleLinearEqn();
+}
+
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% assemble the scaled SSS equations from the current internal/external
+//% basis and factorize their normal equations
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+MatrixXd RtSssAlgo::assembleLinearEqn()
+{
 //  build linear equation
 //    MatrixXd EqnARR(NumCoil, EqnInRR.cols()+EqnOutRR.cols());
 //    MatrixXd EqnA(NumCoil, EqnIn.cols()+EqnOut.cols());
@@ -143,14 +160,14 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 //        std::cout << "EqnB: " << EqnB.rows() << " x " << EqnB.cols() << std::endl;
 //    std::cout << "pass 2" << std::endl;
 
-//    LinEqn.append(EqnInRR);
-//    LinEqn.append(EqnOutRR);
-    LinEqn.append(EqnIn);
-    LinEqn.append(EqnOut);
-    LinEqn.append(EqnARR);
-    LinEqn.append(EqnA);
-//    LinEqn.append(EqnB);
-    LinEqn.append(CoilScale.asDiagonal());
+////    LinEqn.append(EqnInRR);
+////    LinEqn.append(EqnOutRR);
+//    LinEqn.append(EqnIn);
+//    LinEqn.append(EqnOut);
+//    LinEqn.append(EqnARR);
+//    LinEqn.append(EqnA);
+////    LinEqn.append(EqnB);
+//    LinEqn.append(CoilScale.asDiagonal());
 
 
 //    std::cout << "EqnInRR *********************************" << endl << EqnInRR << endl << endl;
@@ -163,12 +180,159 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 
 //    std::cout << "building SSS linear equation .....finished !" << endl;
 
-    //qDebug() << "buildLinearEqn END";
+//  % factorize the normal equations once -- they only change with the basis
+    EqnARRLLT.compute(EqnARR.transpose() * EqnARR);
+    EqnALLT.compute(EqnA.transpose() * EqnA);
 
-//    return LinEqn;
     return CoilScale.asDiagonal();
 }
 
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% move the expansion origin (e.g. to the HPI head origin) and update the
+//% internal basis only -- the external basis does not depend on the head
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% origin:           new origin in device coordinates [X; Y; Z]
+//% threshold:        minimal displacement [m] which triggers an update
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% returns true if the linear equations were rebuilt
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+bool RtSssAlgo::updateOrigin(const Vector3d& origin, double threshold)
+{
+    QList<MatrixXd> Eqn;
+    qint32 LIn;
+
+    if(EqnA.size() == 0 || (origin - Origin).norm() <= threshold)
+        return false;
+
+    Origin = origin;
+
+//  internal basis only (LOut = 0); not persisted, a moving head would only fill the cache
+    LIn = qMax(LInRR, LInOLS);
+    Eqn = getSSSEqn(LIn, 0);
+
+    EqnInRR = Eqn[0].leftCols(LInRR*LInRR + 2*LInRR);
+    EqnIn = Eqn[0].leftCols(LInOLS*LInOLS + 2*LInOLS);
+
+    assembleLinearEqn();
+
+    return true;
+}
+
+Vector3d RtSssAlgo::getOrigin()
+{
+    return Origin;
+}
+
+void RtSssAlgo::setBasisCacheDir(const QString& dir)
+{
+    BasisCacheDir = dir;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% cache file of the SSS basis, keyed by coil geometry, expansion orders
+//% and origin
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+QString RtSssAlgo::getBasisCacheFile(qint32 LIn, qint32 LOut)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    qint32 version = RTSSS_BASIS_CACHE_VER;
+
+    hash.addData((const char*)&version, sizeof(qint32));
+    hash.addData((const char*)&LIn, sizeof(qint32));
+    hash.addData((const char*)&LOut, sizeof(qint32));
+    hash.addData((const char*)Origin.data(), 3*sizeof(double));
+    hash.addData((const char*)&NumCoil, sizeof(qint32));
+
+    for(int i = 0; i < NumCoil; i++)
+    {
+        MatrixXd coil_rk = CoilRk[i];
+        MatrixXd coil_wk = CoilWk[i];
+        MatrixXd coil_t = CoilT[i];
+        qint32 coil_nk = CoilNk(i);
+
+        hash.addData((const char*)&coil_nk, sizeof(qint32));
+        hash.addData((const char*)coil_t.data(), coil_t.size()*sizeof(double));
+        hash.addData((const char*)coil_rk.data(), coil_rk.size()*sizeof(double));
+        hash.addData((const char*)coil_wk.data(), coil_wk.size()*sizeof(double));
+    }
+
+    return QDir(BasisCacheDir).filePath(QString("sss_basis_%1.bin").arg(QString(hash.result().toHex())));
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% getSSSEqn backed by the basis cache on disk
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+QList<MatrixXd> RtSssAlgo::getSSSEqnCached(qint32 LIn, qint32 LOut)
+{
+    QList<MatrixXd> Eqn;
+    QString fileName;
+
+    if(BasisCacheDir.isEmpty())
+        return getSSSEqn(LIn, LOut);
+
+    fileName = getBasisCacheFile(LIn, LOut);
+
+    QFile file(fileName);
+    if(file.open(QIODevice::ReadOnly))
+    {
+        QDataStream in(&file);
+        in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+        quint32 magic;
+        qint32 version;
+        in >> magic >> version;
+
+        if(magic == RTSSS_BASIS_CACHE_MAGIC && version == RTSSS_BASIS_CACHE_VER)
+        {
+            for(int k = 0; k < 2 && in.status() == QDataStream::Ok; k++)
+            {
+                qint32 rows, cols;
+                in >> rows >> cols;
+                if(rows != NumCoil || cols < 0)
+                    break;
+
+                MatrixXd mat(rows, cols);
+                for(int i = 0; i < mat.size(); i++)
+                    in >> mat.data()[i];
+                Eqn.append(mat);
+            }
+        }
+        file.close();
+
+        if(Eqn.size() == 2 && in.status() == QDataStream::Ok
+                && Eqn[0].cols() == LIn*LIn + 2*LIn && Eqn[1].cols() == LOut*LOut + 2*LOut)
+            return Eqn;
+
+        qWarning() << "RtSssAlgo: ignoring invalid SSS basis cache" << fileName;
+        Eqn.clear();
+    }
+
+    Eqn = getSSSEqn(LIn, LOut);
+
+    //Write to a temporary file which replaces the cache file on commit, so a reader never sees a partial basis
+    QSaveFile saveFile(fileName);
+    if(!QDir().mkpath(BasisCacheDir) || !saveFile.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "RtSssAlgo: could not write SSS basis cache" << fileName;
+        return Eqn;
+    }
+
+    QDataStream out(&saveFile);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    out << (quint32)RTSSS_BASIS_CACHE_MAGIC << (qint32)RTSSS_BASIS_CACHE_VER;
+    for(int k = 0; k < 2; k++)
+    {
+        out << (qint32)Eqn[k].rows() << (qint32)Eqn[k].cols();
+        for(int i = 0; i < Eqn[k].size(); i++)
+            out << Eqn[k].data()[i];
+    }
+
+    if(out.status() != QDataStream::Ok || !saveFile.commit())
+        qWarning() << "RtSssAlgo: could not write SSS basis cache" << fileName;
+
+    return Eqn;
+}
+
 void RtSssAlgo::setSSSParameter(QList<int> expansionOrder)
 {
 //    LInRR = 5;
@@ -812,15 +976,60 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
 {
     //qDebug() << "getSSSRR START";
 
-    int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut, Weight; //, ErrRel;
-    VectorXd ErrRel;
+    int NumCoil, NumExp;
+    MatrixXd SSSIn;
+
+//  % initialization
+    NumCoil = EqnB.rows();
+    NumExp = EqnB.cols();
+
+    SSSIn.setZero(NumCoil,NumExp);
+
+//  % samples are independent -- split them into column chunks solved in parallel
+    int NumChunk = qMin(QThread::idealThreadCount(), NumExp / RTSSS_RR_MIN_CHUNK);
+
+    if(NumChunk <= 1)
+        solveSSSRR(EqnB, 0, NumExp, SSSIn);
+    else
+    {
+        QList<SSSRRChunk> chunks;
+        int StartCol = 0;
+        for(int i=0; i<NumChunk; i++)
+        {
+            SSSRRChunk chunk;
+            chunk.Algo = this;
+            chunk.EqnB = &EqnB;
+            chunk.SSSIn = &SSSIn;
+            chunk.StartCol = StartCol;
+            chunk.NumCols = NumExp / NumChunk + (i < NumExp % NumChunk ? 1 : 0);
+            StartCol += chunk.NumCols;
+            chunks.append(chunk);
+        }
+
+        QtConcurrent::blockingMap(chunks, solveSSSRRChunk);
+    }
+
+    //qDebug() << "getSSSRR END";
+
+    return SSSIn;
+}
+
+
+void RtSssAlgo::solveSSSRRChunk(SSSRRChunk& chunk)
+{
+    chunk.Algo->solveSSSRR(*chunk.EqnB, chunk.StartCol, chunk.NumCols, *chunk.SSSIn);
+}
+
+
+void RtSssAlgo::solveSSSRR(const MatrixXd& EqnB, qint32 StartCol, qint32 NumCols, MatrixXd& SSSIn) const
+{
+    int NumBIn, NumCoil;
     double RR_K1, RR_K2, RR_K3;
-    double eqn_scale0, eqn_scale;
-    MatrixXd sol_X, sol_X_old, eqn_Y, eqn_D, temp_M, temp_N, sol_in, sol_out;
-    MatrixXd diagMat;
-    VectorXd eqn_err, weight_index;
-    QList<MatrixXd> RRsss;
+    double eqn_scale, err_rel;
+    MatrixXd B, W, sol_X, sol_X_new, eqn_err, temp_M, temp_N, eqn_Y, eqn_S;
+    VectorXd eqn_scale0, eqn_D;
+    VectorXi weight_index, active;
+    int NumActive, NumIdx;
 
 //  % error tolerance for robust regression
     double ErrTolRel = 1e-3;
@@ -830,127 +1039,124 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
 
 //  % initialization
     NumBIn = EqnIn.cols();
-    NumBOut = EqnOut.cols();
     NumCoil = EqnB.rows();
-    NumExp = EqnB.cols();
-
-    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
-    EqnInv = (EqnA.transpose() * EqnA).inverse();
 
-    SSSIn.setZero(NumCoil,NumExp);
-    SSSOut.setZero(NumCoil,NumExp);
-    Weight.setZero(NumCoil,NumExp);
-    ErrRel.setZero(NumExp);
     RR_K3 = 3;
     RR_K2 = 4.685;
     RR_K1 = qSqrt(1-qSqrt(3)/2) * RR_K2;
 
-    for(int i=0; i<NumExp; i++)
+    B = EqnB.middleCols(StartCol, NumCols);
+    W.setOnes(NumCoil, NumCols);
+    weight_index.resize(NumCoil);
+
+//  % solve OLS solution of all samples at once
+    sol_X = EqnARRLLT.solve(EqnARR.transpose() * B);
+
+//  % scale linear equation
+    eqn_err = EqnARR * sol_X - B;
+    eqn_scale0.resize(NumCols);
+    active.setOnes(NumCols);
+    NumActive = NumCols;
+    for(int i=0; i<NumCols; i++)
     {
-//      % solve OLS solution
-        sol_X = EqnRRInv * (EqnARR.transpose() * EqnB.col(i));
-//        std::cout << "sol_X ************************" << endl << sol_X.transpose() << endl;
-
-//      % scale linear equation
-        eqn_err = EqnARR * sol_X - EqnB.col(i);
-        eqn_scale0 = stdev(eqn_err);
-        eqn_err = eqn_err.cwiseAbs() / eqn_scale0;
-
-//      % solve iteratively re-weighted least squares (Bi-Square) -- subspace
-        sol_X_old.setConstant(sol_X.rows(), sol_X.cols(), 1e30);
-//        while (((sol_X-sol_X_old).norm() / sol_X.norm()) > ErrTolRel)
-        int cnt=0;
-        while (((sol_X.array()-sol_X_old.array()).matrix().norm() / sol_X.norm()) > ErrTolRel)
-//        for (int h=0; h<2; h++)
+        eqn_scale0(i) = stdev(eqn_err.col(i));
+        if(eqn_scale0(i) > 0)
+            eqn_err.col(i) = eqn_err.col(i).cwiseAbs() / eqn_scale0(i);
+        else
         {
-            cnt++;
-//            cout << "while cnt: " << cnt << endl;
-            sol_X_old = sol_X;
-//            Weight(:,i) = (eqn_err <= RR_K1) + (eqn_err > RR_K1 & eqn_err <= RR_K2) .* (1-(eqn_err-RR_K1).^2/(RR_K2-RR_K1)^2).^2;
-//            Weight.col(i) = eigen_LTE(eqn_err, RR_K1) + eigen_AND(eigen_GT(eqn_err, RR_K1),eigen_LTE(eqn_err, RR_K2));
-            Weight.col(i) = eigen_LTE(eqn_err,RR_K1).array() + eigen_AND(eigen_GT(eqn_err,RR_K1),eigen_LTE(eqn_err,RR_K2)).array() * (1 - ((eqn_err.array()-RR_K1).pow(2)) / pow(RR_K2-RR_K1,2) ).pow(2);
-//            std::cout << "Weight **************************" << endl << Weight.transpose() << endl;
-
-//          % weight_index = find(Weight(:,i) < WeightThres);
-            weight_index = eigen_LT_index(Weight.col(i), WeightThres);
-//            weight_index = eigen_LT_index_test(Weight.col(i), h);
-//            std:cout << "weight_index ********************* " << endl << weight_index << endl;
-
-//          % eqn_Y = EqnARR(weight_index,:);   eqn_D = Weight(weight_index,i) - 1;
-            eqn_Y.resize(weight_index.size(), EqnARR.cols());
-            eqn_D.resize(weight_index.size(),1);
-            for(int k=0; k<weight_index.size(); k++)
-            {
-                eqn_Y.row(k) = EqnARR.row(weight_index(k));
-//                std::cout << "eqn_Y: " << eqn_Y.rows() << " x " << eqn_Y.cols() << endl;
-//                std::cout << "eqn_D: "  << eqn_D.rows() << " x " << eqn_D.cols() << endl;
-                eqn_D(k) = Weight(weight_index(k),i) - 1;
-            }
-//              std::cout << "eqn_D: " << endl << eqn_D.transpose() << endl << endl;
-            temp_M = EqnARR.transpose() * (Weight.col(i).array() * EqnB.col(i).array()).matrix();
-//              std::cout << "temp_M: " << endl << temp_M.transpose() << endl << endl;
+//          % exact fit -- keep the OLS solution with unit weights
+            active(i) = 0;
+            --NumActive;
+        }
+    }
 
-//            std::cout << "EqnRRInv: " << EqnRRInv.rows() << " x " << EqnRRInv.cols() << endl;
-//            std::cout << "eqn_Y: " << eqn_Y.rows() << " x " << eqn_Y.cols() << endl;
-//              std::cout << "EqnRRInv: " << endl << EqnRRInv.transpose() << endl << endl;
-//              std::cout << "eqn_Y: " << endl << eqn_Y.transpose() << endl << endl;
+//  % solve iteratively re-weighted least squares (Bi-Square) -- subspace
+    for(int iter=0; NumActive > 0 && iter < RTSSS_RR_MAX_ITER; iter++)
+    {
+        for(int i=0; i<NumCols; i++)
+        {
+            if(!active(i))
+                continue;
+//          % Weight(:,i) = (eqn_err <= RR_K1) + (eqn_err > RR_K1 & eqn_err <= RR_K2) .* (1-(eqn_err-RR_K1).^2/(RR_K2-RR_K1)^2).^2;
+            W.col(i) = (eqn_err.col(i).array() <= RR_K1).select(1.0,
+                       (eqn_err.col(i).array() <= RR_K2).select((1 - (eqn_err.col(i).array()-RR_K1).square() / pow(RR_K2-RR_K1,2)).square(), 0.0));
+        }
 
-            temp_N = EqnRRInv * eqn_Y.transpose();
-//              std::cout << "temp_N: " << endl << temp_N.transpose() << endl << endl;
+//      % right hand sides of all samples are formed and solved with a single product
+        temp_M = EqnARR.transpose() * W.cwiseProduct(B);
+        sol_X_new = EqnARRLLT.solve(temp_M);
 
+        for(int i=0; i<NumCols; i++)
+        {
+            if(!active(i))
+                continue;
 
-//            diagMat = eqn_D.asDiagonal();
-//        std::cout << "diagMat ************************" << endl << diagMat.transpose() << endl;
-//            diagMat = 1 / diagMat.array();
-//        std::cout << "diagMat ************************" << endl << diagMat.transpose() << endl;
+//          % low-rank (Woodbury) correction for the downweighted coils
+//          % sol_X = EqnRRInv * temp_M - temp_N * ((diag(1./eqn_D) + eqn_Y * temp_N) \ (temp_N'*temp_M));
+            NumIdx = 0;
+            for(int k=0; k<NumCoil; k++)
+                if(W(k,i) < WeightThres)
+                    weight_index(NumIdx++) = k;
 
-            diagMat = (1 / eqn_D.array()).matrix().asDiagonal();
-//            cout << "diagMat ************************" << i+1 << endl << diagMat.rows() << " x" << diagMat.cols() << endl;
+            if(NumIdx > 0)
+            {
+                eqn_Y.resize(NumIdx, EqnARR.cols());
+                eqn_D.resize(NumIdx);
+                for(int k=0; k<NumIdx; k++)
+                {
+                    eqn_Y.row(k) = EqnARR.row(weight_index(k));
+                    eqn_D(k) = W(weight_index(k),i) - 1;
+                }
+                temp_N = EqnARRLLT.solve(eqn_Y.transpose());
+                eqn_S = eqn_Y * temp_N;
+                eqn_S.diagonal() += eqn_D.cwiseInverse();
+                sol_X_new.col(i) -= temp_N * eqn_S.partialPivLu().solve(temp_N.transpose() * temp_M.col(i));
+            }
 
-            sol_X = EqnRRInv * temp_M - temp_N * (diagMat + eqn_Y * temp_N).inverse() * (temp_N.transpose() * temp_M);
-            eqn_err = (EqnARR * sol_X - EqnB.col(i)).cwiseAbs();
-            eqn_scale = qMin(eqn_scale0, RR_K3 * qSqrt((Weight.col(i).array() * eqn_err.array() * eqn_err.array()).mean()));
-            eqn_err = eqn_err / eqn_scale;
-//             std::cout << "temp_M: " << endl << temp_M.transpose() << endl << endl;
+            err_rel = (sol_X_new.col(i) - sol_X.col(i)).norm() / sol_X_new.col(i).norm();
+            sol_X.col(i) = sol_X_new.col(i);
 
-//            std::cout << "(sol_X.array()-sol_X_old.array()).matrix().norm(): " << (sol_X.array()-sol_X_old.array()).matrix().norm() << endl << endl;
-//            std::cout << "sol_X.norm():  " << sol_X.norm()  << endl  << endl;
-//        std::cout << "sol_X ************************" << endl << sol_X.transpose() << endl << endl;
+            eqn_err.col(i) = (EqnARR * sol_X.col(i) - B.col(i)).cwiseAbs();
+            eqn_scale = qMin(eqn_scale0(i), RR_K3 * qSqrt((W.col(i).array() * eqn_err.col(i).array().square()).mean()));
+            eqn_err.col(i) /= eqn_scale;
 
+            if(!(err_rel > ErrTolRel))
+            {
+                active(i) = 0;
+                --NumActive;
+            }
         }
-//      % solve weighted SSS - full
-//      % eqn_Y = EqnA(weight_index,:); temp_M = EqnA' * (Weight(:,i).*EqnB(:,i)); temp_N = EqnInv * eqn_Y';
-        eqn_Y.resize(weight_index.size(), NumBIn+NumBOut);
-        for(int k=0; k<weight_index.size(); k++) eqn_Y.row(k) = EqnA.row(weight_index(k));
-        temp_M = EqnA.transpose() * (Weight.col(i).array() * EqnB.col(i).array()).matrix();
-        temp_N = EqnInv * eqn_Y.transpose();
-
-
-//      % sol_X = EqnInv * temp_M - temp_N * ((diag(1./eqn_D) + eqn_Y * temp_N); // \ (temp_N'*temp_M));
-//        diagMat = eqn_D.asDiagonal();
-//        diagMat = 1 / diagMat.array();
-        diagMat = (1 / eqn_D.array()).matrix().asDiagonal();
-        sol_X = EqnInv * temp_M - temp_N * (diagMat + eqn_Y * temp_N).inverse() * (temp_N.transpose() * temp_M);
+    }
 
-        ErrRel(i) = (EqnA * sol_X - EqnB.col(i)).norm() / EqnB.col(i).norm();
+//  % solve weighted SSS - full, using the weights of the last iteration
+    temp_M = EqnA.transpose() * W.cwiseProduct(B);
+    sol_X = EqnALLT.solve(temp_M);
 
-        sol_in = sol_X.block(0,0,NumBIn,1);
-        sol_out = sol_X.block(NumBIn,0,NumBOut,1);  // sol_X(NumBIn+1:NumBIn+NumBOut,1);
+    for(int i=0; i<NumCols; i++)
+    {
+        NumIdx = 0;
+        for(int k=0; k<NumCoil; k++)
+            if(W(k,i) < WeightThres)
+                weight_index(NumIdx++) = k;
 
-//      % recover internal/external MEG siganl
-        SSSIn.col(i) = EqnIn * sol_in;
-        SSSOut.col(i) = EqnOut * sol_out;
+        if(NumIdx == 0)
+            continue;
 
+        eqn_Y.resize(NumIdx, EqnA.cols());
+        eqn_D.resize(NumIdx);
+        for(int k=0; k<NumIdx; k++)
+        {
+            eqn_Y.row(k) = EqnA.row(weight_index(k));
+            eqn_D(k) = W(weight_index(k),i) - 1;
+        }
+        temp_N = EqnALLT.solve(eqn_Y.transpose());
+        eqn_S = eqn_Y * temp_N;
+        eqn_S.diagonal() += eqn_D.cwiseInverse();
+        sol_X.col(i) -= temp_N * eqn_S.partialPivLu().solve(temp_N.transpose() * temp_M.col(i));
     }
-    RRsss.append(SSSIn);
-    RRsss.append(SSSOut);
-    RRsss.append(Weight);
-    RRsss.append(ErrRel);
-
-    //qDebug() << "getSSSRR END";
 
-//    return RRsss;
-    return SSSIn;
+//  % recover internal MEG siganl
+    SSSIn.middleCols(StartCol, NumCols).noalias() = EqnIn * sol_X.topRows(NumBIn);
 }
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -981,47 +1187,19 @@ MatrixXd RtSssAlgo::getSSSOLS(MatrixXd EqnB)
 {
     //qDebug() << "getSSSOLS START";
 
-    int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut;
-    MatrixXd sol_X, sol_in, sol_out;
-    VectorXd ErrRel;
-    QList<MatrixXd> OLSsss;
+    int NumBIn;
+    MatrixXd sol_X;
 
 //  % initialization
     NumBIn = EqnIn.cols();
-    NumBOut = EqnOut.cols();
-    NumCoil = EqnB.rows();
-    NumExp = EqnB.cols();
-
-    EqnRRInv = (EqnA.transpose() * EqnA).inverse();
-    SSSIn.setZero(NumCoil,NumExp);
-    SSSOut.setZero(NumCoil,NumExp);
-    ErrRel.setZero(NumExp);
-
-    for (int i=0; i<NumExp; i++)
-    {
-//      % solve OLS solution
-        sol_X = EqnRRInv * (EqnA.transpose() * EqnB.col(i));
-
-        ErrRel(i) = (EqnA * sol_X - EqnB.col(i)).norm() / EqnB.col(i).norm();
-
-        sol_in = sol_X.block(0,0,NumBIn,1);
 
-        sol_out = sol_X.block(NumBIn,0, NumBOut,1);    // probably NumBIn+0 is correct.  Please debug !!!!
-
-//      % recover internal/external MEG siganl
-        SSSIn.col(i) = EqnIn * sol_in;
-        SSSOut.col(i) = EqnOut * sol_out;
-    }
-
-    OLSsss.append(SSSIn);
-    OLSsss.append(SSSOut);
-    OLSsss.append(ErrRel);
+//  % solve OLS solution of all samples at once
+    sol_X = EqnALLT.solve(EqnA.transpose() * EqnB);
 
     //qDebug() << "getSSSOLS END";
 
-//    return OLSsss;
-    return SSSIn;
+//  % recover internal MEG siganl
+    return EqnIn * sol_X.topRows(NumBIn);
 }
 
 // Return number of meg channels
@@ -68,6 +68,13 @@
 #define BABYMEG 1
 #define VECTORVIEW 2
 
+#define RTSSS_RR_MAX_ITER       100     /**< Maximal number of robust regression iterations per sample. */
+#define RTSSS_RR_MIN_CHUNK      32      /**< Minimal number of samples handed to one robust regression worker. */
+#define RTSSS_REORIGIN_THRESHOLD 0.005     /**< Head displacement [m] which triggers a rebuild of the internal basis. */
+#define RTSSS_HEAD_ORIGIN_Z 0.04           /**< z of the SSS origin in head coordinates [m], x and y are 0. */
+#define RTSSS_BASIS_CACHE_MAGIC 0x53535342  /**< "SSSB" - magic of a cached SSS basis file. */
+#define RTSSS_BASIS_CACHE_VER   1           /**< Version of the cached SSS basis file layout. */
+
 using namespace Eigen;
 using namespace std;
 using namespace FIFFLIB;
@@ -109,6 +116,10 @@ public:
 
     QList<MatrixXd> getLinEqn();
 
+    void setBasisCacheDir(const QString& dir);
+    bool updateOrigin(const Vector3d& origin, double threshold);
+    Vector3d getOrigin();
+
     void setMEGInfo(FiffInfo::SPtr fiffinfo, RowVectorXi);
     void setSSSParameter(QList<int>);
     qint32 getNumMEGChan();
@@ -121,12 +132,26 @@ private:
     void getCoilInfoVectorView4Sim();
     void getCoilInfoBabyMEG4Sim();
     QList<MatrixXd> getSSSEqn(qint32, qint32);
+    QList<MatrixXd> getSSSEqnCached(qint32, qint32);
+    QString getBasisCacheFile(qint32, qint32);
+    MatrixXd assembleLinearEqn();
 //    QList<MatrixXd> getSSSEqn(VectorXi Lexp);
     void getSSSBasis(VectorXd, VectorXd, VectorXd, qint32, qint32);
     void getCartesianToSpherCoordinate(VectorXd, VectorXd, VectorXd);
     void getSphereToCartesianVector();
     int strmatch(char, char);
 
+    struct SSSRRChunk
+    {
+        const RtSssAlgo* Algo;
+        const MatrixXd* EqnB;
+        MatrixXd* SSSIn;
+        qint32 StartCol, NumCols;
+    };
+
+    void solveSSSRR(const MatrixXd& EqnB, qint32 StartCol, qint32 NumCols, MatrixXd& SSSIn) const;
+    static void solveSSSRRChunk(SSSRRChunk& chunk);
+
     qint32 NumMEGChan, NumCoil, NumBadCoil;
     VectorXi BadChan;
     QList<MatrixXd> CoilT;
@@ -140,6 +165,8 @@ private:
     Vector3d Origin;
     MatrixXd BInX, BInY, BInZ, BOutX, BOutY, BOutZ;
     MatrixXd EqnInRR, EqnOutRR, EqnIn, EqnOut, EqnARR, EqnA, EqnB;
+    LLT<MatrixXd> EqnARRLLT, EqnALLT;   // cached factorizations of EqnARR'*EqnARR and EqnA'*EqnA
+    QString BasisCacheDir;              // directory of the persisted SSS bases, empty disables the disk cache
 
     VectorXd R, PHI, THETA;
     VectorXd R_X, R_Y, R_Z;
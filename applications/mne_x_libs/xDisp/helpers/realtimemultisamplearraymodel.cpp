@@ -315,7 +315,8 @@ void RealTimeMultiSampleArrayModel::setFiffInfo(FiffInfo::SPtr& p_pFiffInfo)
         m_vecLastBlockFirstValuesRaw.conservativeResize(m_pFiffInfo->chs.size());
         m_vecLastBlockFirstValuesRaw.setZero();
 
-        m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
+        if(!m_filterData.isEmpty())
+            m_pOverlapSaveFilter = OverlapSaveFilter::SPtr(new OverlapSaveFilter(m_filterData, m_pFiffInfo->chs.size()));
 
         m_matSparseProj = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
         m_matSparseComp = SparseMatrix<double>(m_pFiffInfo->chs.size(),m_pFiffInfo->chs.size());
@@ -889,8 +890,8 @@ void RealTimeMultiSampleArrayModel::filterChanged(QList<FilterData> filterData)
         if(m_iMaxFilterLength<filterData.at(i).m_iFilterOrder)
             m_iMaxFilterLength = filterData.at(i).m_iFilterOrder;
 
-    m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
-    m_matOverlap.setZero();
+    //The new filter starts without history
+    m_pOverlapSaveFilter = OverlapSaveFilter::SPtr(new OverlapSaveFilter(m_filterData, m_pFiffInfo->chs.size()));
 
     m_bDrawFilterFront = false;
 
@@ -1157,7 +1158,6 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
 
         for(int r = 0; r<timeData.size(); r++) {
             m_matDataFiltered.row(timeData.at(r).second.first) = timeData.at(r).second.second.segment(m_iMaxFilterLength+m_iMaxFilterLength/2, m_matDataRaw.cols());
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
         }
     }
 
@@ -1177,9 +1177,7 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
 
 void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const MatrixXd &data, int dataIndex)
 {
-    //std::cout<<"START RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
-
-    if(dataIndex >= m_matDataFiltered.cols() || data.cols()<m_iMaxFilterLength)
+    if(dataIndex >= m_matDataFiltered.cols() || data.cols() == 0)
         return;
 
     if(data.rows() != m_matDataFiltered.rows()) {
@@ -1187,108 +1185,47 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const MatrixXd &d
         return;
     }
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
-    QList<int> notFilterChannelIndex;
-
-    for(qint32 i=0; i<data.rows(); ++i) {
-        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name))
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(m_filterData,QPair<int,RowVectorXd>(i,data.row(i))));
-        else
-            notFilterChannelIndex.append(i);
-    }
-
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
-
-        future.waitForFinished();
-
-        //Do the overlap add method and store in m_matDataFiltered
-        int iFilterDelay = m_iMaxFilterLength/2;
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
-
-        for(int r = 0; r<timeData.size(); r++) {
-            if(m_iCurrentSample+2*data.cols() > m_matDataRaw.cols()) {
-                //Handle last data block
-                //std::cout<<"Handle last data block"<<std::endl;
+    if(!m_pOverlapSaveFilter || m_pOverlapSaveFilter->numChannels() != data.rows())
+        m_pOverlapSaveFilter = OverlapSaveFilter::SPtr(new OverlapSaveFilter(m_filterData, data.rows()));
 
-                if(m_bDrawFilterFront) {
-                    //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+    //Filter all channels at once. The filter keeps the last samples of each channel, so the blocks are filtered as one continuous signal.
+    m_pOverlapSaveFilter->process(data, m_matDataBlockFiltered);
 
-                    //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+    //Column j of the filtered block belongs to the sample dataIndex+j-iFilterDelay
+    int iFilterDelay = m_pOverlapSaveFilter->delay();
+    int iFilteredNumberCols = data.cols();
 
-                    //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-                    int start = dataIndex-iFilterDelay < 0 ? 0 : dataIndex-iFilterDelay;
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
-                } else {
-                    //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(dataIndex-iFilterDelay,m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(dataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
-                }
-
-                //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
-            } else if(m_iCurrentSample == 0) {
-                //Handle first data block
-                //std::cout<<"Handle first data block"<<std::endl;
-
-                if(m_bDrawFilterFront) {
-                    //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+    for(qint32 i=0; i<data.rows(); ++i) {
+        if(!m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+            //Fill filtered data with raw data if the channel is not filtered
+            m_matDataFiltered.row(i).segment(dataIndex,iFilteredNumberCols) = data.row(i);
+            continue;
+        }
 
-                    //Add newly calculate data to the tail of the current filter data matrix
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(m_matDataFiltered.cols()-iFilterDelay-m_iResidual, iFilterDelay) = tempData.head(iFilterDelay) + m_matOverlap.row(timeData.at(r).second.first).head(iFilterDelay);
+        if(m_bDrawFilterFront) {
+            int start = dataIndex-iFilterDelay;
 
-                    //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay) = tempData.segment(iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay);
+            if(start < 0) {
+                //The delayed front of the first data block belongs to the end of the last display block
+                int iFront = qMin(-start, iFilteredNumberCols);
+                m_matDataFiltered.row(i).segment(m_matDataFiltered.cols()-m_iResidual+start, iFront) = m_matDataBlockFiltered.row(i).head(iFront);
 
-                    //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
-                    m_matDataFiltered.row(timeData.at(r).second.first).tail(m_iResidual) = m_matDataFiltered.row(timeData.at(r).second.first).head(m_iResidual);
-                } else {
-                    //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
-                }
+                if(iFront < iFilteredNumberCols)
+                    m_matDataFiltered.row(i).head(iFilteredNumberCols-iFront) = m_matDataBlockFiltered.row(i).tail(iFilteredNumberCols-iFront);
 
-                //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
+                if(m_iResidual > 0 && dataIndex == 0)
+                    m_matDataFiltered.row(i).tail(m_iResidual) = m_matDataFiltered.row(i).head(m_iResidual);
             } else {
-                //Handle middle data blocks
-                //std::cout<<"Handle middle data block"<<std::endl;
-
-                if(m_bDrawFilterFront) {
-                    //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
-
-                    //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
-
-                    //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(dataIndex-iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
-                } else {
-                    //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(dataIndex-iFilterDelay,m_iMaxFilterLength).setZero();// = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(dataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
-                }
-
-                //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matDataFiltered.row(i).segment(start,iFilteredNumberCols) = m_matDataBlockFiltered.row(i);
             }
+        } else if(iFilteredNumberCols > iFilterDelay) {
+            //The filter was changed. Skip the delayed front, it contains the settling of the new filter.
+            m_matDataFiltered.row(i).segment(dataIndex,iFilteredNumberCols-iFilterDelay) = m_matDataBlockFiltered.row(i).tail(iFilteredNumberCols-iFilterDelay);
         }
     }
 
     m_bDrawFilterFront = true;
-
-    //Fill filtered data with raw data if the channel was not filtered
-    for(int i = 0; i<notFilterChannelIndex.size(); i++)
-        m_matDataFiltered.row(notFilterChannelIndex.at(i)).segment(dataIndex,data.row(notFilterChannelIndex.at(i)).cols()) = data.row(notFilterChannelIndex.at(i));
-
-    //std::cout<<"END RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
 }
 
 
@@ -1304,7 +1241,9 @@ void RealTimeMultiSampleArrayModel::clearModel()
     m_matDataFilteredFreeze.setZero();
     m_vecLastBlockFirstValuesFiltered.setZero();
     m_vecLastBlockFirstValuesRaw.setZero();
-    m_matOverlap.setZero();
+
+    if(m_pOverlapSaveFilter)
+        m_pOverlapSaveFilter->reset();
 
     endResetModel();
 
@@ -47,6 +47,7 @@
 #include <fiff/fiff_info.h>
 
 #include <utils/filterTools/filterdata.h>
+#include <utils/filterTools/overlapsavefilter.h>
 #include <utils/mnemath.h>
 #include <utils/detecttrigger.h>
 #include <utils/ioutils.h>
@@ -579,7 +580,9 @@ private:
     MatrixXdR                           m_matDataFiltered;                          /**< The filtered data */
     MatrixXdR                           m_matDataRawFreeze;                         /**< The raw data in freeze mode */
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode */
-    MatrixXd                            m_matOverlap;                               /**< Last overlap block for the back */
+    MatrixXd                            m_matDataBlockFiltered;                     /**< The filtered current data block */
+
+    OverlapSaveFilter::SPtr             m_pOverlapSaveFilter;                       /**< Stateful filter of the incoming data blocks, holds the filter history of all channels */
 
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA oerpator in case of a VectorView system.*/
     Eigen::VectorXi                     m_vecIndicesSecondVV;                       /**< The indices of the channels to pick for the second SPHARA oerpator in case of a VectorView system.*/
@@ -655,7 +658,7 @@ inline qint32 RealTimeMultiSampleArrayModel::getCurrentSampleIndex() const
 //        if(!m_bDrawFilterFront)
 //            return m_iCurrentSample+m_iMaxFilterLength/2;
 //        else
-            return m_iCurrentSample-m_iMaxFilterLength/2;
+            return m_iCurrentSample-getCurrentOverlapAddDelay();
     }
 
     return m_iCurrentSample;
@@ -800,7 +803,7 @@ inline bool RealTimeMultiSampleArrayModel::triggerDetectionActive() const
 inline int RealTimeMultiSampleArrayModel::getCurrentOverlapAddDelay() const
 {
     if(!m_filterData.isEmpty())
-        return m_iMaxFilterLength/2;
+        return m_pOverlapSaveFilter ? m_pOverlapSaveFilter->delay() : m_iMaxFilterLength/2;
     else
         return 0;
 }
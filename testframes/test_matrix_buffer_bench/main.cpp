@@ -0,0 +1,197 @@
+//=============================================================================================================
+/**
+* @file     main.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Benchmark of CircularMatrixBuffer against its semaphore based predecessor CircularMatrixBuffer_old.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <generics/circularmatrixbuffer.h>
+#include <generics/circularmatrixbuffer_old.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QFuture>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace IOBuffer;
+
+
+//*************************************************************************************************************
+
+template<typename BufferType>
+void produce(BufferType* pBuffer, const MatrixXd* pMatrix, int iNumBlocks)
+{
+    for(int i = 0; i < iNumBlocks; ++i)
+        pBuffer->push(pMatrix);
+}
+
+
+//*************************************************************************************************************
+
+void printResult(const char* sName, qint64 iNsecs, int iNumBlocks, int iRows, int iCols)
+{
+    double t_dSecs = (double)iNsecs/1.0e9;
+    double t_dMBytes = (double)iNumBlocks*iRows*iCols*sizeof(double)/(1024.0*1024.0);
+    printf("%-28s %9.2f ms  %10.1f blocks/s  %9.1f MB/s\n", sName, t_dSecs*1000.0, iNumBlocks/t_dSecs, t_dMBytes/t_dSecs);
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+//=============================================================================================================
+/**
+* The function main marks the entry point of the program.
+* By default, main has the storage class extern.
+*
+* Pushes blocks of 306 channels x 1000 samples from a producer thread and pops them in the main thread.
+* Optional arguments: number of blocks, buffer length in blocks.
+*
+* @param [in] argc (argument count) is an integer that indicates how many arguments were entered on the command line when the program was started.
+* @param [in] argv (argument vector) is an array of pointers to arrays of character objects. The array objects are null-terminated strings, representing the arguments that were entered on the command line when the program was started.
+* @return the value that was set to exit() (which is 0 if exit() is called via quit()).
+*/
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    const int iRows = 306;
+    const int iCols = 1000;
+    int iNumBlocks = argc > 1 ? atoi(argv[1]) : 2000;
+    int iBufferLength = argc > 2 ? atoi(argv[2]) : 8;
+
+    MatrixXd matBlock = MatrixXd::Random(iRows, iCols);
+    MatrixXd matOut;
+    QElapsedTimer timer;
+    QFuture<void> future;
+    double dCheck = 0;
+
+    printf("%d blocks of %d x %d doubles, buffer length %d\n\n", iNumBlocks, iRows, iCols, iBufferLength);
+
+    //
+    // Semaphore based buffer, per element copy
+    //
+    {
+        CircularMatrixBuffer_old<double> bufferOld(iBufferLength, iRows, iCols);
+        timer.start();
+        future = QtConcurrent::run(produce<CircularMatrixBuffer_old<double> >, &bufferOld, &matBlock, iNumBlocks);
+        for(int i = 0; i < iNumBlocks; ++i)
+        {
+            matOut = bufferOld.pop();
+            dCheck += matOut(0,0);
+        }
+        future.waitForFinished();
+        printResult("CircularMatrixBuffer_old", timer.nsecsElapsed(), iNumBlocks, iRows, iCols);
+    }
+
+    //
+    // Lock-free buffer, pop returning a new matrix
+    //
+    {
+        CircularMatrixBuffer<double> buffer(iBufferLength, iRows, iCols);
+        timer.start();
+        future = QtConcurrent::run(produce<CircularMatrixBuffer<double> >, &buffer, &matBlock, iNumBlocks);
+        for(int i = 0; i < iNumBlocks; ++i)
+        {
+            matOut = buffer.pop();
+            dCheck += matOut(0,0);
+        }
+        future.waitForFinished();
+        printResult("CircularMatrixBuffer pop()", timer.nsecsElapsed(), iNumBlocks, iRows, iCols);
+    }
+
+    //
+    // Lock-free buffer, pop into a preallocated matrix
+    //
+    {
+        CircularMatrixBuffer<double> buffer(iBufferLength, iRows, iCols);
+        matOut.resize(iRows, iCols);
+        timer.start();
+        future = QtConcurrent::run(produce<CircularMatrixBuffer<double> >, &buffer, &matBlock, iNumBlocks);
+        for(int i = 0; i < iNumBlocks; ++i)
+        {
+            buffer.pop(matOut);
+            dCheck += matOut(0,0);
+        }
+        future.waitForFinished();
+        printResult("CircularMatrixBuffer pop(&)", timer.nsecsElapsed(), iNumBlocks, iRows, iCols);
+    }
+
+    //
+    // Lock-free buffer, borrowed view
+    //
+    {
+        CircularMatrixBuffer<double> buffer(iBufferLength, iRows, iCols);
+        timer.start();
+        future = QtConcurrent::run(produce<CircularMatrixBuffer<double> >, &buffer, &matBlock, iNumBlocks);
+        for(int i = 0; i < iNumBlocks; ++i)
+        {
+            dCheck += buffer.acquireView()(0,0);
+            buffer.releaseView();
+        }
+        future.waitForFinished();
+        printResult("CircularMatrixBuffer view", timer.nsecsElapsed(), iNumBlocks, iRows, iCols);
+    }
+
+    printf("\nCheck: %s\n", dCheck == 4.0*iNumBlocks*matBlock(0,0) ? "passed" : "FAILED");
+
+    return 0;
+}